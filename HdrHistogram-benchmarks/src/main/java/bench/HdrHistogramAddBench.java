@@ -0,0 +1,73 @@
+/**
+ * Written by Gil Tene of Azul Systems, and released to the public domain,
+ * as explained at http://creativecommons.org/publicdomain/zero/1.0/
+ *
+ * @author Gil Tene
+ */
+
+package bench;
+
+import org.HdrHistogram.*;
+import org.openjdk.jmh.annotations.*;
+
+import java.util.concurrent.TimeUnit;
+
+/*
+  Measures adding (and subtracting) same-shape histograms, with dense inputs (every bucket populated) and
+  sparse inputs (a few values within a narrow span):
+    $ java -jar target/benchmarks.jar HdrHistogramAddBench
+ */
+@Warmup(iterations = 5, time = 1, timeUnit = TimeUnit.SECONDS)
+@Measurement(iterations = 5, time = 1, timeUnit = TimeUnit.SECONDS)
+@Fork(3)
+@State(Scope.Thread)
+
+public class HdrHistogramAddBench {
+    static final long highestTrackableValue = 3600L * 1000 * 1000; // e.g. for 1 hr in usec units
+
+    @Param({"Histogram", "IntCountsHistogram", "ShortCountsHistogram", "PackedHistogram"})
+    String histogramType;
+
+    @Param({"dense", "sparse"})
+    String inputDistribution;
+
+    @Param({ "2", "3" })
+    int numberOfSignificantValueDigits;
+
+    AbstractHistogram histogram;
+    AbstractHistogram otherHistogram;
+
+    AbstractHistogram newHistogram() {
+        if (histogramType.equals("IntCountsHistogram")) {
+            return new IntCountsHistogram(highestTrackableValue, numberOfSignificantValueDigits);
+        } else if (histogramType.equals("ShortCountsHistogram")) {
+            return new ShortCountsHistogram(highestTrackableValue, numberOfSignificantValueDigits);
+        } else if (histogramType.equals("PackedHistogram")) {
+            return new PackedHistogram(highestTrackableValue, numberOfSignificantValueDigits);
+        }
+        return new Histogram(highestTrackableValue, numberOfSignificantValueDigits);
+    }
+
+    @Setup
+    public void setup() {
+        histogram = newHistogram();
+        otherHistogram = newHistogram();
+        if (inputDistribution.equals("dense")) {
+            for (long value = 1; value < highestTrackableValue; value = otherHistogram.nextNonEquivalentValue(value)) {
+                otherHistogram.recordValue(value);
+            }
+        } else {
+            for (long value = 1000; value < 1100; value += 10) {
+                otherHistogram.recordValue(value);
+            }
+        }
+        histogram.add(otherHistogram);
+    }
+
+    @Benchmark
+    public void addThenSubtract() {
+        // Pairing the add with a subtract keeps narrow counts from overflowing across iterations:
+        histogram.add(otherHistogram);
+        histogram.subtract(otherHistogram);
+    }
+}
@@ -0,0 +1,77 @@
+/**
+ * Written by Gil Tene of Azul Systems, and released to the public domain,
+ * as explained at http://creativecommons.org/publicdomain/zero/1.0/
+ *
+ * @author Gil Tene
+ */
+
+package bench;
+
+import org.HdrHistogram.*;
+import org.openjdk.jmh.annotations.*;
+
+import java.util.Random;
+import java.util.concurrent.TimeUnit;
+
+/*
+  Measures percentile queries of (and additions from) concurrent histograms, both when the histogram is quiescent
+  and when every query follows a new recording:
+    $ java -jar target/benchmarks.jar HdrHistogramConcurrentQueryBench
+ */
+@Warmup(iterations = 5, time = 1, timeUnit = TimeUnit.SECONDS)
+@Measurement(iterations = 5, time = 1, timeUnit = TimeUnit.SECONDS)
+@Fork(3)
+@State(Scope.Thread)
+
+public class HdrHistogramConcurrentQueryBench {
+    static final long highestTrackableValue = 3600L * 1000 * 1000; // e.g. for 1 hr in usec units
+    static final int numberOfSignificantValueDigits = 3;
+    static final double[] percentiles = {50.0, 90.0, 99.0, 99.9, 99.99, 100.0};
+
+    @Param({"ConcurrentHistogram", "PackedConcurrentHistogram", "Histogram"})
+    String histogramType;
+
+    AbstractHistogram histogram;
+    Histogram targetHistogram;
+    long[] valuesAtPercentiles = new long[percentiles.length];
+    int i;
+
+    @Setup
+    public void setup() {
+        if (histogramType.equals("ConcurrentHistogram")) {
+            histogram = new ConcurrentHistogram(highestTrackableValue, numberOfSignificantValueDigits);
+        } else if (histogramType.equals("PackedConcurrentHistogram")) {
+            histogram = new PackedConcurrentHistogram(highestTrackableValue, numberOfSignificantValueDigits);
+        } else {
+            histogram = new Histogram(highestTrackableValue, numberOfSignificantValueDigits);
+        }
+        targetHistogram = new Histogram(highestTrackableValue, numberOfSignificantValueDigits);
+        Random random = new Random(42);
+        for (int j = 0; j < 100000; j++) {
+            histogram.recordValue((long) (100000 * random.nextDouble() * random.nextDouble()));
+        }
+    }
+
+    @Benchmark
+    public long quiescentValueAtPercentile() {
+        return histogram.getValueAtPercentile(99.9);
+    }
+
+    @Benchmark
+    public long[] quiescentValuesAtPercentiles() {
+        histogram.getValuesAtPercentiles(percentiles, valuesAtPercentiles);
+        return valuesAtPercentiles;
+    }
+
+    @Benchmark
+    public long recordThenValueAtPercentile() {
+        histogram.recordValue(1000 + (i++ & 0xfff));
+        return histogram.getValueAtPercentile(99.9);
+    }
+
+    @Benchmark
+    public void addToHistogram() {
+        targetHistogram.reset();
+        targetHistogram.add(histogram);
+    }
+}
@@ -0,0 +1,68 @@
+/**
+ * Written by Gil Tene of Azul Systems, and released to the public domain,
+ * as explained at http://creativecommons.org/publicdomain/zero/1.0/
+ *
+ * @author Gil Tene
+ */
+
+package bench;
+
+import org.HdrHistogram.*;
+import org.openjdk.jmh.annotations.*;
+
+import java.util.concurrent.TimeUnit;
+
+/*
+  Measures multi-threaded recording into a shared ConcurrentDoubleHistogram, where periodic outlier values
+  (in both directions) keep expanding the covered range. Each measured iteration records a batch of values per
+  thread into a freshly constructed histogram, so that every iteration includes the same range adjustments:
+    $ java -jar target/benchmarks.jar HdrHistogramDoubleRangeContentionBench -t 16
+ */
+@BenchmarkMode(Mode.SingleShotTime)
+@OutputTimeUnit(TimeUnit.MILLISECONDS)
+@Warmup(iterations = 10, batchSize = HdrHistogramDoubleRangeContentionBench.recordingsPerBatch)
+@Measurement(iterations = 10, batchSize = HdrHistogramDoubleRangeContentionBench.recordingsPerBatch)
+@Fork(3)
+@State(Scope.Benchmark)
+
+public class HdrHistogramDoubleRangeContentionBench {
+    static final int recordingsPerBatch = 100000;
+    static final int numberOfSignificantValueDigits = 3;
+    static final long highestToLowestValueRatio = 1000L * 1000 * 1000 * 1000;
+
+    @Param({"autoResizing", "fixedRange"})
+    String rangeMode;
+
+    // Record an outlier once every this many recordings per thread (0 for no outliers):
+    @Param({"0", "1000", "100"})
+    int outlierInterval;
+
+    ConcurrentDoubleHistogram histogram;
+
+    @State(Scope.Thread)
+    public static class ThreadState {
+        int i;
+        int outliers;
+    }
+
+    @Setup(Level.Iteration)
+    public void setup() {
+        histogram = rangeMode.equals("autoResizing") ?
+                new ConcurrentDoubleHistogram(numberOfSignificantValueDigits) :
+                new ConcurrentDoubleHistogram(highestToLowestValueRatio, numberOfSignificantValueDigits);
+        // Start from a narrow range around the common values:
+        histogram.recordValue(1.0);
+        histogram.recordValue(2.0);
+    }
+
+    @Benchmark
+    public void recordWithRangeExpansions(ThreadState threadState) {
+        double value = 1.0 + ((threadState.i++ & 0xff) / 256.0);
+        if ((outlierInterval > 0) && ((threadState.i % outlierInterval) == 0)) {
+            // Outliers alternate between ever lower and ever higher values (by factors of 4, up to 2^18 each way):
+            final int magnitude = 2 * (1 + ((threadState.outliers >> 1) % 9));
+            value = ((threadState.outliers++ & 1) == 0) ? value / (1L << magnitude) : value * (1L << magnitude);
+        }
+        histogram.recordValue(value);
+    }
+}
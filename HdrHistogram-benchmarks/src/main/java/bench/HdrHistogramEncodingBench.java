@@ -74,4 +74,24 @@ public class HdrHistogramEncodingBench {
         buffer.rewind();
         Histogram.decodeFromCompressedByteBuffer(buffer, 0);
     }
+
+    @Benchmark
+    public void fastEncodeIntoCompressedByteBuffer() {
+        buffer.clear();
+        histogram.encodeIntoCompressedByteBuffer(buffer, HistogramCompressionCodec.FAST);
+    }
+
+    @Benchmark
+    public void nonCompressedEncodeIntoCompressedByteBuffer() {
+        buffer.clear();
+        histogram.encodeIntoCompressedByteBuffer(buffer, HistogramCompressionCodec.NONE);
+    }
+
+    @Benchmark
+    public void roundtripFastCompressed() throws DataFormatException {
+        buffer.clear();
+        histogram.encodeIntoCompressedByteBuffer(buffer, HistogramCompressionCodec.FAST);
+        buffer.rewind();
+        Histogram.decodeFromCompressedByteBuffer(buffer, 0);
+    }
 }
@@ -0,0 +1,111 @@
+/**
+ * Written by Gil Tene of Azul Systems, and released to the public domain,
+ * as explained at http://creativecommons.org/publicdomain/zero/1.0/
+ *
+ * @author Gil Tene
+ */
+
+package bench;
+
+import org.HdrHistogram.*;
+import org.openjdk.jmh.annotations.*;
+import org.openjdk.jmh.infra.Blackhole;
+
+import java.io.ByteArrayInputStream;
+import java.io.ByteArrayOutputStream;
+import java.io.IOException;
+import java.io.InputStream;
+import java.util.concurrent.TimeUnit;
+import java.util.zip.DataFormatException;
+
+/*
+  Measures scanning of the bundled jHiccup log, with and without decoding of the interval histograms:
+    $ java -jar target/benchmarks.jar HdrHistogramLogScanningBench
+ */
+@Warmup(iterations = 5, time = 1, timeUnit = TimeUnit.SECONDS)
+@Measurement(iterations = 5, time = 1, timeUnit = TimeUnit.SECONDS)
+@Fork(3)
+@State(Scope.Thread)
+
+public class HdrHistogramLogScanningBench {
+
+    byte[] logBytes;
+
+    @Setup
+    public void setup() throws IOException {
+        InputStream inputStream = HistogramData.class.getResourceAsStream("jHiccup-2.0.6.logV1.hlog");
+        ByteArrayOutputStream outputStream = new ByteArrayOutputStream();
+        byte[] chunk = new byte[8192];
+        int bytesRead;
+        while ((bytesRead = inputStream.read(chunk)) > 0) {
+            outputStream.write(chunk, 0, bytesRead);
+        }
+        inputStream.close();
+        logBytes = outputStream.toByteArray();
+    }
+
+    static class CountingHandler implements HistogramLogScanner.EventHandler {
+        final boolean decode;
+        final Blackhole blackhole;
+
+        CountingHandler(boolean decode, Blackhole blackhole) {
+            this.decode = decode;
+            this.blackhole = blackhole;
+        }
+
+        @Override
+        public boolean onComment(String comment) {
+            return false;
+        }
+
+        @Override
+        public boolean onBaseTime(double secondsSinceEpoch) {
+            return false;
+        }
+
+        @Override
+        public boolean onStartTime(double secondsSinceEpoch) {
+            return false;
+        }
+
+        @Override
+        public boolean onHistogram(String tag, double timestamp, double length,
+                                   HistogramLogScanner.EncodableHistogramSupplier lazyReader) {
+            blackhole.consume(timestamp);
+            if (decode) {
+                try {
+                    blackhole.consume(lazyReader.read());
+                } catch (DataFormatException ex) {
+                    throw new IllegalStateException(ex);
+                }
+            }
+            return false;
+        }
+
+        @Override
+        public boolean onException(Throwable t) {
+            throw new IllegalStateException(t);
+        }
+    }
+
+    @Benchmark
+    public void scanTimestampsOnly(Blackhole blackhole) {
+        HistogramLogScanner scanner = new HistogramLogScanner(new ByteArrayInputStream(logBytes));
+        scanner.process(new CountingHandler(false, blackhole));
+    }
+
+    @Benchmark
+    public void scanAndDecodeHistograms(Blackhole blackhole) {
+        HistogramLogScanner scanner = new HistogramLogScanner(new ByteArrayInputStream(logBytes));
+        scanner.process(new CountingHandler(true, blackhole));
+    }
+
+    @Benchmark
+    public void readAllIntervalHistograms(Blackhole blackhole) {
+        HistogramLogReader reader = new HistogramLogReader(new ByteArrayInputStream(logBytes));
+        EncodableHistogram histogram;
+        while ((histogram = reader.nextIntervalHistogram()) != null) {
+            blackhole.consume(histogram);
+        }
+    }
+}
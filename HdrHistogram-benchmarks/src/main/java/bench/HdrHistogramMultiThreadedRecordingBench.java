@@ -0,0 +1,100 @@
+/**
+ * Written by Gil Tene of Azul Systems, and released to the public domain,
+ * as explained at http://creativecommons.org/publicdomain/zero/1.0/
+ *
+ * @author Gil Tene
+ */
+
+package bench;
+
+import org.HdrHistogram.*;
+import org.openjdk.jmh.annotations.Benchmark;
+import org.openjdk.jmh.annotations.Fork;
+import org.openjdk.jmh.annotations.Measurement;
+import org.openjdk.jmh.annotations.Scope;
+import org.openjdk.jmh.annotations.Setup;
+import org.openjdk.jmh.annotations.State;
+import org.openjdk.jmh.annotations.Warmup;
+import org.openjdk.jmh.runner.Runner;
+import org.openjdk.jmh.runner.RunnerException;
+import org.openjdk.jmh.runner.options.Options;
+import org.openjdk.jmh.runner.options.OptionsBuilder;
+
+import java.util.concurrent.TimeUnit;
+
+/*
+  Compares multi-threaded recording into shared (atomic and concurrent) histograms and recorders. Run with a
+  given number of recording threads:
+    $ java -jar target/benchmarks.jar HdrHistogramMultiThreadedRecordingBench -t 32
+
+  Or scale from 1 to N (default: 2 x available processors) recording threads, in powers of 2:
+    $ java -cp target/benchmarks.jar bench.HdrHistogramMultiThreadedRecordingBench [N]
+ */
+@Warmup(iterations = 5, time = 1, timeUnit = TimeUnit.SECONDS)
+@Measurement(iterations = 5, time = 1, timeUnit = TimeUnit.SECONDS)
+@Fork(3)
+@State(Scope.Benchmark)
+
+public class HdrHistogramMultiThreadedRecordingBench {
+    static final long highestTrackableValue = 3600L * 1000 * 1000; // e.g. for 1 hr in usec units
+    static final int numberOfSignificantValueDigits = 3;
+    static final long testValueLevel = 12340;
+
+    AtomicHistogram atomicHistogram;
+    ConcurrentHistogram concurrentHistogram;
+    PackedConcurrentHistogram packedConcurrentHistogram;
+    Recorder recorder;
+    StripedRecorder stripedRecorder;
+
+    @State(Scope.Thread)
+    public static class ThreadState {
+        int i;
+    }
+
+    @Setup
+    public void setup() {
+        atomicHistogram = new AtomicHistogram(highestTrackableValue, numberOfSignificantValueDigits);
+        concurrentHistogram = new ConcurrentHistogram(highestTrackableValue, numberOfSignificantValueDigits);
+        packedConcurrentHistogram =
+                new PackedConcurrentHistogram(highestTrackableValue, numberOfSignificantValueDigits);
+        recorder = new Recorder(highestTrackableValue, numberOfSignificantValueDigits);
+        stripedRecorder = new StripedRecorder(highestTrackableValue, numberOfSignificantValueDigits);
+    }
+
+    @Benchmark
+    public void atomicHistogramRecordingSpeed(ThreadState threadState) {
+        atomicHistogram.recordValue(testValueLevel + (threadState.i++ & 0x800));
+    }
+
+    @Benchmark
+    public void concurrentHistogramRecordingSpeed(ThreadState threadState) {
+        concurrentHistogram.recordValue(testValueLevel + (threadState.i++ & 0x800));
+    }
+
+    @Benchmark
+    public void packedConcurrentHistogramRecordingSpeed(ThreadState threadState) {
+        packedConcurrentHistogram.recordValue(testValueLevel + (threadState.i++ & 0x800));
+    }
+
+    @Benchmark
+    public void recorderRecordingSpeed(ThreadState threadState) {
+        recorder.recordValue(testValueLevel + (threadState.i++ & 0x800));
+    }
+
+    @Benchmark
+    public void stripedRecorderRecordingSpeed(ThreadState threadState) {
+        stripedRecorder.recordValue(testValueLevel + (threadState.i++ & 0x800));
+    }
+
+    public static void main(String[] args) throws RunnerException {
+        int maxThreads = (args.length > 0) ?
+                Integer.parseInt(args[0]) : 2 * Runtime.getRuntime().availableProcessors();
+        for (int threads = 1; threads <= maxThreads; threads *= 2) {
+            Options options = new OptionsBuilder()
+                    .include(HdrHistogramMultiThreadedRecordingBench.class.getSimpleName())
+                    .threads(threads)
+                    .build();
+            new Runner(options).run();
+        }
+    }
+}
@@ -0,0 +1,83 @@
+/**
+ * Written by Gil Tene of Azul Systems, and released to the public domain,
+ * as explained at http://creativecommons.org/publicdomain/zero/1.0/
+ *
+ * @author Gil Tene
+ */
+
+package bench;
+
+import org.HdrHistogram.*;
+import org.openjdk.jmh.annotations.*;
+import org.openjdk.jmh.infra.Blackhole;
+
+import java.nio.ByteBuffer;
+import java.util.concurrent.TimeUnit;
+
+/*
+  Measures the upkeep cost of a Histogram's occupancy bitmap on recording, against its benefit when iterating,
+  encoding and adding sparsely populated histograms (a few hundred distinct values across tens of thousands of
+  counts slots):
+    $ java -jar target/benchmarks.jar HdrHistogramOccupancyBench
+ */
+@Warmup(iterations = 5, time = 1, timeUnit = TimeUnit.SECONDS)
+@Measurement(iterations = 5, time = 1, timeUnit = TimeUnit.SECONDS)
+@Fork(3)
+@State(Scope.Thread)
+
+public class HdrHistogramOccupancyBench {
+    static final long highestTrackableValue = 3600L * 1000 * 1000; // e.g. for 1 hr in usec units
+    static final int numberOfSignificantValueDigits = 3;
+    static final int numberOfDistinctValues = 256;
+    static final int valuesMask = numberOfDistinctValues - 1;
+
+    @Param({"false", "true"})
+    boolean occupancyTracking;
+
+    Histogram histogram;
+    Histogram sparseHistogram;
+    Histogram targetHistogram;
+    ByteBuffer buffer;
+    long[] values;
+    int valueIndex;
+
+    @Setup
+    public void setup() {
+        histogram = new Histogram(highestTrackableValue, numberOfSignificantValueDigits);
+        histogram.setOccupancyTracking(occupancyTracking);
+        sparseHistogram = new Histogram(highestTrackableValue, numberOfSignificantValueDigits);
+        sparseHistogram.setOccupancyTracking(occupancyTracking);
+        targetHistogram = new Histogram(highestTrackableValue, numberOfSignificantValueDigits);
+        // Values spread (log-uniformly) across the whole value range:
+        values = new long[numberOfDistinctValues];
+        for (int i = 0; i < values.length; i++) {
+            values[i] = (long) Math.pow(highestTrackableValue, (i + 1.0) / values.length);
+            sparseHistogram.recordValue(values[i]);
+        }
+        buffer = ByteBuffer.allocate(sparseHistogram.getNeededByteBufferCapacity());
+    }
+
+    @Benchmark
+    public void recordValue() {
+        histogram.recordValue(values[valueIndex++ & valuesMask]);
+    }
+
+    @Benchmark
+    public void iterateRecordedValues(Blackhole blackhole) {
+        for (HistogramIterationValue v : sparseHistogram.recordedValues()) {
+            blackhole.consume(v.getCountAtValueIteratedTo());
+        }
+    }
+
+    @Benchmark
+    public void encodeIntoByteBuffer(Blackhole blackhole) {
+        buffer.clear();
+        blackhole.consume(sparseHistogram.encodeIntoByteBuffer(buffer));
+    }
+
+    @Benchmark
+    public void addThenSubtract() {
+        targetHistogram.add(sparseHistogram);
+        targetHistogram.subtract(sparseHistogram);
+    }
+}
@@ -0,0 +1,105 @@
+/**
+ * Written by Gil Tene of Azul Systems, and released to the public domain,
+ * as explained at http://creativecommons.org/publicdomain/zero/1.0/
+ *
+ * @author Gil Tene
+ */
+
+package bench;
+
+import org.HdrHistogram.*;
+import org.openjdk.jmh.annotations.Benchmark;
+import org.openjdk.jmh.annotations.Fork;
+import org.openjdk.jmh.annotations.Measurement;
+import org.openjdk.jmh.annotations.Scope;
+import org.openjdk.jmh.annotations.Setup;
+import org.openjdk.jmh.annotations.State;
+import org.openjdk.jmh.annotations.Warmup;
+import org.openjdk.jmh.runner.Runner;
+import org.openjdk.jmh.runner.RunnerException;
+import org.openjdk.jmh.runner.options.Options;
+import org.openjdk.jmh.runner.options.OptionsBuilder;
+
+import java.util.concurrent.TimeUnit;
+
+/*
+  Compares writer critical section scaling of WriterReaderPhaser and StripedWriterReaderPhaser, both bare and
+  as used by (integer and double) recorders. Run with a given number of recording threads:
+    $ java -jar target/benchmarks.jar HdrHistogramPhaserScalingBench -t 32
+
+  Or scale from 1 to N (default: 64) recording threads, in powers of 2:
+    $ java -cp target/benchmarks.jar bench.HdrHistogramPhaserScalingBench [N]
+ */
+@Warmup(iterations = 5, time = 1, timeUnit = TimeUnit.SECONDS)
+@Measurement(iterations = 5, time = 1, timeUnit = TimeUnit.SECONDS)
+@Fork(3)
+@State(Scope.Benchmark)
+
+public class HdrHistogramPhaserScalingBench {
+    static final long highestTrackableValue = 3600L * 1000 * 1000; // e.g. for 1 hr in usec units
+    static final int numberOfSignificantValueDigits = 3;
+    static final long testValueLevel = 12340;
+
+    WriterReaderPhaser phaser;
+    WriterReaderPhaser stripedPhaser;
+    Recorder recorder;
+    Recorder stripedPhaserRecorder;
+    DoubleRecorder doubleRecorder;
+    DoubleRecorder stripedPhaserDoubleRecorder;
+
+    @State(Scope.Thread)
+    public static class ThreadState {
+        int i;
+    }
+
+    @Setup
+    public void setup() {
+        phaser = new WriterReaderPhaser();
+        stripedPhaser = new StripedWriterReaderPhaser();
+        recorder = new Recorder(1, highestTrackableValue, numberOfSignificantValueDigits, false);
+        stripedPhaserRecorder = new Recorder(1, highestTrackableValue, numberOfSignificantValueDigits, true);
+        doubleRecorder = new DoubleRecorder(highestTrackableValue, numberOfSignificantValueDigits, false);
+        stripedPhaserDoubleRecorder = new DoubleRecorder(highestTrackableValue, numberOfSignificantValueDigits, true);
+    }
+
+    @Benchmark
+    public void phaserCriticalSection() {
+        phaser.writerCriticalSectionExit(phaser.writerCriticalSectionEnter());
+    }
+
+    @Benchmark
+    public void stripedPhaserCriticalSection() {
+        stripedPhaser.writerCriticalSectionExit(stripedPhaser.writerCriticalSectionEnter());
+    }
+
+    @Benchmark
+    public void recorderRecordingSpeed(ThreadState threadState) {
+        recorder.recordValue(testValueLevel + (threadState.i++ & 0x800));
+    }
+
+    @Benchmark
+    public void stripedPhaserRecorderRecordingSpeed(ThreadState threadState) {
+        stripedPhaserRecorder.recordValue(testValueLevel + (threadState.i++ & 0x800));
+    }
+
+    @Benchmark
+    public void doubleRecorderRecordingSpeed(ThreadState threadState) {
+        doubleRecorder.recordValue(testValueLevel + (threadState.i++ & 0x800));
+    }
+
+    @Benchmark
+    public void stripedPhaserDoubleRecorderRecordingSpeed(ThreadState threadState) {
+        stripedPhaserDoubleRecorder.recordValue(testValueLevel + (threadState.i++ & 0x800));
+    }
+
+    public static void main(String[] args) throws RunnerException {
+        int maxThreads = (args.length > 0) ? Integer.parseInt(args[0]) : 64;
+        for (int threads = 1; threads <= maxThreads; threads *= 2) {
+            Options options = new OptionsBuilder()
+                    .include(HdrHistogramPhaserScalingBench.class.getSimpleName())
+                    .threads(threads)
+                    .build();
+            new Runner(options).run();
+        }
+    }
+}
@@ -13,6 +13,7 @@ import org.HdrHistogram.Recorder;
 import org.openjdk.jmh.annotations.Benchmark;
 import org.openjdk.jmh.annotations.Fork;
 import org.openjdk.jmh.annotations.Measurement;
+import org.openjdk.jmh.annotations.OperationsPerInvocation;
 import org.openjdk.jmh.annotations.Scope;
 import org.openjdk.jmh.annotations.Setup;
 import org.openjdk.jmh.annotations.State;
@@ -41,17 +42,22 @@ public class HdrHistogramRecordingBench {
     static final long highestTrackableValue = 3600L * 1000 * 1000; // e.g. for 1 hr in usec units
     static final int numberOfSignificantValueDigits = 3;
     static final long testValueLevel = 12340;
+    static final int batchSize = 1024;
 
     AbstractHistogram histogram;
     AbstractHistogram synchronizedHistogram;
     AbstractHistogram atomicHistogram;
     AbstractHistogram concurrentHistogram;
+    AbstractHistogram adaptiveCountsHistogram;
+    AbstractHistogram pagedHistogram;
     Recorder recorder;
     SingleWriterRecorder singleWriterRecorder;
     DoubleHistogram doubleHistogram;
     DoubleRecorder doubleRecorder;
     SingleWriterDoubleRecorder singleWriterDoubleRecorder;
 
+    long[] batchValues;
+
     int i;
 
     @Setup
@@ -60,11 +66,17 @@ public class HdrHistogramRecordingBench {
         synchronizedHistogram = new SynchronizedHistogram(highestTrackableValue, numberOfSignificantValueDigits);
         atomicHistogram = new AtomicHistogram(highestTrackableValue, numberOfSignificantValueDigits);
         concurrentHistogram = new ConcurrentHistogram(highestTrackableValue, numberOfSignificantValueDigits);
+        adaptiveCountsHistogram = new AdaptiveCountsHistogram(highestTrackableValue, numberOfSignificantValueDigits);
+        pagedHistogram = new PagedHistogram(highestTrackableValue, numberOfSignificantValueDigits);
         recorder = new Recorder(highestTrackableValue, numberOfSignificantValueDigits);
         singleWriterRecorder = new SingleWriterRecorder(highestTrackableValue, numberOfSignificantValueDigits);
         doubleHistogram = new DoubleHistogram(highestTrackableValue, numberOfSignificantValueDigits);
         doubleRecorder = new DoubleRecorder(highestTrackableValue, numberOfSignificantValueDigits);
         singleWriterDoubleRecorder = new SingleWriterDoubleRecorder(highestTrackableValue, numberOfSignificantValueDigits);
+        batchValues = new long[batchSize];
+        for (int j = 0; j < batchSize; j++) {
+            batchValues[j] = testValueLevel + ((j * 7) & 0xfff);
+        }
     }
 
     @Benchmark
@@ -88,6 +100,16 @@ public class HdrHistogramRecordingBench {
         concurrentHistogram.recordValue(testValueLevel + (i++ & 0x800));
     }
 
+    @Benchmark
+    public void rawAdaptiveCountsRecordingSpeed() {
+        adaptiveCountsHistogram.recordValue(testValueLevel + (i++ & 0x800));
+    }
+
+    @Benchmark
+    public void rawPagedRecordingSpeed() {
+        pagedHistogram.recordValue(testValueLevel + (i++ & 0x800));
+    }
+
 
     @Benchmark
     public void singleWriterRecorderRecordingSpeed() {
@@ -116,4 +138,57 @@ public class HdrHistogramRecordingBench {
         singleWriterDoubleRecorder.recordValue(testValueLevel + (i++ & 0x800));
     }
 
+    // Batch recording. Scores are reported per value recorded, for comparison with the single value cases:
+
+    @Benchmark
+    @OperationsPerInvocation(batchSize)
+    public void rawSingleValueLoopRecordingSpeed() {
+        for (int j = 0; j < batchSize; j++) {
+            histogram.recordValue(batchValues[j]);
+        }
+    }
+
+    @Benchmark
+    @OperationsPerInvocation(batchSize)
+    public void rawBatchRecordingSpeed() {
+        histogram.recordValues(batchValues, 0, batchSize);
+    }
+
+    @Benchmark
+    @OperationsPerInvocation(batchSize)
+    public void rawConcurrentBatchRecordingSpeed() {
+        concurrentHistogram.recordValues(batchValues, 0, batchSize);
+    }
+
+    @Benchmark
+    @OperationsPerInvocation(batchSize)
+    public void recorderSingleValueLoopRecordingSpeed() {
+        for (int j = 0; j < batchSize; j++) {
+            recorder.recordValue(batchValues[j]);
+        }
+    }
+
+    @Benchmark
+    @OperationsPerInvocation(batchSize)
+    public void recorderBatchRecordingSpeed() {
+        recorder.recordValues(batchValues, 0, batchSize);
+    }
+
+    @Benchmark
+    @OperationsPerInvocation(batchSize)
+    public void singleWriterRecorderBatchRecordingSpeed() {
+        singleWriterRecorder.recordValues(batchValues, 0, batchSize);
+    }
+
+    // Coordinated omission correction of a 10 msec stall, with an expected interval of 1 usec (in nsec units):
+
+    @Benchmark
+    public void rawRecordingWithExpectedIntervalSpeed() {
+        histogram.recordValueWithExpectedInterval(10000000L + (i++ & 0x800), 1000L);
+    }
+
+    @Benchmark
+    public void recorderRecordingWithExpectedIntervalSpeed() {
+        recorder.recordValueWithExpectedInterval(10000000L + (i++ & 0x800), 1000L);
+    }
 }
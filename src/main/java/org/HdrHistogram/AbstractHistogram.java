@@ -11,6 +11,7 @@ import java.io.*;
 import java.lang.reflect.Constructor;
 import java.lang.reflect.InvocationTargetException;
 import java.nio.ByteBuffer;
+import java.util.Arrays;
 import java.util.Iterator;
 import java.util.Locale;
 import java.util.concurrent.atomic.AtomicLong;
@@ -49,6 +50,10 @@ abstract class AbstractHistogramBase extends EncodableHistogram {
     int countsArrayLength;
     int wordSizeInBytes;
 
+    // The (shared, interned) bucket geometry of the counts array. The geometry fields above and the hot fields in
+    // AbstractHistogram mirror it:
+    HistogramLayout layout;
+
     long startTimeStampMsec = Long.MAX_VALUE;
     long endTimeStampMsec = 0;
     String tag = null;
@@ -57,7 +62,56 @@ abstract class AbstractHistogramBase extends EncodableHistogram {
     double doubleToIntegerValueConversionRatio = 1.0;
 
     PercentileIterator percentileIterator;
-    RecordedValuesIterator recordedValuesIterator;
+
+    // Optional cumulative count (prefix sum) index, used to speed up percentile queries:
+    boolean cumulativeCountIndexing = false;
+    // Valid for as long as the contents remain unchanged. Each (re)build is made into a fresh array and published
+    // along with the total count it was built for as a single immutable object, so that concurrent queries never
+    // search an index that is being rebuilt:
+    volatile CumulativeCountIndex cachedCumulativeCountIndex;
+
+    static final class CumulativeCountIndex {
+        final long totalCount;
+        final long[] cumulativeCounts;
+
+        CumulativeCountIndex(final long totalCount, final long[] cumulativeCounts) {
+            this.totalCount = totalCount;
+            this.cumulativeCounts = cumulativeCounts;
+        }
+    }
+
+    // Cached mean and standard deviation, valid for as long as the contents remain unchanged. Published as a
+    // single immutable object, so that concurrent queries (e.g. of an AtomicHistogram) never see a mean and
+    // standard deviation from different computations, or paired with a different total count:
+    volatile Moments cachedMoments;
+
+    static final class Moments {
+        final long totalCount;
+        final double mean;
+        final double stdDeviation;
+
+        Moments(final long totalCount, final double mean, final double stdDeviation) {
+            this.totalCount = totalCount;
+            this.mean = mean;
+            this.stdDeviation = stdDeviation;
+        }
+    }
+
+    // Min and max values derived from the counts (when not tracked on recording), valid for as long as the
+    // contents remain unchanged. Published as a single immutable object, like the cached moments:
+    volatile DerivedMinAndMax cachedDerivedMinAndMax;
+
+    static final class DerivedMinAndMax {
+        final long totalCount;
+        final long maxValue;
+        final long minNonZeroValue;
+
+        DerivedMinAndMax(final long totalCount, final long maxValue, final long minNonZeroValue) {
+            this.totalCount = totalCount;
+            this.maxValue = maxValue;
+            this.minNonZeroValue = minNonZeroValue;
+        }
+    }
 
     ByteBuffer intermediateUncompressedByteBuffer = null;
     byte[] intermediateUncompressedByteArray = null;
@@ -124,6 +178,9 @@ public abstract class AbstractHistogram extends AbstractHistogramBase implements
     long unitMagnitudeMask;
     volatile long maxValue = 0;
     volatile long minNonZeroValue = Long.MAX_VALUE;
+    // When set, maxValue and minNonZeroValue are not maintained by recordings, and are derived from the counts
+    // when queried instead:
+    boolean lazyMinMaxTracking = false;
 
     private static final AtomicLongFieldUpdater<AbstractHistogram> maxValueUpdater =
             AtomicLongFieldUpdater.newUpdater(AbstractHistogram.class, "maxValue");
@@ -183,6 +240,56 @@ public abstract class AbstractHistogram extends AbstractHistogramBase implements
 
     abstract void resize(long newHighestTrackableValue);
 
+    /**
+     * Indicate whether this histogram's counts are held in its own backing counts array, and are only ever read
+     * and updated there with plain array accesses. {@link Histogram}, {@link IntCountsHistogram} and
+     * {@link ShortCountsHistogram} qualify. Their subclasses that keep their counts elsewhere, or update them
+     * atomically or under a critical section, override this to opt out.
+     * @return true if the backing counts array is plain
+     */
+    boolean countsArrayIsPlain() {
+        return false;
+    }
+
+    /**
+     * Get this histogram's backing counts array (a long[], int[] or short[], indexed by normalized index), if
+     * its counts may be read directly with plain array accesses (see {@link CountsArrayKernels}).
+     * @return the backing counts array, or null
+     */
+    Object getPlainCountsArray() {
+        return null;
+    }
+
+    /**
+     * Get this histogram's backing counts array, if its counts may also be updated directly with plain array
+     * accesses. Read-only implementations return null.
+     * @return the backing counts array, or null
+     */
+    Object getUpdatablePlainCountsArray() {
+        return getPlainCountsArray();
+    }
+
+    /**
+     * Get the histogram that queries of (and additions from) this histogram's contents should be run against.
+     * Implementations whose counts can only be read one index at a time under a critical section, and may
+     * change on the fly (e.g. {@link ConcurrentHistogram}), return a snapshot of their contents.
+     * @return this histogram, or a read-only snapshot of its contents
+     */
+    AbstractHistogram getQueryHistogram() {
+        return this;
+    }
+
+    /**
+     * Copy this histogram's counts at (logical) indexes 0 to length - 1 into a target array.
+     * @param targetCounts the array to copy the counts into
+     * @param length the number of counts to copy
+     */
+    void copyCountsInto(final long[] targetCounts, final int length) {
+        for (int i = 0; i < length; i++) {
+            targetCounts[i] = getCountAtIndex(i);
+        }
+    }
+
     /**
      * Get the total count of all recorded values in the histogram
      * @return the total count of all recorded values in the histogram
@@ -270,7 +377,19 @@ public abstract class AbstractHistogram extends AbstractHistogramBase implements
      */
     protected AbstractHistogram(final long lowestDiscernibleValue, final long highestTrackableValue,
                                 final int numberOfSignificantValueDigits) {
-        // Verify argument validity
+        verifyRangeArguments(lowestDiscernibleValue, highestTrackableValue, numberOfSignificantValueDigits);
+        identity = constructionIdentityCount.getAndIncrement();
+
+        init(lowestDiscernibleValue, highestTrackableValue, numberOfSignificantValueDigits, 1.0, 0);
+    }
+
+    /**
+     * Verify the validity of a histogram's range arguments, as required by the constructors.
+     *
+     * @throws IllegalArgumentException if any of the arguments is out of range
+     */
+    static void verifyRangeArguments(final long lowestDiscernibleValue, final long highestTrackableValue,
+                                     final int numberOfSignificantValueDigits) {
         if (lowestDiscernibleValue < 1) {
             throw new IllegalArgumentException("lowestDiscernibleValue must be >= 1");
         }
@@ -284,9 +403,6 @@ public abstract class AbstractHistogram extends AbstractHistogramBase implements
         if ((numberOfSignificantValueDigits < 0) || (numberOfSignificantValueDigits > 5)) {
             throw new IllegalArgumentException("numberOfSignificantValueDigits must be between 0 and 5");
         }
-        identity = constructionIdentityCount.getAndIncrement();
-
-        init(lowestDiscernibleValue, highestTrackableValue, numberOfSignificantValueDigits, 1.0, 0);
     }
 
     /**
@@ -315,44 +431,22 @@ public abstract class AbstractHistogram extends AbstractHistogramBase implements
             setNormalizingIndexOffset(normalizingIndexOffset);
         }
 
-        /*
-         * Given a 3 decimal point accuracy, the expectation is obviously for "+/- 1 unit at 1000". It also means that
-         * it's "ok to be +/- 2 units at 2000". The "tricky" thing is that it is NOT ok to be +/- 2 units at 1999. Only
-         * starting at 2000. So internally, we need to maintain single unit resolution to 2x 10^decimalPoints.
-         */
-        final long largestValueWithSingleUnitResolution = 2 * (long) Math.pow(10, numberOfSignificantValueDigits);
-
-        unitMagnitude = (int) (Math.log(lowestDiscernibleValue)/Math.log(2));
-        unitMagnitudeMask = (1 << unitMagnitude) - 1;
-
-        // We need to maintain power-of-two subBucketCount (for clean direct indexing) that is large enough to
-        // provide unit resolution to at least largestValueWithSingleUnitResolution. So figure out
-        // largestValueWithSingleUnitResolution's nearest power-of-two (rounded up), and use that:
-        int subBucketCountMagnitude = (int) Math.ceil(Math.log(largestValueWithSingleUnitResolution)/Math.log(2));
-        subBucketHalfCountMagnitude = subBucketCountMagnitude - 1;
-        subBucketCount = 1 << subBucketCountMagnitude;
-        subBucketHalfCount = subBucketCount / 2;
-        subBucketMask = ((long)subBucketCount - 1) << unitMagnitude;
-
-        if (subBucketCountMagnitude + unitMagnitude > 62) {
-            // subBucketCount entries can't be represented, with unitMagnitude applied, in a positive long.
-            // Technically it still sort of works if their sum is 63: you can represent all but the last number
-            // in the shifted subBucketCount. However, the utility of such a histogram vs ones whose magnitude here
-            // fits in 62 bits is debatable, and it makes it harder to work through the logic.
-            // Sums larger than 64 are totally broken as leadingZeroCountBase would go negative.
-            throw new IllegalArgumentException("Cannot represent numberOfSignificantValueDigits worth of values " +
-                    "beyond lowestDiscernibleValue");
-        }
+        // Look up the (shared) geometry for this precision and lowestDiscernibleValue, rejecting combinations that
+        // cannot be represented:
+        layout = HistogramLayout.get(numberOfSignificantValueDigits,
+                HistogramLayout.unitMagnitude(lowestDiscernibleValue), 1);
+        unitMagnitude = layout.unitMagnitude;
+        unitMagnitudeMask = layout.unitMagnitudeMask;
+        subBucketHalfCountMagnitude = layout.subBucketHalfCountMagnitude;
+        subBucketCount = layout.subBucketCount;
+        subBucketHalfCount = layout.subBucketHalfCount;
+        subBucketMask = layout.subBucketMask;
+        leadingZeroCountBase = layout.leadingZeroCountBase;
 
         // determine exponent range needed to support the trackable value with no overflow:
         establishSize(highestTrackableValue);
 
-        // Establish leadingZeroCountBase, used in getBucketIndex() fast path:
-        // subtract the bits that would be used by the largest value in bucket 0.
-        leadingZeroCountBase = 64 - unitMagnitude - subBucketCountMagnitude;
-
         percentileIterator = new PercentileIterator(this, 1);
-        recordedValuesIterator = new RecordedValuesIterator(this);
     }
 
     /**
@@ -375,9 +469,11 @@ public abstract class AbstractHistogram extends AbstractHistogramBase implements
         // establish counts array length:
         countsArrayLength = determineArrayLengthNeeded(newHighestTrackableValue);
         // establish exponent range needed to support the trackable value with no overflow:
-        bucketCount = getBucketsNeededToCoverValue(newHighestTrackableValue);
+        layout = layout.withBucketCountCovering(newHighestTrackableValue);
+        bucketCount = layout.bucketCount;
         // establish the new highest trackable value:
         highestTrackableValue = newHighestTrackableValue;
+        invalidateCachedStatistics();
     }
 
     final int determineArrayLengthNeeded(long highestTrackableValue) {
@@ -436,6 +532,48 @@ public abstract class AbstractHistogram extends AbstractHistogramBase implements
         this.autoResize = autoResize;
     }
 
+    /**
+     * Indicate whether or not the histogram derives its min and max values from its counts when queried,
+     * rather than tracking them on each recording
+     * @return lazy min/max tracking setting
+     */
+    public boolean isLazyMinMaxTracking() {
+        return lazyMinMaxTracking;
+    }
+
+    /**
+     * Control whether or not the histogram derives its min and max values from its counts when queried, rather
+     * than tracking them on each recording.
+     * <p>
+     * Tracking min and max values on recording involves reading (and occasionally updating) the shared max value
+     * and min non-zero value fields on every recording, which in the concurrent histogram variants means
+     * volatile reads and possible compare-and-set operations. With lazy min/max tracking enabled, recordings
+     * skip these fields entirely, and {@link #getMaxValue}, {@link #getMinNonZeroValue} (and the queries that
+     * depend on them) instead scan in from the ends of the counts array for the highest and lowest populated
+     * slots. The derived values are cached until the histogram's contents change, so an unchanged histogram is
+     * only scanned once. Query results are the same in either mode. This mode pays off for histograms that are
+     * recorded into (especially concurrently) far more often than they are queried, such as the
+     * {@link AtomicHistogram} interval histograms of a {@link Recorder}, which use it. It does not pay off for
+     * {@link ConcurrentHistogram}s, whose count reads each enter a reader critical section.
+     * <p>
+     * This setting should not be changed while values are being concurrently recorded into the histogram.
+     *
+     * @param lazyMinMaxTracking lazy min/max tracking setting
+     */
+    public void setLazyMinMaxTracking(boolean lazyMinMaxTracking) {
+        if (lazyMinMaxTracking == this.lazyMinMaxTracking) {
+            return;
+        }
+        if (!lazyMinMaxTracking) {
+            // Resume tracking from the current contents:
+            final DerivedMinAndMax derived = establishDerivedMinAndMax();
+            maxValue = derived.maxValue;
+            minNonZeroValue = derived.minNonZeroValue;
+        }
+        this.lazyMinMaxTracking = lazyMinMaxTracking;
+        cachedDerivedMinAndMax = null;
+    }
+
     //   ##     ##    ###    ##       ##     ## ########
     //   ##     ##   ## ##   ##       ##     ## ##
     //   ##     ##  ##   ##  ##       ##     ## ##
@@ -506,6 +644,30 @@ public abstract class AbstractHistogram extends AbstractHistogramBase implements
         recordSingleValueWithExpectedInterval(value, expectedIntervalBetweenValueSamples);
     }
 
+    /**
+     * Record a batch of values in the histogram
+     * <p>
+     * The effect is identical to calling {@link #recordValue(long)} for each of the values in
+     * <b><code>values[offset]</code></b> through <b><code>values[offset + length - 1]</code></b>, but the
+     * histogram's min/max tracking and total count are only updated once per batch.
+     * <p>
+     * Should a value in the batch fall outside of the histogram's covered range (and not be handled by
+     * auto-resizing), the values preceding it in the batch remain recorded when the exception is thrown.
+     *
+     * @param values The array holding the values to be recorded
+     * @param offset The index in <b><code>values</code></b> of the first value to record
+     * @param length The number of values to record
+     * @throws ArrayIndexOutOfBoundsException (may throw) if a value exceeds highestTrackableValue
+     */
+    public void recordValues(final long[] values, final int offset, final int length)
+            throws ArrayIndexOutOfBoundsException {
+        if ((offset < 0) || (length < 0) || (length > values.length - offset)) {
+            throw new ArrayIndexOutOfBoundsException("offset (" + offset + ") and length (" + length +
+                    ") do not describe a range within the values array (of length " + values.length + ")");
+        }
+        recordValuesInBatch(values, offset, length);
+    }
+
     // Package-internal support for converting and recording double values into integer histograms:
     void recordConvertedDoubleValue(final double value) {
         long integerValue = (long) (value * doubleToIntegerValueConversionRatio);
@@ -517,6 +679,38 @@ public abstract class AbstractHistogram extends AbstractHistogramBase implements
         recordCountAtValue(count, integerValue);
     }
 
+    /**
+     * Record a double value, given a double to integer value conversion ratio that is exactly
+     * 2^<b><code>ratioExponent</code></b>, and a value that converts to an integer value that is at least
+     * subBucketHalfCount. Since scaling by a power of two leaves the double's mantissa bits unchanged, the counts
+     * index is derived directly from the double's exponent and mantissa bits, rather than from the converted value.
+     *
+     * @return true if the value was recorded, or false (with nothing recorded) if it lies beyond the counts array
+     */
+    final boolean recordConvertedDoubleValueWithPowerOfTwoRatio(final double value,
+                                                              final double doubleToIntegerRatio,
+                                                              final int ratioExponent) {
+        final long integerValue = (long) (value * doubleToIntegerRatio);
+        // The exponent is that of the (exactly scaled) converted value, i.e. floor(log2(integerValue)):
+        final int bucketIndex = Math.getExponent(value) + ratioExponent - subBucketHalfCountMagnitude - unitMagnitude;
+        final int countsIndex;
+        if (bucketIndex > 0) {
+            // The sub bucket index (less subBucketHalfCount) is held in the top bits of the mantissa:
+            final long mantissaBits = Double.doubleToRawLongBits(value) & 0xfffffffffffffL;
+            countsIndex = ((bucketIndex + 1) << subBucketHalfCountMagnitude) +
+                    (int) (mantissaBits >>> (52 - subBucketHalfCountMagnitude));
+        } else {
+            countsIndex = countsArrayIndex(integerValue);
+        }
+        if (countsIndex >= countsArrayLength) {
+            return false;
+        }
+        incrementCountAtIndex(countsIndex);
+        updateMinAndMax(integerValue);
+        incrementTotalCount();
+        return true;
+    }
+
     /**
      * @deprecated
      *
@@ -535,6 +729,9 @@ public abstract class AbstractHistogram extends AbstractHistogramBase implements
     }
 
     void updateMinAndMax(final long value) {
+        if (lazyMinMaxTracking) {
+            return; // Derived from the counts when queried
+        }
         if (value > maxValue) {
             updatedMaxValue(value);
         }
@@ -545,6 +742,10 @@ public abstract class AbstractHistogram extends AbstractHistogramBase implements
 
     private void recordCountAtValue(final long count, final long value)
             throws ArrayIndexOutOfBoundsException {
+        if (count < 0) {
+            // Negative counts can leave the total count unchanged across a set of recordings:
+            invalidateCachedStatistics();
+        }
         int countsIndex = countsArrayIndex(value);
         try {
             addToCountAtIndex(countsIndex, count);
@@ -566,6 +767,43 @@ public abstract class AbstractHistogram extends AbstractHistogramBase implements
         incrementTotalCount();
     }
 
+    private void recordValuesInBatch(final long[] values, final int offset, final int length)
+            throws ArrayIndexOutOfBoundsException {
+        // Track the batch's min/max locally, and only publish them (along with the total count) once the
+        // batch is done. The finally clause keeps the tracking values consistent with the counts recorded
+        // thus far when a value in the batch turns out to be out of range.
+        long batchMaxValue = 0;
+        long batchMinNonZeroValue = Long.MAX_VALUE;
+        int recordedCount = 0;
+        try {
+            final int endIndex = offset + length;
+            for (int i = offset; i < endIndex; i++) {
+                final long value = values[i];
+                final int countsIndex = countsArrayIndex(value);
+                try {
+                    incrementCountAtIndex(countsIndex);
+                } catch (IndexOutOfBoundsException ex) {
+                    handleRecordException(1, value, ex);
+                }
+                if (value > batchMaxValue) {
+                    batchMaxValue = value;
+                }
+                if ((value < batchMinNonZeroValue) && (value != 0)) {
+                    batchMinNonZeroValue = value;
+                }
+                recordedCount++;
+            }
+        } finally {
+            if (recordedCount > 0) {
+                updateMinAndMax(batchMaxValue);
+                if (batchMinNonZeroValue != Long.MAX_VALUE) {
+                    updateMinAndMax(batchMinNonZeroValue);
+                }
+                addToTotalCount(recordedCount);
+            }
+        }
+    }
+
     private void handleRecordException(final long count, final long value, Exception ex) {
         if (!autoResize) {
             throw new ArrayIndexOutOfBoundsException("value " + value + " outside of histogram covered range. Caused by: " + ex);
@@ -573,33 +811,58 @@ public abstract class AbstractHistogram extends AbstractHistogramBase implements
         resize(value);
         int countsIndex = countsArrayIndex(value);
         addToCountAtIndex(countsIndex, count);
-        this.highestTrackableValue = highestEquivalentValue(valueFromIndex(countsArrayLength - 1));
+        this.highestTrackableValue = highestEquivalentValueAtIndex(countsArrayLength - 1);
     }
 
     private void recordValueWithCountAndExpectedInterval(final long value, final long count,
                                                          final long expectedIntervalBetweenValueSamples)
             throws ArrayIndexOutOfBoundsException {
         recordCountAtValue(count, value);
-        if (expectedIntervalBetweenValueSamples <= 0)
-            return;
-        for (long missingValue = value - expectedIntervalBetweenValueSamples;
-             missingValue >= expectedIntervalBetweenValueSamples;
-             missingValue -= expectedIntervalBetweenValueSamples) {
-            recordCountAtValue(count, missingValue);
-        }
+        recordMissingValuesWithCount(value, count, expectedIntervalBetweenValueSamples);
     }
 
     private void recordSingleValueWithExpectedInterval(final long value,
                                                        final long expectedIntervalBetweenValueSamples)
             throws ArrayIndexOutOfBoundsException {
         recordSingleValue(value);
-        if (expectedIntervalBetweenValueSamples <= 0)
+        recordMissingValuesWithCount(value, 1, expectedIntervalBetweenValueSamples);
+    }
+
+    /**
+     * Record [count] occurrences of each of the values auto-generated for coordinated omission correction of
+     * [value], i.e. (value - expectedInterval), (value - 2 * expectedInterval), ... down to (and including) the
+     * lowest such value that is no smaller than expectedInterval.
+     * <p>
+     * Rather than recording the missing values one at a time, they are counted per bucket: the missing values
+     * that fall within a bucket form an arithmetic progression, so their number follows directly from the
+     * bucket's lowest equivalent value, and is added to the bucket's count in a single update. The min value
+     * and total count are updated once for the entire series.
+     */
+    private void recordMissingValuesWithCount(final long value, final long count,
+                                              final long expectedIntervalBetweenValueSamples)
+            throws ArrayIndexOutOfBoundsException {
+        if ((expectedIntervalBetweenValueSamples <= 0) ||
+                (value - expectedIntervalBetweenValueSamples < expectedIntervalBetweenValueSamples)) {
             return;
-        for (long missingValue = value - expectedIntervalBetweenValueSamples;
-             missingValue >= expectedIntervalBetweenValueSamples;
-             missingValue -= expectedIntervalBetweenValueSamples) {
-            recordSingleValue(missingValue);
         }
+        final long numberOfMissingValues = (value / expectedIntervalBetweenValueSamples) - 1;
+        final long lowestMissingValue =
+                (value % expectedIntervalBetweenValueSamples) + expectedIntervalBetweenValueSamples;
+        long missingValue = value - expectedIntervalBetweenValueSamples;
+        while (missingValue >= lowestMissingValue) {
+            final long lowestValueInBucket = Math.max(lowestEquivalentValue(missingValue), lowestMissingValue);
+            final long missingValuesInBucket =
+                    ((missingValue - lowestValueInBucket) / expectedIntervalBetweenValueSamples) + 1;
+            final int countsIndex = countsArrayIndex(missingValue);
+            try {
+                addToCountAtIndex(countsIndex, missingValuesInBucket * count);
+            } catch (IndexOutOfBoundsException ex) {
+                handleRecordException(missingValuesInBucket * count, missingValue, ex);
+            }
+            missingValue -= missingValuesInBucket * expectedIntervalBetweenValueSamples;
+        }
+        updateMinAndMax(lowestMissingValue);
+        addToTotalCount(numberOfMissingValues * count);
     }
 
     //    ######  ##       ########    ###    ########  #### ##    ##  ######
@@ -619,6 +882,7 @@ public abstract class AbstractHistogram extends AbstractHistogramBase implements
      */
     @Override
     public void reset() {
+        invalidateCachedStatistics();
         clearCounts();
         resetMaxValue(0);
         resetMinNonZeroValue(Long.MAX_VALUE);
@@ -718,12 +982,15 @@ public abstract class AbstractHistogram extends AbstractHistogramBase implements
      * As part of adding the contents, the start/end timestamp range of this histogram will be
      * extended to include the start/end timestamp range of the other histogram.
      *
-     * @param otherHistogram The other histogram.
+     * @param histogram The other histogram.
      * @throws ArrayIndexOutOfBoundsException (may throw) if values in fromHistogram's are
      * higher than highestTrackableValue.
      */
-    public void add(final AbstractHistogram otherHistogram) throws ArrayIndexOutOfBoundsException {
-        long highestRecordableValue = highestEquivalentValue(valueFromIndex(countsArrayLength - 1));
+    public void add(final AbstractHistogram histogram) throws ArrayIndexOutOfBoundsException {
+        // Histograms whose counts may change on the fly (e.g. concurrent ones) are read through a stable snapshot:
+        final AbstractHistogram otherHistogram = histogram.getQueryHistogram();
+        invalidateCachedStatistics();
+        long highestRecordableValue = highestEquivalentValueAtIndex(countsArrayLength - 1);
         if (highestRecordableValue < otherHistogram.getMaxValue()) {
             if (!isAutoResize()) {
                 throw new ArrayIndexOutOfBoundsException(
@@ -731,43 +998,57 @@ public abstract class AbstractHistogram extends AbstractHistogramBase implements
             }
             resize(otherHistogram.getMaxValue());
         }
-        if ((bucketCount == otherHistogram.bucketCount) &&
-                (subBucketCount == otherHistogram.subBucketCount) &&
-                (unitMagnitude == otherHistogram.unitMagnitude) &&
-                (getNormalizingIndexOffset() == otherHistogram.getNormalizingIndexOffset()) &&
-                !(otherHistogram instanceof ConcurrentHistogram) ) {
+        if ((layout == otherHistogram.layout) &&
+                (getNormalizingIndexOffset() == otherHistogram.getNormalizingIndexOffset())) {
             // Counts arrays are of the same length and meaning, so we can just iterate and add directly:
             long observedOtherTotalCount = 0;
-            for (int i = 0; i < otherHistogram.countsArrayLength; i++) {
-                long otherCount = otherHistogram.getCountAtIndex(i);
-                if (otherCount > 0) {
-                    addToCountAtIndex(i, otherCount);
-                    observedOtherTotalCount += otherCount;
+            final Object counts = getUpdatablePlainCountsArray();
+            final Object otherCounts = otherHistogram.getPlainCountsArray();
+            if ((counts != null) && (otherCounts != null) && (getNormalizingIndexOffset() == 0) &&
+                    !hasOccupancyBitmap() && !otherHistogram.canSkipEmptySlots()) {
+                // Both counts arrays are directly accessible (this histogram has no occupancy bitmap that the
+                // kernel would bypass, and the other cannot skip its empty slots), so add the other's populated
+                // span with a kernel:
+                if (otherHistogram.getTotalCount() != 0) {
+                    observedOtherTotalCount = CountsArrayKernels.add(counts, otherCounts,
+                            otherHistogram.getLowestPopulatedIndex(), otherHistogram.getHighestPopulatedIndex());
+                }
+            } else if (otherHistogram.getTotalCount() != 0) {
+                final int toIndex = otherHistogram.getHighestPopulatedIndex();
+                for (int i = otherHistogram.nextPopulatedIndex(otherHistogram.getLowestPopulatedIndex());
+                     i <= toIndex; i = otherHistogram.nextPopulatedIndex(i + 1)) {
+                    long otherCount = otherHistogram.getCountAtIndex(i);
+                    if (otherCount > 0) {
+                        addToCountAtIndex(i, otherCount);
+                        observedOtherTotalCount += otherCount;
+                    }
                 }
             }
             setTotalCount(getTotalCount() + observedOtherTotalCount);
-            updatedMaxValue(Math.max(getMaxValue(), otherHistogram.getMaxValue()));
-            updateMinNonZeroValue(Math.min(getMinNonZeroValue(), otherHistogram.getMinNonZeroValue()));
+            if (!lazyMinMaxTracking) {
+                updatedMaxValue(Math.max(getMaxValue(), otherHistogram.getMaxValue()));
+                updateMinNonZeroValue(Math.min(getMinNonZeroValue(), otherHistogram.getMinNonZeroValue()));
+            }
         } else {
-            // Arrays are not a direct match (or the other could change on the fly in some valid way),
-            // so we can't just stream through and add them. Instead, go through the array and add each
-            // non-zero value found at it's proper value:
+            // Arrays are not a direct match, so we can't just stream through and add them. Instead, go through
+            // the array and add each non-zero value found at it's proper value:
 
             // Do max value first, to avoid max value updates on each iteration:
             int otherMaxIndex = otherHistogram.countsArrayIndex(otherHistogram.getMaxValue());
             long otherCount = otherHistogram.getCountAtIndex(otherMaxIndex);
             recordValueWithCount(otherHistogram.valueFromIndex(otherMaxIndex), otherCount);
 
-            // Record the remaining values, up to but not including the max value:
-            for (int i = 0; i < otherMaxIndex; i++) {
+            // Record the remaining values, from the lowest populated index up to but not including the max value:
+            for (int i = otherHistogram.nextPopulatedIndex(otherHistogram.getLowestPopulatedIndex());
+                 i < otherMaxIndex; i = otherHistogram.nextPopulatedIndex(i + 1)) {
                 otherCount = otherHistogram.getCountAtIndex(i);
                 if (otherCount > 0) {
                     recordValueWithCount(otherHistogram.valueFromIndex(i), otherCount);
                 }
             }
         }
-        setStartTimeStamp(Math.min(startTimeStampMsec, otherHistogram.startTimeStampMsec));
-        setEndTimeStamp(Math.max(endTimeStampMsec, otherHistogram.endTimeStampMsec));
+        setStartTimeStamp(Math.min(startTimeStampMsec, histogram.startTimeStampMsec));
+        setEndTimeStamp(Math.max(endTimeStampMsec, histogram.endTimeStampMsec));
     }
 
     /**
@@ -775,26 +1056,51 @@ public abstract class AbstractHistogram extends AbstractHistogramBase implements
      * <p>
      * The start/end timestamps of this histogram will remain unchanged.
      *
-     * @param otherHistogram The other histogram.
+     * @param histogram The other histogram.
      * @throws ArrayIndexOutOfBoundsException (may throw) if values in otherHistogram's are higher than highestTrackableValue.
      *
      */
-    public void subtract(final AbstractHistogram otherHistogram)
+    public void subtract(final AbstractHistogram histogram)
             throws ArrayIndexOutOfBoundsException, IllegalArgumentException {
+        final AbstractHistogram otherHistogram = histogram.getQueryHistogram();
+        invalidateCachedStatistics();
         if (highestEquivalentValue(otherHistogram.getMaxValue()) >
-                highestEquivalentValue(valueFromIndex(this.countsArrayLength - 1))) {
+                highestEquivalentValueAtIndex(this.countsArrayLength - 1)) {
             throw new IllegalArgumentException(
                     "The other histogram includes values that do not fit in this histogram's range.");
         }
-        for (int i = 0; i < otherHistogram.countsArrayLength; i++) {
-            long otherCount = otherHistogram.getCountAtIndex(i);
-            if (otherCount > 0) {
-                long otherValue = otherHistogram.valueFromIndex(i);
-                if (getCountAtValue(otherValue) < otherCount) {
-                    throw new IllegalArgumentException("otherHistogram count (" + otherCount + ") at value " +
-                            otherValue + " is larger than this one's (" + getCountAtValue(otherValue) + ")");
+        final Object counts = getUpdatablePlainCountsArray();
+        final Object otherCounts = otherHistogram.getPlainCountsArray();
+        if ((counts != null) && (otherCounts != null) && !otherHistogram.canSkipEmptySlots() &&
+                (layout == otherHistogram.layout) &&
+                (getNormalizingIndexOffset() == 0) && (otherHistogram.getNormalizingIndexOffset() == 0)) {
+            // Counts arrays are of the same length and meaning, and both are directly accessible, so subtract
+            // the other's populated span with a kernel (after verifying that no count would go negative):
+            if (otherHistogram.getTotalCount() != 0) {
+                final int fromIndex = otherHistogram.getLowestPopulatedIndex();
+                final int toIndex = otherHistogram.getHighestPopulatedIndex();
+                final int badIndex = CountsArrayKernels.indexOfLargerCount(counts, otherCounts, fromIndex, toIndex);
+                if (badIndex >= 0) {
+                    throw new IllegalArgumentException("otherHistogram count (" +
+                            otherHistogram.getCountAtIndex(badIndex) + ") at value " +
+                            otherHistogram.valueFromIndex(badIndex) + " is larger than this one's (" +
+                            getCountAtIndex(badIndex) + ")");
+                }
+                addToTotalCount(-CountsArrayKernels.subtract(counts, otherCounts, fromIndex, toIndex));
+            }
+        } else if (otherHistogram.getTotalCount() != 0) {
+            final int toIndex = otherHistogram.getHighestPopulatedIndex();
+            for (int i = otherHistogram.nextPopulatedIndex(otherHistogram.getLowestPopulatedIndex());
+                 i <= toIndex; i = otherHistogram.nextPopulatedIndex(i + 1)) {
+                long otherCount = otherHistogram.getCountAtIndex(i);
+                if (otherCount > 0) {
+                    long otherValue = otherHistogram.valueFromIndex(i);
+                    if (getCountAtValue(otherValue) < otherCount) {
+                        throw new IllegalArgumentException("otherHistogram count (" + otherCount + ") at value " +
+                                otherValue + " is larger than this one's (" + getCountAtValue(otherValue) + ")");
+                    }
+                    recordValueWithCount(otherValue, -otherCount);
                 }
-                recordValueWithCount(otherValue, -otherCount);
             }
         }
         // With subtraction, the max and minNonZero values could have changed:
@@ -884,8 +1190,13 @@ public abstract class AbstractHistogram extends AbstractHistogramBase implements
                     "Operation would overflow, would discard recorded value counts");
         }
 
+        invalidateCachedStatistics();
         long maxValueBeforeShift = maxValueUpdater.getAndSet(this, 0);
         long minNonZeroValueBeforeShift = minNonZeroValueUpdater.getAndSet(this, Long.MAX_VALUE);
+        if (lazyMinMaxTracking) {
+            // The tracked value is not maintained, so derive it from the (not yet shifted) counts:
+            minNonZeroValueBeforeShift = getTrackedMinNonZeroValue();
+        }
 
         boolean lowestHalfBucketPopulated = (minNonZeroValueBeforeShift < (subBucketHalfCount << unitMagnitude));
 
@@ -1022,6 +1333,7 @@ public abstract class AbstractHistogram extends AbstractHistogramBase implements
 
         // perform shift:
 
+        invalidateCachedStatistics();
         long maxValueBeforeShift = maxValueUpdater.getAndSet(this, 0);
         long minNonZeroValueBeforeShift = minNonZeroValueUpdater.getAndSet(this, Long.MAX_VALUE);
 
@@ -1078,7 +1390,13 @@ public abstract class AbstractHistogram extends AbstractHistogramBase implements
         // 2 histograms may be equal but have different underlying array sizes. This can happen for instance due to
         // resizing.
         if (countsArrayLength == that.countsArrayLength) {
-            for (int i = 0; i < countsArrayLength; i++) {
+            // With equal max and min non-zero values, counts can only differ at index 0 (which may hold values
+            // below the min non-zero value) or within the populated span:
+            if (getCountAtIndex(0) != that.getCountAtIndex(0)) {
+                return false;
+            }
+            final int toIndex = getHighestPopulatedIndex();
+            for (int i = getLowestPopulatedIndex(); i <= toIndex; i++) {
                 if (getCountAtIndex(i) != that.getCountAtIndex(i)) {
                     return false;
                 }
@@ -1247,7 +1565,8 @@ public abstract class AbstractHistogram extends AbstractHistogramBase implements
      * @return a (conservatively high) estimate of the Histogram's total footprint in bytes
      */
     public int getEstimatedFootprintInBytes() {
-        return _getEstimatedFootprintInBytes();
+        final CumulativeCountIndex index = cachedCumulativeCountIndex;
+        return _getEstimatedFootprintInBytes() + ((index != null) ? 8 * index.cumulativeCounts.length : 0);
     }
 
     //   ######## #### ##     ## ########  ######  ########    ###    ##     ## ########
@@ -1353,6 +1672,7 @@ public abstract class AbstractHistogram extends AbstractHistogramBase implements
      * @return the Max value recorded in the histogram
      */
     public long getMaxValue() {
+        final long maxValue = getTrackedMaxValue();
         return (maxValue == 0) ? 0 : highestEquivalentValue(maxValue);
     }
 
@@ -1363,10 +1683,63 @@ public abstract class AbstractHistogram extends AbstractHistogramBase implements
      * @return the lowest recorded non-zero value level in the histogram
      */
     public long getMinNonZeroValue() {
+        final long minNonZeroValue = getTrackedMinNonZeroValue();
         return (minNonZeroValue == Long.MAX_VALUE) ?
                 Long.MAX_VALUE : lowestEquivalentValue(minNonZeroValue);
     }
 
+    private long getTrackedMaxValue() {
+        if (lazyMinMaxTracking) {
+            return establishDerivedMinAndMax().maxValue;
+        }
+        return maxValue;
+    }
+
+    private long getTrackedMinNonZeroValue() {
+        if (lazyMinMaxTracking) {
+            return establishDerivedMinAndMax().minNonZeroValue;
+        }
+        return minNonZeroValue;
+    }
+
+    /**
+     * Derive the max value and min non-zero value (in their internal tracking forms) from the counts, scanning in
+     * from the ends of the counts array. As with the cached moments, the results are cached until the histogram's
+     * contents change: recordings are detected through a change in the total count, while all other content
+     * changes explicitly invalidate the cached results.
+     *
+     * @return the (possibly cached) derived min and max values of the current contents
+     */
+    private DerivedMinAndMax establishDerivedMinAndMax() {
+        final long totalCount = getTotalCount();
+        final DerivedMinAndMax derived = cachedDerivedMinAndMax;
+        if ((derived != null) && (derived.totalCount == totalCount)) {
+            return derived;
+        }
+        long max = 0;
+        long minNonZero = Long.MAX_VALUE;
+        if (totalCount != 0) {
+            // Include index 0: with a lowestDiscernibleValue above 1, it holds non-zero (sub-unit) values too.
+            for (int i = countsArrayLength - 1; i >= 0; i--) {
+                if (getCountAtIndex(i) > 0) {
+                    max = highestEquivalentValueAtIndex(i);
+                    break;
+                }
+            }
+            if (max != 0) {
+                for (int i = nextPopulatedIndex(1); i < countsArrayLength; i = nextPopulatedIndex(i + 1)) {
+                    if (getCountAtIndex(i) > 0) {
+                        minNonZero = valueFromIndex(i);
+                        break;
+                    }
+                }
+            }
+        }
+        final DerivedMinAndMax newDerived = new DerivedMinAndMax(totalCount, max, minNonZero);
+        cachedDerivedMinAndMax = newDerived;
+        return newDerived;
+    }
+
     /**
      * Get the highest recorded value level in the histogram as a double
      *
@@ -1386,14 +1759,7 @@ public abstract class AbstractHistogram extends AbstractHistogramBase implements
         if (getTotalCount() == 0) {
             return 0.0;
         }
-        recordedValuesIterator.reset();
-        double totalValue = 0;
-        while (recordedValuesIterator.hasNext()) {
-            HistogramIterationValue iterationValue = recordedValuesIterator.next();
-            totalValue += medianEquivalentValue(iterationValue.getValueIteratedTo())
-                    * (double) iterationValue.getCountAtValueIteratedTo();
-        }
-        return (totalValue * 1.0) / getTotalCount();
+        return establishMoments().mean;
     }
 
     /**
@@ -1405,16 +1771,109 @@ public abstract class AbstractHistogram extends AbstractHistogramBase implements
         if (getTotalCount() == 0) {
             return 0.0;
         }
-        final double mean =  getMean();
-        double geometric_deviation_total = 0.0;
-        recordedValuesIterator.reset();
-        while (recordedValuesIterator.hasNext()) {
-            HistogramIterationValue iterationValue = recordedValuesIterator.next();
-            double deviation = (medianEquivalentValue(iterationValue.getValueIteratedTo()) * 1.0) - mean;
-            geometric_deviation_total += (deviation * deviation) * iterationValue.getCountAddedInThisIterationStep();
+        return establishMoments().stdDeviation;
+    }
+
+    /**
+     * Compute the mean and standard deviation of the recorded values (at their median equivalent values) in a
+     * single pass over the counts array, using a count-weighted form of Welford's algorithm. The results are cached
+     * until the histogram's contents change, so repeated mean/stddev queries of an unchanged histogram are O(1).
+     * As with the cumulative count index, recordings are detected through a change in the total count, while all
+     * other content changes explicitly invalidate the cached results.
+     *
+     * @return the (possibly cached) moments of the current contents
+     */
+    private Moments establishMoments() {
+        final long totalCount = getTotalCount();
+        final Moments moments = cachedMoments;
+        if ((moments != null) && (moments.totalCount == totalCount)) {
+            return moments;
+        }
+        long observedCount = 0;
+        double mean = 0.0;
+        double sumOfSquaredDeviations = 0.0;
+        final int toIndex = getHighestPopulatedIndex();
+        for (int i = getLowestPopulatedIndex(); i <= toIndex; i++) {
+            final long countAtIndex = getCountAtIndex(i);
+            if (countAtIndex > 0) {
+                final double value = medianEquivalentValue(valueFromIndex(i));
+                observedCount += countAtIndex;
+                final double deviation = value - mean;
+                mean += deviation * countAtIndex / observedCount;
+                sumOfSquaredDeviations += countAtIndex * deviation * (value - mean);
+            }
+        }
+        final Moments newMoments = new Moments(totalCount, mean,
+                (observedCount > 0) ? Math.sqrt(sumOfSquaredDeviations / observedCount) : 0.0);
+        cachedMoments = newMoments;
+        return newMoments;
+    }
+
+    /**
+     * Indicate whether or not the histogram maintains a cumulative count index for percentile queries
+     * @return cumulative count indexing setting
+     */
+    public boolean isCumulativeCountIndexing() {
+        return cumulativeCountIndexing;
+    }
+
+    /**
+     * Control whether or not the histogram maintains a cumulative count (prefix sum) index for use by
+     * {@link #getValueAtPercentile}, {@link #getPercentileAtOrBelowValue} and {@link #getCountBetweenValues}.
+     * <p>
+     * When enabled, the index is built lazily by the first query that follows a change to the histogram's
+     * contents, and subsequent queries are answered with a binary search (or a direct lookup) over the index
+     * rather than with a linear scan of the counts array. Recording, adding, subtracting, shifting or resetting
+     * invalidate the index. The recording code path is not affected by this setting. The index costs an
+     * additional 8 bytes per counts array entry, and pays off when several queries are made between
+     * changes to the histogram's contents (e.g. when reporting multiple percentiles of an interval histogram).
+     * See {@link FrozenHistogram} for a read-only histogram whose index is built once.
+     *
+     * @param cumulativeCountIndexing cumulative count indexing setting
+     */
+    public void setCumulativeCountIndexing(boolean cumulativeCountIndexing) {
+        this.cumulativeCountIndexing = cumulativeCountIndexing;
+        if (!cumulativeCountIndexing) {
+            invalidateCachedStatistics();
+        }
+    }
+
+    final void invalidateCachedStatistics() {
+        cachedCumulativeCountIndex = null;
+        cachedMoments = null;
+        cachedDerivedMinAndMax = null;
+    }
+
+    /**
+     * Get the cumulative count index, (re)building it if it is stale. Recordings are detected by a change in the
+     * total count, while all other content changes explicitly invalidate the index. The last entry of the
+     * returned index holds the total count it covers, which callers should use (rather than a separately read
+     * total count) when relating the index's entries to the whole.
+     *
+     * @return the cumulative count index, or null if cumulative count indexing is not enabled.
+     */
+    final long[] getCumulativeCountIndex() {
+        if (!cumulativeCountIndexing) {
+            return null;
+        }
+        final long totalCount = getTotalCount();
+        final CumulativeCountIndex cached = cachedCumulativeCountIndex;
+        if ((cached != null) && (cached.totalCount == totalCount) &&
+                (cached.cumulativeCounts.length == countsArrayLength)) {
+            return cached.cumulativeCounts;
+        }
+        final long[] index = new long[countsArrayLength];
+        // Entries below the populated span hold 0, and entries above it hold the total count:
+        final int fromIndex = getLowestPopulatedIndex();
+        final int toIndex = getHighestPopulatedIndex();
+        long totalToCurrentIndex = 0;
+        for (int i = fromIndex; i <= toIndex; i++) {
+            totalToCurrentIndex += getCountAtIndex(i);
+            index[i] = totalToCurrentIndex;
         }
-        double std_deviation = Math.sqrt(geometric_deviation_total / getTotalCount());
-        return std_deviation;
+        Arrays.fill(index, toIndex + 1, index.length, totalToCurrentIndex);
+        cachedCumulativeCountIndex = new CumulativeCountIndex(totalCount, index);
+        return index;
     }
 
     /**
@@ -1430,27 +1889,154 @@ public abstract class AbstractHistogram extends AbstractHistogramBase implements
      * in the histogram are either larger than or equivalent to. Returns 0 if no recorded values exist.
      */
     public long getValueAtPercentile(final double percentile) {
+        final long[] cumulativeCounts = getCumulativeCountIndex();
+        final long totalCount = (cumulativeCounts != null) ?
+                cumulativeCounts[cumulativeCounts.length - 1] : getTotalCount();
+        final int index = indexReachingCumulativeCount(cumulativeCounts, countAtPercentile(percentile, totalCount));
+        if (index < 0) {
+            return 0;
+        }
+        return valueAtPercentileIndex(percentile, index);
+    }
+
+    /**
+     * Get the values at a set of given percentiles.
+     * <p>
+     * Equivalent to calling {@link #getValueAtPercentile} for each of the given percentiles, but resolves all of
+     * them in a single forward pass over the histogram's counts, and writes the results into a caller-supplied
+     * array. No allocation is performed when the percentiles are supplied in ascending order (as is common in
+     * reporting, e.g. 50%, 90%, 99%, 99.9%, 99.99%, 100%).
+     *
+     * @param percentiles The percentiles for which to return the associated values
+     * @param valuesAtPercentiles The array into which to write the results. valuesAtPercentiles[i] will hold
+     *                            the value at percentiles[i]. Must be at least as long as percentiles.
+     * @throws IllegalArgumentException if valuesAtPercentiles is shorter than percentiles
+     */
+    public void getValuesAtPercentiles(final double[] percentiles, final long[] valuesAtPercentiles) {
+        if (valuesAtPercentiles.length < percentiles.length) {
+            throw new IllegalArgumentException("valuesAtPercentiles array (length " + valuesAtPercentiles.length +
+                    ") is shorter than the percentiles array (length " + percentiles.length + ")");
+        }
+        resolveValuesAtPercentiles(percentiles, valuesAtPercentiles, null, 1.0);
+    }
+
+    /**
+     * Resolve the values at the given percentiles into either longValues or (scaled by ratio) doubleValues.
+     */
+    void resolveValuesAtPercentiles(final double[] percentiles,
+                                    final long[] longValues, final double[] doubleValues, final double ratio) {
+        final int[] order = ascendingOrderOf(percentiles);
+        final long[] cumulativeCounts = getCumulativeCountIndex();
+        final long totalCount = (cumulativeCounts != null) ?
+                cumulativeCounts[cumulativeCounts.length - 1] : getTotalCount();
+        final int highestPopulatedIndex = getHighestPopulatedIndex();
+        int index = getLowestPopulatedIndex() - 1;
+        long totalToCurrentIndex = 0;
+        for (int i = 0; i < percentiles.length; i++) {
+            final int p = (order == null) ? i : order[i];
+            final double percentile = percentiles[p];
+            final long countAtPercentile = countAtPercentile(percentile, totalCount);
+            long valueAtPercentile = 0;
+            if (cumulativeCounts != null) {
+                index = indexReachingCumulativeCount(cumulativeCounts, countAtPercentile);
+                if (index >= 0) {
+                    valueAtPercentile = valueAtPercentileIndex(percentile, index);
+                }
+            } else {
+                // Targets are visited in ascending order, so the scan picks up where the previous one stopped:
+                while ((totalToCurrentIndex < countAtPercentile) && (index < highestPopulatedIndex)) {
+                    index++;
+                    totalToCurrentIndex += getCountAtIndex(index);
+                }
+                if (totalToCurrentIndex >= countAtPercentile) {
+                    valueAtPercentile = valueAtPercentileIndex(percentile, index);
+                }
+            }
+            if (longValues != null) {
+                longValues[p] = valueAtPercentile;
+            } else {
+                doubleValues[p] = valueAtPercentile * ratio;
+            }
+        }
+    }
+
+    /**
+     * @return null if the percentiles are already in ascending order, or the order in which to visit them otherwise
+     */
+    private static int[] ascendingOrderOf(final double[] percentiles) {
+        int i = 1;
+        while ((i < percentiles.length) && (percentiles[i - 1] <= percentiles[i])) {
+            i++;
+        }
+        if (i >= percentiles.length) {
+            return null;
+        }
+        // Percentile lists are short, so a simple insertion sort will do:
+        final int[] order = new int[percentiles.length];
+        for (i = 0; i < order.length; i++) {
+            int j = i;
+            while ((j > 0) && (percentiles[order[j - 1]] > percentiles[i])) {
+                order[j] = order[j - 1];
+                j--;
+            }
+            order[j] = i;
+        }
+        return order;
+    }
+
+    static long countAtPercentile(final double percentile, final long totalCount) {
         // Truncate to 0..100%, and remove 1 ulp to avoid roundoff overruns into next bucket when we
         // subsequently round up to the nearest integer:
         double requestedPercentile =
                 Math.min(Math.max(Math.nextAfter(percentile, Double.NEGATIVE_INFINITY), 0.0D), 100.0D);
         // derive the count at the requested percentile. We round up to nearest integer to ensure that the
         // largest value that the requested percentile of overall recorded values is <= is actually included.
-        double fpCountAtPercentile = (requestedPercentile * getTotalCount()) / 100.0D;
+        double fpCountAtPercentile = (requestedPercentile * totalCount) / 100.0D;
         long countAtPercentile = (long)(Math.ceil(fpCountAtPercentile)); // round up
 
-        countAtPercentile = Math.max(countAtPercentile, 1); // Make sure we at least reach the first recorded entry
+        return Math.max(countAtPercentile, 1); // Make sure we at least reach the first recorded entry
+    }
+
+    private long valueAtPercentileIndex(final double percentile, final int index) {
+        long valueAtIndex = valueFromIndex(index);
+        return (percentile == 0.0) ?
+                lowestEquivalentValue(valueAtIndex) :
+                highestEquivalentValue(valueAtIndex);
+    }
+
+    /**
+     * Find the lowest counts array index at which the cumulative count reaches a given count, using a
+     * cumulative count index (if not null) or a linear scan.
+     *
+     * @return the index found, or -1 if the histogram holds less than the given count.
+     */
+    private int indexReachingCumulativeCount(final long[] cumulativeCounts, final long count) {
+        if (cumulativeCounts != null) {
+            // Binary search for the lowest index whose cumulative count is >= count:
+            int low = 0;
+            int high = cumulativeCounts.length - 1;
+            if ((high < 0) || (cumulativeCounts[high] < count)) {
+                return -1;
+            }
+            while (low < high) {
+                final int mid = (low + high) >>> 1;
+                if (cumulativeCounts[mid] >= count) {
+                    high = mid;
+                } else {
+                    low = mid + 1;
+                }
+            }
+            return low;
+        }
         long totalToCurrentIndex = 0;
-        for (int i = 0; i < countsArrayLength; i++) {
+        final int toIndex = getHighestPopulatedIndex();
+        for (int i = getLowestPopulatedIndex(); i <= toIndex; i++) {
             totalToCurrentIndex += getCountAtIndex(i);
-            if (totalToCurrentIndex >= countAtPercentile) {
-                long valueAtIndex = valueFromIndex(i);
-                return (percentile == 0.0) ?
-                        lowestEquivalentValue(valueAtIndex) :
-                        highestEquivalentValue(valueAtIndex);
+            if (totalToCurrentIndex >= count) {
+                return i;
             }
         }
-        return 0;
+        return -1;
     }
 
     /**
@@ -1470,8 +2056,13 @@ public abstract class AbstractHistogram extends AbstractHistogramBase implements
             return 100.0;
         }
         final int targetIndex = Math.min(countsArrayIndex(value), (countsArrayLength - 1));
+        final long[] cumulativeCounts = getCumulativeCountIndex();
+        if (cumulativeCounts != null) {
+            return (100.0 * cumulativeCounts[targetIndex]) / cumulativeCounts[cumulativeCounts.length - 1];
+        }
         long totalToCurrentIndex = 0;
-        for (int i = 0; i <= targetIndex; i++) {
+        final int toIndex = Math.min(targetIndex, getHighestPopulatedIndex());
+        for (int i = getLowestPopulatedIndex(); i <= toIndex; i++) {
             totalToCurrentIndex += getCountAtIndex(i);
         }
         return (100.0 * totalToCurrentIndex) / getTotalCount();
@@ -1491,8 +2082,16 @@ public abstract class AbstractHistogram extends AbstractHistogramBase implements
     public long getCountBetweenValues(final long lowValue, final long highValue) throws ArrayIndexOutOfBoundsException {
         final int lowIndex = Math.max(0, countsArrayIndex(lowValue));
         final int highIndex = Math.min(countsArrayIndex(highValue), (countsArrayLength - 1));
+        final long[] cumulativeCounts = getCumulativeCountIndex();
+        if (cumulativeCounts != null) {
+            if (lowIndex > highIndex) {
+                return 0;
+            }
+            return cumulativeCounts[highIndex] - ((lowIndex > 0) ? cumulativeCounts[lowIndex - 1] : 0);
+        }
         long count = 0;
-        for (int i = lowIndex ; i <= highIndex; i++) {
+        final int toIndex = Math.min(highIndex, getHighestPopulatedIndex());
+        for (int i = Math.max(lowIndex, getLowestPopulatedIndex()); i <= toIndex; i++) {
             count += getCountAtIndex(i);
         }
         return count;
@@ -1863,8 +2462,8 @@ public abstract class AbstractHistogram extends AbstractHistogramBase implements
         // Max Value is added to the serialized form because establishing max via scanning is "harder" during
         // deserialization, as the counts array is not available at the subclass deserializing level, and we don't
         // really want to have each subclass establish max on it's own...
-        o.writeLong(maxValue);
-        o.writeLong(minNonZeroValue);
+        o.writeLong(getTrackedMaxValue());
+        o.writeLong(getTrackedMinNonZeroValue());
         o.writeLong(startTimeStampMsec);
         o.writeLong(endTimeStampMsec);
         o.writeBoolean(autoResize);
@@ -1926,7 +2525,7 @@ public abstract class AbstractHistogram extends AbstractHistogramBase implements
         return getNeededByteBufferCapacity(countsArrayLength);
     }
 
-    private static final int ENCODING_HEADER_SIZE = 40;
+    static final int ENCODING_HEADER_SIZE = 40;
     private static final int V0_ENCODING_HEADER_SIZE = 32;
 
     int getNeededByteBufferCapacity(final int relevantLength) {
@@ -1947,10 +2546,10 @@ public abstract class AbstractHistogram extends AbstractHistogramBase implements
     private static final int V1EncodingCookieBase = 0x1c849301;
     private static final int V1CompressedEncodingCookieBase = 0x1c849302;
 
-    private static final int V2EncodingCookieBase = 0x1c849303;
-    private static final int V2CompressedEncodingCookieBase = 0x1c849304;
+    static final int V2EncodingCookieBase = 0x1c849303;
+    static final int V2CompressedEncodingCookieBase = 0x1c849304;
 
-    private static final int V2maxWordSizeInBytes = 9; // LEB128-64b9B + ZigZag require up to 9 bytes per word
+    static final int V2maxWordSizeInBytes = 9; // LEB128-64b9B + ZigZag require up to 9 bytes per word
 
     private static final int encodingCookieBase = V2EncodingCookieBase;
     private static final int compressedEncodingCookieBase = V2CompressedEncodingCookieBase;
@@ -1963,11 +2562,11 @@ public abstract class AbstractHistogram extends AbstractHistogramBase implements
         return compressedEncodingCookieBase | 0x10; // LSBit of wordSize byte indicates TLZE Encoding
     }
 
-    private static int getCookieBase(final int cookie) {
+    static int getCookieBase(final int cookie) {
         return (cookie & ~0xf0);
     }
 
-    private static int getWordSizeInBytesFromCookie(final int cookie) {
+    static int getWordSizeInBytesFromCookie(final int cookie) {
         if ((getCookieBase(cookie) == V2EncodingCookieBase) ||
                 (getCookieBase(cookie) == V2CompressedEncodingCookieBase)) {
             return V2maxWordSizeInBytes;
@@ -2015,6 +2614,19 @@ public abstract class AbstractHistogram extends AbstractHistogramBase implements
     synchronized public int encodeIntoCompressedByteBuffer(
             final ByteBuffer targetBuffer,
             final int compressionLevel) {
+        return encodeIntoCompressedByteBuffer(targetBuffer, HistogramCompressionCodec.deflate(compressionLevel));
+    }
+
+    /**
+     * Encode this histogram in compressed form into a byte array, using a given compression codec
+     * @param targetBuffer The buffer to encode into
+     * @param codec The compression codec to use (see {@link HistogramCompressionCodec})
+     * @return The number of bytes written to the buffer
+     */
+    @Override
+    synchronized public int encodeIntoCompressedByteBuffer(
+            final ByteBuffer targetBuffer,
+            final HistogramCompressionCodec codec) {
         int neededCapacity = getNeededByteBufferCapacity(countsArrayLength);
         if (intermediateUncompressedByteBuffer == null || intermediateUncompressedByteBuffer.capacity() < neededCapacity) {
             intermediateUncompressedByteBuffer = ByteBuffer.allocate(neededCapacity).order(BIG_ENDIAN);
@@ -2023,34 +2635,34 @@ public abstract class AbstractHistogram extends AbstractHistogramBase implements
         int initialTargetPosition = targetBuffer.position();
 
         final int uncompressedLength = encodeIntoByteBuffer(intermediateUncompressedByteBuffer);
-        targetBuffer.putInt(getCompressedEncodingCookie());
+        targetBuffer.putInt(codec.getCookieBase() | 0x10); // LSBit of wordSize byte indicates TLZE Encoding
 
         targetBuffer.putInt(0); // Placeholder for compressed contents length
 
-        Deflater compressor = new Deflater(compressionLevel);
-        compressor.setInput(intermediateUncompressedByteBuffer.array(), 0, uncompressedLength);
-        compressor.finish();
-
         byte[] targetArray;
+        int compressedTargetOffset;
 
         if (targetBuffer.hasArray()) {
             targetArray = targetBuffer.array();
+            compressedTargetOffset = targetBuffer.arrayOffset() + initialTargetPosition + 8;
         } else {
             if (intermediateUncompressedByteArray == null ||
                 intermediateUncompressedByteArray.length < targetBuffer.capacity()) {
                 intermediateUncompressedByteArray = new byte[targetBuffer.capacity()];
             }
             targetArray = intermediateUncompressedByteArray;
+            compressedTargetOffset = 0;
         }
 
-        int compressedTargetOffset = initialTargetPosition + 8;
         int compressedDataLength =
-            compressor.deflate(
+            codec.compress(
+                intermediateUncompressedByteBuffer.array(),
+                0,
+                uncompressedLength,
                 targetArray,
                 compressedTargetOffset,
-                targetArray.length - compressedTargetOffset
+                Math.min(targetArray.length - compressedTargetOffset, targetBuffer.remaining())
             );
-        compressor.end();
 
         if (!targetBuffer.hasArray()) {
             targetBuffer.put(targetArray, compressedTargetOffset, compressedDataLength);
@@ -2230,7 +2842,7 @@ public abstract class AbstractHistogram extends AbstractHistogramBase implements
     }
 
     synchronized void fillBufferFromCountsArray(ByteBuffer buffer) {
-        final int countsLimit = countsArrayIndex(maxValue) + 1;
+        final int countsLimit = countsArrayIndex(getTrackedMaxValue()) + 1;
         int srcIndex = 0;
 
         while (srcIndex < countsLimit) {
@@ -2246,7 +2858,11 @@ public abstract class AbstractHistogram extends AbstractHistogramBase implements
             // Count trailing 0s (which follow this count):
             long zerosCount = 0;
             if (count == 0) {
-                zerosCount = 1;
+                // Jump over the slots known to be empty (if the histogram tracks occupancy), then over any
+                // remaining zero counts:
+                final int nextIndex = Math.min(nextPopulatedIndex(srcIndex), countsLimit);
+                zerosCount = 1 + (nextIndex - srcIndex);
+                srcIndex = nextIndex;
                 while ((srcIndex < countsLimit) && (getCountAtIndex(srcIndex) == 0)) {
                     zerosCount++;
                     srcIndex++;
@@ -2274,28 +2890,37 @@ public abstract class AbstractHistogram extends AbstractHistogramBase implements
         } else if (getCookieBase(cookie) == V0CompressedEncodingCookieBase) {
             headerSize = V0_ENCODING_HEADER_SIZE;
         } else {
-            throw new IllegalArgumentException("The buffer does not contain a compressed Histogram");
+            final HistogramCompressionCodec codec = HistogramCompressionCodec.forCookieBase(getCookieBase(cookie));
+            if (codec == null) {
+                throw new IllegalArgumentException("The buffer does not contain a compressed Histogram");
+            }
+            final int lengthOfCompressedContents = buffer.getInt();
+            final ByteBuffer contents = codec.decompress(buffer, lengthOfCompressedContents);
+            buffer.position(buffer.position() + lengthOfCompressedContents);
+            return decodeFromByteBuffer(contents, histogramClass, minBarForHighestTrackableValue);
         }
 
         final int lengthOfCompressedContents = buffer.getInt();
         final Inflater decompressor = new Inflater();
+        try {
+            if (buffer.hasArray()) {
+                decompressor.setInput(buffer.array(), buffer.arrayOffset() + initialTargetPosition + 8,
+                        lengthOfCompressedContents);
+            } else {
+                byte[] compressedContents = new byte[lengthOfCompressedContents];
+                buffer.get(compressedContents);
+                decompressor.setInput(compressedContents);
+            }
 
-        if (buffer.hasArray()) {
-            decompressor.setInput(buffer.array(), initialTargetPosition + 8, lengthOfCompressedContents);
-        } else {
-            byte[] compressedContents = new byte[lengthOfCompressedContents];
-            buffer.get(compressedContents);
-            decompressor.setInput(compressedContents);
-        }
-
-        final ByteBuffer headerBuffer = ByteBuffer.allocate(headerSize).order(BIG_ENDIAN);
-        decompressor.inflate(headerBuffer.array());
-        T histogram = decodeFromByteBuffer(
-                headerBuffer, histogramClass, minBarForHighestTrackableValue, decompressor);
-
-        decompressor.end();
+            final ByteBuffer headerBuffer = ByteBuffer.allocate(headerSize).order(BIG_ENDIAN);
+            decompressor.inflate(headerBuffer.array());
+            T histogram = decodeFromByteBuffer(
+                    headerBuffer, histogramClass, minBarForHighestTrackableValue, decompressor);
 
-        return histogram;
+            return histogram;
+        } finally {
+            decompressor.end();
+        }
     }
 
     //   #### ##    ## ######## ######## ########  ##    ##    ###    ##
@@ -2361,7 +2986,7 @@ public abstract class AbstractHistogram extends AbstractHistogramBase implements
             }
         }
         if (maxIndex >= 0) {
-            updatedMaxValue(highestEquivalentValue(valueFromIndex(maxIndex)));
+            updatedMaxValue(highestEquivalentValueAtIndex(maxIndex));
         }
         if (minNonZeroIndex >= 0) {
             updateMinNonZeroValue(valueFromIndex(minNonZeroIndex));
@@ -2370,22 +2995,7 @@ public abstract class AbstractHistogram extends AbstractHistogramBase implements
     }
 
     int getBucketsNeededToCoverValue(final long value) {
-        // Shift won't overflow because subBucketMagnitude + unitMagnitude <= 62.
-        // the k'th bucket can express from 0 * 2^k to subBucketCount * 2^k in units of 2^k
-        long smallestUntrackableValue = ((long) subBucketCount) << unitMagnitude;
-
-        // always have at least 1 bucket
-        int bucketsNeeded = 1;
-        while (smallestUntrackableValue <= value) {
-            if (smallestUntrackableValue > (Long.MAX_VALUE / 2)) {
-                // next shift will overflow, meaning that bucket could represent values up to ones greater than
-                // Long.MAX_VALUE, so it's the last bucket
-                return bucketsNeeded + 1;
-            }
-            smallestUntrackableValue <<= 1;
-            bucketsNeeded++;
-        }
-        return bucketsNeeded;
+        return layout.getBucketsNeededToCoverValue(value);
     }
 
     /**
@@ -2408,6 +3018,48 @@ public abstract class AbstractHistogram extends AbstractHistogramBase implements
         return countsArrayIndex(bucketIndex, subBucketIndex);
     }
 
+    /**
+     * Get the lowest counts index that may hold a non-zero count, per the tracked min non-zero value (or 0, when
+     * a zero value has been recorded). Only meaningful for histograms with a non-zero total count.
+     */
+    int getLowestPopulatedIndex() {
+        final long minNonZeroValue = getMinNonZeroValue();
+        if ((minNonZeroValue == Long.MAX_VALUE) || (getCountAtIndex(0) != 0)) {
+            return 0;
+        }
+        return Math.min(countsArrayIndex(minNonZeroValue), countsArrayLength - 1);
+    }
+
+    /**
+     * Get the highest counts index that may hold a non-zero count, per the tracked max value.
+     */
+    int getHighestPopulatedIndex() {
+        return Math.min(countsArrayIndex(getMaxValue()), countsArrayLength - 1);
+    }
+
+    /**
+     * Get the lowest counts index at or above fromIndex that may hold a non-zero count. Histograms that can
+     * skip empty slots (see {@link #canSkipEmptySlots}) jump over known-empty slots (returning countsArrayLength
+     * if there are none), while all others just return fromIndex.
+     */
+    int nextPopulatedIndex(final int fromIndex) {
+        return fromIndex;
+    }
+
+    /**
+     * @return true if {@link #nextPopulatedIndex} can skip over empty counts slots
+     */
+    boolean canSkipEmptySlots() {
+        return false;
+    }
+
+    /**
+     * @return true if this histogram maintains an occupancy bitmap that must be updated along with its counts
+     */
+    boolean hasOccupancyBitmap() {
+        return false;
+    }
+
     private int countsArrayIndex(final int bucketIndex, final int subBucketIndex) {
         assert(subBucketIndex < subBucketCount);
         assert(bucketIndex == 0 || (subBucketIndex >= subBucketHalfCount));
@@ -2472,16 +3124,17 @@ public abstract class AbstractHistogram extends AbstractHistogramBase implements
     }
 
     final long valueFromIndex(final int index) {
-        int bucketIndex = (index >> subBucketHalfCountMagnitude) - 1;
-        int subBucketIndex = (index & (subBucketHalfCount - 1)) + subBucketHalfCount;
-        if (bucketIndex < 0) {
-            subBucketIndex -= subBucketHalfCount;
-            bucketIndex = 0;
-        }
-        return valueFromIndex(bucketIndex, subBucketIndex);
+        return layout.valueFromIndex(index);
+    }
+
+    final long highestEquivalentValueAtIndex(final int index) {
+        return layout.highestEquivalentValueAtIndex(index);
     }
 
     static int numberOfSubBuckets(final int numberOfSignificantValueDigits) {
+        if ((numberOfSignificantValueDigits >= 0) && (numberOfSignificantValueDigits <= 5)) {
+            return HistogramLayout.subBucketCount(numberOfSignificantValueDigits);
+        }
         final long largestValueWithSingleUnitResolution = 2 * (long) Math.pow(10, numberOfSignificantValueDigits);
 
         // We need to maintain power-of-two subBucketCount (for clean direct indexing) that is large enough to
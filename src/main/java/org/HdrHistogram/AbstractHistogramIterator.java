@@ -52,6 +52,17 @@ abstract class AbstractHistogramIterator implements Iterator<HistogramIterationV
         currentIterationValue.reset();
     }
 
+    /**
+     * Move a freshly reset iterator forward to the histogram's lowest populated index, skipping the (empty)
+     * indexes below it. Only suitable for iterators that do not report on empty index ranges.
+     */
+    void skipToLowestPopulatedIndex() {
+        if (arrayTotalCount == 0) {
+            return;
+        }
+        moveToIndex(histogram.nextPopulatedIndex(histogram.getLowestPopulatedIndex()));
+    }
+
     /**
      * Returns true if the iteration has more elements. (In other words, returns true if next would return an
      * element rather than throwing an exception.)
@@ -78,7 +89,7 @@ abstract class AbstractHistogramIterator implements Iterator<HistogramIterationV
             countAtThisValue = histogram.getCountAtIndex(currentIndex);
             if (freshSubBucket) { // Don't add unless we've incremented since last bucket...
                 totalCountToCurrentIndex += countAtThisValue;
-                totalValueToCurrentIndex += countAtThisValue * histogram.highestEquivalentValue(currentValueAtIndex);
+                totalValueToCurrentIndex += countAtThisValue * histogram.highestEquivalentValueAtIndex(currentIndex);
                 freshSubBucket = false;
             }
             if (reachedIterationLevel()) {
@@ -131,7 +142,7 @@ abstract class AbstractHistogramIterator implements Iterator<HistogramIterationV
     }
 
     long getValueIteratedTo() {
-        return histogram.highestEquivalentValue(currentValueAtIndex);
+        return histogram.highestEquivalentValueAtIndex(currentIndex);
     }
 
     private boolean exhaustedSubBuckets() {
@@ -139,9 +150,21 @@ abstract class AbstractHistogramIterator implements Iterator<HistogramIterationV
     }
 
     void incrementSubBucket() {
+        moveToIndex(currentIndex + 1);
+    }
+
+    /**
+     * Move to the next index that may hold a non-zero count, skipping over slots the histogram knows to be empty.
+     * Only suitable for iterators that do not report on empty index ranges.
+     */
+    final void incrementToNextPopulatedSubBucket() {
+        moveToIndex(histogram.nextPopulatedIndex(currentIndex + 1));
+    }
+
+    private void moveToIndex(final int index) {
         freshSubBucket = true;
-        // Take on the next index:
-        currentIndex++;
+        // Take on the new index:
+        currentIndex = index;
         currentValueAtIndex = histogram.valueFromIndex(currentIndex);
         // Figure out the value at the next index (used by some iterators):
         nextValueAtIndex = histogram.valueFromIndex(currentIndex + 1);
@@ -0,0 +1,408 @@
+/**
+ * Written by Gil Tene of Azul Systems, and released to the public domain,
+ * as explained at http://creativecommons.org/publicdomain/zero/1.0/
+ *
+ * @author Gil Tene
+ */
+
+package org.HdrHistogram;
+
+import java.io.IOException;
+import java.io.ObjectInputStream;
+import java.nio.ByteBuffer;
+import java.util.Arrays;
+import java.util.zip.DataFormatException;
+
+/**
+ * <h3>A High Dynamic Range (HDR) Histogram whose count word width adapts to the recorded counts</h3>
+ * <p>
+ * {@link AdaptiveCountsHistogram} keeps its counts in blocks, with one block per half-bucket (i.e. per binary
+ * order of magnitude) of the value range. All blocks start out with 1 byte count cells, and each block is
+ * individually promoted to wider (2, 4 or 8 byte) count cells when a count within it would no longer fit its
+ * current width. Blocks covering rarely recorded values thus keep using 1 byte per count, while blocks covering
+ * the commonly recorded values grow as wide as their counts need. Unlike {@link ShortCountsHistogram} and
+ * {@link IntCountsHistogram}, an {@link AdaptiveCountsHistogram} never overflows its counts, and unlike
+ * {@link Histogram}, it does not spend 8 bytes on each mostly-small count. This makes it a good fit for
+ * keeping large numbers of histograms (e.g. one per endpoint) in memory at once.
+ * <p>
+ * Count updates in an {@link AdaptiveCountsHistogram} are somewhat more expensive than in a {@link Histogram},
+ * as they need to dispatch on the block's count width. Block widths only ever grow: they are retained across
+ * {@link #reset()} calls, and {@link #getEstimatedFootprintInBytes()} reports the footprint of the current widths.
+ * <p>
+ * See package description for {@link org.HdrHistogram} for details.
+ */
+
+public class AdaptiveCountsHistogram extends AbstractHistogram {
+    long totalCount;
+    int normalizingIndexOffset;
+
+    // Each block is a byte[], short[], int[] or long[] (as indicated by its word size), and covers the
+    // normalized counts index range of a single half-bucket. Narrower-than-long counts are kept unsigned:
+    Object[] blocks;
+    byte[] blockWordSizes;
+
+    @Override
+    long getCountAtIndex(final int index) {
+        return getCountAtNormalizedIndex(normalizeIndex(index, normalizingIndexOffset, countsArrayLength));
+    }
+
+    @Override
+    long getCountAtNormalizedIndex(final int index) {
+        return getCountInBlock(index >> subBucketHalfCountMagnitude, index & (subBucketHalfCount - 1));
+    }
+
+    @Override
+    void incrementCountAtIndex(final int index) {
+        addToCountAtNormalizedIndex(normalizeIndex(index, normalizingIndexOffset, countsArrayLength), 1);
+    }
+
+    @Override
+    void addToCountAtIndex(final int index, final long value) {
+        addToCountAtNormalizedIndex(normalizeIndex(index, normalizingIndexOffset, countsArrayLength), value);
+    }
+
+    @Override
+    void setCountAtIndex(int index, long value) {
+        setCountAtNormalizedIndex(normalizeIndex(index, normalizingIndexOffset, countsArrayLength), value);
+    }
+
+    @Override
+    void setCountAtNormalizedIndex(int index, long value) {
+        setCountInBlock(index >> subBucketHalfCountMagnitude, index & (subBucketHalfCount - 1), value);
+    }
+
+    private void addToCountAtNormalizedIndex(final int index, final long value) {
+        final int blockIndex = index >> subBucketHalfCountMagnitude;
+        final int indexInBlock = index & (subBucketHalfCount - 1);
+        setCountInBlock(blockIndex, indexInBlock, getCountInBlock(blockIndex, indexInBlock) + value);
+    }
+
+    private long getCountInBlock(final int blockIndex, final int indexInBlock) {
+        final Object block = blocks[blockIndex];
+        switch (blockWordSizes[blockIndex]) {
+            case 1:
+                return ((byte[]) block)[indexInBlock] & 0xffL;
+            case 2:
+                return ((short[]) block)[indexInBlock] & 0xffffL;
+            case 4:
+                return ((int[]) block)[indexInBlock] & 0xffffffffL;
+            default:
+                return ((long[]) block)[indexInBlock];
+        }
+    }
+
+    private void setCountInBlock(final int blockIndex, final int indexInBlock, final long count) {
+        if (!fitsWordSize(count, blockWordSizes[blockIndex])) {
+            promoteBlock(blockIndex, wordSizeNeededFor(count));
+        }
+        final Object block = blocks[blockIndex];
+        switch (blockWordSizes[blockIndex]) {
+            case 1:
+                ((byte[]) block)[indexInBlock] = (byte) count;
+                break;
+            case 2:
+                ((short[]) block)[indexInBlock] = (short) count;
+                break;
+            case 4:
+                ((int[]) block)[indexInBlock] = (int) count;
+                break;
+            default:
+                ((long[]) block)[indexInBlock] = count;
+        }
+    }
+
+    private static boolean fitsWordSize(final long count, final int wordSizeInBytes) {
+        // Narrow counts are unsigned, so negative counts (which may appear transiently) need long words:
+        return (wordSizeInBytes == 8) || ((count >>> (wordSizeInBytes << 3)) == 0);
+    }
+
+    private static int wordSizeNeededFor(final long count) {
+        return fitsWordSize(count, 1) ? 1 : fitsWordSize(count, 2) ? 2 : fitsWordSize(count, 4) ? 4 : 8;
+    }
+
+    private void promoteBlock(final int blockIndex, final int newWordSizeInBytes) {
+        final int blockLength = subBucketHalfCount;
+        final Object newBlock = allocateBlock(newWordSizeInBytes);
+        for (int i = 0; i < blockLength; i++) {
+            final long count = getCountInBlock(blockIndex, i);
+            if (count != 0) {
+                switch (newWordSizeInBytes) {
+                    case 2:
+                        ((short[]) newBlock)[i] = (short) count;
+                        break;
+                    case 4:
+                        ((int[]) newBlock)[i] = (int) count;
+                        break;
+                    default:
+                        ((long[]) newBlock)[i] = count;
+                }
+            }
+        }
+        blocks[blockIndex] = newBlock;
+        blockWordSizes[blockIndex] = (byte) newWordSizeInBytes;
+    }
+
+    private Object allocateBlock(final int wordSizeInBytes) {
+        switch (wordSizeInBytes) {
+            case 1:
+                return new byte[subBucketHalfCount];
+            case 2:
+                return new short[subBucketHalfCount];
+            case 4:
+                return new int[subBucketHalfCount];
+            default:
+                return new long[subBucketHalfCount];
+        }
+    }
+
+    private void allocateBlocks(final int fromBlockIndex, final int toBlockIndex) {
+        for (int blockIndex = fromBlockIndex; blockIndex < toBlockIndex; blockIndex++) {
+            blocks[blockIndex] = allocateBlock(1);
+            blockWordSizes[blockIndex] = 1;
+        }
+    }
+
+    private void establishBlocks() {
+        final int numberOfBlocks = countsArrayLength >> subBucketHalfCountMagnitude;
+        blocks = new Object[numberOfBlocks];
+        blockWordSizes = new byte[numberOfBlocks];
+        allocateBlocks(0, numberOfBlocks);
+    }
+
+    /**
+     * Get the number of count blocks (one per half-bucket of the value range) currently using count cells
+     * of a given width.
+     *
+     * @param wordSizeInBytes The count cell width (1, 2, 4 or 8 bytes)
+     * @return the number of blocks currently using count cells of the given width
+     */
+    public int getNumberOfBlocksWithWordSize(final int wordSizeInBytes) {
+        int numberOfBlocks = 0;
+        for (byte blockWordSize : blockWordSizes) {
+            if (blockWordSize == wordSizeInBytes) {
+                numberOfBlocks++;
+            }
+        }
+        return numberOfBlocks;
+    }
+
+    @Override
+    int getNormalizingIndexOffset() {
+        return normalizingIndexOffset;
+    }
+
+    @Override
+    void setNormalizingIndexOffset(int normalizingIndexOffset) {
+        this.normalizingIndexOffset = normalizingIndexOffset;
+    }
+
+    @Override
+    void setIntegerToDoubleValueConversionRatio(double integerToDoubleValueConversionRatio) {
+        nonConcurrentSetIntegerToDoubleValueConversionRatio(integerToDoubleValueConversionRatio);
+    }
+
+    @Override
+    void shiftNormalizingIndexByOffset(int offsetToAdd,
+                                       boolean lowestHalfBucketPopulated,
+                                       double newIntegerToDoubleValueConversionRatio) {
+        nonConcurrentNormalizingIndexShift(offsetToAdd, lowestHalfBucketPopulated);
+    }
+
+    @Override
+    void clearCounts() {
+        // Keep the blocks at their current widths, so that a reset histogram does not need to re-promote them:
+        for (int blockIndex = 0; blockIndex < blocks.length; blockIndex++) {
+            final Object block = blocks[blockIndex];
+            switch (blockWordSizes[blockIndex]) {
+                case 1:
+                    Arrays.fill((byte[]) block, (byte) 0);
+                    break;
+                case 2:
+                    Arrays.fill((short[]) block, (short) 0);
+                    break;
+                case 4:
+                    Arrays.fill((int[]) block, 0);
+                    break;
+                default:
+                    Arrays.fill((long[]) block, 0);
+            }
+        }
+        totalCount = 0;
+    }
+
+    @Override
+    public AdaptiveCountsHistogram copy() {
+        AdaptiveCountsHistogram copy = new AdaptiveCountsHistogram(this);
+        copy.add(this);
+        return copy;
+    }
+
+    @Override
+    public AdaptiveCountsHistogram copyCorrectedForCoordinatedOmission(final long expectedIntervalBetweenValueSamples) {
+        AdaptiveCountsHistogram toHistogram = new AdaptiveCountsHistogram(this);
+        toHistogram.addWhileCorrectingForCoordinatedOmission(this, expectedIntervalBetweenValueSamples);
+        return toHistogram;
+    }
+
+    @Override
+    public long getTotalCount() {
+        return totalCount;
+    }
+
+    @Override
+    void setTotalCount(final long totalCount) {
+        this.totalCount = totalCount;
+    }
+
+    @Override
+    void incrementTotalCount() {
+        totalCount++;
+    }
+
+    @Override
+    void addToTotalCount(long value) {
+        totalCount += value;
+    }
+
+    @Override
+    int _getEstimatedFootprintInBytes() {
+        // Each block costs an array header and a reference, in addition to its count cells:
+        int footprint = 512 + (5 * blocks.length);
+        for (byte blockWordSize : blockWordSizes) {
+            footprint += 16 + (blockWordSize * subBucketHalfCount);
+        }
+        return footprint;
+    }
+
+    @Override
+    void resize(long newHighestTrackableValue) {
+        final int oldNormalizedZeroIndex = normalizeIndex(0, normalizingIndexOffset, countsArrayLength);
+        final int oldNumberOfBlocks = blocks.length;
+
+        establishSize(newHighestTrackableValue);
+
+        final int numberOfBlocks = countsArrayLength >> subBucketHalfCountMagnitude;
+        final int blocksDelta = numberOfBlocks - oldNumberOfBlocks;
+
+        blocks = Arrays.copyOf(blocks, numberOfBlocks);
+        blockWordSizes = Arrays.copyOf(blockWordSizes, numberOfBlocks);
+
+        if (oldNormalizedZeroIndex != 0) {
+            // We need to shift the blocks from the zero index and up to the end of the array. Normalizing offsets
+            // are always whole multiples of half-buckets, so whole blocks can be moved:
+            final int oldZeroBlockIndex = oldNormalizedZeroIndex >> subBucketHalfCountMagnitude;
+            final int newZeroBlockIndex = oldZeroBlockIndex + blocksDelta;
+            final int blocksToMove = oldNumberOfBlocks - oldZeroBlockIndex;
+            System.arraycopy(blocks, oldZeroBlockIndex, blocks, newZeroBlockIndex, blocksToMove);
+            System.arraycopy(blockWordSizes, oldZeroBlockIndex, blockWordSizes, newZeroBlockIndex, blocksToMove);
+            allocateBlocks(oldZeroBlockIndex, newZeroBlockIndex);
+        } else {
+            allocateBlocks(oldNumberOfBlocks, numberOfBlocks);
+        }
+    }
+
+    /**
+     * Construct an auto-resizing AdaptiveCountsHistogram with a lowest discernible value of 1 and an auto-adjusting
+     * highestTrackableValue. Can auto-resize up to track values up to (Long.MAX_VALUE / 2).
+     *
+     * @param numberOfSignificantValueDigits Specifies the precision to use. This is the number of significant
+     *                                       decimal digits to which the histogram will maintain value resolution
+     *                                       and separation. Must be a non-negative integer between 0 and 5.
+     */
+    public AdaptiveCountsHistogram(final int numberOfSignificantValueDigits) {
+        this(1, 2, numberOfSignificantValueDigits);
+        setAutoResize(true);
+    }
+
+    /**
+     * Construct an AdaptiveCountsHistogram given the Highest value to be tracked and a number of significant
+     * decimal digits. The histogram will be constructed to implicitly track (distinguish from 0) values as low as 1.
+     *
+     * @param highestTrackableValue The highest value to be tracked by the histogram. Must be a positive
+     *                              integer that is {@literal >=} 2.
+     * @param numberOfSignificantValueDigits Specifies the precision to use. This is the number of significant
+     *                                       decimal digits to which the histogram will maintain value resolution
+     *                                       and separation. Must be a non-negative integer between 0 and 5.
+     */
+    public AdaptiveCountsHistogram(final long highestTrackableValue, final int numberOfSignificantValueDigits) {
+        this(1, highestTrackableValue, numberOfSignificantValueDigits);
+    }
+
+    /**
+     * Construct an AdaptiveCountsHistogram given the Lowest and Highest values to be tracked and a number of
+     * significant decimal digits. Providing a lowestDiscernibleValue is useful is situations where the units used
+     * for the histogram's values are much smaller that the minimal accuracy required. E.g. when tracking
+     * time values stated in nanosecond units, where the minimal accuracy required is a microsecond, the
+     * proper value for lowestDiscernibleValue would be 1000.
+     *
+     * @param lowestDiscernibleValue The lowest value that can be tracked (distinguished from 0) by the histogram.
+     *                               Must be a positive integer that is {@literal >=} 1. May be internally rounded
+     *                               down to nearest power of 2.
+     * @param highestTrackableValue The highest value to be tracked by the histogram. Must be a positive
+     *                              integer that is {@literal >=} (2 * lowestDiscernibleValue).
+     * @param numberOfSignificantValueDigits Specifies the precision to use. This is the number of significant
+     *                                       decimal digits to which the histogram will maintain value resolution
+     *                                       and separation. Must be a non-negative integer between 0 and 5.
+     */
+    public AdaptiveCountsHistogram(final long lowestDiscernibleValue, final long highestTrackableValue,
+                                   final int numberOfSignificantValueDigits) {
+        super(lowestDiscernibleValue, highestTrackableValue, numberOfSignificantValueDigits);
+        establishBlocks();
+        wordSizeInBytes = 8;
+    }
+
+    /**
+     * Construct a histogram with the same range settings as a given source histogram,
+     * duplicating the source's start/end timestamps (but NOT it's contents)
+     * @param source The source histogram to duplicate
+     */
+    public AdaptiveCountsHistogram(final AbstractHistogram source) {
+        super(source);
+        establishBlocks();
+        wordSizeInBytes = 8;
+    }
+
+    /**
+     * Construct a new histogram by decoding it from a ByteBuffer.
+     * @param buffer The buffer to decode from
+     * @param minBarForHighestTrackableValue Force highestTrackableValue to be set at least this high
+     * @return The newly constructed histogram
+     */
+    public static AdaptiveCountsHistogram decodeFromByteBuffer(final ByteBuffer buffer,
+                                                               final long minBarForHighestTrackableValue) {
+        return decodeFromByteBuffer(buffer, AdaptiveCountsHistogram.class, minBarForHighestTrackableValue);
+    }
+
+    /**
+     * Construct a new histogram by decoding it from a compressed form in a ByteBuffer.
+     * @param buffer The buffer to decode from
+     * @param minBarForHighestTrackableValue Force highestTrackableValue to be set at least this high
+     * @return The newly constructed histogram
+     * @throws DataFormatException on error parsing/decompressing the buffer
+     */
+    public static AdaptiveCountsHistogram decodeFromCompressedByteBuffer(final ByteBuffer buffer,
+                                                                         final long minBarForHighestTrackableValue)
+            throws DataFormatException {
+        return decodeFromCompressedByteBuffer(buffer, AdaptiveCountsHistogram.class, minBarForHighestTrackableValue);
+    }
+
+    /**
+     * Construct a new AdaptiveCountsHistogram by decoding it from a String containing a base64 encoded
+     * compressed histogram representation.
+     *
+     * @param base64CompressedHistogramString A string containing a base64 encoding of a compressed histogram
+     * @return An AdaptiveCountsHistogram decoded from the string
+     * @throws DataFormatException on error parsing/decompressing the input
+     */
+    public static AdaptiveCountsHistogram fromString(final String base64CompressedHistogramString)
+            throws DataFormatException {
+        return decodeFromCompressedByteBuffer(
+                ByteBuffer.wrap(Base64Helper.parseBase64Binary(base64CompressedHistogramString)),
+                0);
+    }
+
+    private void readObject(final ObjectInputStream o)
+            throws IOException, ClassNotFoundException {
+        o.defaultReadObject();
+    }
+}
@@ -30,41 +30,94 @@ import java.util.zip.DataFormatException;
  * See package description for {@link org.HdrHistogram} for details.
  */
 
+@SuppressWarnings("unused")
 public class AtomicHistogram extends Histogram {
 
     static final AtomicLongFieldUpdater<AtomicHistogram> totalCountUpdater =
             AtomicLongFieldUpdater.newUpdater(AtomicHistogram.class, "totalCount");
+
+    static final AtomicReferenceFieldUpdater<AtomicHistogram, AtomicLongArray> countsUpdater =
+            AtomicReferenceFieldUpdater.newUpdater(AtomicHistogram.class, AtomicLongArray.class, "counts");
+
+    // totalCount is written by every recording, while the inherited recording path fields (and the counts
+    // reference below) are read by every recording. 128 bytes of padding on each side of totalCount keep it
+    // on cache lines (and adjacent-line prefetch pairs) of its own, so that concurrent recordings' totalCount
+    // updates do not keep invalidating the lines holding the read-mostly fields. Subclass field layout rules
+    // in most practical JVM implementations place all of a class's long fields (in declaration order) ahead
+    // of its reference fields, and after all of its superclass fields.
+    private transient long prePad0, prePad1, prePad2, prePad3, prePad4, prePad5, prePad6, prePad7;
+    private transient long prePad8, prePad9, prePad10, prePad11, prePad12, prePad13, prePad14, prePad15;
     volatile long totalCount;
+    private transient long postPad0, postPad1, postPad2, postPad3, postPad4, postPad5, postPad6, postPad7;
+    private transient long postPad8, postPad9, postPad10, postPad11, postPad12, postPad13, postPad14, postPad15;
+
+    // Null while lazily unallocated (see Histogram#setLazyCountsAllocation), in which case all counts are zero:
     volatile AtomicLongArray counts;
 
     @Override
     long getCountAtIndex(final int index) {
-        return counts.get(index);
+        final AtomicLongArray counts = this.counts;
+        return (counts != null) ? counts.get(index) : 0;
     }
 
     @Override
     long getCountAtNormalizedIndex(final int index) {
-        return counts.get(index);
+        return getCountAtIndex(index);
     }
 
     @Override
     void incrementCountAtIndex(final int index) {
-        counts.getAndIncrement(index);
+        final AtomicLongArray counts = this.counts;
+        ((counts != null) ? counts : allocatedCounts()).getAndIncrement(index);
     }
 
     @Override
     void addToCountAtIndex(final int index, final long value) {
-        counts.getAndAdd(index, value);
+        final AtomicLongArray counts = this.counts;
+        if (counts != null) {
+            counts.getAndAdd(index, value);
+        } else if (value != 0) {
+            allocatedCounts().getAndAdd(index, value);
+        }
     }
 
     @Override
     void setCountAtIndex(int index, long value) {
-        counts.lazySet(index, value);
+        final AtomicLongArray counts = this.counts;
+        if (counts != null) {
+            counts.lazySet(index, value);
+        } else if (value != 0) {
+            allocatedCounts().lazySet(index, value);
+        }
     }
 
     @Override
     void setCountAtNormalizedIndex(int index, long value) {
-        counts.lazySet(index, value);
+        setCountAtIndex(index, value);
+    }
+
+    private AtomicLongArray allocatedCounts() {
+        // Concurrent first recordings may each allocate an array, but only one of them gets installed:
+        countsUpdater.compareAndSet(this, null, new AtomicLongArray(countsArrayLength));
+        return counts;
+    }
+
+    @Override
+    void allocateCounts() {
+        if (counts == null) {
+            allocatedCounts();
+        }
+    }
+
+    @Override
+    void releaseCounts() {
+        counts = null;
+    }
+
+    @Override
+    boolean countsArrayIsPlain() {
+        // Counts are updated atomically, in an AtomicLongArray:
+        return false;
     }
 
     @Override
@@ -109,8 +162,14 @@ public class AtomicHistogram extends Histogram {
 
     @Override
     void clearCounts() {
-        for (int i = 0; i < counts.length(); i++) {
-            counts.lazySet(i, 0);
+        final AtomicLongArray counts = this.counts;
+        if (lazyCountsAllocation && (getTotalCount() == 0)) {
+            // Nothing was recorded since the previous reset, so hold no counts until the next recording:
+            releaseCounts();
+        } else if (counts != null) {
+            for (int i = 0; i < counts.length(); i++) {
+                counts.lazySet(i, 0);
+            }
         }
         totalCountUpdater.set(this, 0);
     }
@@ -151,7 +210,8 @@ public class AtomicHistogram extends Histogram {
 
     @Override
     int _getEstimatedFootprintInBytes() {
-        return (512 + (8 * counts.length()));
+        final AtomicLongArray counts = this.counts;
+        return (512 + ((counts != null) ? (8 * counts.length()) : 0));
     }
 
     /**
@@ -186,8 +246,15 @@ public class AtomicHistogram extends Histogram {
      */
     public AtomicHistogram(final long lowestDiscernibleValue, final long highestTrackableValue,
                            final int numberOfSignificantValueDigits) {
+        this(lowestDiscernibleValue, highestTrackableValue, numberOfSignificantValueDigits, true);
+    }
+
+    AtomicHistogram(final long lowestDiscernibleValue, final long highestTrackableValue,
+                    final int numberOfSignificantValueDigits, boolean allocateCountsArray) {
         super(lowestDiscernibleValue, highestTrackableValue, numberOfSignificantValueDigits, false);
-        counts = new AtomicLongArray(countsArrayLength);
+        if (allocateCountsArray) {
+            counts = new AtomicLongArray(countsArrayLength);
+        }
         wordSizeInBytes = 8;
     }
 
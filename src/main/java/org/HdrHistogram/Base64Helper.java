@@ -57,6 +57,54 @@ class Base64Helper {
     }
 
 
+    private static final byte[] decodingTable = new byte[128];
+    static {
+        java.util.Arrays.fill(decodingTable, (byte) -1);
+        final String alphabet = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+        for (int i = 0; i < alphabet.length(); i++) {
+            decodingTable[alphabet.charAt(i)] = (byte) i;
+        }
+    }
+
+    /**
+     * Converts a range of Base64 encoded (ASCII) bytes to a byte array, without going through a String
+     *
+     * @param base64input An array holding base64-encoded input bytes
+     * @param offset The offset of the first input byte
+     * @param length The number of input bytes
+     * @return a byte array containing the binary representation equivalent of the Base64 encoded input
+     * @throws IllegalArgumentException if the input is not valid Base64
+     */
+    static byte[] parseBase64Binary(final byte[] base64input, final int offset, int length) {
+        // Drop up to two padding characters:
+        int paddingLength = 0;
+        while ((length > 0) && (paddingLength < 2) && (base64input[offset + length - 1] == '=')) {
+            length--;
+            paddingLength++;
+        }
+        if ((length % 4) == 1) {
+            throw new IllegalArgumentException("Invalid Base64 input length");
+        }
+        final byte[] output = new byte[(length * 3) / 4];
+        int outputIndex = 0;
+        int accumulator = 0;
+        int bitsInAccumulator = 0;
+        for (int i = offset; i < offset + length; i++) {
+            final int c = base64input[i];
+            final int sextet = (c >= 0) ? decodingTable[c] : -1;
+            if (sextet < 0) {
+                throw new IllegalArgumentException("Illegal Base64 character: " + (char) (c & 0xff));
+            }
+            accumulator = (accumulator << 6) | sextet;
+            bitsInAccumulator += 6;
+            if (bitsInAccumulator >= 8) {
+                bitsInAccumulator -= 8;
+                output[outputIndex++] = (byte) (accumulator >> bitsInAccumulator);
+            }
+        }
+        return output;
+    }
+
     private static Method decodeMethod;
     private static Method encodeMethod;
 
@@ -0,0 +1,499 @@
+/**
+ * Written by Gil Tene of Azul Systems, and released to the public domain,
+ * as explained at http://creativecommons.org/publicdomain/zero/1.0/
+ *
+ * @author Gil Tene
+ */
+
+package org.HdrHistogram;
+
+import java.io.File;
+import java.io.IOException;
+import java.io.ObjectInputStream;
+import java.io.ObjectOutputStream;
+import java.io.RandomAccessFile;
+import java.nio.ByteBuffer;
+import java.nio.ByteOrder;
+import java.nio.MappedByteBuffer;
+import java.nio.channels.FileChannel;
+import java.util.zip.DataFormatException;
+
+/**
+ * <h3>A High Dynamic Range (HDR) Histogram with <b><code>long</code></b> counts held in a {@link ByteBuffer}</h3>
+ * <p>
+ * {@link ByteBufferHistogram} behaves like {@link Histogram}, but keeps its counts array in a {@link ByteBuffer}
+ * rather than in a <b><code>long[]</code></b>. By default the buffer is a direct (off-heap) buffer, which keeps
+ * large counts arrays of long-lived histograms out of the garbage collected heap. Alternatively, a
+ * ByteBufferHistogram can be constructed over a caller-supplied buffer, such as a {@link MappedByteBuffer}
+ * (see {@link #createFileBacked} and {@link #openFileBacked}). A file-backed histogram's counts can be read by
+ * other processes while it is being recorded into, without any serialization step.
+ * <p>
+ * The buffer holds a fixed size header (describing the histogram's value range, precision and normalizing
+ * offset) followed by the counts array, all in little-endian byte order. Total count and min/max values are
+ * tracked on-heap, and are re-established from the counts array when a buffer is wrapped (see {@link #wrap}) or
+ * explicitly re-synchronized (see {@link #syncFromBuffer()}).
+ * <p>
+ * Auto-resizing is only supported for histograms that allocate their own (direct) buffer. Histograms constructed
+ * over a caller-supplied buffer have a fixed value range.
+ * <p>
+ * ByteBufferHistogram is not internally synchronized, and has the same thread-safety properties as
+ * {@link Histogram}.
+ * <p>
+ * See package description for {@link org.HdrHistogram} for details.
+ */
+
+public class ByteBufferHistogram extends AbstractHistogram {
+    static final int bufferCookie = 0x1c8493b0;
+
+    // Header layout:
+    static final int cookieOffset = 0;
+    static final int countsArrayLengthOffset = 4;
+    static final int lowestDiscernibleValueOffset = 8;
+    static final int highestTrackableValueOffset = 16;
+    static final int numberOfSignificantValueDigitsOffset = 24;
+    static final int normalizingIndexOffsetOffset = 28;
+    static final int integerToDoubleValueConversionRatioOffset = 32;
+    static final int headerSize = 64;
+
+    long totalCount;
+    int normalizingIndexOffset;
+    transient ByteBuffer buffer;
+    private boolean ownsBuffer;
+
+    private static int countOffset(final int normalizedIndex) {
+        return headerSize + (normalizedIndex << 3);
+    }
+
+    @Override
+    long getCountAtIndex(final int index) {
+        return buffer.getLong(countOffset(normalizeIndex(index, normalizingIndexOffset, countsArrayLength)));
+    }
+
+    @Override
+    long getCountAtNormalizedIndex(final int index) {
+        return buffer.getLong(countOffset(index));
+    }
+
+    @Override
+    void incrementCountAtIndex(final int index) {
+        final int offset = countOffset(normalizeIndex(index, normalizingIndexOffset, countsArrayLength));
+        buffer.putLong(offset, buffer.getLong(offset) + 1);
+    }
+
+    @Override
+    void addToCountAtIndex(final int index, final long value) {
+        final int offset = countOffset(normalizeIndex(index, normalizingIndexOffset, countsArrayLength));
+        buffer.putLong(offset, buffer.getLong(offset) + value);
+    }
+
+    @Override
+    void setCountAtIndex(int index, long value) {
+        buffer.putLong(countOffset(normalizeIndex(index, normalizingIndexOffset, countsArrayLength)), value);
+    }
+
+    @Override
+    void setCountAtNormalizedIndex(int index, long value) {
+        buffer.putLong(countOffset(index), value);
+    }
+
+    @Override
+    int getNormalizingIndexOffset() {
+        return normalizingIndexOffset;
+    }
+
+    @Override
+    void setNormalizingIndexOffset(int normalizingIndexOffset) {
+        this.normalizingIndexOffset = normalizingIndexOffset;
+        if (buffer != null) {
+            buffer.putInt(normalizingIndexOffsetOffset, normalizingIndexOffset);
+        }
+    }
+
+    @Override
+    void setIntegerToDoubleValueConversionRatio(double integerToDoubleValueConversionRatio) {
+        nonConcurrentSetIntegerToDoubleValueConversionRatio(integerToDoubleValueConversionRatio);
+        if (buffer != null) {
+            buffer.putDouble(integerToDoubleValueConversionRatioOffset, integerToDoubleValueConversionRatio);
+        }
+    }
+
+    @Override
+    void shiftNormalizingIndexByOffset(int offsetToAdd,
+                                       boolean lowestHalfBucketPopulated,
+                                       double newIntegerToDoubleValueConversionRatio) {
+        nonConcurrentNormalizingIndexShift(offsetToAdd, lowestHalfBucketPopulated);
+    }
+
+    @Override
+    void clearCounts() {
+        for (int i = 0; i < countsArrayLength; i++) {
+            buffer.putLong(countOffset(i), 0);
+        }
+        totalCount = 0;
+    }
+
+    @Override
+    public ByteBufferHistogram copy() {
+        ByteBufferHistogram copy = new ByteBufferHistogram(this);
+        copy.add(this);
+        return copy;
+    }
+
+    @Override
+    public ByteBufferHistogram copyCorrectedForCoordinatedOmission(final long expectedIntervalBetweenValueSamples) {
+        ByteBufferHistogram copy = new ByteBufferHistogram(this);
+        copy.addWhileCorrectingForCoordinatedOmission(this, expectedIntervalBetweenValueSamples);
+        return copy;
+    }
+
+    @Override
+    public long getTotalCount() {
+        return totalCount;
+    }
+
+    @Override
+    void setTotalCount(final long totalCount) {
+        this.totalCount = totalCount;
+    }
+
+    @Override
+    void incrementTotalCount() {
+        totalCount++;
+    }
+
+    @Override
+    void addToTotalCount(final long value) {
+        totalCount += value;
+    }
+
+    @Override
+    int _getEstimatedFootprintInBytes() {
+        return (512 + headerSize + (8 * countsArrayLength));
+    }
+
+    @Override
+    void resize(long newHighestTrackableValue) {
+        if (!ownsBuffer) {
+            throw new IllegalStateException(
+                    "ByteBufferHistogram does not support resizing of caller-supplied buffers.");
+        }
+        final int oldCountsArrayLength = countsArrayLength;
+        final int oldNormalizedZeroIndex = normalizeIndex(0, normalizingIndexOffset, oldCountsArrayLength);
+
+        establishSize(newHighestTrackableValue);
+
+        final ByteBuffer newBuffer = allocateBuffer(countsArrayLength);
+        final ByteBuffer oldContents = buffer.duplicate();
+        oldContents.limit(countOffset(oldCountsArrayLength));
+        oldContents.position(0);
+        newBuffer.put(oldContents);
+
+        if (oldNormalizedZeroIndex != 0) {
+            // We need to shift the stuff from the zero index and up to the end of the array:
+            final int countsDelta = countsArrayLength - oldCountsArrayLength;
+            for (int i = oldCountsArrayLength - 1; i >= oldNormalizedZeroIndex; i--) {
+                newBuffer.putLong(countOffset(i + countsDelta), newBuffer.getLong(countOffset(i)));
+            }
+            for (int i = oldNormalizedZeroIndex; i < oldNormalizedZeroIndex + countsDelta; i++) {
+                newBuffer.putLong(countOffset(i), 0);
+            }
+        }
+        buffer = newBuffer;
+        writeHeader();
+    }
+
+    @Override
+    public void setAutoResize(boolean autoResize) {
+        if (autoResize && !ownsBuffer) {
+            throw new IllegalStateException(
+                    "ByteBufferHistogram does not support AutoResize for caller-supplied buffers.");
+        }
+        super.setAutoResize(autoResize);
+    }
+
+    @Override
+    public boolean supportsAutoResize() {
+        return ownsBuffer;
+    }
+
+    /**
+     * Construct an auto-resizing ByteBufferHistogram (in a direct buffer) with a lowest discernible value of 1 and
+     * an auto-adjusting highestTrackableValue. Can auto-resize up to track values up to (Long.MAX_VALUE / 2).
+     *
+     * @param numberOfSignificantValueDigits Specifies the precision to use. This is the number of significant
+     *                                       decimal digits to which the histogram will maintain value resolution
+     *                                       and separation. Must be a non-negative integer between 0 and 5.
+     */
+    public ByteBufferHistogram(final int numberOfSignificantValueDigits) {
+        this(1, 2, numberOfSignificantValueDigits);
+        setAutoResize(true);
+    }
+
+    /**
+     * Construct a ByteBufferHistogram (in a direct buffer) given the Highest value to be tracked and a number of
+     * significant decimal digits. The histogram will be constructed to implicitly track (distinguish from 0) values
+     * as low as 1.
+     *
+     * @param highestTrackableValue The highest value to be tracked by the histogram. Must be a positive
+     *                              integer that is {@literal >=} 2.
+     * @param numberOfSignificantValueDigits Specifies the precision to use. This is the number of significant
+     *                                       decimal digits to which the histogram will maintain value resolution
+     *                                       and separation. Must be a non-negative integer between 0 and 5.
+     */
+    public ByteBufferHistogram(final long highestTrackableValue, final int numberOfSignificantValueDigits) {
+        this(1, highestTrackableValue, numberOfSignificantValueDigits);
+    }
+
+    /**
+     * Construct a ByteBufferHistogram (in a direct buffer) given the Lowest and Highest values to be tracked and a
+     * number of significant decimal digits. Providing a lowestDiscernibleValue is useful is situations where the
+     * units used for the histogram's values are much smaller that the minimal accuracy required. E.g. when tracking
+     * time values stated in nanosecond units, where the minimal accuracy required is a microsecond, the
+     * proper value for lowestDiscernibleValue would be 1000.
+     *
+     * @param lowestDiscernibleValue The lowest value that can be tracked (distinguished from 0) by the histogram.
+     *                               Must be a positive integer that is {@literal >=} 1. May be internally rounded
+     *                               down to nearest power of 2.
+     * @param highestTrackableValue The highest value to be tracked by the histogram. Must be a positive
+     *                              integer that is {@literal >=} (2 * lowestDiscernibleValue).
+     * @param numberOfSignificantValueDigits Specifies the precision to use. This is the number of significant
+     *                                       decimal digits to which the histogram will maintain value resolution
+     *                                       and separation. Must be a non-negative integer between 0 and 5.
+     */
+    public ByteBufferHistogram(final long lowestDiscernibleValue, final long highestTrackableValue,
+                               final int numberOfSignificantValueDigits) {
+        super(lowestDiscernibleValue, highestTrackableValue, numberOfSignificantValueDigits);
+        ownsBuffer = true;
+        buffer = allocateBuffer(countsArrayLength);
+        wordSizeInBytes = 8;
+        writeHeader();
+    }
+
+    /**
+     * Construct a ByteBufferHistogram over a caller-supplied buffer (e.g. a {@link MappedByteBuffer}), given the
+     * Lowest and Highest values to be tracked and a number of significant decimal digits. The histogram's header
+     * and (zeroed) counts are written into the buffer, starting at the buffer's current position. The buffer
+     * must have at least {@link #getNeededBufferCapacity} bytes remaining.
+     *
+     * @param lowestDiscernibleValue The lowest value that can be tracked (distinguished from 0) by the histogram.
+     *                               Must be a positive integer that is {@literal >=} 1. May be internally rounded
+     *                               down to nearest power of 2.
+     * @param highestTrackableValue The highest value to be tracked by the histogram. Must be a positive
+     *                              integer that is {@literal >=} (2 * lowestDiscernibleValue).
+     * @param numberOfSignificantValueDigits Specifies the precision to use. This is the number of significant
+     *                                       decimal digits to which the histogram will maintain value resolution
+     *                                       and separation. Must be a non-negative integer between 0 and 5.
+     * @param buffer The buffer to hold the histogram's header and counts
+     * @throws IllegalArgumentException if the buffer is too small for the histogram
+     */
+    public ByteBufferHistogram(final long lowestDiscernibleValue, final long highestTrackableValue,
+                               final int numberOfSignificantValueDigits, final ByteBuffer buffer) {
+        super(lowestDiscernibleValue, highestTrackableValue, numberOfSignificantValueDigits);
+        ownsBuffer = false;
+        this.buffer = sliceOf(buffer, countOffset(countsArrayLength));
+        wordSizeInBytes = 8;
+        writeHeader();
+        clearCounts();
+    }
+
+    /**
+     * Construct a histogram with the same range settings as a given source histogram,
+     * duplicating the source's start/end timestamps (but NOT it's contents). The histogram's counts
+     * are held in a direct buffer.
+     * @param source The source histogram to duplicate
+     */
+    public ByteBufferHistogram(final AbstractHistogram source) {
+        super(source);
+        ownsBuffer = true;
+        buffer = allocateBuffer(countsArrayLength);
+        wordSizeInBytes = 8;
+        writeHeader();
+    }
+
+    private ByteBufferHistogram(final ByteBuffer buffer,
+                                final long lowestDiscernibleValue, final long highestTrackableValue,
+                                final int numberOfSignificantValueDigits) {
+        super(lowestDiscernibleValue, highestTrackableValue, numberOfSignificantValueDigits);
+        ownsBuffer = false;
+        this.buffer = buffer;
+        wordSizeInBytes = 8;
+    }
+
+    /**
+     * Construct a ByteBufferHistogram over a buffer that already holds a ByteBufferHistogram's header and counts
+     * (starting at the buffer's current position), e.g. a buffer mapped from a file that another process is
+     * recording into. The buffer's contents are not modified, and read-only buffers are supported for
+     * querying purposes.
+     *
+     * @param buffer The buffer holding the histogram's header and counts
+     * @return A ByteBufferHistogram using the buffer's contents
+     * @throws IllegalArgumentException if the buffer does not hold a ByteBufferHistogram
+     */
+    public static ByteBufferHistogram wrap(final ByteBuffer buffer) {
+        final ByteBuffer header = buffer.slice().order(ByteOrder.LITTLE_ENDIAN);
+        if ((header.remaining() < headerSize) || (header.getInt(cookieOffset) != bufferCookie)) {
+            throw new IllegalArgumentException("The buffer does not contain a ByteBufferHistogram");
+        }
+        final ByteBufferHistogram histogram = new ByteBufferHistogram(null,
+                header.getLong(lowestDiscernibleValueOffset),
+                header.getLong(highestTrackableValueOffset),
+                header.getInt(numberOfSignificantValueDigitsOffset));
+        if (header.getInt(countsArrayLengthOffset) != histogram.countsArrayLength) {
+            throw new IllegalArgumentException("The buffer's counts array length does not match its header");
+        }
+        histogram.buffer = sliceOf(buffer, countOffset(histogram.countsArrayLength));
+        histogram.syncFromBuffer();
+        return histogram;
+    }
+
+    /**
+     * Create (or overwrite) a file of the needed size, and construct a ByteBufferHistogram whose header
+     * and counts are held in a read-write mapping of the file.
+     *
+     * @param file The file to hold the histogram's header and counts
+     * @param lowestDiscernibleValue The lowest value that can be tracked (distinguished from 0) by the histogram.
+     *                               Must be a positive integer that is {@literal >=} 1. May be internally rounded
+     *                               down to nearest power of 2.
+     * @param highestTrackableValue The highest value to be tracked by the histogram. Must be a positive
+     *                              integer that is {@literal >=} (2 * lowestDiscernibleValue).
+     * @param numberOfSignificantValueDigits Specifies the precision to use. This is the number of significant
+     *                                       decimal digits to which the histogram will maintain value resolution
+     *                                       and separation. Must be a non-negative integer between 0 and 5.
+     * @return A file-backed ByteBufferHistogram
+     * @throws IOException on failure to create or map the file
+     */
+    public static ByteBufferHistogram createFileBacked(final File file,
+                                                       final long lowestDiscernibleValue,
+                                                       final long highestTrackableValue,
+                                                       final int numberOfSignificantValueDigits) throws IOException {
+        final int capacity =
+                getNeededBufferCapacity(lowestDiscernibleValue, highestTrackableValue, numberOfSignificantValueDigits);
+        final RandomAccessFile raf = new RandomAccessFile(file, "rw");
+        try {
+            raf.setLength(capacity);
+            MappedByteBuffer mappedBuffer = raf.getChannel().map(FileChannel.MapMode.READ_WRITE, 0, capacity);
+            return new ByteBufferHistogram(lowestDiscernibleValue, highestTrackableValue,
+                    numberOfSignificantValueDigits, mappedBuffer);
+        } finally {
+            raf.close();
+        }
+    }
+
+    /**
+     * Construct a ByteBufferHistogram over a mapping of an existing file created with
+     * {@link #createFileBacked}. The file's contents are not modified by opening it.
+     *
+     * @param file The file holding the histogram's header and counts
+     * @param readOnly If true, the file is mapped read-only, and the returned histogram can only be queried
+     * @return A file-backed ByteBufferHistogram
+     * @throws IOException on failure to open or map the file
+     * @throws IllegalArgumentException if the file does not hold a ByteBufferHistogram
+     */
+    public static ByteBufferHistogram openFileBacked(final File file, final boolean readOnly) throws IOException {
+        final RandomAccessFile raf = new RandomAccessFile(file, readOnly ? "r" : "rw");
+        try {
+            MappedByteBuffer mappedBuffer = raf.getChannel().map(
+                    readOnly ? FileChannel.MapMode.READ_ONLY : FileChannel.MapMode.READ_WRITE, 0, raf.length());
+            return wrap(mappedBuffer);
+        } finally {
+            raf.close();
+        }
+    }
+
+    /**
+     * Get the number of bytes needed to hold the header and counts of a ByteBufferHistogram with the given
+     * settings.
+     *
+     * @param lowestDiscernibleValue The lowest value that can be tracked (distinguished from 0) by the histogram.
+     * @param highestTrackableValue The highest value to be tracked by the histogram.
+     * @param numberOfSignificantValueDigits Specifies the precision to use.
+     * @return the number of bytes needed
+     */
+    public static int getNeededBufferCapacity(final long lowestDiscernibleValue, final long highestTrackableValue,
+                                              final int numberOfSignificantValueDigits) {
+        verifyRangeArguments(lowestDiscernibleValue, highestTrackableValue, numberOfSignificantValueDigits);
+        return countOffset(HistogramLayout.forValueRange(
+                lowestDiscernibleValue, highestTrackableValue, numberOfSignificantValueDigits).countsArrayLength);
+    }
+
+    /**
+     * Re-establish this histogram's total count and min/max values from the counts currently held in its buffer.
+     * Useful when querying a buffer that is being recorded into by another histogram instance (e.g. in another
+     * process sharing a file-backed histogram).
+     */
+    public void syncFromBuffer() {
+        normalizingIndexOffset = buffer.getInt(normalizingIndexOffsetOffset);
+        nonConcurrentSetIntegerToDoubleValueConversionRatio(
+                buffer.getDouble(integerToDoubleValueConversionRatioOffset));
+        invalidateCachedStatistics();
+        establishInternalTackingValues();
+    }
+
+    private void writeHeader() {
+        buffer.putInt(cookieOffset, bufferCookie);
+        buffer.putInt(countsArrayLengthOffset, countsArrayLength);
+        buffer.putLong(lowestDiscernibleValueOffset, getLowestDiscernibleValue());
+        buffer.putLong(highestTrackableValueOffset, getHighestTrackableValue());
+        buffer.putInt(numberOfSignificantValueDigitsOffset, getNumberOfSignificantValueDigits());
+        buffer.putInt(normalizingIndexOffsetOffset, normalizingIndexOffset);
+        buffer.putDouble(integerToDoubleValueConversionRatioOffset, getIntegerToDoubleValueConversionRatio());
+    }
+
+    private static ByteBuffer allocateBuffer(final int countsArrayLength) {
+        return ByteBuffer.allocateDirect(countOffset(countsArrayLength)).order(ByteOrder.LITTLE_ENDIAN);
+    }
+
+    private static ByteBuffer sliceOf(final ByteBuffer buffer, final int neededCapacity) {
+        if (buffer.remaining() < neededCapacity) {
+            throw new IllegalArgumentException("The buffer has " + buffer.remaining() +
+                    " bytes remaining, and needs at least " + neededCapacity);
+        }
+        final ByteBuffer slice = buffer.slice();
+        slice.limit(neededCapacity);
+        return slice.order(ByteOrder.LITTLE_ENDIAN);
+    }
+
+    /**
+     * Construct a new histogram by decoding it from a ByteBuffer.
+     * @param buffer The buffer to decode from
+     * @param minBarForHighestTrackableValue Force highestTrackableValue to be set at least this high
+     * @return The newly constructed histogram
+     */
+    public static ByteBufferHistogram decodeFromByteBuffer(final ByteBuffer buffer,
+                                                           final long minBarForHighestTrackableValue) {
+        return decodeFromByteBuffer(buffer, ByteBufferHistogram.class, minBarForHighestTrackableValue);
+    }
+
+    /**
+     * Construct a new histogram by decoding it from a compressed form in a ByteBuffer.
+     * @param buffer The buffer to decode from
+     * @param minBarForHighestTrackableValue Force highestTrackableValue to be set at least this high
+     * @return The newly constructed histogram
+     * @throws DataFormatException on error parsing/decompressing the buffer
+     */
+    public static ByteBufferHistogram decodeFromCompressedByteBuffer(final ByteBuffer buffer,
+                                                                     final long minBarForHighestTrackableValue)
+            throws DataFormatException {
+        return decodeFromCompressedByteBuffer(buffer, ByteBufferHistogram.class, minBarForHighestTrackableValue);
+    }
+
+    private void writeObject(final ObjectOutputStream o)
+            throws IOException {
+        o.defaultWriteObject();
+        for (int i = 0; i < countsArrayLength; i++) {
+            o.writeLong(getCountAtNormalizedIndex(i));
+        }
+    }
+
+    private void readObject(final ObjectInputStream o)
+            throws IOException, ClassNotFoundException {
+        o.defaultReadObject();
+        // Deserialized histograms always hold their counts in a (newly allocated) direct buffer:
+        ownsBuffer = true;
+        buffer = allocateBuffer(countsArrayLength);
+        for (int i = 0; i < countsArrayLength; i++) {
+            setCountAtNormalizedIndex(i, o.readLong());
+        }
+        writeHeader();
+    }
+}
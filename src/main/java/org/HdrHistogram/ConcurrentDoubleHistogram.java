@@ -7,7 +7,11 @@
 
 package org.HdrHistogram;
 
+import java.io.IOException;
+import java.io.ObjectInputStream;
 import java.nio.ByteBuffer;
+import java.util.concurrent.ConcurrentLinkedQueue;
+import java.util.concurrent.atomic.AtomicIntegerFieldUpdater;
 import java.util.zip.DataFormatException;
 
 /**
@@ -52,11 +56,44 @@ import java.util.zip.DataFormatException;
  * due to overflow or underflow conditions. These exceptions will only be thrown if recording the value would have
  * resulted in discarding or losing the required value precision of values already recorded in the histogram.
  * <p>
+ * Auto-ranging adjustments do not block recording threads on a monitor: Recordings of values within the current
+ * range proceed concurrently with an adjustment, and a single recording thread at a time claims the adjustment.
+ * When auto-resizing, recordings of other out-of-range values that arrive while an adjustment is in progress are
+ * handed off to the adjusting thread, which records them (adjusting the range as needed) before it returns.
+ * Otherwise, such recordings wait for the in-progress adjustment to complete before making their own. Either way,
+ * a recording thread waits (spinning, not parking) until its value has been recorded, and any resulting
+ * {@link ArrayIndexOutOfBoundsException} is thrown to the recording thread.
+ * <p>
  * See package description for {@link org.HdrHistogram} for details.
  */
 
 public class ConcurrentDoubleHistogram extends DoubleHistogram {
 
+    private transient volatile int rangeAdjustmentInProgress;
+    private transient ConcurrentLinkedQueue<PendingRecording> pendingRecordings =
+            new ConcurrentLinkedQueue<PendingRecording>();
+
+    private static final AtomicIntegerFieldUpdater<ConcurrentDoubleHistogram> rangeAdjustmentInProgressUpdater =
+            AtomicIntegerFieldUpdater.newUpdater(ConcurrentDoubleHistogram.class, "rangeAdjustmentInProgress");
+
+    private static final class PendingRecording {
+        final double value;
+        final long count;
+        // Set (by the thread that took the recording over) before completed is:
+        RuntimeException failure;
+        volatile boolean completed;
+
+        PendingRecording(final double value, final long count) {
+            this.value = value;
+            this.count = count;
+        }
+
+        void complete(final RuntimeException failure) {
+            this.failure = failure;
+            completed = true;
+        }
+    }
+
     /**
      * Construct a new auto-resizing DoubleHistogram using a precision stated as a number of significant decimal
      * digits.
@@ -110,6 +147,101 @@ public class ConcurrentDoubleHistogram extends DoubleHistogram {
         );
     }
 
+    @Override
+    boolean autoAdjustRangeForValue(final double value, final long count) {
+        // Zero is always valid, and doesn't need auto-range adjustment:
+        if (value == 0.0) {
+            return true;
+        }
+        if ((value < 0.0) || (value > highestAllowedValueEver)) {
+            // Never recordable. This will throw without changing the range:
+            adjustRangeForValue(value);
+        }
+        while (!tryClaimRangeAdjustment()) {
+            if (isAutoResize()) {
+                // Hand the recording off to the adjusting thread (or to whichever thread claims the next
+                // adjustment), and wait for it to be recorded:
+                final PendingRecording recording = new PendingRecording(value, count);
+                pendingRecordings.add(recording);
+                awaitPendingRecording(recording);
+                return false;
+            }
+            Thread.yield();
+        }
+        try {
+            adjustRangeForValue(value);
+        } finally {
+            completeRangeAdjustment();
+        }
+        return true;
+    }
+
+    private boolean tryClaimRangeAdjustment() {
+        return rangeAdjustmentInProgressUpdater.compareAndSet(this, 0, 1);
+    }
+
+    /**
+     * Wait for a handed off recording to complete, claiming and completing the range adjustment in this thread if
+     * no other thread is (e.g. when the adjustment completed before the recording was queued). A failure to record
+     * the value is thrown to this (the recording) thread.
+     */
+    private void awaitPendingRecording(final PendingRecording recording) {
+        while (!recording.completed) {
+            if (tryClaimRangeAdjustment()) {
+                completeRangeAdjustment();
+            } else {
+                Thread.yield();
+            }
+        }
+        if (recording.failure != null) {
+            throw recording.failure;
+        }
+    }
+
+    /**
+     * Record any handed off recordings and release the range adjustment claim. A failure to record a handed off
+     * value is passed back to the thread that handed it off, and does not stop the remaining ones from being
+     * recorded. Recordings handed off after the queue was last drained are either picked up by re-claiming the
+     * adjustment here, or by their own (waiting) thread.
+     */
+    private void completeRangeAdjustment() {
+        do {
+            try {
+                PendingRecording recording;
+                while ((recording = pendingRecordings.poll()) != null) {
+                    try {
+                        adjustRangeForValue(recording.value);
+                        integerValuesHistogram.recordConvertedDoubleValueWithCount(recording.value,
+                                recording.count);
+                    } catch (RuntimeException ex) {
+                        recording.complete(ex);
+                        continue;
+                    }
+                    recording.complete(null);
+                }
+            } finally {
+                rangeAdjustmentInProgress = 0;
+            }
+        } while (!pendingRecordings.isEmpty() && tryClaimRangeAdjustment());
+    }
+
+    @Override
+    public void reset() {
+        // Handed off recordings that are still queued are discarded along with the rest of the contents (and
+        // their threads released):
+        PendingRecording recording;
+        while ((recording = pendingRecordings.poll()) != null) {
+            recording.complete(null);
+        }
+        super.reset();
+    }
+
+    private void readObject(final ObjectInputStream o)
+            throws IOException, ClassNotFoundException {
+        o.defaultReadObject();
+        pendingRecordings = new ConcurrentLinkedQueue<PendingRecording>();
+    }
+
     /**
      * Construct a new ConcurrentDoubleHistogram by decoding it from a ByteBuffer.
      * @param buffer The buffer to decode from
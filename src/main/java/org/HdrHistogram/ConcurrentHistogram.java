@@ -9,6 +9,7 @@ package org.HdrHistogram;
 
 import java.io.IOException;
 import java.io.ObjectInputStream;
+import java.io.PrintStream;
 import java.nio.ByteBuffer;
 import java.util.concurrent.atomic.AtomicLongArray;
 import java.util.concurrent.atomic.AtomicLongFieldUpdater;
@@ -29,6 +30,13 @@ import java.util.zip.DataFormatException;
  * use the {@link SynchronizedHistogram} variant, or (recommended) use {@link Recorder} or
  * {@link SingleWriterRecorder} which are intended for this purpose.
  * <p>
+ * Queries (percentiles, mean and standard deviation, counts between values, iteration, percentile output) and
+ * additions of a ConcurrentHistogram's contents to other histograms are run against a snapshot of its contents,
+ * captured under a single critical section for (and dropped after) each query. When queried while recording is in
+ * progress, a snapshot will include some subset of the concurrently recorded values, and will be internally
+ * consistent (e.g. its percentiles will agree with its total count). Callers making several queries of the same
+ * contents should take a {@link #snapshot()} once, and query it instead.
+ * <p>
  * Auto-resizing: When constructed with no specified value range range (or when auto-resize is turned on with {@link
  * Histogram#setAutoResize}) a {@link Histogram} will auto-resize its dynamic range to include recorded values as
  * they are encountered. Note that recording calls that cause auto-resizing may take longer to execute, as resizing
@@ -42,7 +50,14 @@ public class ConcurrentHistogram extends Histogram {
 
     static final AtomicLongFieldUpdater<ConcurrentHistogram> totalCountUpdater =
             AtomicLongFieldUpdater.newUpdater(ConcurrentHistogram.class, "totalCount");
+
+    // Padded on both sides, to keep the totalCount updates made by every recording from false-sharing with the
+    // read-mostly fields used in the recording path (see the matching AtomicHistogram layout comment):
+    private transient long prePad0, prePad1, prePad2, prePad3, prePad4, prePad5, prePad6, prePad7;
+    private transient long prePad8, prePad9, prePad10, prePad11, prePad12, prePad13, prePad14, prePad15;
     volatile long totalCount;
+    private transient long postPad0, postPad1, postPad2, postPad3, postPad4, postPad5, postPad6, postPad7;
+    private transient long postPad8, postPad9, postPad10, postPad11, postPad12, postPad13, postPad14, postPad15;
 
     volatile ConcurrentArrayWithNormalizingOffset activeCounts;
     volatile ConcurrentArrayWithNormalizingOffset inactiveCounts;
@@ -110,6 +125,23 @@ public class ConcurrentHistogram extends Histogram {
         }
     }
 
+    @Override
+    void copyCountsInto(final long[] targetCounts, final int length) {
+        try {
+            wrp.readerLock();
+            assert (countsArrayLength == activeCounts.length());
+            assert (countsArrayLength == inactiveCounts.length());
+            final int activeOffset = activeCounts.getNormalizingIndexOffset();
+            final int inactiveOffset = inactiveCounts.getNormalizingIndexOffset();
+            for (int i = 0; i < length; i++) {
+                targetCounts[i] = activeCounts.get(normalizeIndex(i, activeOffset, countsArrayLength)) +
+                        inactiveCounts.get(normalizeIndex(i, inactiveOffset, countsArrayLength));
+            }
+        } finally {
+            wrp.readerUnlock();
+        }
+    }
+
     @Override
     void incrementCountAtIndex(final int index) {
         long criticalValue = wrp.writerCriticalSectionEnter();
@@ -192,6 +224,12 @@ public class ConcurrentHistogram extends Histogram {
         }
     }
 
+    @Override
+    boolean countsArrayIsPlain() {
+        // Counts are updated atomically, in active and inactive counts arrays:
+        return false;
+    }
+
     @Override
     int getNormalizingIndexOffset() {
         return activeCounts.getNormalizingIndexOffset();
@@ -431,6 +469,14 @@ public class ConcurrentHistogram extends Histogram {
         this.autoResize = true;
     }
 
+    @Override
+    public void setLazyCountsAllocation(final boolean lazyCountsAllocation) {
+        if (lazyCountsAllocation) {
+            throw new IllegalStateException(
+                    getClass().getSimpleName() + " does not support lazy counts allocation.");
+        }
+    }
+
     @Override
     void clearCounts() {
         try {
@@ -603,6 +649,104 @@ public class ConcurrentHistogram extends Histogram {
                 0);
     }
 
+    /**
+     * Take a read-only snapshot of the current contents of this histogram.
+     * <p>
+     * The snapshot is captured under a single critical section, and is consistent with respect to any
+     * concurrent auto-resizing and value shifting operations. Values that are recorded concurrently with the
+     * capture may or may not be included in it, but the snapshot's total count, min and max values are always
+     * derived from (and consistent with) its own counts.
+     *
+     * @return a read-only snapshot of this histogram's contents
+     */
+    public FrozenHistogram snapshot() {
+        try {
+            wrp.readerLock();
+            return new FrozenHistogram(this);
+        } finally {
+            wrp.readerUnlock();
+        }
+    }
+
+    @Override
+    AbstractHistogram getQueryHistogram() {
+        try {
+            wrp.readerLock();
+            // A single query does not pay for building a cumulative count index (which snapshot() builds):
+            return new FrozenHistogram(this, false);
+        } finally {
+            wrp.readerUnlock();
+        }
+    }
+
+    // Queries are answered by a snapshot taken for (and private to) each query:
+
+    @Override
+    public double getMean() {
+        return getQueryHistogram().getMean();
+    }
+
+    @Override
+    public double getStdDeviation() {
+        return getQueryHistogram().getStdDeviation();
+    }
+
+    @Override
+    public long getValueAtPercentile(final double percentile) {
+        return getQueryHistogram().getValueAtPercentile(percentile);
+    }
+
+    @Override
+    public void getValuesAtPercentiles(final double[] percentiles, final long[] valuesAtPercentiles) {
+        getQueryHistogram().getValuesAtPercentiles(percentiles, valuesAtPercentiles);
+    }
+
+    @Override
+    public double getPercentileAtOrBelowValue(final long value) {
+        return getQueryHistogram().getPercentileAtOrBelowValue(value);
+    }
+
+    @Override
+    public long getCountBetweenValues(final long lowValue, final long highValue)
+            throws ArrayIndexOutOfBoundsException {
+        return getQueryHistogram().getCountBetweenValues(lowValue, highValue);
+    }
+
+    @Override
+    public Percentiles percentiles(final int percentileTicksPerHalfDistance) {
+        return getQueryHistogram().percentiles(percentileTicksPerHalfDistance);
+    }
+
+    @Override
+    public LinearBucketValues linearBucketValues(final long valueUnitsPerBucket) {
+        return getQueryHistogram().linearBucketValues(valueUnitsPerBucket);
+    }
+
+    @Override
+    public LogarithmicBucketValues logarithmicBucketValues(final long valueUnitsInFirstBucket, final double logBase) {
+        return getQueryHistogram().logarithmicBucketValues(valueUnitsInFirstBucket, logBase);
+    }
+
+    @Override
+    public RecordedValues recordedValues() {
+        return getQueryHistogram().recordedValues();
+    }
+
+    @Override
+    public AllValues allValues() {
+        return getQueryHistogram().allValues();
+    }
+
+    @Override
+    public void outputPercentileDistribution(final PrintStream printStream,
+                                             final int percentileTicksPerHalfDistance,
+                                             final Double outputValueUnitScalingRatio,
+                                             final boolean useCsvFormat) {
+        // Output from a private snapshot, so that the output does not need to hold the readerLock:
+        snapshot().outputPercentileDistribution(printStream, percentileTicksPerHalfDistance,
+                outputValueUnitScalingRatio, useCsvFormat);
+    }
+
     private void readObject(final ObjectInputStream o)
             throws IOException, ClassNotFoundException {
         o.defaultReadObject();
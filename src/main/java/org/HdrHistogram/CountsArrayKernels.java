@@ -0,0 +1,335 @@
+/**
+ * Written by Gil Tene of Azul Systems, and released to the public domain,
+ * as explained at http://creativecommons.org/publicdomain/zero/1.0/
+ *
+ * @author Gil Tene
+ */
+
+package org.HdrHistogram;
+
+/**
+ * Element-wise add and subtract kernels over the backing counts arrays (long[], int[] or short[]) of
+ * histograms that share the same shape (bucket count, sub-bucket count, unit magnitude) and have a zero
+ * normalizing index offset, such that equal array indexes carry the same meaning in both arrays.
+ * <p>
+ * The kernels are plain, branch-light loops over a [fromIndex, toIndex] (inclusive) index range, which the JIT
+ * compiler can unroll and (for the non-narrowing pairs) vectorize. Narrowing kernels (into int[] or short[]
+ * counts) check for overflow, and throw the same {@link IllegalStateException} the histograms' own count
+ * updates do.
+ */
+final class CountsArrayKernels {
+
+    private CountsArrayKernels() {
+    }
+
+    /**
+     * Add the counts in fromCounts[fromIndex..toIndex] to the counts in toCounts[fromIndex..toIndex].
+     *
+     * @return the sum of the counts added
+     */
+    static long add(final Object toCounts, final Object fromCounts, final int fromIndex, final int toIndex) {
+        if (toCounts instanceof long[]) {
+            final long[] to = (long[]) toCounts;
+            if (fromCounts instanceof long[]) {
+                return add(to, (long[]) fromCounts, fromIndex, toIndex);
+            } else if (fromCounts instanceof int[]) {
+                return add(to, (int[]) fromCounts, fromIndex, toIndex);
+            } else {
+                return add(to, (short[]) fromCounts, fromIndex, toIndex);
+            }
+        } else if (toCounts instanceof int[]) {
+            final int[] to = (int[]) toCounts;
+            if (fromCounts instanceof long[]) {
+                return add(to, (long[]) fromCounts, fromIndex, toIndex);
+            } else if (fromCounts instanceof int[]) {
+                return add(to, (int[]) fromCounts, fromIndex, toIndex);
+            } else {
+                return add(to, (short[]) fromCounts, fromIndex, toIndex);
+            }
+        } else {
+            final short[] to = (short[]) toCounts;
+            if (fromCounts instanceof long[]) {
+                return add(to, (long[]) fromCounts, fromIndex, toIndex);
+            } else if (fromCounts instanceof int[]) {
+                return add(to, (int[]) fromCounts, fromIndex, toIndex);
+            } else {
+                return add(to, (short[]) fromCounts, fromIndex, toIndex);
+            }
+        }
+    }
+
+    /**
+     * Find the first index in [fromIndex, toIndex] at which the count in fromCounts is larger than the count in
+     * toCounts (i.e. at which subtracting fromCounts from toCounts would result in a negative count).
+     *
+     * @return the first such index, or -1 if there is none
+     */
+    static int indexOfLargerCount(final Object toCounts, final Object fromCounts,
+                                  final int fromIndex, final int toIndex) {
+        for (int i = fromIndex; i <= toIndex; i++) {
+            if (countAt(toCounts, i) < countAt(fromCounts, i)) {
+                return i;
+            }
+        }
+        return -1;
+    }
+
+    /**
+     * Subtract the counts in fromCounts[fromIndex..toIndex] from the counts in toCounts[fromIndex..toIndex].
+     * Callers are expected to have verified (with {@link #indexOfLargerCount}) that no count will go negative.
+     *
+     * @return the sum of the counts subtracted
+     */
+    static long subtract(final Object toCounts, final Object fromCounts, final int fromIndex, final int toIndex) {
+        if (toCounts instanceof long[]) {
+            final long[] to = (long[]) toCounts;
+            if (fromCounts instanceof long[]) {
+                return subtract(to, (long[]) fromCounts, fromIndex, toIndex);
+            } else if (fromCounts instanceof int[]) {
+                return subtract(to, (int[]) fromCounts, fromIndex, toIndex);
+            } else {
+                return subtract(to, (short[]) fromCounts, fromIndex, toIndex);
+            }
+        } else if (toCounts instanceof int[]) {
+            final int[] to = (int[]) toCounts;
+            if (fromCounts instanceof long[]) {
+                return subtract(to, (long[]) fromCounts, fromIndex, toIndex);
+            } else if (fromCounts instanceof int[]) {
+                return subtract(to, (int[]) fromCounts, fromIndex, toIndex);
+            } else {
+                return subtract(to, (short[]) fromCounts, fromIndex, toIndex);
+            }
+        } else {
+            final short[] to = (short[]) toCounts;
+            if (fromCounts instanceof long[]) {
+                return subtract(to, (long[]) fromCounts, fromIndex, toIndex);
+            } else if (fromCounts instanceof int[]) {
+                return subtract(to, (int[]) fromCounts, fromIndex, toIndex);
+            } else {
+                return subtract(to, (short[]) fromCounts, fromIndex, toIndex);
+            }
+        }
+    }
+
+    private static long countAt(final Object counts, final int index) {
+        if (counts instanceof long[]) {
+            return ((long[]) counts)[index];
+        } else if (counts instanceof int[]) {
+            return ((int[]) counts)[index];
+        } else {
+            return ((short[]) counts)[index];
+        }
+    }
+
+    //
+    // Add kernels:
+    //
+
+    private static long add(final long[] to, final long[] from, final int fromIndex, final int toIndex) {
+        long sum = 0;
+        for (int i = fromIndex; i <= toIndex; i++) {
+            final long count = from[i];
+            to[i] += count;
+            sum += count;
+        }
+        return sum;
+    }
+
+    private static long add(final long[] to, final int[] from, final int fromIndex, final int toIndex) {
+        long sum = 0;
+        for (int i = fromIndex; i <= toIndex; i++) {
+            final long count = from[i];
+            to[i] += count;
+            sum += count;
+        }
+        return sum;
+    }
+
+    private static long add(final long[] to, final short[] from, final int fromIndex, final int toIndex) {
+        long sum = 0;
+        for (int i = fromIndex; i <= toIndex; i++) {
+            final long count = from[i];
+            to[i] += count;
+            sum += count;
+        }
+        return sum;
+    }
+
+    private static long add(final int[] to, final long[] from, final int fromIndex, final int toIndex) {
+        long sum = 0;
+        for (int i = fromIndex; i <= toIndex; i++) {
+            final long count = from[i];
+            final long newCount = to[i] + count;
+            if (newCount > Integer.MAX_VALUE) {
+                throw new IllegalStateException("would overflow integer count");
+            }
+            to[i] = (int) newCount;
+            sum += count;
+        }
+        return sum;
+    }
+
+    private static long add(final int[] to, final int[] from, final int fromIndex, final int toIndex) {
+        long sum = 0;
+        for (int i = fromIndex; i <= toIndex; i++) {
+            final long count = from[i];
+            final long newCount = to[i] + count;
+            if (newCount > Integer.MAX_VALUE) {
+                throw new IllegalStateException("would overflow integer count");
+            }
+            to[i] = (int) newCount;
+            sum += count;
+        }
+        return sum;
+    }
+
+    private static long add(final int[] to, final short[] from, final int fromIndex, final int toIndex) {
+        long sum = 0;
+        for (int i = fromIndex; i <= toIndex; i++) {
+            final long count = from[i];
+            final long newCount = to[i] + count;
+            if (newCount > Integer.MAX_VALUE) {
+                throw new IllegalStateException("would overflow integer count");
+            }
+            to[i] = (int) newCount;
+            sum += count;
+        }
+        return sum;
+    }
+
+    private static long add(final short[] to, final long[] from, final int fromIndex, final int toIndex) {
+        long sum = 0;
+        for (int i = fromIndex; i <= toIndex; i++) {
+            final long count = from[i];
+            final long newCount = to[i] + count;
+            if (newCount > Short.MAX_VALUE) {
+                throw new IllegalStateException("would overflow short integer count");
+            }
+            to[i] = (short) newCount;
+            sum += count;
+        }
+        return sum;
+    }
+
+    private static long add(final short[] to, final int[] from, final int fromIndex, final int toIndex) {
+        long sum = 0;
+        for (int i = fromIndex; i <= toIndex; i++) {
+            final long count = from[i];
+            final long newCount = to[i] + count;
+            if (newCount > Short.MAX_VALUE) {
+                throw new IllegalStateException("would overflow short integer count");
+            }
+            to[i] = (short) newCount;
+            sum += count;
+        }
+        return sum;
+    }
+
+    private static long add(final short[] to, final short[] from, final int fromIndex, final int toIndex) {
+        long sum = 0;
+        for (int i = fromIndex; i <= toIndex; i++) {
+            final long count = from[i];
+            final long newCount = to[i] + count;
+            if (newCount > Short.MAX_VALUE) {
+                throw new IllegalStateException("would overflow short integer count");
+            }
+            to[i] = (short) newCount;
+            sum += count;
+        }
+        return sum;
+    }
+
+    //
+    // Subtract kernels (counts are known not to go negative, so no narrowing checks are needed):
+    //
+
+    private static long subtract(final long[] to, final long[] from, final int fromIndex, final int toIndex) {
+        long sum = 0;
+        for (int i = fromIndex; i <= toIndex; i++) {
+            final long count = from[i];
+            to[i] -= count;
+            sum += count;
+        }
+        return sum;
+    }
+
+    private static long subtract(final long[] to, final int[] from, final int fromIndex, final int toIndex) {
+        long sum = 0;
+        for (int i = fromIndex; i <= toIndex; i++) {
+            final long count = from[i];
+            to[i] -= count;
+            sum += count;
+        }
+        return sum;
+    }
+
+    private static long subtract(final long[] to, final short[] from, final int fromIndex, final int toIndex) {
+        long sum = 0;
+        for (int i = fromIndex; i <= toIndex; i++) {
+            final long count = from[i];
+            to[i] -= count;
+            sum += count;
+        }
+        return sum;
+    }
+
+    private static long subtract(final int[] to, final long[] from, final int fromIndex, final int toIndex) {
+        long sum = 0;
+        for (int i = fromIndex; i <= toIndex; i++) {
+            final long count = from[i];
+            to[i] = (int) (to[i] - count);
+            sum += count;
+        }
+        return sum;
+    }
+
+    private static long subtract(final int[] to, final int[] from, final int fromIndex, final int toIndex) {
+        long sum = 0;
+        for (int i = fromIndex; i <= toIndex; i++) {
+            final int count = from[i];
+            to[i] -= count;
+            sum += count;
+        }
+        return sum;
+    }
+
+    private static long subtract(final int[] to, final short[] from, final int fromIndex, final int toIndex) {
+        long sum = 0;
+        for (int i = fromIndex; i <= toIndex; i++) {
+            final int count = from[i];
+            to[i] -= count;
+            sum += count;
+        }
+        return sum;
+    }
+
+    private static long subtract(final short[] to, final long[] from, final int fromIndex, final int toIndex) {
+        long sum = 0;
+        for (int i = fromIndex; i <= toIndex; i++) {
+            final long count = from[i];
+            to[i] = (short) (to[i] - count);
+            sum += count;
+        }
+        return sum;
+    }
+
+    private static long subtract(final short[] to, final int[] from, final int fromIndex, final int toIndex) {
+        long sum = 0;
+        for (int i = fromIndex; i <= toIndex; i++) {
+            final int count = from[i];
+            to[i] = (short) (to[i] - count);
+            sum += count;
+        }
+        return sum;
+    }
+
+    private static long subtract(final short[] to, final short[] from, final int fromIndex, final int toIndex) {
+        long sum = 0;
+        for (int i = fromIndex; i <= toIndex; i++) {
+            final short count = from[i];
+            to[i] = (short) (to[i] - count);
+            sum += count;
+        }
+        return sum;
+    }
+}
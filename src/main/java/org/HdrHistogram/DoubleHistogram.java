@@ -51,7 +51,7 @@ import java.util.zip.Deflater;
  * See package description for {@link org.HdrHistogram} for details.
  */
 public class DoubleHistogram extends EncodableHistogram implements DoubleValueRecorder, Serializable {
-    private static final double highestAllowedValueEver; // A value that will keep us from multiplying into infinity.
+    static final double highestAllowedValueEver; // A value that will keep us from multiplying into infinity.
 
     private long configuredHighestToLowestValueRatio;
 
@@ -65,6 +65,17 @@ public class DoubleHistogram extends EncodableHistogram implements DoubleValueRe
 
     private boolean autoResize = false;
 
+    // Recording fast path state: A plain (non-volatile) snapshot of the covered range and conversion ratio, taken
+    // on the recording slow path, and valid for as long as rangeVersion (advanced on every range change) matches
+    // fastPathRangeVersion. Only established for internal histograms that are not recorded into concurrently,
+    // and whose conversion ratio is a power of two (which it is, unless derived from an external source):
+    private transient int rangeVersion;
+    private transient int fastPathRangeVersion;
+    private transient double fastPathLowestValueInAutoRange;
+    private transient double fastPathHighestValueLimitInAutoRange;
+    private transient double fastPathDoubleToIntegerValueConversionRatio;
+    private transient int fastPathConversionRatioExponent;
+
     /**
      * Construct a new auto-resizing DoubleHistogram using a precision stated as a number
      * of significant decimal digits.
@@ -246,6 +257,7 @@ public class DoubleHistogram extends EncodableHistogram implements DoubleValueRe
     }
 
     private void setTrackableValueRange(final double lowestValueInAutoRange, final double highestValueInAutoRange) {
+        rangeVersion++;
         this.currentLowestValueInAutoRange = lowestValueInAutoRange;
         this.currentHighestValueLimitInAutoRange = highestValueInAutoRange;
         double integerToDoubleValueConversionRatio = lowestValueInAutoRange / getLowestTrackingIntegerValue();
@@ -270,6 +282,23 @@ public class DoubleHistogram extends EncodableHistogram implements DoubleValueRe
         this.autoResize = autoResize;
     }
 
+    /**
+     * Indicate whether or not the histogram maintains a cumulative count index for percentile queries
+     * @return cumulative count indexing setting
+     */
+    public boolean isCumulativeCountIndexing() {
+        return integerValuesHistogram.isCumulativeCountIndexing();
+    }
+
+    /**
+     * Control whether or not the histogram maintains a cumulative count (prefix sum) index for percentile
+     * queries. See {@link AbstractHistogram#setCumulativeCountIndexing} for details.
+     * @param cumulativeCountIndexing cumulative count indexing setting
+     */
+    public void setCumulativeCountIndexing(boolean cumulativeCountIndexing) {
+        integerValuesHistogram.setCumulativeCountIndexing(cumulativeCountIndexing);
+    }
+
     //
     //
     //
@@ -334,7 +363,10 @@ public class DoubleHistogram extends EncodableHistogram implements DoubleValueRe
             if ((value < currentLowestValueInAutoRange) || (value >= currentHighestValueLimitInAutoRange)) {
                 // Zero is valid and needs no auto-ranging, but also rare enough that we should deal
                 // with it on the slow path...
-                autoAdjustRangeForValue(value);
+                if (!autoAdjustRangeForValue(value, count)) {
+                    // The recording was handed off to a concurrent range adjustment:
+                    return;
+                }
             }
             try {
                 integerValuesHistogram.recordConvertedDoubleValueWithCount(value, count);
@@ -356,12 +388,48 @@ public class DoubleHistogram extends EncodableHistogram implements DoubleValueRe
     }
 
     private void recordSingleValue(final double value) throws ArrayIndexOutOfBoundsException {
+        if ((fastPathRangeVersion == rangeVersion) &&
+                (value >= fastPathLowestValueInAutoRange) && (value < fastPathHighestValueLimitInAutoRange) &&
+                integerValuesHistogram.recordConvertedDoubleValueWithPowerOfTwoRatio(value,
+                        fastPathDoubleToIntegerValueConversionRatio, fastPathConversionRatioExponent)) {
+            return;
+        }
+        recordSingleValueSlowPath(value);
+        establishRecordingFastPath();
+    }
+
+    private void establishRecordingFastPath() {
+        final Class<?> internalHistogramClass = integerValuesHistogram.getClass();
+        if ((internalHistogramClass != Histogram.class) &&
+                (internalHistogramClass != IntCountsHistogram.class) &&
+                (internalHistogramClass != ShortCountsHistogram.class) &&
+                (internalHistogramClass != PackedHistogram.class)) {
+            return;
+        }
+        final double ratio = integerValuesHistogram.getDoubleToIntegerValueConversionRatio();
+        final int ratioExponent = Math.getExponent(ratio);
+        // (Values must also be normal, for their exponent bits to hold their binary order of magnitude)
+        if ((ratio != Math.scalb(1.0, ratioExponent)) || (ratioExponent < Double.MIN_EXPONENT) ||
+                (currentLowestValueInAutoRange < Double.MIN_NORMAL)) {
+            return;
+        }
+        fastPathLowestValueInAutoRange = currentLowestValueInAutoRange;
+        fastPathHighestValueLimitInAutoRange = currentHighestValueLimitInAutoRange;
+        fastPathDoubleToIntegerValueConversionRatio = ratio;
+        fastPathConversionRatioExponent = ratioExponent;
+        fastPathRangeVersion = rangeVersion;
+    }
+
+    private void recordSingleValueSlowPath(final double value) throws ArrayIndexOutOfBoundsException {
         int throwCount = 0;
         while (true) {
             if ((value < currentLowestValueInAutoRange) || (value >= currentHighestValueLimitInAutoRange)) {
                 // Zero is valid and needs no auto-ranging, but also rare enough that we should deal
                 // with it on the slow path...
-                autoAdjustRangeForValue(value);
+                if (!autoAdjustRangeForValue(value, 1)) {
+                    // The recording was handed off to a concurrent range adjustment:
+                    return;
+                }
             }
             try {
                 integerValuesHistogram.recordConvertedDoubleValue(value);
@@ -403,15 +471,31 @@ public class DoubleHistogram extends EncodableHistogram implements DoubleValueRe
     //
     //
 
-    private void autoAdjustRangeForValue(final double value) {
+    /**
+     * Adjust the covered range (if needed) such that it includes the given value, ahead of recording count
+     * occurrences of the value. Subclasses may override this to coordinate concurrent adjustments differently,
+     * including by taking over the recording itself.
+     *
+     * @return true if the caller should go on to record the value, or false if the recording was handed off
+     */
+    boolean autoAdjustRangeForValue(final double value, final long count) {
         // Zero is always valid, and doesn't need auto-range adjustment:
         if (value == 0.0) {
-            return;
+            return true;
         }
         autoAdjustRangeForValueSlowPath(value);
+        return true;
     }
 
     private synchronized void autoAdjustRangeForValueSlowPath(final double value) {
+        adjustRangeForValue(value);
+    }
+
+    /**
+     * Shift (or resize) the covered range to include the given value. Callers must ensure that no other range
+     * adjustment runs concurrently.
+     */
+    final void adjustRangeForValue(final double value) {
         try {
             if (value < currentLowestValueInAutoRange) {
                 if (value < 0.0) {
@@ -468,7 +552,7 @@ public class DoubleHistogram extends EncodableHistogram implements DoubleValueRe
 
             // First, temporarily change the highest value in auto-range without changing conversion ratios.
             // This is done to force new values higher than the new expected highest value to attempt an
-            // adjustment (which is synchronized and will wait behind this one). This ensures that we will
+            // adjustment (which will wait behind, or be handed off to, this one). This ensures that we will
             // not end up with any concurrently recorded values that would need to be discarded if the shift
             // fails. If this shift succeeds, the pending adjustment attempt will end up doing nothing.
             currentHighestValueLimitInAutoRange *= shiftMultiplier;
@@ -531,7 +615,7 @@ public class DoubleHistogram extends EncodableHistogram implements DoubleValueRe
 
             // First, temporarily change the lowest value in auto-range without changing conversion ratios.
             // This is done to force new values lower than the new expected lowest value to attempt an
-            // adjustment (which is synchronized and will wait behind this one). This ensures that we will
+            // adjustment (which will wait behind, or be handed off to, this one). This ensures that we will
             // not end up with any concurrently recorded values that would need to be discarded if the shift
             // fails. If this shift succeeds, the pending adjustment attempt will end up doing nothing.
             currentLowestValueInAutoRange *= shiftMultiplier;
@@ -1109,6 +1193,27 @@ public class DoubleHistogram extends EncodableHistogram implements DoubleValueRe
         return integerValuesHistogram.getValueAtPercentile(percentile) * getIntegerToDoubleValueConversionRatio();
     }
 
+    /**
+     * Get the values at a set of given percentiles.
+     * <p>
+     * Equivalent to calling {@link #getValueAtPercentile} for each of the given percentiles, but resolves all of
+     * them in a single forward pass over the histogram's counts, and writes the results into a caller-supplied
+     * array. No allocation is performed when the percentiles are supplied in ascending order.
+     *
+     * @param percentiles The percentiles for which to return the associated values
+     * @param valuesAtPercentiles The array into which to write the results. valuesAtPercentiles[i] will hold
+     *                            the value at percentiles[i]. Must be at least as long as percentiles.
+     * @throws IllegalArgumentException if valuesAtPercentiles is shorter than percentiles
+     */
+    public void getValuesAtPercentiles(final double[] percentiles, final double[] valuesAtPercentiles) {
+        if (valuesAtPercentiles.length < percentiles.length) {
+            throw new IllegalArgumentException("valuesAtPercentiles array (length " + valuesAtPercentiles.length +
+                    ") is shorter than the percentiles array (length " + percentiles.length + ")");
+        }
+        integerValuesHistogram.resolveValuesAtPercentiles(percentiles, null, valuesAtPercentiles,
+                getIntegerToDoubleValueConversionRatio());
+    }
+
     /**
      * Get the percentile at a given value.
      * The percentile returned is the percentile of values recorded in the histogram that are smaller
@@ -1504,6 +1609,22 @@ public class DoubleHistogram extends EncodableHistogram implements DoubleValueRe
         return integerValuesHistogram.encodeIntoCompressedByteBuffer(targetBuffer, compressionLevel) + 16;
     }
 
+    /**
+     * Encode this histogram in compressed form into a byte array, using a given compression codec
+     * @param targetBuffer The buffer to encode into
+     * @param codec The compression codec to use (see {@link HistogramCompressionCodec})
+     * @return The number of bytes written to the buffer
+     */
+    @Override
+    synchronized public int encodeIntoCompressedByteBuffer(
+            final ByteBuffer targetBuffer,
+            final HistogramCompressionCodec codec) {
+        targetBuffer.putInt(DHIST_compressedEncodingCookie);
+        targetBuffer.putInt(getNumberOfSignificantValueDigits());
+        targetBuffer.putLong(configuredHighestToLowestValueRatio);
+        return integerValuesHistogram.encodeIntoCompressedByteBuffer(targetBuffer, codec) + 16;
+    }
+
     /**
      * Encode this histogram in compressed form into a byte array
      * @param targetBuffer The buffer to encode into
@@ -42,7 +42,7 @@ public class DoubleRecorder implements DoubleValueRecorder, IntervalHistogramPro
     private static AtomicLong instanceIdSequencer = new AtomicLong(1);
     private final long instanceId = instanceIdSequencer.getAndIncrement();
 
-    private final WriterReaderPhaser recordingPhaser = new WriterReaderPhaser();
+    private final WriterReaderPhaser recordingPhaser;
 
     private volatile ConcurrentDoubleHistogram activeHistogram;
     private ConcurrentDoubleHistogram inactiveHistogram;
@@ -64,6 +64,23 @@ public class DoubleRecorder implements DoubleValueRecorder, IntervalHistogramPro
      * @param packed Specifies whether the recorder will uses a packed internal representation or not.
      */
     public DoubleRecorder(final int numberOfSignificantValueDigits, boolean packed) {
+        this(numberOfSignificantValueDigits, packed, false);
+    }
+
+    /**
+     * Construct an auto-resizing {@link DoubleRecorder} using a precision stated as a number
+     * of significant decimal digits.
+     *
+     * @param numberOfSignificantValueDigits Specifies the precision to use. This is the number of significant
+     *                                       decimal digits to which the histogram will maintain value resolution
+     *                                       and separation. Must be a non-negative integer between 0 and 5.
+     * @param packed Specifies whether the recorder will uses a packed internal representation or not.
+     * @param stripedPhaser Specifies whether the recorder coordinates recording with interval sampling using a
+     *                      {@link StripedWriterReaderPhaser} (which scales better with many concurrently recording
+     *                      threads) rather than a {@link WriterReaderPhaser}.
+     */
+    public DoubleRecorder(final int numberOfSignificantValueDigits, boolean packed, boolean stripedPhaser) {
+        recordingPhaser = stripedPhaser ? new StripedWriterReaderPhaser() : new WriterReaderPhaser();
         activeHistogram = packed ?
                 new PackedInternalConcurrentDoubleHistogram(instanceId, numberOfSignificantValueDigits) :
                 new InternalConcurrentDoubleHistogram(instanceId, numberOfSignificantValueDigits);
@@ -94,6 +111,25 @@ public class DoubleRecorder implements DoubleValueRecorder, IntervalHistogramPro
      */
     public DoubleRecorder(final long highestToLowestValueRatio,
                           final int numberOfSignificantValueDigits) {
+        this(highestToLowestValueRatio, numberOfSignificantValueDigits, false);
+    }
+
+    /**
+     * Construct a {@link DoubleRecorder} dynamic range of values to cover and a number of significant
+     * decimal digits, optionally using a {@link StripedWriterReaderPhaser}.
+     *
+     * @param highestToLowestValueRatio specifies the dynamic range to use (as a ratio)
+     * @param numberOfSignificantValueDigits Specifies the precision to use. This is the number of significant
+     *                                       decimal digits to which the histogram will maintain value resolution
+     *                                       and separation. Must be a non-negative integer between 0 and 5.
+     * @param stripedPhaser Specifies whether the recorder coordinates recording with interval sampling using a
+     *                      {@link StripedWriterReaderPhaser} (which scales better with many concurrently recording
+     *                      threads) rather than a {@link WriterReaderPhaser}.
+     */
+    public DoubleRecorder(final long highestToLowestValueRatio,
+                          final int numberOfSignificantValueDigits,
+                          final boolean stripedPhaser) {
+        recordingPhaser = stripedPhaser ? new StripedWriterReaderPhaser() : new WriterReaderPhaser();
         activeHistogram = new InternalConcurrentDoubleHistogram(
                 instanceId, highestToLowestValueRatio, numberOfSignificantValueDigits);
         inactiveHistogram = null;
@@ -197,6 +233,25 @@ public class DoubleRecorder implements DoubleValueRecorder, IntervalHistogramPro
         performIntervalSample();
     }
 
+    /**
+     * Collect flip wait times, wait iterations and writer enters per interval for subsequent interval
+     * samples into the given {@link PhaseFlipMetrics}.
+     *
+     * @param flipMetrics the metrics to collect into, or null to stop collecting flip metrics
+     */
+    public void setFlipMetrics(PhaseFlipMetrics flipMetrics) {
+        recordingPhaser.setFlipMetrics(flipMetrics);
+    }
+
+    /**
+     * Get the {@link PhaseFlipMetrics} (if any) that interval sample flips are currently collected into.
+     *
+     * @return the attached flip metrics, or null if none are attached
+     */
+    public PhaseFlipMetrics getFlipMetrics() {
+        return recordingPhaser.getFlipMetrics();
+    }
+
     private void performIntervalSample() {
         try {
             recordingPhaser.readerLock();
@@ -229,7 +284,7 @@ public class DoubleRecorder implements DoubleValueRecorder, IntervalHistogramPro
             // Make sure we are not in the middle of recording a value on the previously active histogram:
 
             // Flip phase to make sure no recordings that were in flight pre-flip are still active:
-            recordingPhaser.flipPhase(500000L /* yield in 0.5 msec units if needed */);
+            recordingPhaser.adaptiveFlipPhase(500000L /* park in up to 0.5 msec units if needed */);
         } finally {
             recordingPhaser.readerUnlock();
         }
@@ -22,6 +22,21 @@ public abstract class EncodableHistogram {
 
     public abstract int encodeIntoCompressedByteBuffer(final ByteBuffer targetBuffer, int compressionLevel);
 
+    /**
+     * Encode this histogram in compressed form into a byte buffer, using a given compression codec.
+     * Subclasses that support {@link HistogramCompressionCodec}s override this method; the default
+     * implementation throws {@link UnsupportedOperationException}.
+     *
+     * @param targetBuffer The buffer to encode into
+     * @param codec The compression codec to use
+     * @return The number of bytes written to the buffer
+     */
+    public int encodeIntoCompressedByteBuffer(final ByteBuffer targetBuffer,
+                                              final HistogramCompressionCodec codec) {
+        throw new UnsupportedOperationException(getClass().getName() +
+                " does not support encoding with a HistogramCompressionCodec");
+    }
+
     public abstract long getStartTimeStamp();
 
     public abstract void setStartTimeStamp(long startTimeStamp);
@@ -0,0 +1,336 @@
+/**
+ * Written by Gil Tene of Azul Systems, and released to the public domain,
+ * as explained at http://creativecommons.org/publicdomain/zero/1.0/
+ *
+ * @author Gil Tene
+ */
+
+package org.HdrHistogram;
+
+import java.nio.ByteBuffer;
+import java.util.Iterator;
+import java.util.NoSuchElementException;
+import java.util.zip.DataFormatException;
+
+import static java.nio.ByteOrder.BIG_ENDIAN;
+
+/**
+ * <h3>A read-only view of a histogram in its encoded (V2) form</h3>
+ * <p>
+ * An {@link EncodedHistogramView} answers common queries (total count, min/max values, value at percentile,
+ * and iteration through recorded values) by streaming directly over the ZigZag LEB128 encoded counts payload
+ * produced by {@link AbstractHistogram#encodeIntoByteBuffer}, without ever materializing a counts array. This
+ * makes it a cheap way to extract a few statistics (e.g. the 99%'ile and max) from stored histograms, where a
+ * full {@link AbstractHistogram#decodeFromByteBuffer decode} would allocate and fill a counts array covering
+ * the histogram's entire value range.
+ * <p>
+ * Each query is a forward pass over the payload. Total count and min/max values are established by a single pass
+ * on first use, and cached. The view does not copy the payload of an uncompressed buffer, and the buffer's
+ * contents must not be modified while the view is in use. Views of compressed buffers (see
+ * {@link #wrapCompressed}) decompress the payload bytes once, but still never allocate a counts array.
+ * <p>
+ * Values reported by a view are the integer values recorded in the encoded histogram. For encoded
+ * {@link DoubleHistogram}s, multiply by {@link #getIntegerToDoubleValueConversionRatio()} to obtain the
+ * double values.
+ * <p>
+ * An EncodedHistogramView is not thread-safe.
+ */
+public class EncodedHistogramView {
+    private final ByteBuffer payload;
+    private final int payloadStartPosition;
+    private final int payloadLengthInBytes;
+
+    private final long lowestDiscernibleValue;
+    private final long highestTrackableValue;
+    private final int numberOfSignificantValueDigits;
+    private final double integerToDoubleValueConversionRatio;
+
+    private final HistogramLayout layout;
+
+    private boolean trackingValuesAreEstablished = false;
+    private long totalCount;
+    private int minNonZeroIndex;
+    private int maxIndex;
+
+    private EncodedHistogramView(final ByteBuffer buffer) {
+        final ByteBuffer header = buffer.duplicate().order(BIG_ENDIAN);
+        final int cookie = header.getInt();
+        if ((AbstractHistogram.getCookieBase(cookie) != AbstractHistogram.V2EncodingCookieBase) ||
+                (AbstractHistogram.getWordSizeInBytesFromCookie(cookie) != AbstractHistogram.V2maxWordSizeInBytes)) {
+            throw new IllegalArgumentException("The buffer does not contain a V2 encoded Histogram");
+        }
+        payloadLengthInBytes = header.getInt();
+        header.getInt(); // normalizingIndexOffset does not affect the (logical) order of encoded counts.
+        numberOfSignificantValueDigits = header.getInt();
+        lowestDiscernibleValue = header.getLong();
+        highestTrackableValue = header.getLong();
+        integerToDoubleValueConversionRatio = header.getDouble();
+        payloadStartPosition = header.position();
+        if (payloadLengthInBytes > header.remaining()) {
+            throw new IllegalArgumentException("The buffer does not contain the full Histogram payload");
+        }
+        payload = header;
+
+        // Use the same (shared) value layout an AbstractHistogram with these parameters would use:
+        layout = HistogramLayout.forValueRange(lowestDiscernibleValue, highestTrackableValue,
+                numberOfSignificantValueDigits);
+    }
+
+    /**
+     * Construct a view over a histogram encoded (in uncompressed V2 form) in a ByteBuffer, starting at the
+     * buffer's current position. The buffer's position is not modified.
+     *
+     * @param buffer The buffer holding the encoded histogram
+     * @return A view of the encoded histogram
+     * @throws IllegalArgumentException if the buffer does not hold a V2 encoded histogram
+     */
+    public static EncodedHistogramView wrap(final ByteBuffer buffer) {
+        return new EncodedHistogramView(buffer);
+    }
+
+    /**
+     * Construct a view over a histogram encoded in compressed (V2) form in a ByteBuffer, starting at the
+     * buffer's current position. The encoded payload is decompressed into a byte array (or, for the
+     * {@link HistogramCompressionCodec#NONE} codec, read in place), but no counts array is allocated.
+     * The buffer's position is not modified.
+     *
+     * @param buffer The buffer holding the compressed encoded histogram
+     * @return A view of the encoded histogram
+     * @throws DataFormatException on error parsing/decompressing the buffer
+     * @throws IllegalArgumentException if the buffer does not hold a compressed V2 encoded histogram
+     */
+    public static EncodedHistogramView wrapCompressed(final ByteBuffer buffer) throws DataFormatException {
+        final ByteBuffer source = buffer.duplicate().order(BIG_ENDIAN);
+        final int cookie = source.getInt();
+        final HistogramCompressionCodec codec =
+                HistogramCompressionCodec.forCookieBase(AbstractHistogram.getCookieBase(cookie));
+        if (codec == null) {
+            throw new IllegalArgumentException("The buffer does not contain a compressed V2 encoded Histogram");
+        }
+        final int lengthOfCompressedContents = source.getInt();
+        return new EncodedHistogramView(codec.decompress(source, lengthOfCompressedContents));
+    }
+
+    //   #######  ##     ## ######## ########  #### ########  ######
+    //  ##     ## ##     ## ##       ##     ##  ##  ##       ##    ##
+    //  ##     ## ##     ## ##       ##     ##  ##  ##       ##
+    //  ##     ## ##     ## ######   ########   ##  ######    ######
+    //  ##  ## ## ##     ## ##       ##   ##    ##  ##             ##
+    //  ##    ##  ##     ## ##       ##    ##   ##  ##       ##    ##
+    //   ##### ##  #######  ######## ##     ## #### ########  ######
+    //
+    // Queries:
+    //
+
+    /**
+     * @return the lowestDiscernibleValue of the encoded histogram
+     */
+    public long getLowestDiscernibleValue() {
+        return lowestDiscernibleValue;
+    }
+
+    /**
+     * @return the highestTrackableValue of the encoded histogram
+     */
+    public long getHighestTrackableValue() {
+        return highestTrackableValue;
+    }
+
+    /**
+     * @return the numberOfSignificantValueDigits of the encoded histogram
+     */
+    public int getNumberOfSignificantValueDigits() {
+        return numberOfSignificantValueDigits;
+    }
+
+    /**
+     * @return the ratio by which integer values in the encoded histogram are multiplied to obtain double values
+     * (1.0 for integer value histograms)
+     */
+    public double getIntegerToDoubleValueConversionRatio() {
+        return integerToDoubleValueConversionRatio;
+    }
+
+    /**
+     * Get the total count of all recorded values in the encoded histogram
+     * @return the total count of all recorded values in the encoded histogram
+     */
+    public long getTotalCount() {
+        establishTrackingValues();
+        return totalCount;
+    }
+
+    /**
+     * Get the highest recorded value level in the encoded histogram. If the histogram has no recorded values,
+     * the value returned is 0.
+     *
+     * @return the Max value recorded in the encoded histogram
+     */
+    public long getMaxValue() {
+        establishTrackingValues();
+        return (maxIndex < 0) ? 0 : layout.highestEquivalentValueAtIndex(maxIndex);
+    }
+
+    /**
+     * Get the lowest recorded non-zero value level in the encoded histogram. If the histogram has no recorded
+     * values, the value returned is Long.MAX_VALUE.
+     *
+     * @return the lowest recorded non-zero value level in the encoded histogram
+     */
+    public long getMinNonZeroValue() {
+        establishTrackingValues();
+        return (minNonZeroIndex < 0) ? Long.MAX_VALUE : layout.valueFromIndex(minNonZeroIndex);
+    }
+
+    /**
+     * Get the value at a given percentile, with the same semantics as
+     * {@link AbstractHistogram#getValueAtPercentile(double)}.
+     *
+     * @param percentile  The percentile for which to return the associated value
+     * @return The value that the given percentage of the overall recorded value entries in the encoded histogram
+     * are either smaller than or equivalent to. When the percentile is 0.0, returns the value that all value
+     * entries in the histogram are either larger than or equivalent to.
+     */
+    public long getValueAtPercentile(final double percentile) {
+        final long countAtPercentile = AbstractHistogram.countAtPercentile(percentile, getTotalCount());
+        final ByteBuffer source = payloadSource();
+        final int endPosition = payloadStartPosition + payloadLengthInBytes;
+        long totalToCurrentIndex = 0;
+        int index = 0;
+        while (source.position() < endPosition) {
+            final long count = ZigZagEncoding.getLong(source);
+            if (count < 0) {
+                index += zerosCount(count);
+                continue;
+            }
+            totalToCurrentIndex += count;
+            if (totalToCurrentIndex >= countAtPercentile) {
+                return (percentile == 0.0) ?
+                        layout.valueFromIndex(index) :
+                        layout.highestEquivalentValueAtIndex(index);
+            }
+            index++;
+        }
+        return 0;
+    }
+
+    /**
+     * Provide a means of iterating through all recorded values in the encoded histogram, with the same
+     * semantics as {@link AbstractHistogram#recordedValues()}. The iteration streams over the encoded payload.
+     *
+     * @return An {@link java.lang.Iterable}{@literal <}{@link HistogramIterationValue}{@literal >}
+     * through the encoded histogram's recorded values
+     */
+    public Iterable<HistogramIterationValue> recordedValues() {
+        return new Iterable<HistogramIterationValue>() {
+            @Override
+            public Iterator<HistogramIterationValue> iterator() {
+                return new RecordedValuesIterator();
+            }
+        };
+    }
+
+    private class RecordedValuesIterator implements Iterator<HistogramIterationValue> {
+        private final ByteBuffer source = payloadSource();
+        private final int endPosition = payloadStartPosition + payloadLengthInBytes;
+        private final long arrayTotalCount = getTotalCount();
+        private final HistogramIterationValue currentIterationValue = new HistogramIterationValue();
+        private int nextIndex = 0;
+        private long prevValueIteratedTo = 0;
+        private long totalCountToCurrentIndex = 0;
+        private long totalValueToCurrentIndex = 0;
+
+        @Override
+        public boolean hasNext() {
+            return (totalCountToCurrentIndex < arrayTotalCount);
+        }
+
+        @Override
+        public HistogramIterationValue next() {
+            while (source.position() < endPosition) {
+                final long count = ZigZagEncoding.getLong(source);
+                if (count < 0) {
+                    nextIndex += zerosCount(count);
+                    continue;
+                }
+                final int index = nextIndex++;
+                if (count == 0) {
+                    continue;
+                }
+                final long valueIteratedTo = layout.highestEquivalentValueAtIndex(index);
+                totalCountToCurrentIndex += count;
+                totalValueToCurrentIndex += count * valueIteratedTo;
+                final double percentile = (100.0 * totalCountToCurrentIndex) / arrayTotalCount;
+                currentIterationValue.set(valueIteratedTo, prevValueIteratedTo, count, count,
+                        totalCountToCurrentIndex, totalValueToCurrentIndex, percentile, percentile,
+                        integerToDoubleValueConversionRatio);
+                prevValueIteratedTo = valueIteratedTo;
+                return currentIterationValue;
+            }
+            throw new NoSuchElementException();
+        }
+
+        @Override
+        public void remove() {
+            throw new UnsupportedOperationException();
+        }
+    }
+
+    //   #### ##    ## ######## ######## ########  ##    ##    ###    ##
+    //    ##  ###   ##    ##    ##       ##     ## ###   ##   ## ##   ##
+    //    ##  ####  ##    ##    ##       ##     ## ####  ##  ##   ##  ##
+    //    ##  ## ## ##    ##    ######   ########  ## ## ## ##     ## ##
+    //    ##  ##  ####    ##    ##       ##   ##   ##  #### ######### ##
+    //    ##  ##   ###    ##    ##       ##    ##  ##   ### ##     ## ##
+    //   #### ##    ##    ##    ######## ##     ## ##    ## ##     ## ########
+    //
+    // Internal helper methods:
+    //
+
+    private ByteBuffer payloadSource() {
+        final ByteBuffer source = payload.duplicate();
+        source.position(payloadStartPosition);
+        return source;
+    }
+
+    private static int zerosCount(final long count) {
+        // Negative values in the V2 encoding indicate a run of zero counts:
+        final long zc = -count;
+        if (zc > Integer.MAX_VALUE) {
+            throw new IllegalArgumentException(
+                    "An encoded zero count of > Integer.MAX_VALUE was encountered in the source");
+        }
+        return (int) zc;
+    }
+
+    private void establishTrackingValues() {
+        if (trackingValuesAreEstablished) {
+            return;
+        }
+        final ByteBuffer source = payloadSource();
+        final int endPosition = payloadStartPosition + payloadLengthInBytes;
+        long observedTotalCount = 0;
+        int observedMinNonZeroIndex = -1;
+        int observedMaxIndex = -1;
+        int index = 0;
+        while (source.position() < endPosition) {
+            final long count = ZigZagEncoding.getLong(source);
+            if (count < 0) {
+                index += zerosCount(count);
+                continue;
+            }
+            if (count > 0) {
+                observedTotalCount += count;
+                observedMaxIndex = index;
+                if ((observedMinNonZeroIndex < 0) && (index != 0)) {
+                    observedMinNonZeroIndex = index;
+                }
+            }
+            index++;
+        }
+        totalCount = observedTotalCount;
+        minNonZeroIndex = observedMinNonZeroIndex;
+        maxIndex = observedMaxIndex;
+        trackingValuesAreEstablished = true;
+    }
+}
@@ -0,0 +1,177 @@
+/**
+ * Written by Gil Tene of Azul Systems, and released to the public domain,
+ * as explained at http://creativecommons.org/publicdomain/zero/1.0/
+ *
+ * @author Gil Tene
+ */
+
+package org.HdrHistogram;
+
+import java.io.IOException;
+import java.io.ObjectInputStream;
+
+/**
+ * <h3>A read-only snapshot of a High Dynamic Range (HDR) Histogram</h3>
+ * <p>
+ * A {@link FrozenHistogram} captures the contents of a source histogram at construction time, and does not
+ * support any further modification of its contents. Since its contents never change, a FrozenHistogram
+ * builds its cumulative count index (see {@link AbstractHistogram#setCumulativeCountIndexing}) exactly once,
+ * making {@link #getValueAtPercentile}, {@link #getPercentileAtOrBelowValue} and
+ * {@link #getCountBetweenValues} queries O(log N) or O(1) operations rather than linear scans of the
+ * counts array. This makes FrozenHistogram a good fit for histograms that are recorded (or decoded) once
+ * and then queried repeatedly, e.g. interval histograms that are published to multiple percentile reports.
+ * <p>
+ * Calls to recording, adding, subtracting, shifting, or resetting operations on a FrozenHistogram will throw
+ * an {@link IllegalStateException}. Metadata (start/end timestamps and tag) can still be set.
+ * <p>
+ * See package description for {@link org.HdrHistogram} for details.
+ */
+
+public class FrozenHistogram extends Histogram {
+
+    @Override
+    void incrementCountAtIndex(final int index) {
+        throw new IllegalStateException("FrozenHistogram does not support recording operations.");
+    }
+
+    @Override
+    void addToCountAtIndex(final int index, final long value) {
+        throw new IllegalStateException("FrozenHistogram does not support recording operations.");
+    }
+
+    @Override
+    void setCountAtIndex(int index, long value) {
+        throw new IllegalStateException("FrozenHistogram does not support modification of counts.");
+    }
+
+    @Override
+    void setCountAtNormalizedIndex(int index, long value) {
+        throw new IllegalStateException("FrozenHistogram does not support modification of counts.");
+    }
+
+    @Override
+    void setNormalizingIndexOffset(int normalizingIndexOffset) {
+        if (normalizingIndexOffset != 0) {
+            throw new IllegalStateException(
+                    "FrozenHistogram does not support non-zero normalizing index settings.");
+        }
+    }
+
+    @Override
+    void shiftNormalizingIndexByOffset(int offsetToAdd,
+                                       boolean lowestHalfBucketPopulated,
+                                       double newIntegerToDoubleValueConversionRatio) {
+        throw new IllegalStateException("FrozenHistogram does not support Shifting operations.");
+    }
+
+    @Override
+    public void shiftValuesLeft(final int numberOfBinaryOrdersOfMagnitude) {
+        throw new IllegalStateException("FrozenHistogram does not support Shifting operations.");
+    }
+
+    @Override
+    public void shiftValuesRight(final int numberOfBinaryOrdersOfMagnitude) {
+        throw new IllegalStateException("FrozenHistogram does not support Shifting operations.");
+    }
+
+    @Override
+    void setIntegerToDoubleValueConversionRatio(double integerToDoubleValueConversionRatio) {
+        throw new IllegalStateException("FrozenHistogram does not support value conversion ratio changes.");
+    }
+
+    @Override
+    void resize(long newHighestTrackableValue) {
+        throw new IllegalStateException("FrozenHistogram does not support resizing operations.");
+    }
+
+    @Override
+    public void setAutoResize(boolean autoResize) {
+        if (autoResize) {
+            throw new IllegalStateException("FrozenHistogram does not support AutoResize operation.");
+        }
+    }
+
+    @Override
+    public void setLazyCountsAllocation(boolean lazyCountsAllocation) {
+        if (lazyCountsAllocation) {
+            throw new IllegalStateException("FrozenHistogram does not support lazy counts allocation.");
+        }
+    }
+
+    @Override
+    public boolean supportsAutoResize() { return false; }
+
+    @Override
+    void clearCounts() {
+        throw new IllegalStateException("FrozenHistogram does not support reset operations.");
+    }
+
+    @Override
+    Object getUpdatablePlainCountsArray() {
+        // Counts may be read directly, but never updated:
+        return null;
+    }
+
+    @Override
+    void incrementTotalCount() {
+        throw new IllegalStateException("FrozenHistogram does not support recording operations.");
+    }
+
+    @Override
+    void addToTotalCount(final long value) {
+        throw new IllegalStateException("FrozenHistogram does not support recording operations.");
+    }
+
+    @Override
+    public FrozenHistogram copy() {
+        return new FrozenHistogram(this);
+    }
+
+    @Override
+    public FrozenHistogram copyCorrectedForCoordinatedOmission(final long expectedIntervalBetweenValueSamples) {
+        Histogram corrected = new Histogram(this);
+        corrected.addWhileCorrectingForCoordinatedOmission(this, expectedIntervalBetweenValueSamples);
+        return new FrozenHistogram(corrected);
+    }
+
+    /**
+     * Construct a FrozenHistogram holding a snapshot of the contents of a given source histogram, along with
+     * the source's range settings, start/end timestamps and tag.
+     * <p>
+     * The source histogram is not modified. If the source may be concurrently modified, the caller is
+     * responsible for making sure it is not modified while the snapshot is being taken (e.g. by taking the
+     * snapshot of an interval histogram obtained from a {@link Recorder}).
+     *
+     * @param source The source histogram to take a snapshot of
+     */
+    public FrozenHistogram(final AbstractHistogram source) {
+        this(source, true);
+    }
+
+    /**
+     * Construct a FrozenHistogram holding a snapshot of the contents of a given source histogram, optionally
+     * without a cumulative count index (for snapshots that are taken for a single query).
+     *
+     * @param source The source histogram to take a snapshot of
+     * @param cumulativeCountIndexing Whether to build (and keep) a cumulative count index
+     */
+    FrozenHistogram(final AbstractHistogram source, final boolean cumulativeCountIndexing) {
+        super(source, true);
+        autoResize = false;
+        tag = source.getTag();
+        nonConcurrentSetIntegerToDoubleValueConversionRatio(source.getIntegerToDoubleValueConversionRatio());
+        final int lengthToCopy = Math.min(countsArrayLength, source.countsArrayLength);
+        source.copyCountsInto(counts, lengthToCopy);
+        establishInternalTackingValues(lengthToCopy);
+        if (cumulativeCountIndexing) {
+            this.cumulativeCountIndexing = true;
+            getCumulativeCountIndex();
+        }
+    }
+
+    private void readObject(final ObjectInputStream o)
+            throws IOException, ClassNotFoundException {
+        o.defaultReadObject();
+        cumulativeCountIndexing = true;
+    }
+}
@@ -38,6 +38,10 @@ import java.util.zip.DataFormatException;
  * they are encountered. Note that recording calls that cause auto-resizing may take longer to execute, as resizing
  * incurs allocation and copying of internal data structures.
  * <p>
+ * Lazy counts allocation: When lazy counts allocation is turned on with {@link Histogram#setLazyCountsAllocation}, a
+ * {@link Histogram} only holds a counts array while values are recorded into it, which suits large numbers of
+ * mostly idle histograms.
+ * <p>
  * See package description for {@link org.HdrHistogram} for details.
  */
 
@@ -46,34 +50,238 @@ public class Histogram extends AbstractHistogram {
     long[] counts;
     int normalizingIndexOffset;
 
+    // Optional two-level occupancy bitmap over the (normalized) counts array: one bit per counts slot, and one
+    // summary bit per 64-slot occupancy word. A set bit indicates that the slot (or word) may hold a non-zero
+    // count, and every non-zero slot has its bits set. Bits are only cleared when the counts are cleared.
+    long[] occupancyWords;
+    long[] occupancySummaryWords;
+
+    // When set, the counts array is only allocated by the first (non-zero) count update, and is released
+    // again by a reset that finds nothing was recorded since the previous one. A null counts array reads
+    // as all-zero counts:
+    boolean lazyCountsAllocation;
+
     @Override
     long getCountAtIndex(final int index) {
-        return counts[normalizeIndex(index, normalizingIndexOffset, countsArrayLength)];
+        return (counts != null) ? counts[normalizeIndex(index, normalizingIndexOffset, countsArrayLength)] : 0;
     }
 
     @Override
     long getCountAtNormalizedIndex(final int index) {
-        return counts[index];
+        return (counts != null) ? counts[index] : 0;
     }
 
     @Override
     void incrementCountAtIndex(final int index) {
-        counts[normalizeIndex(index, normalizingIndexOffset, countsArrayLength)]++;
+        final int normalizedIndex = normalizeIndex(index, normalizingIndexOffset, countsArrayLength);
+        if (counts == null) {
+            allocateCounts();
+        }
+        if ((counts[normalizedIndex]++ == 0) && (occupancyWords != null)) {
+            markOccupied(normalizedIndex);
+        }
     }
 
     @Override
     void addToCountAtIndex(final int index, final long value) {
-        counts[normalizeIndex(index, normalizingIndexOffset, countsArrayLength)] += value;
+        if (counts == null) {
+            if (value == 0) {
+                return;
+            }
+            allocateCounts();
+        }
+        final int normalizedIndex = normalizeIndex(index, normalizingIndexOffset, countsArrayLength);
+        counts[normalizedIndex] += value;
+        if (occupancyWords != null) {
+            markOccupied(normalizedIndex);
+        }
     }
 
     @Override
     void setCountAtIndex(int index, long value) {
-        counts[normalizeIndex(index, normalizingIndexOffset, countsArrayLength)] = value;
+        setCountAtNormalizedIndex(normalizeIndex(index, normalizingIndexOffset, countsArrayLength), value);
     }
 
     @Override
     void setCountAtNormalizedIndex(int index, long value) {
+        if (counts == null) {
+            if (value == 0) {
+                return;
+            }
+            allocateCounts();
+        }
         counts[index] = value;
+        if ((value != 0) && (occupancyWords != null)) {
+            markOccupied(index);
+        }
+    }
+
+    /**
+     * Allocate the counts array, if it is not currently allocated.
+     */
+    void allocateCounts() {
+        if (counts == null) {
+            counts = new long[countsArrayLength];
+        }
+    }
+
+    /**
+     * Release the counts array. Must only be called when all counts are zero.
+     */
+    void releaseCounts() {
+        counts = null;
+    }
+
+    /**
+     * Indicate whether or not the histogram allocates its counts array lazily
+     * @return lazy counts allocation setting
+     */
+    public boolean isLazyCountsAllocation() {
+        return lazyCountsAllocation;
+    }
+
+    /**
+     * Control whether or not the histogram allocates its counts array lazily.
+     * <p>
+     * With lazy counts allocation enabled, the histogram only holds a counts array while it has values recorded
+     * into it: the array is released right away if the histogram is currently empty, and whenever a
+     * {@link #reset()} finds that nothing was recorded since the previous reset. It is allocated again by the
+     * next recording (or addition of a non-empty histogram). Queries, iteration, encoding, and adding an empty
+     * histogram to others never touch (or allocate) a counts array. Histograms that are recorded into between
+     * every reset keep their counts array, so only histograms that sit idle for a whole interval pay for a
+     * later re-allocation. This pays off when many histograms (e.g. per-endpoint interval histograms) are
+     * mostly idle, at the cost of an allocation within the first recording call into an idle histogram.
+     * <p>
+     * Disabling lazy counts allocation allocates the counts array (if needed) right away. Lazy counts
+     * allocation is only supported by {@link Histogram}, {@link SynchronizedHistogram} and
+     * {@link AtomicHistogram}. Other subclasses will throw an {@link IllegalStateException} when it is enabled.
+     * <p>
+     * This setting should not be changed while values are being concurrently recorded into the histogram.
+     *
+     * @param lazyCountsAllocation lazy counts allocation setting
+     */
+    public void setLazyCountsAllocation(final boolean lazyCountsAllocation) {
+        this.lazyCountsAllocation = lazyCountsAllocation;
+        if (!lazyCountsAllocation) {
+            allocateCounts();
+        } else if ((getTotalCount() == 0) && hasNoNonZeroCounts()) {
+            releaseCounts();
+        }
+    }
+
+    private boolean hasNoNonZeroCounts() {
+        // Negative counts can leave a non-empty histogram with a zero total count:
+        for (int i = 0; i < countsArrayLength; i++) {
+            if (getCountAtIndex(i) != 0) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    private void markOccupied(final int normalizedIndex) {
+        final int wordIndex = normalizedIndex >>> 6;
+        occupancyWords[wordIndex] |= (1L << normalizedIndex);
+        occupancySummaryWords[wordIndex >>> 6] |= (1L << wordIndex);
+    }
+
+    /**
+     * Indicate whether or not the histogram maintains an occupancy bitmap over its counts
+     * @return occupancy tracking setting
+     */
+    public boolean isOccupancyTracking() {
+        return (occupancyWords != null);
+    }
+
+    /**
+     * Control whether or not the histogram maintains a two-level occupancy bitmap over its counts array (one bit
+     * per counts slot, and one per 64-slot bitmap word).
+     * <p>
+     * When enabled, recorded value and percentile iteration, encoding, and adding or subtracting this histogram
+     * to or from others jump directly between (possibly) non-zero counts slots, rather than visiting every slot
+     * in between. This pays off for sparsely populated histograms (e.g. a few hundred distinct values recorded
+     * across tens of thousands of slots). The bitmap is maintained on recording, at the cost of an added check
+     * (and, when a slot first becomes non-zero, a bit update) per recording, and of one additional bit per
+     * counts array entry.
+     * <p>
+     * Occupancy tracking is only supported by histograms whose counts are kept and updated in place in the
+     * inherited counts array (such as {@link Histogram} and {@link SynchronizedHistogram}). Subclasses that keep
+     * their counts elsewhere (such as {@link AtomicHistogram} or {@link PackedHistogram}) will throw an
+     * {@link IllegalStateException} when it is enabled.
+     *
+     * @param occupancyTracking occupancy tracking setting
+     */
+    public void setOccupancyTracking(final boolean occupancyTracking) {
+        if (!occupancyTracking) {
+            occupancyWords = null;
+            occupancySummaryWords = null;
+            return;
+        }
+        if (!countsArrayIsPlain()) {
+            throw new IllegalStateException(getClass().getSimpleName() + " does not support occupancy tracking.");
+        }
+        establishOccupancy();
+    }
+
+    private void establishOccupancy() {
+        final int numberOfWords = (countsArrayLength + 63) >>> 6;
+        occupancyWords = new long[numberOfWords];
+        occupancySummaryWords = new long[(numberOfWords + 63) >>> 6];
+        for (int i = 0; (counts != null) && (i < counts.length); i++) {
+            if (counts[i] != 0) {
+                markOccupied(i);
+            }
+        }
+    }
+
+    @Override
+    boolean hasOccupancyBitmap() {
+        return (occupancyWords != null);
+    }
+
+    @Override
+    boolean canSkipEmptySlots() {
+        return (occupancyWords != null);
+    }
+
+    @Override
+    int nextPopulatedIndex(final int fromIndex) {
+        final long[] words = occupancyWords;
+        // The bitmap is kept over normalized indexes, so it can only be used for skipping while those match
+        // the (logical) indexes being scanned:
+        if ((words == null) || (normalizingIndexOffset != 0) || (fromIndex >= countsArrayLength)) {
+            return fromIndex;
+        }
+        int wordIndex = fromIndex >>> 6;
+        final long word = words[wordIndex] & (-1L << fromIndex);
+        if (word != 0) {
+            return (wordIndex << 6) + Long.numberOfTrailingZeros(word);
+        }
+        // Use the summary words to find the next occupancy word with any bits set:
+        wordIndex++;
+        int summaryIndex = wordIndex >>> 6;
+        if (summaryIndex >= occupancySummaryWords.length) {
+            return countsArrayLength;
+        }
+        long summaryWord = occupancySummaryWords[summaryIndex] & (-1L << wordIndex);
+        while (summaryWord == 0) {
+            if (++summaryIndex >= occupancySummaryWords.length) {
+                return countsArrayLength;
+            }
+            summaryWord = occupancySummaryWords[summaryIndex];
+        }
+        wordIndex = (summaryIndex << 6) + Long.numberOfTrailingZeros(summaryWord);
+        return (wordIndex << 6) + Long.numberOfTrailingZeros(words[wordIndex]);
+    }
+
+    @Override
+    boolean countsArrayIsPlain() {
+        return true;
+    }
+
+    @Override
+    Object getPlainCountsArray() {
+        return countsArrayIsPlain() ? counts : null;
     }
 
     @Override
@@ -100,8 +308,17 @@ public class Histogram extends AbstractHistogram {
 
     @Override
     void clearCounts() {
-        java.util.Arrays.fill(counts, 0);
+        if (lazyCountsAllocation && (totalCount == 0)) {
+            // Nothing was recorded since the previous reset, so hold no counts until the next recording:
+            releaseCounts();
+        } else if (counts != null) {
+            java.util.Arrays.fill(counts, 0);
+        }
         totalCount = 0;
+        if (occupancyWords != null) {
+            java.util.Arrays.fill(occupancyWords, 0);
+            java.util.Arrays.fill(occupancySummaryWords, 0);
+        }
     }
 
     @Override
@@ -140,7 +357,7 @@ public class Histogram extends AbstractHistogram {
 
     @Override
     int _getEstimatedFootprintInBytes() {
-        return (512 + (8 * counts.length));
+        return (512 + ((counts != null) ? (8 * counts.length) : 0));
     }
 
     @Override
@@ -149,6 +366,14 @@ public class Histogram extends AbstractHistogram {
 
         establishSize(newHighestTrackableValue);
 
+        if (counts == null) {
+            // Nothing to copy, the counts will be allocated at the new size when first updated:
+            if (occupancyWords != null) {
+                establishOccupancy();
+            }
+            return;
+        }
+
         int countsDelta = countsArrayLength - counts.length;
 
         counts = Arrays.copyOf(counts, countsArrayLength);
@@ -160,6 +385,10 @@ public class Histogram extends AbstractHistogram {
             System.arraycopy(counts, oldNormalizedZeroIndex, counts, newNormalizedZeroIndex, lengthToCopy);
             Arrays.fill(counts, oldNormalizedZeroIndex, newNormalizedZeroIndex, 0);
         }
+
+        if (occupancyWords != null) {
+            establishOccupancy();
+        }
     }
 
     /**
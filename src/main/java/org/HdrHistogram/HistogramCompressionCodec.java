@@ -0,0 +1,485 @@
+/**
+ * Written by Gil Tene of Azul Systems, and released to the public domain,
+ * as explained at http://creativecommons.org/publicdomain/zero/1.0/
+ *
+ * @author Gil Tene
+ */
+
+package org.HdrHistogram;
+
+import java.nio.ByteBuffer;
+import java.util.Arrays;
+import java.util.zip.DataFormatException;
+import java.util.zip.Deflater;
+import java.util.zip.Inflater;
+
+import static java.nio.ByteOrder.BIG_ENDIAN;
+
+/**
+ * <h3>Compression codecs for the compressed histogram encoding</h3>
+ * <p>
+ * A {@link HistogramCompressionCodec} determines how the (V2) encoded form of a histogram is compressed by
+ * {@link AbstractHistogram#encodeIntoCompressedByteBuffer(ByteBuffer, HistogramCompressionCodec)} and
+ * {@link DoubleHistogram#encodeIntoCompressedByteBuffer(ByteBuffer, HistogramCompressionCodec)}. Each codec is
+ * identified by its own cookie in the compressed encoding, and decoding (e.g. via
+ * {@link Histogram#decodeFromCompressedByteBuffer}) detects the codec used automatically.
+ * <p>
+ * The following codecs are provided:
+ * <ul>
+ * <li>{@link #deflate(int)} (and {@link #DEFLATE}): java.util.zip Deflater compression at a given compression
+ * level. This is the long-standing compressed encoding format, readable by all versions of HdrHistogram.
+ * {@link HistogramLogWriter} reuses a single Deflater across the histograms it writes.</li>
+ * <li>{@link #FAST}: a pure-Java LZ77 (LZ4-style) block codec, that trades compression ratio for much lower CPU
+ * cost than Deflater, on both the encoding and decoding sides.</li>
+ * <li>{@link #NONE}: no compression. The encoded form is framed with a compressed encoding cookie and length,
+ * so it can be used wherever a compressed histogram is expected (e.g. in histogram logs), at no
+ * compression cost.</li>
+ * </ul>
+ * Histograms compressed with {@link #FAST} or {@link #NONE} can only be decoded by versions of HdrHistogram
+ * that support these codecs.
+ */
+public abstract class HistogramCompressionCodec {
+
+    // Cookie bases for compressed encodings (alongside AbstractHistogram.V2CompressedEncodingCookieBase):
+    static final int V2FastCompressedEncodingCookieBase = 0x1c849305;
+    static final int V2NonCompressedEncodingCookieBase = 0x1c849306;
+
+    private static final DeflateCodec[] deflateCodecs = new DeflateCodec[11];
+    static {
+        for (int level = Deflater.DEFAULT_COMPRESSION; level <= Deflater.BEST_COMPRESSION; level++) {
+            deflateCodecs[level + 1] = new DeflateCodec(level);
+        }
+    }
+
+    /**
+     * Deflater compression at the default compression level
+     */
+    public static final HistogramCompressionCodec DEFLATE = deflate(Deflater.DEFAULT_COMPRESSION);
+
+    /**
+     * Fast (LZ4-style) compression
+     */
+    public static final HistogramCompressionCodec FAST = new FastCodec();
+
+    /**
+     * No compression (framed, uncompressed encoding)
+     */
+    public static final HistogramCompressionCodec NONE = new NonCompressingCodec();
+
+    /**
+     * Get a Deflater based codec for a given compression level
+     * @param compressionLevel Compression level (for java.util.zip.Deflater).
+     * @return a Deflater based codec for the given compression level
+     */
+    public static HistogramCompressionCodec deflate(final int compressionLevel) {
+        if ((compressionLevel < Deflater.DEFAULT_COMPRESSION) || (compressionLevel > Deflater.BEST_COMPRESSION)) {
+            throw new IllegalArgumentException("Invalid compression level: " + compressionLevel);
+        }
+        return deflateCodecs[compressionLevel + 1];
+    }
+
+    HistogramCompressionCodec() {
+    }
+
+    /**
+     * @return the cookie base identifying this codec in the compressed encoding
+     */
+    abstract int getCookieBase();
+
+    /**
+     * @return the maximum number of bytes compress() may produce for a source of the given length
+     */
+    abstract int getMaxCompressedLength(int sourceLength);
+
+    /**
+     * Compress source[sourceOffset, sourceOffset + sourceLength) into target, starting at targetOffset.
+     * @return the number of bytes written into target
+     */
+    abstract int compress(byte[] source, int sourceOffset, int sourceLength,
+                          byte[] target, int targetOffset, int targetLength);
+
+    /**
+     * Decompress contentsLength bytes of compressed contents starting at the source buffer's position.
+     * @return a buffer positioned at the start of the uncompressed (encoded histogram) contents
+     */
+    abstract ByteBuffer decompress(ByteBuffer source, int contentsLength) throws DataFormatException;
+
+    /**
+     * Get a codec equivalent to this one, that reuses its own compression state (e.g. a Deflater) across calls
+     * rather than allocating it per call. The returned codec must only be used by one thread at a time, and must
+     * be {@link #release() released} when no longer needed.
+     * @return a codec reusing its own compression state (or this codec, if it has no such state)
+     */
+    HistogramCompressionCodec newReusingInstance() {
+        return this;
+    }
+
+    /**
+     * Release any (native) compression state held by a codec obtained from {@link #newReusingInstance()}.
+     * The codec must not be used afterwards.
+     */
+    void release() {
+    }
+
+    /**
+     * @return the codec for a given compressed encoding cookie base, or null if the cookie base is not known
+     */
+    static HistogramCompressionCodec forCookieBase(final int cookieBase) {
+        switch (cookieBase) {
+            case AbstractHistogram.V2CompressedEncodingCookieBase:
+                return DEFLATE;
+            case V2FastCompressedEncodingCookieBase:
+                return FAST;
+            case V2NonCompressedEncodingCookieBase:
+                return NONE;
+            default:
+                return null;
+        }
+    }
+
+    private static byte[] arrayOf(final ByteBuffer source, final int length) {
+        byte[] contents = new byte[length];
+        source.duplicate().get(contents);
+        return contents;
+    }
+
+    //  ########  ######## ######## ##          ###    ######## ########
+    //  ##     ## ##       ##       ##         ## ##      ##    ##
+    //  ##     ## ##       ##       ##        ##   ##     ##    ##
+    //  ##     ## ######   ######   ##       ##     ##    ##    ######
+    //  ##     ## ##       ##       ##       #########    ##    ##
+    //  ##     ## ##       ##       ##       ##     ##    ##    ##
+    //  ########  ######## ##       ######## ##     ##    ##    ########
+
+    private static class DeflateCodec extends HistogramCompressionCodec {
+        // Deflate cannot expand its input by more than ~1032:1, so longer indicated payloads are corrupt:
+        private static final int MAX_EXPANSION_RATIO = 1032;
+
+        private final int compressionLevel;
+        // Only set in reusing instances (the shared per-level codecs allocate, and end, a Deflater per call):
+        private final Deflater reusedDeflater;
+
+        DeflateCodec(final int compressionLevel) {
+            this(compressionLevel, null);
+        }
+
+        private DeflateCodec(final int compressionLevel, final Deflater reusedDeflater) {
+            this.compressionLevel = compressionLevel;
+            this.reusedDeflater = reusedDeflater;
+        }
+
+        @Override
+        HistogramCompressionCodec newReusingInstance() {
+            return new DeflateCodec(compressionLevel, new Deflater(compressionLevel));
+        }
+
+        @Override
+        void release() {
+            if (reusedDeflater != null) {
+                reusedDeflater.end();
+            }
+        }
+
+        @Override
+        int getCookieBase() {
+            return AbstractHistogram.V2CompressedEncodingCookieBase;
+        }
+
+        @Override
+        int getMaxCompressedLength(final int sourceLength) {
+            // Worst case expansion of stored deflate blocks, plus zlib header and trailer:
+            return sourceLength + (sourceLength >> 12) + (sourceLength >> 14) + (sourceLength >> 25) + 13 + 6;
+        }
+
+        @Override
+        int compress(final byte[] source, final int sourceOffset, final int sourceLength,
+                     final byte[] target, final int targetOffset, final int targetLength) {
+            final Deflater compressor;
+            if (reusedDeflater != null) {
+                compressor = reusedDeflater;
+                compressor.reset();
+            } else {
+                compressor = new Deflater(compressionLevel);
+            }
+            try {
+                compressor.setInput(source, sourceOffset, sourceLength);
+                compressor.finish();
+                return compressor.deflate(target, targetOffset, targetLength);
+            } finally {
+                if (compressor != reusedDeflater) {
+                    compressor.end();
+                }
+            }
+        }
+
+        @Override
+        ByteBuffer decompress(final ByteBuffer source, final int contentsLength) throws DataFormatException {
+            final Inflater decompressor = new Inflater();
+            try {
+                if (source.hasArray()) {
+                    decompressor.setInput(source.array(), source.arrayOffset() + source.position(), contentsLength);
+                } else {
+                    decompressor.setInput(arrayOf(source, contentsLength));
+                }
+                final byte[] headerBytes = new byte[AbstractHistogram.ENCODING_HEADER_SIZE];
+                if (decompressor.inflate(headerBytes) < headerBytes.length) {
+                    throw new DataFormatException("The compressed contents do not contain a full Histogram header");
+                }
+                final int payloadLengthInBytes = ByteBuffer.wrap(headerBytes).order(BIG_ENDIAN).getInt(4);
+                if ((payloadLengthInBytes < 0) ||
+                        (payloadLengthInBytes > (long) MAX_EXPANSION_RATIO * contentsLength)) {
+                    throw new DataFormatException("Invalid payload length: " + payloadLengthInBytes);
+                }
+                final byte[] contents = Arrays.copyOf(headerBytes, headerBytes.length + payloadLengthInBytes);
+                if (decompressor.inflate(contents, headerBytes.length, payloadLengthInBytes) != payloadLengthInBytes) {
+                    throw new DataFormatException("Compressed contents do not match their indicated length");
+                }
+                return ByteBuffer.wrap(contents).order(BIG_ENDIAN);
+            } finally {
+                decompressor.end();
+            }
+        }
+    }
+
+    //  ########    ###     ######  ########
+    //  ##         ## ##   ##    ##    ##
+    //  ##        ##   ##  ##          ##
+    //  ######   ##     ##  ######     ##
+    //  ##       #########       ##    ##
+    //  ##       ##     ## ##    ##    ##
+    //  ##       ##     ##  ######     ##
+
+    /**
+     * An LZ77 block codec in the style of LZ4. The compressed contents start with the uncompressed length
+     * (a 4 byte int), followed by a series of sequences. Each sequence consists of a token byte (literal run
+     * length in the high nibble, match length minus 4 in the low nibble, with a nibble value of 15 indicating
+     * that additional length bytes follow), the literal bytes, and (for all but the last sequence) a 2 byte
+     * little-endian match offset.
+     */
+    private static class FastCodec extends HistogramCompressionCodec {
+        private static final int MIN_MATCH = 4;
+        private static final int MAX_OFFSET = 0xffff;
+        private static final int HASH_LOG = 12;
+
+        private static final ThreadLocal<int[]> pooledHashTable = new ThreadLocal<int[]>() {
+            @Override
+            protected int[] initialValue() {
+                return new int[1 << HASH_LOG];
+            }
+        };
+
+        @Override
+        int getCookieBase() {
+            return V2FastCompressedEncodingCookieBase;
+        }
+
+        @Override
+        int getMaxCompressedLength(final int sourceLength) {
+            return 4 + sourceLength + (sourceLength / 255) + 16;
+        }
+
+        private static int readInt(final byte[] array, final int offset) {
+            return ((array[offset] & 0xff) << 24) | ((array[offset + 1] & 0xff) << 16) |
+                    ((array[offset + 2] & 0xff) << 8) | (array[offset + 3] & 0xff);
+        }
+
+        private static int hash(final int sequence) {
+            return (sequence * -1640531535) >>> (32 - HASH_LOG);
+        }
+
+        private static int putLengthExtension(final byte[] target, int position, int remainingLength) {
+            while (remainingLength >= 255) {
+                target[position++] = (byte) 255;
+                remainingLength -= 255;
+            }
+            target[position++] = (byte) remainingLength;
+            return position;
+        }
+
+        private static int putSequence(final byte[] target, int position,
+                                       final byte[] source, final int literalsOffset, final int literalsLength,
+                                       final int matchOffset, final int matchLength) {
+            final int tokenPosition = position++;
+            int token = Math.min(literalsLength, 15) << 4;
+            if (literalsLength >= 15) {
+                position = putLengthExtension(target, position, literalsLength - 15);
+            }
+            System.arraycopy(source, literalsOffset, target, position, literalsLength);
+            position += literalsLength;
+            if (matchLength > 0) {
+                target[position++] = (byte) matchOffset;
+                target[position++] = (byte) (matchOffset >>> 8);
+                final int encodedMatchLength = matchLength - MIN_MATCH;
+                token |= Math.min(encodedMatchLength, 15);
+                if (encodedMatchLength >= 15) {
+                    position = putLengthExtension(target, position, encodedMatchLength - 15);
+                }
+            }
+            target[tokenPosition] = (byte) token;
+            return position;
+        }
+
+        @Override
+        int compress(final byte[] source, final int sourceOffset, final int sourceLength,
+                     final byte[] target, final int targetOffset, final int targetLength) {
+            if (targetLength < getMaxCompressedLength(sourceLength)) {
+                throw new ArrayIndexOutOfBoundsException("target does not have capacity for " +
+                        getMaxCompressedLength(sourceLength) + " bytes");
+            }
+            final int[] hashTable = pooledHashTable.get();
+            Arrays.fill(hashTable, -1);
+
+            int position = targetOffset;
+            target[position++] = (byte) (sourceLength >>> 24);
+            target[position++] = (byte) (sourceLength >>> 16);
+            target[position++] = (byte) (sourceLength >>> 8);
+            target[position++] = (byte) sourceLength;
+
+            final int sourceEnd = sourceOffset + sourceLength;
+            final int matchSearchLimit = sourceEnd - MIN_MATCH;
+            int anchor = sourceOffset;
+            int index = sourceOffset;
+            while (index <= matchSearchLimit) {
+                final int sequence = readInt(source, index);
+                final int hashIndex = hash(sequence);
+                final int candidate = hashTable[hashIndex];
+                hashTable[hashIndex] = index;
+                if ((candidate >= 0) && (index - candidate <= MAX_OFFSET) &&
+                        (readInt(source, candidate) == sequence)) {
+                    int matchLength = MIN_MATCH;
+                    while ((index + matchLength < sourceEnd) &&
+                            (source[candidate + matchLength] == source[index + matchLength])) {
+                        matchLength++;
+                    }
+                    position = putSequence(target, position, source, anchor, index - anchor,
+                            index - candidate, matchLength);
+                    index += matchLength;
+                    anchor = index;
+                } else {
+                    index++;
+                }
+            }
+            // Last sequence holds the remaining literals, and no match:
+            position = putSequence(target, position, source, anchor, sourceEnd - anchor, 0, 0);
+            return position - targetOffset;
+        }
+
+        private static int getLengthExtension(final byte[] source, final int[] position, final int end)
+                throws DataFormatException {
+            int length = 0;
+            int b;
+            do {
+                if (position[0] >= end) {
+                    throw new DataFormatException("Truncated length in compressed contents");
+                }
+                b = source[position[0]++] & 0xff;
+                length += b;
+            } while (b == 255);
+            return length;
+        }
+
+        @Override
+        ByteBuffer decompress(final ByteBuffer source, final int contentsLength) throws DataFormatException {
+            final byte[] sourceArray;
+            final int sourceOffset;
+            if (source.hasArray()) {
+                sourceArray = source.array();
+                sourceOffset = source.arrayOffset() + source.position();
+            } else {
+                sourceArray = arrayOf(source, contentsLength);
+                sourceOffset = 0;
+            }
+            if (contentsLength < 5) {
+                throw new DataFormatException("Compressed contents are too short");
+            }
+            final int end = sourceOffset + contentsLength;
+            final int uncompressedLength = readInt(sourceArray, sourceOffset);
+            if (uncompressedLength < 0) {
+                throw new DataFormatException("Invalid uncompressed length: " + uncompressedLength);
+            }
+            final byte[] contents = new byte[uncompressedLength];
+            final int[] position = {sourceOffset + 4};
+            int outputPosition = 0;
+            while (position[0] < end) {
+                final int token = sourceArray[position[0]++] & 0xff;
+                int literalsLength = token >>> 4;
+                if (literalsLength == 15) {
+                    literalsLength += getLengthExtension(sourceArray, position, end);
+                }
+                if ((literalsLength > end - position[0]) ||
+                        (literalsLength > uncompressedLength - outputPosition)) {
+                    throw new DataFormatException("Literal run overflows compressed contents");
+                }
+                System.arraycopy(sourceArray, position[0], contents, outputPosition, literalsLength);
+                position[0] += literalsLength;
+                outputPosition += literalsLength;
+                if (position[0] >= end) {
+                    break; // The last sequence has no match
+                }
+                if (position[0] + 2 > end) {
+                    throw new DataFormatException("Truncated match offset in compressed contents");
+                }
+                final int matchOffset =
+                        (sourceArray[position[0]] & 0xff) | ((sourceArray[position[0] + 1] & 0xff) << 8);
+                position[0] += 2;
+                int matchLength = token & 0xf;
+                if (matchLength == 15) {
+                    matchLength += getLengthExtension(sourceArray, position, end);
+                }
+                matchLength += MIN_MATCH;
+                if ((matchOffset == 0) || (matchOffset > outputPosition) ||
+                        (matchLength > uncompressedLength - outputPosition)) {
+                    throw new DataFormatException("Invalid match in compressed contents");
+                }
+                // Matches may overlap their own output, so copy byte by byte:
+                int matchPosition = outputPosition - matchOffset;
+                for (int i = 0; i < matchLength; i++) {
+                    contents[outputPosition++] = contents[matchPosition++];
+                }
+            }
+            if (outputPosition != uncompressedLength) {
+                throw new DataFormatException("Compressed contents do not match their indicated length");
+            }
+            return ByteBuffer.wrap(contents).order(BIG_ENDIAN);
+        }
+    }
+
+    //  ##    ##  #######  ##    ## ########
+    //  ###   ## ##     ## ###   ## ##
+    //  ####  ## ##     ## ####  ## ##
+    //  ## ## ## ##     ## ## ## ## ######
+    //  ##  #### ##     ## ##  #### ##
+    //  ##   ### ##     ## ##   ### ##
+    //  ##    ##  #######  ##    ## ########
+
+    private static class NonCompressingCodec extends HistogramCompressionCodec {
+        @Override
+        int getCookieBase() {
+            return V2NonCompressedEncodingCookieBase;
+        }
+
+        @Override
+        int getMaxCompressedLength(final int sourceLength) {
+            return sourceLength;
+        }
+
+        @Override
+        int compress(final byte[] source, final int sourceOffset, final int sourceLength,
+                     final byte[] target, final int targetOffset, final int targetLength) {
+            if (targetLength < sourceLength) {
+                throw new ArrayIndexOutOfBoundsException("target does not have capacity for " +
+                        sourceLength + " bytes");
+            }
+            System.arraycopy(source, sourceOffset, target, targetOffset, sourceLength);
+            return sourceLength;
+        }
+
+        @Override
+        ByteBuffer decompress(final ByteBuffer source, final int contentsLength) {
+            // No copy needed: decode directly from the framed contents.
+            final ByteBuffer contents = source.slice().order(BIG_ENDIAN);
+            contents.limit(contentsLength);
+            return contents;
+        }
+    }
+}
@@ -0,0 +1,247 @@
+/**
+ * Written by Gil Tene of Azul Systems, and released to the public domain,
+ * as explained at http://creativecommons.org/publicdomain/zero/1.0/
+ *
+ * @author Gil Tene
+ */
+
+package org.HdrHistogram;
+
+import java.util.concurrent.ConcurrentHashMap;
+
+/**
+ * The immutable bucket geometry of a histogram's counts array: its unit magnitude, sub-bucket counts and masks,
+ * bucket count and counts array length, along with precomputed tables used to translate counts array indexes
+ * into values.
+ * <p>
+ * Layouts are interned by (numberOfSignificantValueDigits, unit magnitude, bucket count), which are all that the
+ * length and meaning of a counts array depend on. All histograms whose counts arrays are laid out the same (and in
+ * particular, all histograms with the same lowestDiscernibleValue, highestTrackableValue and
+ * numberOfSignificantValueDigits) share a single layout instance, and can recognize each other with a reference
+ * comparison. Looking up an interned layout also saves constructing histograms from re-deriving their geometry.
+ * <p>
+ * The value tables hold an entry per half-bucket (rather than per counts array slot), which keeps them small
+ * enough to stay cache resident: the lowest value in the half-bucket, and the binary magnitude of the value
+ * steps between its slots, which is also the magnitude of each of its slots' equivalent value range.
+ */
+final class HistogramLayout {
+    private static final ConcurrentHashMap<Integer, HistogramLayout> internedLayouts =
+            new ConcurrentHashMap<Integer, HistogramLayout>();
+
+    // The sub-bucket count magnitudes for 0 to 5 significant value digits:
+    private static final int[] subBucketCountMagnitudes = new int[6];
+
+    static {
+        for (int digits = 0; digits < subBucketCountMagnitudes.length; digits++) {
+            /*
+             * Given a 3 decimal point accuracy, the expectation is obviously for "+/- 1 unit at 1000". It also means
+             * that it's "ok to be +/- 2 units at 2000". The "tricky" thing is that it is NOT ok to be +/- 2 units at
+             * 1999. Only starting at 2000. So internally, we need to maintain single unit resolution to 2x
+             * 10^decimalPoints.
+             */
+            final long largestValueWithSingleUnitResolution = 2 * (long) Math.pow(10, digits);
+            // We need to maintain power-of-two subBucketCount (for clean direct indexing) that is large enough to
+            // provide unit resolution to at least largestValueWithSingleUnitResolution. So figure out
+            // largestValueWithSingleUnitResolution's nearest power-of-two (rounded up), and use that:
+            subBucketCountMagnitudes[digits] =
+                    (int) Math.ceil(Math.log(largestValueWithSingleUnitResolution)/Math.log(2));
+        }
+    }
+
+    final int numberOfSignificantValueDigits;
+    /**
+     * Largest k such that 2^k &lt;= lowestDiscernibleValue
+     */
+    final int unitMagnitude;
+    /**
+     * Lowest unitMagnitude bits are set
+     */
+    final long unitMagnitudeMask;
+    final int subBucketCountMagnitude;
+    final int subBucketHalfCountMagnitude;
+    final int subBucketCount;
+    final int subBucketHalfCount;
+    /**
+     * Biggest value that can fit in bucket 0
+     */
+    final long subBucketMask;
+    /**
+     * Number of leading zeros in the largest value that can fit in bucket 0.
+     */
+    final int leadingZeroCountBase;
+    final int bucketCount;
+    final int countsArrayLength;
+
+    // Per half-bucket of the counts array (and the two half-buckets just past its end, which iterators peek into):
+    private final long[] halfBucketBaseValues;
+    private final int[] halfBucketValueShifts;
+
+    private HistogramLayout(final int numberOfSignificantValueDigits, final int unitMagnitude,
+                            final int bucketCount) {
+        if ((numberOfSignificantValueDigits < 0) || (numberOfSignificantValueDigits > 5)) {
+            throw new IllegalArgumentException("numberOfSignificantValueDigits must be between 0 and 5");
+        }
+        this.numberOfSignificantValueDigits = numberOfSignificantValueDigits;
+        this.unitMagnitude = unitMagnitude;
+        unitMagnitudeMask = (1 << unitMagnitude) - 1;
+
+        subBucketCountMagnitude = subBucketCountMagnitudes[numberOfSignificantValueDigits];
+        if ((unitMagnitude < 0) || (subBucketCountMagnitude + unitMagnitude > 62)) {
+            // subBucketCount entries can't be represented, with unitMagnitude applied, in a positive long.
+            // Technically it still sort of works if their sum is 63: you can represent all but the last number
+            // in the shifted subBucketCount. However, the utility of such a histogram vs ones whose magnitude here
+            // fits in 62 bits is debatable, and it makes it harder to work through the logic.
+            // Sums larger than 64 are totally broken as leadingZeroCountBase would go negative.
+            throw new IllegalArgumentException("Cannot represent numberOfSignificantValueDigits worth of values " +
+                    "beyond lowestDiscernibleValue");
+        }
+        subBucketHalfCountMagnitude = subBucketCountMagnitude - 1;
+        subBucketCount = 1 << subBucketCountMagnitude;
+        subBucketHalfCount = subBucketCount / 2;
+        subBucketMask = ((long) subBucketCount - 1) << unitMagnitude;
+
+        // Establish leadingZeroCountBase, used in getBucketIndex() fast path:
+        // subtract the bits that would be used by the largest value in bucket 0.
+        leadingZeroCountBase = 64 - unitMagnitude - subBucketCountMagnitude;
+
+        this.bucketCount = bucketCount;
+        countsArrayLength = (bucketCount + 1) * subBucketHalfCount;
+
+        final int numberOfHalfBuckets = bucketCount + 3;
+        halfBucketBaseValues = new long[numberOfHalfBuckets];
+        halfBucketValueShifts = new int[numberOfHalfBuckets];
+        for (int halfBucketIndex = 0; halfBucketIndex < numberOfHalfBuckets; halfBucketIndex++) {
+            halfBucketValueShifts[halfBucketIndex] = halfBucketValueShift(halfBucketIndex);
+            halfBucketBaseValues[halfBucketIndex] =
+                    halfBucketBaseValue(halfBucketIndex, halfBucketValueShifts[halfBucketIndex]);
+        }
+    }
+
+    /**
+     * Get the (interned) layout for a given precision, unit magnitude and bucket count.
+     *
+     * @param numberOfSignificantValueDigits The number of significant decimal digits (between 0 and 5)
+     * @param unitMagnitude The unit magnitude (see {@link #unitMagnitude(long)})
+     * @param bucketCount The number of buckets
+     * @return the layout
+     * @throws IllegalArgumentException if the precision and unit magnitude cannot be represented
+     */
+    static HistogramLayout get(final int numberOfSignificantValueDigits, final int unitMagnitude,
+                               final int bucketCount) {
+        // Valid precisions, unit magnitudes, and bucket counts each fit in (well under) 8 bits, and invalid ones
+        // never make it into the map (the constructor rejects them):
+        final Integer key = ((numberOfSignificantValueDigits & 0xff) << 16) | ((unitMagnitude & 0xff) << 8) |
+                (bucketCount & 0xff);
+        HistogramLayout layout = internedLayouts.get(key);
+        if (layout == null) {
+            final HistogramLayout newLayout =
+                    new HistogramLayout(numberOfSignificantValueDigits, unitMagnitude, bucketCount);
+            layout = internedLayouts.putIfAbsent(key, newLayout);
+            if (layout == null) {
+                layout = newLayout;
+            }
+        }
+        return layout;
+    }
+
+    /**
+     * Get the (interned) layout covering a given value range with a given precision.
+     *
+     * @param lowestDiscernibleValue The lowest value that can be discerned (distinguished from 0)
+     * @param highestTrackableValue The highest value to be tracked
+     * @param numberOfSignificantValueDigits The number of significant decimal digits (between 0 and 5)
+     * @return the layout
+     * @throws IllegalArgumentException if the precision and unit magnitude cannot be represented
+     */
+    static HistogramLayout forValueRange(final long lowestDiscernibleValue, final long highestTrackableValue,
+                                         final int numberOfSignificantValueDigits) {
+        return get(numberOfSignificantValueDigits, unitMagnitude(lowestDiscernibleValue), 1)
+                .withBucketCountCovering(highestTrackableValue);
+    }
+
+    /**
+     * Get the (interned) layout with this layout's precision and unit magnitude, and enough buckets to cover
+     * a given value.
+     *
+     * @param value The value to cover
+     * @return the layout
+     */
+    HistogramLayout withBucketCountCovering(final long value) {
+        final int bucketsNeeded = getBucketsNeededToCoverValue(value);
+        return (bucketsNeeded == bucketCount) ? this :
+                get(numberOfSignificantValueDigits, unitMagnitude, bucketsNeeded);
+    }
+
+    /**
+     * @return the largest k such that 2^k &lt;= lowestDiscernibleValue
+     */
+    static int unitMagnitude(final long lowestDiscernibleValue) {
+        return (int) (Math.log(lowestDiscernibleValue)/Math.log(2));
+    }
+
+    /**
+     * @return the sub-bucket count for a number of significant decimal digits (between 0 and 5)
+     */
+    static int subBucketCount(final int numberOfSignificantValueDigits) {
+        return 1 << subBucketCountMagnitudes[numberOfSignificantValueDigits];
+    }
+
+    int getBucketsNeededToCoverValue(final long value) {
+        // Shift won't overflow because subBucketMagnitude + unitMagnitude <= 62.
+        // the k'th bucket can express from 0 * 2^k to subBucketCount * 2^k in units of 2^k
+        long smallestUntrackableValue = ((long) subBucketCount) << unitMagnitude;
+
+        // always have at least 1 bucket
+        int bucketsNeeded = 1;
+        while (smallestUntrackableValue <= value) {
+            if (smallestUntrackableValue > (Long.MAX_VALUE / 2)) {
+                // next shift will overflow, meaning that bucket could represent values up to ones greater than
+                // Long.MAX_VALUE, so it's the last bucket
+                return bucketsNeeded + 1;
+            }
+            smallestUntrackableValue <<= 1;
+            bucketsNeeded++;
+        }
+        return bucketsNeeded;
+    }
+
+    /**
+     * Get the lowest value that maps to a given counts array index.
+     *
+     * @param index The counts array index
+     * @return the lowest value that maps to the index
+     */
+    long valueFromIndex(final int index) {
+        final int halfBucketIndex = index >> subBucketHalfCountMagnitude;
+        final long offsetInHalfBucket = index & (subBucketHalfCount - 1);
+        if ((halfBucketIndex >= 0) && (halfBucketIndex < halfBucketValueShifts.length)) {
+            return halfBucketBaseValues[halfBucketIndex] +
+                    (offsetInHalfBucket << halfBucketValueShifts[halfBucketIndex]);
+        }
+        final int valueShift = halfBucketValueShift(halfBucketIndex);
+        return halfBucketBaseValue(halfBucketIndex, valueShift) + (offsetInHalfBucket << valueShift);
+    }
+
+    /**
+     * Get the highest value that maps to a given counts array index.
+     *
+     * @param index The counts array index
+     * @return the highest value that maps to the index
+     */
+    long highestEquivalentValueAtIndex(final int index) {
+        final int halfBucketIndex = index >> subBucketHalfCountMagnitude;
+        final int valueShift = ((halfBucketIndex >= 0) && (halfBucketIndex < halfBucketValueShifts.length)) ?
+                halfBucketValueShifts[halfBucketIndex] : halfBucketValueShift(halfBucketIndex);
+        return valueFromIndex(index) + (1L << valueShift) - 1;
+    }
+
+    private int halfBucketValueShift(final int halfBucketIndex) {
+        // The lower half of bucket 0 shares bucket 0's unit, while every other half-bucket is the top half of
+        // bucket (halfBucketIndex - 1):
+        return ((halfBucketIndex > 0) ? (halfBucketIndex - 1) : 0) + unitMagnitude;
+    }
+
+    private long halfBucketBaseValue(final int halfBucketIndex, final int valueShift) {
+        return (halfBucketIndex > 0) ? (((long) subBucketHalfCount) << valueShift) : 0;
+    }
+}
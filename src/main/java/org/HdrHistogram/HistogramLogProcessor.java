@@ -7,10 +7,14 @@
 
 package org.HdrHistogram;
 
-import java.io.FileNotFoundException;
-import java.io.FileOutputStream;
-import java.io.PrintStream;
+import java.io.*;
 import java.util.*;
+import java.util.concurrent.Callable;
+import java.util.concurrent.ExecutionException;
+import java.util.concurrent.ExecutorService;
+import java.util.concurrent.Executors;
+import java.util.concurrent.Future;
+import java.util.zip.DataFormatException;
 
 /**
  * {@link org.HdrHistogram.HistogramLogProcessor} will process an input log and
@@ -48,6 +52,16 @@ import java.util.*;
  * HistogramLogProcessor also accepts and optional -csv parameter, which
  * will cause the output formatting (of both output file forms) to use
  * a CSV file format.
+ * <p>
+ * When provided with a -threads parameter larger than 1 (and an input file
+ * name via -i), HistogramLogProcessor will process the log in parallel: the
+ * input file is split into chunks on line boundaries, interval histograms are
+ * decoded and accumulated by a pool of worker threads, and the interval lines
+ * are then output in their original order. Parallel processing holds all the
+ * interval histograms in the selected range in memory. For logs of
+ * DoubleHistograms, accumulated totals may differ from those of sequential
+ * processing within the precision of the histograms (as totals are
+ * accumulated in a different order).
  */
 public class HistogramLogProcessor extends Thread {
 
@@ -79,6 +93,8 @@ public class HistogramLogProcessor extends Thread {
 
         double expectedIntervalForCoordinatedOmissionCorrection = 0.0;
 
+        int numberOfThreads = 1;
+
         String errorMessage = "";
 
         HistogramLogProcessorConfiguration(final String[] args) {
@@ -116,6 +132,8 @@ public class HistogramLogProcessor extends Thread {
                     } else if (args[i].equals("-correctLogWithKnownCoordinatedOmission")) {
                         expectedIntervalForCoordinatedOmissionCorrection =
                                 Double.parseDouble(args[++i]);  // lgtm [java/index-out-of-bounds]
+                    } else if (args[i].equals("-threads")) {
+                        numberOfThreads = Integer.parseInt(args[++i]);          // lgtm [java/index-out-of-bounds]
                     } else if (args[i].equals("-h")) {
                         askedForHelp = true;
                         throw new Exception("Help: " + args[i]);
@@ -123,6 +141,9 @@ public class HistogramLogProcessor extends Thread {
                         throw new Exception("Invalid args: " + args[i]);
                     }
                 }
+                if ((numberOfThreads > 1) && (inputFileName == null)) {
+                    throw new Exception("Parallel processing (-threads) requires an input file (-i)");
+                }
             } catch (Exception e) {
                 errorMessage = "Error: " + versionString + " launched with the following args:\n";
 
@@ -137,7 +158,8 @@ public class HistogramLogProcessor extends Thread {
                 final String validArgs =
                         "\"[-csv] [-v] [-i inputFileName] [-o outputFileName] [-tag tag] " +
                                 "[-start rangeStartTimeSec] [-end rangeEndTimeSec] " +
-                                "[-outputValueUnitRatio r] [-correctLogWithKnownCoordinatedOmission i] [-listtags]";
+                                "[-outputValueUnitRatio r] [-correctLogWithKnownCoordinatedOmission i] [-listtags] " +
+                                "[-threads n]";
 
                 System.err.println("valid arguments = " + validArgs);
 
@@ -158,7 +180,8 @@ public class HistogramLogProcessor extends Thread {
                             "                                              value i (in whatever units the log histograms were recorded with). This\n" +
                             "                                              feature should only be used when the input log is known to have been\n" +
                             "                                              recorded with coordinated omissions, and when an expected interval is known.\n" +
-                            " [-listtags]                                  list all tags found on histogram lines the input file."
+                            " [-listtags]                                  list all tags found on histogram lines the input file.\n" +
+                            " [-threads n]                                 Process the input file in parallel, using n worker threads (default 1)"
                 );
                 System.exit(1);
             }
@@ -175,11 +198,141 @@ public class HistogramLogProcessor extends Thread {
         log.format(" seconds (relative to StartTime)]\n");
     }
 
-    private void outputStartTime(final PrintStream log, final Double startTime) {
-        log.format(Locale.US, "#[StartTime: %.3f (seconds since epoch), %s]\n",
+    private void outputStartTime(final Appendable log, final Double startTime) {
+        new Formatter(log).format(Locale.US, "#[StartTime: %.3f (seconds since epoch), %s]\n",
                 startTime, (new Date((long) (startTime * 1000))).toString());
     }
 
+    /**
+     * Formats interval log and moving window log lines (and their legends) to their [optional] destinations.
+     */
+    private class IntervalLogFormatter {
+        private final Formatter timeIntervalLog;
+        private final Formatter movingWindowLog;
+        private boolean timeIntervalLogLegendWritten;
+        private boolean movingWindowLogLegendWritten;
+
+        private final String logFormat;
+        private final String movingWindowLogFormat;
+
+        // Percentiles reported per interval line, resolved in a single pass per histogram:
+        private final double[] intervalPercentiles = {50.0, 90.0};
+        private final double[] totalPercentiles = {50.0, 90.0, 99.0, 99.9, 99.99};
+        private final long[] intervalValues = new long[intervalPercentiles.length];
+        private final long[] totalValues = new long[totalPercentiles.length];
+        private final double[] intervalDoubleValues = new double[intervalPercentiles.length];
+        private final double[] totalDoubleValues = new double[totalPercentiles.length];
+
+        IntervalLogFormatter(final Appendable timeIntervalLog, final Appendable movingWindowLog,
+                             final boolean legendsWritten) {
+            this.timeIntervalLog = (timeIntervalLog != null) ? new Formatter(timeIntervalLog) : null;
+            this.movingWindowLog = (movingWindowLog != null) ? new Formatter(movingWindowLog) : null;
+            timeIntervalLogLegendWritten = legendsWritten;
+            movingWindowLogLegendWritten = legendsWritten;
+            if (config.logFormatCsv) {
+                logFormat = "%.3f,%d,%.3f,%.3f,%.3f,%d,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f\n";
+                movingWindowLogFormat = "%.3f,%d,%.3f,%.3f\n";
+            } else {
+                logFormat = "%4.3f: I:%d ( %7.3f %7.3f %7.3f ) T:%d ( %7.3f %7.3f %7.3f %7.3f %7.3f %7.3f )\n";
+                movingWindowLogFormat = "%4.3f: I:%d P:%7.3f M:%7.3f\n";
+            }
+        }
+
+        void outputIntervalLine(final EncodableHistogram intervalHistogram,
+                                final EncodableHistogram accumulatedHistogram,
+                                final double startTimeSec) {
+            if (timeIntervalLog == null) {
+                return;
+            }
+            if (!timeIntervalLogLegendWritten) {
+                timeIntervalLogLegendWritten = true;
+                if (config.logFormatCsv) {
+                    timeIntervalLog.format("%s%n", "\"Timestamp\",\"Int_Count\",\"Int_50%\",\"Int_90%\",\"Int_Max\",\"Total_Count\"," +
+                            "\"Total_50%\",\"Total_90%\",\"Total_99%\",\"Total_99.9%\",\"Total_99.99%\",\"Total_Max\"");
+                } else {
+                    timeIntervalLog.format("%s%n", "Time: IntervalPercentiles:count ( 50% 90% Max ) TotalPercentiles:count ( 50% 90% 99% 99.9% 99.99% Max )");
+                }
+            }
+
+            if (intervalHistogram instanceof DoubleHistogram) {
+                final DoubleHistogram accumulatedDoubleHistogram = (DoubleHistogram) accumulatedHistogram;
+                ((DoubleHistogram) intervalHistogram).getValuesAtPercentiles(
+                        intervalPercentiles, intervalDoubleValues);
+                accumulatedDoubleHistogram.getValuesAtPercentiles(totalPercentiles, totalDoubleValues);
+                timeIntervalLog.format(Locale.US, logFormat,
+                        ((intervalHistogram.getEndTimeStamp() / 1000.0) - startTimeSec),
+                        // values recorded during the last reporting interval
+                        ((DoubleHistogram) intervalHistogram).getTotalCount(),
+                        intervalDoubleValues[0] / config.outputValueUnitRatio,
+                        intervalDoubleValues[1] / config.outputValueUnitRatio,
+                        ((DoubleHistogram) intervalHistogram).getMaxValue() / config.outputValueUnitRatio,
+                        // values recorded from the beginning until now
+                        accumulatedDoubleHistogram.getTotalCount(),
+                        totalDoubleValues[0] / config.outputValueUnitRatio,
+                        totalDoubleValues[1] / config.outputValueUnitRatio,
+                        totalDoubleValues[2] / config.outputValueUnitRatio,
+                        totalDoubleValues[3] / config.outputValueUnitRatio,
+                        totalDoubleValues[4] / config.outputValueUnitRatio,
+                        accumulatedDoubleHistogram.getMaxValue() / config.outputValueUnitRatio
+                );
+            } else {
+                final Histogram accumulatedRegularHistogram = (Histogram) accumulatedHistogram;
+                ((Histogram) intervalHistogram).getValuesAtPercentiles(intervalPercentiles, intervalValues);
+                accumulatedRegularHistogram.getValuesAtPercentiles(totalPercentiles, totalValues);
+                timeIntervalLog.format(Locale.US, logFormat,
+                        ((intervalHistogram.getEndTimeStamp() / 1000.0) - startTimeSec),
+                        // values recorded during the last reporting interval
+                        ((Histogram) intervalHistogram).getTotalCount(),
+                        intervalValues[0] / config.outputValueUnitRatio,
+                        intervalValues[1] / config.outputValueUnitRatio,
+                        ((Histogram) intervalHistogram).getMaxValue() / config.outputValueUnitRatio,
+                        // values recorded from the beginning until now
+                        accumulatedRegularHistogram.getTotalCount(),
+                        totalValues[0] / config.outputValueUnitRatio,
+                        totalValues[1] / config.outputValueUnitRatio,
+                        totalValues[2] / config.outputValueUnitRatio,
+                        totalValues[3] / config.outputValueUnitRatio,
+                        totalValues[4] / config.outputValueUnitRatio,
+                        accumulatedRegularHistogram.getMaxValue() / config.outputValueUnitRatio
+                );
+            }
+        }
+
+        void outputMovingWindowLine(final EncodableHistogram intervalHistogram,
+                                    final EncodableHistogram movingWindowSumHistogram,
+                                    final double startTimeSec) {
+            if (movingWindowLog == null) {
+                return;
+            }
+            if (!movingWindowLogLegendWritten) {
+                movingWindowLogLegendWritten = true;
+                if (config.logFormatCsv) {
+                    movingWindowLog.format("%s%n", "\"Timestamp\",\"Window_Count\",\"" +
+                            config.movingWindowPercentileToReport +"%'ile\",\"Max\"");
+                } else {
+                    movingWindowLog.format("%s%n", "Time: WindowCount " + config.movingWindowPercentileToReport + "%'ile Max");
+                }
+            }
+            if (intervalHistogram instanceof DoubleHistogram) {
+                movingWindowLog.format(Locale.US, movingWindowLogFormat,
+                        ((intervalHistogram.getEndTimeStamp() / 1000.0) - startTimeSec),
+                        // values recorded during the last reporting interval
+                        ((DoubleHistogram) movingWindowSumHistogram).getTotalCount(),
+                        ((DoubleHistogram) movingWindowSumHistogram).getValueAtPercentile(config.movingWindowPercentileToReport) / config.outputValueUnitRatio,
+                        ((DoubleHistogram) movingWindowSumHistogram).getMaxValue() / config.outputValueUnitRatio
+                );
+            } else {
+                movingWindowLog.format(Locale.US, movingWindowLogFormat,
+                        ((intervalHistogram.getEndTimeStamp() / 1000.0) - startTimeSec),
+                        // values recorded during the last reporting interval
+                        ((Histogram) movingWindowSumHistogram).getTotalCount(),
+                        ((Histogram) movingWindowSumHistogram).getValueAtPercentile(config.movingWindowPercentileToReport) / config.outputValueUnitRatio,
+                        ((Histogram) movingWindowSumHistogram).getMaxValue() / config.outputValueUnitRatio
+                );
+            }
+        }
+    }
+
     EncodableHistogram copyCorrectedForCoordinatedOmission(final EncodableHistogram inputHistogram) {
         EncodableHistogram histogram = inputHistogram;
         if (histogram instanceof DoubleHistogram) {
@@ -243,8 +396,6 @@ public class HistogramLogProcessor extends Thread {
         PrintStream movingWindowLog = null;
         PrintStream histogramPercentileLog = System.out;
         double firstStartTime = 0.0;
-        boolean timeIntervalLogLegendWritten = false;
-        boolean movingWindowLogLegendWritten = false;
 
         Queue<EncodableHistogram> movingWindowQueue = new LinkedList<>();
 
@@ -271,16 +422,6 @@ public class HistogramLogProcessor extends Thread {
             return;
         }
 
-        final String logFormat;
-        final String movingWindowLogFormat;
-        if (config.logFormatCsv) {
-            logFormat = "%.3f,%d,%.3f,%.3f,%.3f,%d,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f\n";
-            movingWindowLogFormat = "%.3f,%d,%.3f,%.3f\n";
-        } else {
-            logFormat = "%4.3f: I:%d ( %7.3f %7.3f %7.3f ) T:%d ( %7.3f %7.3f %7.3f %7.3f %7.3f %7.3f )\n";
-            movingWindowLogFormat = "%4.3f: I:%d P:%7.3f M:%7.3f\n";
-        }
-
         try {
             if (config.outputFileName != null) {
                 try {
@@ -308,6 +449,18 @@ public class HistogramLogProcessor extends Thread {
                 }
             }
 
+            if (config.numberOfThreads > 1) {
+                try {
+                    processInParallel(timeIntervalLog, movingWindowLog, histogramPercentileLog);
+                } catch (InterruptedException ex) {
+                    Thread.currentThread().interrupt();
+                }
+                return;
+            }
+
+            final IntervalLogFormatter intervalLogFormatter =
+                    new IntervalLogFormatter(timeIntervalLog, movingWindowLog, false);
+
             EncodableHistogram intervalHistogram = getIntervalHistogram(config.tag);
             boolean logUsesDoubleHistograms = (intervalHistogram instanceof DoubleHistogram);
 
@@ -328,7 +481,6 @@ public class HistogramLogProcessor extends Thread {
                     new DoubleHistogram(3) :
                     new Histogram(3);
 
-
             while (intervalHistogram != null) {
 
                 // handle accumulated histogram:
@@ -348,26 +500,14 @@ public class HistogramLogProcessor extends Thread {
                 // handle moving window:
                 if (config.movingWindow) {
                     // Add the current interval histogram to the moving window sums:
-                    if ((movingWindowSumHistogram instanceof DoubleHistogram) &&
-                            (intervalHistogram instanceof DoubleHistogram)){
-                        ((DoubleHistogram) movingWindowSumHistogram).add((DoubleHistogram) intervalHistogram);
-                    } else if ((movingWindowSumHistogram instanceof Histogram) &&
-                            (intervalHistogram instanceof Histogram)){
-                        ((Histogram) movingWindowSumHistogram).add((Histogram) intervalHistogram);
-                    }
+                    addToHistogram(movingWindowSumHistogram, intervalHistogram);
                     // Remove previous, now-out-of-window interval histograms from moving window:
                     EncodableHistogram head;
                     while (((head = movingWindowQueue.peek()) != null) &&
                             (head.getEndTimeStamp() <= windowCutOffTimeStamp)) {
                         EncodableHistogram prevHist = movingWindowQueue.remove();
-                        if (movingWindowSumHistogram instanceof DoubleHistogram) {
-                            if (prevHist != null) {
-                                ((DoubleHistogram) movingWindowSumHistogram).subtract((DoubleHistogram) prevHist);
-                            }
-                        } else if (movingWindowSumHistogram instanceof Histogram) {
-                            if (prevHist != null) {
-                                ((Histogram) movingWindowSumHistogram).subtract((Histogram) prevHist);
-                            }
+                        if (prevHist != null) {
+                            subtractFromHistogram(movingWindowSumHistogram, prevHist);
                         }
                     }
                     // Add interval histogram to moving window previous intervals memory:
@@ -384,104 +524,724 @@ public class HistogramLogProcessor extends Thread {
                     }
                 }
 
-                if (timeIntervalLog != null) {
-                    if (!timeIntervalLogLegendWritten) {
-                        timeIntervalLogLegendWritten = true;
-                        if (config.logFormatCsv) {
-                            timeIntervalLog.println("\"Timestamp\",\"Int_Count\",\"Int_50%\",\"Int_90%\",\"Int_Max\",\"Total_Count\"," +
-                                    "\"Total_50%\",\"Total_90%\",\"Total_99%\",\"Total_99.9%\",\"Total_99.99%\",\"Total_Max\"");
-                        } else {
-                            timeIntervalLog.println("Time: IntervalPercentiles:count ( 50% 90% Max ) TotalPercentiles:count ( 50% 90% 99% 99.9% 99.99% Max )");
+                intervalLogFormatter.outputIntervalLine(intervalHistogram,
+                        logUsesDoubleHistograms ? accumulatedDoubleHistogram : accumulatedRegularHistogram,
+                        logReader.getStartTimeSec());
+                intervalLogFormatter.outputMovingWindowLine(intervalHistogram, movingWindowSumHistogram,
+                        logReader.getStartTimeSec());
+
+                intervalHistogram = getIntervalHistogram(config.tag);
+            }
+
+            if (logUsesDoubleHistograms) {
+                accumulatedDoubleHistogram.outputPercentileDistribution(histogramPercentileLog,
+                        config.percentilesOutputTicksPerHalf, config.outputValueUnitRatio, config.logFormatCsv);
+            } else {
+                accumulatedRegularHistogram.outputPercentileDistribution(histogramPercentileLog,
+                        config.percentilesOutputTicksPerHalf, config.outputValueUnitRatio, config.logFormatCsv);
+            }
+        } finally {
+            if (timeIntervalLog != null) {
+                timeIntervalLog.close();
+            }
+            if (movingWindowLog != null) {
+                movingWindowLog.close();
+            }
+            if (histogramPercentileLog != System.out) {
+                histogramPercentileLog.close();
+            }
+        }
+    }
+
+    private static void addToHistogram(final EncodableHistogram histogram, final EncodableHistogram other) {
+        if (histogram instanceof DoubleHistogram) {
+            ((DoubleHistogram) histogram).add((DoubleHistogram) other);
+        } else {
+            ((Histogram) histogram).add((Histogram) other);
+        }
+    }
+
+    private static void subtractFromHistogram(final EncodableHistogram histogram, final EncodableHistogram other) {
+        if (histogram instanceof DoubleHistogram) {
+            ((DoubleHistogram) histogram).subtract((DoubleHistogram) other);
+        } else {
+            ((Histogram) histogram).subtract((Histogram) other);
+        }
+    }
+
+    private static EncodableHistogram copyForAccumulation(final EncodableHistogram histogram) {
+        if (histogram instanceof DoubleHistogram) {
+            DoubleHistogram copy = ((DoubleHistogram) histogram).copy();
+            copy.setAutoResize(true);
+            return copy;
+        } else {
+            Histogram copy = ((Histogram) histogram).copy();
+            copy.setAutoResize(true);
+            return copy;
+        }
+    }
+
+    private static EncodableHistogram newAccumulatedHistogram(final EncodableHistogram template) {
+        EncodableHistogram accumulatedHistogram = copyForAccumulation(template);
+        if (accumulatedHistogram instanceof DoubleHistogram) {
+            ((DoubleHistogram) accumulatedHistogram).reset();
+        } else {
+            ((Histogram) accumulatedHistogram).reset();
+        }
+        return accumulatedHistogram;
+    }
+
+    //
+    // Parallel processing:
+    //
+    // 1. The input file is split into chunks on line boundaries, and each chunk is scanned by a worker, which
+    //    notes start time and base time comments, and the timestamps of interval histogram lines (noting where in
+    //    the file the still encoded payloads of lines with the requested tag are, rather than keeping them, so
+    //    that memory use does not grow with the size of the log).
+    // 2. The chunk events are walked in order (cheaply) to establish the log's start and base times, and to select
+    //    the interval histograms within the requested time range, exactly as HistogramLogReader would. Only the
+    //    selected intervals are ever decoded (and corrected for coordinated omission).
+    // 3. The selected intervals are split into parts. The workers read back, decode and sum up each part (dropping
+    //    each decoded histogram once added), and each part's preceding total is then derived from the part sums (a
+    //    prefix sum over a small number of parts). When no interval or moving window logs are needed, the overall
+    //    total is a tree reduction of the part sums.
+    // 4. The workers read back and decode the intervals of each part again, and format their interval and moving
+    //    window log lines, starting from the part's preceding total (and re-establishing the moving window from the
+    //    preceding intervals). The formatted parts are then output in order.
+    //
+
+    private static final int START_TIME_EVENT = 0;
+    private static final int BASE_TIME_EVENT = 1;
+    private static final int INTERVAL_EVENT = 2;
+    private static final int END_OF_LOG_EVENT = 3;
+
+    private static final int MIN_CHUNK_LENGTH = 4096;
+    private static final int CHUNKS_PER_THREAD = 4;
+
+    /**
+     * An event found while scanning a chunk of the input log. Interval histogram payload locations (in the input
+     * file) are only noted for lines with the tag being processed, and are -1 otherwise.
+     */
+    private static class LogEvent {
+        final int type;
+        final double timeSec;
+        final double intervalLengthSec;
+        final String tag;
+        final long payloadOffset;
+        final int payloadLength;
+
+        LogEvent(final int type, final double timeSec, final double intervalLengthSec,
+                 final String tag, final long payloadOffset, final int payloadLength) {
+            this.type = type;
+            this.timeSec = timeSec;
+            this.intervalLengthSec = intervalLengthSec;
+            this.tag = tag;
+            this.payloadOffset = payloadOffset;
+            this.payloadLength = payloadLength;
+        }
+    }
+
+    /**
+     * A selected interval histogram (located by its still encoded payload in the input file), along with its time
+     * range and the log start time in effect when it was read.
+     */
+    private static class SelectedInterval {
+        final long payloadOffset;
+        final int payloadLength;
+        final String tag;
+        final long startTimeStampMsec;
+        final long endTimeStampMsec;
+        final double startTimeSec;
+
+        SelectedInterval(final long payloadOffset, final int payloadLength, final String tag,
+                         final long startTimeStampMsec, final long endTimeStampMsec, final double startTimeSec) {
+            this.payloadOffset = payloadOffset;
+            this.payloadLength = payloadLength;
+            this.tag = tag;
+            this.startTimeStampMsec = startTimeStampMsec;
+            this.endTimeStampMsec = endTimeStampMsec;
+            this.startTimeSec = startTimeSec;
+        }
+    }
+
+    /**
+     * The sum of a part of the selected intervals. When an interval in the part could not be decoded (or does
+     * not match the log's histogram type), the sum covers the intervals preceding it, and the failure (if it is
+     * not one that HistogramLogReader treats as the end of the log) is noted.
+     */
+    private static class PartSum {
+        final EncodableHistogram sum;
+        final int failedIndex;
+        final RuntimeException failure;
+        final boolean malformed;
+
+        PartSum(final EncodableHistogram sum, final int failedIndex, final RuntimeException failure,
+                final boolean malformed) {
+            this.sum = sum;
+            this.failedIndex = failedIndex;
+            this.failure = failure;
+            this.malformed = malformed;
+        }
+    }
+
+    /**
+     * The formatted log output of a part of the selected intervals.
+     */
+    private static class PartOutput {
+        final String timeIntervalLogText;
+        final String movingWindowLogText;
+        final EncodableHistogram accumulatedHistogram;
+
+        PartOutput(final String timeIntervalLogText, final String movingWindowLogText,
+                   final EncodableHistogram accumulatedHistogram) {
+            this.timeIntervalLogText = timeIntervalLogText;
+            this.movingWindowLogText = movingWindowLogText;
+            this.accumulatedHistogram = accumulatedHistogram;
+        }
+    }
+
+    /**
+     * An InputStream over the next [limit] bytes of another stream.
+     */
+    private static class BoundedInputStream extends FilterInputStream {
+        private long remaining;
+
+        BoundedInputStream(final InputStream in, final long limit) {
+            super(in);
+            remaining = limit;
+        }
+
+        @Override
+        public int read() throws IOException {
+            if (remaining <= 0) {
+                return -1;
+            }
+            int b = super.read();
+            if (b >= 0) {
+                remaining--;
+            }
+            return b;
+        }
+
+        @Override
+        public int read(final byte[] b, final int off, final int len) throws IOException {
+            if (remaining <= 0) {
+                return -1;
+            }
+            int bytesRead = super.read(b, off, (int) Math.min(len, remaining));
+            if (bytesRead > 0) {
+                remaining -= bytesRead;
+            }
+            return bytesRead;
+        }
+    }
+
+    private static <T> T getResult(final Future<T> future) throws InterruptedException {
+        try {
+            return future.get();
+        } catch (ExecutionException ex) {
+            Throwable cause = ex.getCause();
+            if (cause instanceof RuntimeException) {
+                throw (RuntimeException) cause;
+            } else if (cause instanceof Error) {
+                throw (Error) cause;
+            }
+            throw new RuntimeException(cause);
+        }
+    }
+
+    /**
+     * Split the input file into (at most) chunkCount chunks, with each chunk boundary at the start of a line.
+     */
+    private static long[] findChunkBoundaries(final File inputFile, final int chunkCount) throws IOException {
+        final long length = inputFile.length();
+        final long[] boundaries = new long[chunkCount + 1];
+        boundaries[chunkCount] = length;
+        final byte[] buffer = new byte[4096];
+        try (RandomAccessFile file = new RandomAccessFile(inputFile, "r")) {
+            for (int i = 1; i < chunkCount; i++) {
+                long position = Math.max(boundaries[i - 1], (length * i) / chunkCount);
+                // Advance to the start of the next line:
+                file.seek(position);
+                boolean foundLineEnd = false;
+                int bytesRead;
+                while (!foundLineEnd && ((bytesRead = file.read(buffer)) > 0)) {
+                    for (int j = 0; j < bytesRead; j++) {
+                        if (buffer[j] == '\n') {
+                            position += j + 1;
+                            foundLineEnd = true;
+                            break;
                         }
                     }
+                    if (!foundLineEnd) {
+                        position += bytesRead;
+                    }
+                }
+                boundaries[i] = Math.min(position, length);
+            }
+        }
+        return boundaries;
+    }
 
-                    if (logUsesDoubleHistograms) {
-                        timeIntervalLog.format(Locale.US, logFormat,
-                                ((intervalHistogram.getEndTimeStamp() / 1000.0) - logReader.getStartTimeSec()),
-                                // values recorded during the last reporting interval
-                                ((DoubleHistogram) intervalHistogram).getTotalCount(),
-                                ((DoubleHistogram) intervalHistogram).getValueAtPercentile(50.0) / config.outputValueUnitRatio,
-                                ((DoubleHistogram) intervalHistogram).getValueAtPercentile(90.0) / config.outputValueUnitRatio,
-                                ((DoubleHistogram) intervalHistogram).getMaxValue() / config.outputValueUnitRatio,
-                                // values recorded from the beginning until now
-                                accumulatedDoubleHistogram.getTotalCount(),
-                                accumulatedDoubleHistogram.getValueAtPercentile(50.0) / config.outputValueUnitRatio,
-                                accumulatedDoubleHistogram.getValueAtPercentile(90.0) / config.outputValueUnitRatio,
-                                accumulatedDoubleHistogram.getValueAtPercentile(99.0) / config.outputValueUnitRatio,
-                                accumulatedDoubleHistogram.getValueAtPercentile(99.9) / config.outputValueUnitRatio,
-                                accumulatedDoubleHistogram.getValueAtPercentile(99.99) / config.outputValueUnitRatio,
-                                accumulatedDoubleHistogram.getMaxValue() / config.outputValueUnitRatio
-                        );
+    private List<LogEvent> scanChunk(final long chunkStart, final long chunkEnd) throws IOException {
+        final List<LogEvent> events = new ArrayList<>();
+        try (FileInputStream inputStream = new FileInputStream(config.inputFileName)) {
+            inputStream.getChannel().position(chunkStart);
+            final HistogramLogScanner scanner =
+                    new HistogramLogScanner(new BoundedInputStream(inputStream, chunkEnd - chunkStart));
+            scanner.process(new HistogramLogScanner.EventHandler() {
+                @Override
+                public boolean onComment(String comment) {
+                    return false;
+                }
+
+                @Override
+                public boolean onBaseTime(double secondsSinceEpoch) {
+                    events.add(new LogEvent(BASE_TIME_EVENT, secondsSinceEpoch, 0.0, null, -1, 0));
+                    return false;
+                }
+
+                @Override
+                public boolean onStartTime(double secondsSinceEpoch) {
+                    events.add(new LogEvent(START_TIME_EVENT, secondsSinceEpoch, 0.0, null, -1, 0));
+                    return false;
+                }
+
+                @Override
+                public boolean onHistogram(String tag, double timestamp, double length,
+                                           HistogramLogScanner.EncodableHistogramSupplier lazyReader) {
+                    // Payloads are only read back and decoded once the interval is known to be selected:
+                    if ((config.tag == null) ? (tag == null) : config.tag.equals(tag)) {
+                        events.add(new LogEvent(INTERVAL_EVENT, timestamp, length, tag,
+                                chunkStart + scanner.getHistogramPayloadOffset(),
+                                scanner.getHistogramPayloadLength()));
                     } else {
-                        timeIntervalLog.format(Locale.US, logFormat,
-                                ((intervalHistogram.getEndTimeStamp() / 1000.0) - logReader.getStartTimeSec()),
-                                // values recorded during the last reporting interval
-                                ((Histogram) intervalHistogram).getTotalCount(),
-                                ((Histogram) intervalHistogram).getValueAtPercentile(50.0) / config.outputValueUnitRatio,
-                                ((Histogram) intervalHistogram).getValueAtPercentile(90.0) / config.outputValueUnitRatio,
-                                ((Histogram) intervalHistogram).getMaxValue() / config.outputValueUnitRatio,
-                                // values recorded from the beginning until now
-                                accumulatedRegularHistogram.getTotalCount(),
-                                accumulatedRegularHistogram.getValueAtPercentile(50.0) / config.outputValueUnitRatio,
-                                accumulatedRegularHistogram.getValueAtPercentile(90.0) / config.outputValueUnitRatio,
-                                accumulatedRegularHistogram.getValueAtPercentile(99.0) / config.outputValueUnitRatio,
-                                accumulatedRegularHistogram.getValueAtPercentile(99.9) / config.outputValueUnitRatio,
-                                accumulatedRegularHistogram.getValueAtPercentile(99.99) / config.outputValueUnitRatio,
-                                accumulatedRegularHistogram.getMaxValue() / config.outputValueUnitRatio
-                        );
+                        events.add(new LogEvent(INTERVAL_EVENT, timestamp, length, tag, -1, 0));
+                    }
+                    return false;
+                }
+
+                @Override
+                public boolean onException(Throwable t) {
+                    // HistogramLogReader stops reading at a truncated line:
+                    if (t instanceof NoSuchElementException) {
+                        events.add(new LogEvent(END_OF_LOG_EVENT, 0.0, 0.0, null, -1, 0));
+                        return true;
+                    }
+                    if (t instanceof RuntimeException) {
+                        throw (RuntimeException) t;
+                    } else {
+                        throw new RuntimeException(t);
+                    }
+                }
+            });
+        }
+        return events;
+    }
+
+    private List<List<LogEvent>> scanChunksInParallel(final ExecutorService executor)
+            throws InterruptedException {
+        final File inputFile = new File(config.inputFileName);
+        final int chunkCount = (int) Math.max(1, Math.min((long) config.numberOfThreads * CHUNKS_PER_THREAD,
+                inputFile.length() / MIN_CHUNK_LENGTH));
+        final List<List<LogEvent>> chunkEvents = new ArrayList<>(chunkCount);
+        try {
+            final long[] boundaries = findChunkBoundaries(inputFile, chunkCount);
+            final List<Future<List<LogEvent>>> futures = new ArrayList<>(chunkCount);
+            for (int i = 0; i < chunkCount; i++) {
+                final long chunkStart = boundaries[i];
+                final long chunkEnd = boundaries[i + 1];
+                futures.add(executor.submit(new Callable<List<LogEvent>>() {
+                    @Override
+                    public List<LogEvent> call() throws IOException {
+                        return scanChunk(chunkStart, chunkEnd);
+                    }
+                }));
+            }
+            for (int i = 0; i < chunkCount; i++) {
+                try {
+                    chunkEvents.add(getResult(futures.get(i)));
+                } catch (RuntimeException ex) {
+                    System.err.println("Log file parsing error in input between byte offsets " +
+                            boundaries[i] + " and " + boundaries[i + 1] + ": line appears to be malformed.");
+                    if (config.verbose) {
+                        throw ex;
+                    } else {
+                        System.exit(1);
+                    }
+                }
+            }
+        } catch (IOException ex) {
+            throw new RuntimeException(ex);
+        }
+        return chunkEvents;
+    }
+
+    /**
+     * Walk the scanned chunk events in order, establishing start and base times and selecting the interval
+     * histograms in the requested time range, with the same semantics as {@link HistogramLogReader}.
+     */
+    private List<SelectedInterval> selectIntervals(final List<List<LogEvent>> chunkEvents) {
+        final List<SelectedInterval> selectedIntervals = new ArrayList<>();
+        double startTimeSec = 0.0;
+        boolean observedStartTime = false;
+        double baseTimeSec = 0.0;
+        boolean observedBaseTime = false;
+        selection:
+        for (List<LogEvent> events : chunkEvents) {
+            for (LogEvent event : events) {
+                switch (event.type) {
+                    case START_TIME_EVENT:
+                        startTimeSec = event.timeSec;
+                        observedStartTime = true;
+                        break;
+                    case BASE_TIME_EVENT:
+                        baseTimeSec = event.timeSec;
+                        observedBaseTime = true;
+                        break;
+                    case END_OF_LOG_EVENT:
+                        break selection;
+                    case INTERVAL_EVENT:
+                        if (!observedStartTime) {
+                            startTimeSec = event.timeSec;
+                            observedStartTime = true;
+                        }
+                        if (!observedBaseTime) {
+                            baseTimeSec = (event.timeSec < startTimeSec - (365 * 24 * 3600.0)) ? startTimeSec : 0.0;
+                            observedBaseTime = true;
+                        }
+                        final double absoluteStartTimeStampSec = event.timeSec + baseTimeSec;
+                        final double offsetStartTimeStampSec = absoluteStartTimeStampSec - startTimeSec;
+                        if (offsetStartTimeStampSec < config.rangeStartTimeSec) {
+                            break;
+                        }
+                        if (offsetStartTimeStampSec > config.rangeEndTimeSec) {
+                            break selection;
+                        }
+                        if (event.payloadOffset >= 0) {
+                            final double absoluteEndTimeStampSec = absoluteStartTimeStampSec + event.intervalLengthSec;
+                            selectedIntervals.add(new SelectedInterval(event.payloadOffset, event.payloadLength,
+                                    event.tag,
+                                    (long) (absoluteStartTimeStampSec * 1000.0),
+                                    (long) (absoluteEndTimeStampSec * 1000.0), startTimeSec));
+                        }
+                        break;
+                    default:
+                        throw new IllegalStateException("Unexpected log event type " + event.type);
+                }
+            }
+        }
+        return selectedIntervals;
+    }
+
+    /**
+     * Read a selected interval histogram's payload back from the input file, and decode it, corrected for
+     * coordinated omission as requested, with its time range and tag established as HistogramLogReader would.
+     */
+    private EncodableHistogram decodeInterval(final SelectedInterval interval, final RandomAccessFile inputFile)
+            throws DataFormatException, IOException {
+        final byte[] payload = new byte[interval.payloadLength];
+        inputFile.seek(interval.payloadOffset);
+        inputFile.readFully(payload);
+        final EncodableHistogram histogram = copyCorrectedForCoordinatedOmission(
+                HistogramLogScanner.decodeHistogramPayload(payload, 0, payload.length));
+        histogram.setStartTimeStamp(interval.startTimeStampMsec);
+        histogram.setEndTimeStamp(interval.endTimeStampMsec);
+        histogram.setTag(interval.tag);
+        return histogram;
+    }
+
+    /**
+     * Decode a selected interval histogram that is already known to decode (and to match the log's type).
+     */
+    private EncodableHistogram decodeVerifiedInterval(final SelectedInterval interval,
+                                                      final RandomAccessFile inputFile) throws IOException {
+        try {
+            return decodeInterval(interval, inputFile);
+        } catch (DataFormatException ex) {
+            throw new IllegalStateException("Selected interval histogram can no longer be decoded", ex);
+        }
+    }
+
+    private static void verifyHistogramType(final EncodableHistogram histogram,
+                                            final boolean logUsesDoubleHistograms) {
+        if (histogram instanceof DoubleHistogram) {
+            if (!logUsesDoubleHistograms) {
+                throw new IllegalStateException("Encountered a DoubleHistogram line in a log of Histograms.");
+            }
+        } else if (logUsesDoubleHistograms) {
+            throw new IllegalStateException("Encountered a Histogram line in a log of DoubleHistograms.");
+        }
+    }
+
+    /**
+     * Decode and sum up the selected intervals in [from, to), stopping at the first one that cannot be decoded
+     * or does not match the log's histogram type.
+     */
+    private PartSum sumPart(final List<SelectedInterval> intervals, final int from, final int to,
+                            final EncodableHistogram emptyAccumulatedHistogram,
+                            final boolean logUsesDoubleHistograms) throws IOException {
+        final EncodableHistogram partSum = copyForAccumulation(emptyAccumulatedHistogram);
+        try (RandomAccessFile inputFile = new RandomAccessFile(config.inputFileName, "r")) {
+            for (int i = from; i < to; i++) {
+                final EncodableHistogram intervalHistogram;
+                try {
+                    intervalHistogram = decodeInterval(intervals.get(i), inputFile);
+                } catch (DataFormatException ex) {
+                    return new PartSum(partSum, i, null, false);
+                } catch (RuntimeException ex) {
+                    return new PartSum(partSum, i, ex, true);
+                }
+                try {
+                    verifyHistogramType(intervalHistogram, logUsesDoubleHistograms);
+                } catch (IllegalStateException ex) {
+                    return new PartSum(partSum, i, ex, false);
+                }
+                addToHistogram(partSum, intervalHistogram);
+            }
+        }
+        return new PartSum(partSum, -1, null, false);
+    }
+
+    private PartOutput outputPart(final List<SelectedInterval> intervals, final int from, final int to,
+                                  final EncodableHistogram precedingAccumulatedHistogram,
+                                  final int firstStartTimeIndex,
+                                  final boolean outputTimeIntervalLog, final boolean outputMovingWindowLog)
+            throws IOException {
+        try (RandomAccessFile inputFile = new RandomAccessFile(config.inputFileName, "r")) {
+            return outputPart(intervals, from, to, precedingAccumulatedHistogram, firstStartTimeIndex,
+                    outputTimeIntervalLog, outputMovingWindowLog, inputFile);
+        }
+    }
+
+    private PartOutput outputPart(final List<SelectedInterval> intervals, final int from, final int to,
+                                  final EncodableHistogram precedingAccumulatedHistogram,
+                                  final int firstStartTimeIndex,
+                                  final boolean outputTimeIntervalLog, final boolean outputMovingWindowLog,
+                                  final RandomAccessFile inputFile) throws IOException {
+        final StringBuilder timeIntervalLogText = new StringBuilder();
+        final StringBuilder movingWindowLogText = new StringBuilder();
+        final IntervalLogFormatter intervalLogFormatter = new IntervalLogFormatter(
+                outputTimeIntervalLog ? timeIntervalLogText : null,
+                outputMovingWindowLog ? movingWindowLogText : null,
+                from > 0);
+        final EncodableHistogram accumulatedHistogram = copyForAccumulation(precedingAccumulatedHistogram);
+
+        final Queue<EncodableHistogram> movingWindowQueue = new LinkedList<>();
+        EncodableHistogram movingWindowSumHistogram = null;
+        if (outputMovingWindowLog) {
+            movingWindowSumHistogram = (accumulatedHistogram instanceof DoubleHistogram) ?
+                    new DoubleHistogram(3) :
+                    new Histogram(3);
+            // Re-establish the moving window contents from the preceding intervals still in the window:
+            final long windowCutOffTimeStamp =
+                    intervals.get(from).endTimeStampMsec - config.movingWindowLengthInMsec;
+            int windowStart = from;
+            while ((windowStart > 0) &&
+                    (intervals.get(windowStart - 1).endTimeStampMsec > windowCutOffTimeStamp)) {
+                windowStart--;
+            }
+            for (int i = windowStart; i < from; i++) {
+                final EncodableHistogram intervalHistogram = decodeVerifiedInterval(intervals.get(i), inputFile);
+                addToHistogram(movingWindowSumHistogram, intervalHistogram);
+                movingWindowQueue.add(intervalHistogram);
+            }
+        }
+
+        for (int i = from; i < to; i++) {
+            final SelectedInterval interval = intervals.get(i);
+            final EncodableHistogram intervalHistogram = decodeVerifiedInterval(interval, inputFile);
+            addToHistogram(accumulatedHistogram, intervalHistogram);
+
+            if (outputMovingWindowLog) {
+                addToHistogram(movingWindowSumHistogram, intervalHistogram);
+                final long windowCutOffTimeStamp =
+                        intervalHistogram.getEndTimeStamp() - config.movingWindowLengthInMsec;
+                EncodableHistogram head;
+                while (((head = movingWindowQueue.peek()) != null) &&
+                        (head.getEndTimeStamp() <= windowCutOffTimeStamp)) {
+                    subtractFromHistogram(movingWindowSumHistogram, movingWindowQueue.remove());
+                }
+                movingWindowQueue.add(intervalHistogram);
+            }
+
+            if (outputTimeIntervalLog && (i == firstStartTimeIndex)) {
+                outputStartTime(timeIntervalLogText, interval.startTimeSec);
+            }
+            intervalLogFormatter.outputIntervalLine(intervalHistogram, accumulatedHistogram, interval.startTimeSec);
+            intervalLogFormatter.outputMovingWindowLine(intervalHistogram, movingWindowSumHistogram,
+                    interval.startTimeSec);
+        }
+        return new PartOutput(timeIntervalLogText.toString(), movingWindowLogText.toString(), accumulatedHistogram);
+    }
+
+    /**
+     * Sum up the given histograms into the first of them, adding pairs of histograms in parallel.
+     */
+    private static EncodableHistogram treeReduce(final List<EncodableHistogram> histograms,
+                                                 final ExecutorService executor) throws InterruptedException {
+        List<EncodableHistogram> level = histograms;
+        while (level.size() > 1) {
+            final List<Future<EncodableHistogram>> futures = new ArrayList<>();
+            for (int i = 0; i + 1 < level.size(); i += 2) {
+                final EncodableHistogram left = level.get(i);
+                final EncodableHistogram right = level.get(i + 1);
+                futures.add(executor.submit(new Callable<EncodableHistogram>() {
+                    @Override
+                    public EncodableHistogram call() {
+                        addToHistogram(left, right);
+                        return left;
+                    }
+                }));
+            }
+            final List<EncodableHistogram> nextLevel = new ArrayList<>();
+            for (Future<EncodableHistogram> future : futures) {
+                nextLevel.add(getResult(future));
+            }
+            if ((level.size() % 2) != 0) {
+                nextLevel.add(level.get(level.size() - 1));
+            }
+            level = nextLevel;
+        }
+        return level.get(0);
+    }
+
+    private void processInParallel(final PrintStream timeIntervalLog, final PrintStream movingWindowLog,
+                                   final PrintStream histogramPercentileLog) throws InterruptedException {
+        final ExecutorService executor = Executors.newFixedThreadPool(config.numberOfThreads);
+        try {
+            List<SelectedInterval> intervals = selectIntervals(scanChunksInParallel(executor));
+
+            // Decode and sum up the parts of the selected intervals. As HistogramLogReader stops reading at a
+            // histogram that cannot be decoded, a failure to decode one truncates the selected intervals there
+            // (and the parts are then summed up again):
+            EncodableHistogram emptyAccumulatedHistogram = null;
+            boolean logUsesDoubleHistograms = false;
+            int partCount = 0;
+            int[] partBoundaries = null;
+            List<EncodableHistogram> partSums = null;
+            while (partSums == null) {
+                if (!intervals.isEmpty()) {
+                    try (RandomAccessFile inputFile = new RandomAccessFile(config.inputFileName, "r")) {
+                        final EncodableHistogram firstIntervalHistogram = decodeInterval(intervals.get(0), inputFile);
+                        logUsesDoubleHistograms = (firstIntervalHistogram instanceof DoubleHistogram);
+                        emptyAccumulatedHistogram = newAccumulatedHistogram(firstIntervalHistogram);
+                    } catch (DataFormatException ex) {
+                        intervals = intervals.subList(0, 0);
+                    } catch (IOException ex) {
+                        throw new RuntimeException(ex);
                     }
                 }
+                if (intervals.isEmpty()) {
+                    new Histogram(3).outputPercentileDistribution(histogramPercentileLog,
+                            config.percentilesOutputTicksPerHalf, config.outputValueUnitRatio, config.logFormatCsv);
+                    return;
+                }
 
-                if (movingWindowLog != null) {
-                    if (!movingWindowLogLegendWritten) {
-                        movingWindowLogLegendWritten = true;
-                        if (config.logFormatCsv) {
-                            movingWindowLog.println("\"Timestamp\",\"Window_Count\",\"" +
-                                    config.movingWindowPercentileToReport +"%'ile\",\"Max\"");
-                        } else {
-                            movingWindowLog.println("Time: WindowCount " + config.movingWindowPercentileToReport + "%'ile Max");
+                partCount = Math.min(intervals.size(), config.numberOfThreads * CHUNKS_PER_THREAD);
+                partBoundaries = new int[partCount + 1];
+                for (int i = 0; i <= partCount; i++) {
+                    partBoundaries[i] = (int) (((long) intervals.size() * i) / partCount);
+                }
+                final List<SelectedInterval> partIntervals = intervals;
+                final EncodableHistogram partEmptyAccumulatedHistogram = emptyAccumulatedHistogram;
+                final boolean partLogUsesDoubleHistograms = logUsesDoubleHistograms;
+                final List<Future<PartSum>> partSumFutures = new ArrayList<>(partCount);
+                for (int i = 0; i < partCount; i++) {
+                    final int from = partBoundaries[i];
+                    final int to = partBoundaries[i + 1];
+                    partSumFutures.add(executor.submit(new Callable<PartSum>() {
+                        @Override
+                        public PartSum call() throws IOException {
+                            return sumPart(partIntervals, from, to, partEmptyAccumulatedHistogram,
+                                    partLogUsesDoubleHistograms);
                         }
+                    }));
+                }
+                final List<EncodableHistogram> sums = new ArrayList<>(partCount);
+                PartSum failedPartSum = null;
+                for (Future<PartSum> future : partSumFutures) {
+                    final PartSum partSum = getResult(future);
+                    sums.add(partSum.sum);
+                    if ((failedPartSum == null) && (partSum.failedIndex >= 0)) {
+                        failedPartSum = partSum;
                     }
-                    if (intervalHistogram instanceof DoubleHistogram) {
-                        movingWindowLog.format(Locale.US, movingWindowLogFormat,
-                                ((intervalHistogram.getEndTimeStamp() / 1000.0) - logReader.getStartTimeSec()),
-                                // values recorded during the last reporting interval
-                                ((DoubleHistogram) movingWindowSumHistogram).getTotalCount(),
-                                ((DoubleHistogram) movingWindowSumHistogram).getValueAtPercentile(config.movingWindowPercentileToReport) / config.outputValueUnitRatio,
-                                ((DoubleHistogram) movingWindowSumHistogram).getMaxValue() / config.outputValueUnitRatio
-                        );
+                }
+                if (failedPartSum == null) {
+                    partSums = sums;
+                } else if (failedPartSum.malformed) {
+                    System.err.println("Log file parsing error in selected interval histogram number " +
+                            failedPartSum.failedIndex + ": line appears to be malformed.");
+                    if (config.verbose) {
+                        throw failedPartSum.failure;
                     } else {
-                        movingWindowLog.format(Locale.US, movingWindowLogFormat,
-                                ((intervalHistogram.getEndTimeStamp() / 1000.0) - logReader.getStartTimeSec()),
-                                // values recorded during the last reporting interval
-                                ((Histogram) movingWindowSumHistogram).getTotalCount(),
-                                ((Histogram) movingWindowSumHistogram).getValueAtPercentile(config.movingWindowPercentileToReport) / config.outputValueUnitRatio,
-                                ((Histogram) movingWindowSumHistogram).getMaxValue() / config.outputValueUnitRatio
-                        );
+                        System.exit(1);
                     }
+                } else if (failedPartSum.failure != null) {
+                    throw failedPartSum.failure;
+                } else {
+                    intervals = intervals.subList(0, failedPartSum.failedIndex);
+                }
+            }
 
+            int firstStartTimeIndex = -1;
+            for (int i = 0; (firstStartTimeIndex < 0) && (i < intervals.size()); i++) {
+                if (intervals.get(i).startTimeSec != 0.0) {
+                    firstStartTimeIndex = i;
                 }
+            }
 
-                intervalHistogram = getIntervalHistogram(config.tag);
+            final EncodableHistogram accumulatedHistogram;
+            if ((timeIntervalLog == null) && (movingWindowLog == null)) {
+                accumulatedHistogram = treeReduce(partSums, executor);
+            } else {
+                // Establish the total preceding each part, and output the parts' log lines:
+                final List<Future<PartOutput>> partOutputFutures = new ArrayList<>(partCount);
+                EncodableHistogram precedingAccumulatedHistogram = emptyAccumulatedHistogram;
+                for (int i = 0; i < partCount; i++) {
+                    final int from = partBoundaries[i];
+                    final int to = partBoundaries[i + 1];
+                    final EncodableHistogram partPrecedingAccumulatedHistogram = precedingAccumulatedHistogram;
+                    final int partFirstStartTimeIndex = firstStartTimeIndex;
+                    final List<SelectedInterval> partIntervals = intervals;
+                    partOutputFutures.add(executor.submit(new Callable<PartOutput>() {
+                        @Override
+                        public PartOutput call() throws IOException {
+                            return outputPart(partIntervals, from, to, partPrecedingAccumulatedHistogram,
+                                    partFirstStartTimeIndex, (timeIntervalLog != null), (movingWindowLog != null));
+                        }
+                    }));
+                    if (i + 1 < partCount) {
+                        precedingAccumulatedHistogram = copyForAccumulation(precedingAccumulatedHistogram);
+                        addToHistogram(precedingAccumulatedHistogram, partSums.get(i));
+                    }
+                }
+                EncodableHistogram lastPartAccumulatedHistogram = null;
+                for (Future<PartOutput> future : partOutputFutures) {
+                    final PartOutput partOutput = getResult(future);
+                    if (timeIntervalLog != null) {
+                        timeIntervalLog.print(partOutput.timeIntervalLogText);
+                    }
+                    if (movingWindowLog != null) {
+                        movingWindowLog.print(partOutput.movingWindowLogText);
+                    }
+                    lastPartAccumulatedHistogram = partOutput.accumulatedHistogram;
+                }
+                accumulatedHistogram = lastPartAccumulatedHistogram;
             }
 
+            if (firstStartTimeIndex >= 0) {
+                outputStartTime(histogramPercentileLog, intervals.get(firstStartTimeIndex).startTimeSec);
+            }
             if (logUsesDoubleHistograms) {
-                accumulatedDoubleHistogram.outputPercentileDistribution(histogramPercentileLog,
+                ((DoubleHistogram) accumulatedHistogram).outputPercentileDistribution(histogramPercentileLog,
                         config.percentilesOutputTicksPerHalf, config.outputValueUnitRatio, config.logFormatCsv);
             } else {
-                accumulatedRegularHistogram.outputPercentileDistribution(histogramPercentileLog,
+                ((Histogram) accumulatedHistogram).outputPercentileDistribution(histogramPercentileLog,
                         config.percentilesOutputTicksPerHalf, config.outputValueUnitRatio, config.logFormatCsv);
             }
         } finally {
-            if (timeIntervalLog != null) {
-                timeIntervalLog.close();
-            }
-            if (movingWindowLog != null) {
-                movingWindowLog.close();
-            }
-            if (histogramPercentileLog != System.out) {
-                histogramPercentileLog.close();
-            }
+            executor.shutdownNow();
         }
     }
 
@@ -505,6 +1265,8 @@ public class HistogramLogProcessor extends Thread {
      *                                                             recorded with coordinated omissions, and when an expected interval is known.
      * [-outputValueUnitRatio r]                                   The scaling factor by which to divide histogram recorded values units
      *                                                             in output. [default = 1000000.0 (1 msec in nsec)]"
+     * [-threads n]                                                Process the input file in parallel, using n worker threads
+     *                                                             (default 1, requires -i)
      * </pre>
      * @param args command line arguments
      * @throws FileNotFoundException if specified input file is not found
@@ -9,10 +9,20 @@ package org.HdrHistogram;
 
 import java.io.*;
 import java.nio.ByteBuffer;
-import java.util.Locale;
-import java.util.Scanner;
+import java.nio.charset.Charset;
+import java.util.InputMismatchException;
+import java.util.NoSuchElementException;
 import java.util.zip.DataFormatException;
 
+/**
+ * A streaming scanner of histogram logs (see {@link HistogramLogReader} for the log format). The scanner reports
+ * comments, start and base times, and interval histograms to an {@link EventHandler}.
+ * <p>
+ * Log lines are tokenized directly from the underlying byte stream (no regular expressions, no per-token
+ * Strings for timestamps), and interval histogram payloads are only Base64-decoded and decompressed if and when
+ * the handler asks for them (via the lazy reader provided to
+ * {@link EventHandler#onHistogram(String, double, double, EncodableHistogramSupplier)}).
+ */
 public class HistogramLogScanner implements Closeable {
 
     // can't use lambdas, and anyway we need to let the handler take the exception
@@ -30,8 +40,9 @@ public class HistogramLogScanner implements Closeable {
 
         /**
          *  A lazy reader is provided to allow fast skipping of bulk of work where tag or timestamp are to be used as
-         *  a basis for filtering the {@link EncodableHistogram} anyway. The reader is to be called only once.
-         *  
+         *  a basis for filtering the {@link EncodableHistogram} anyway. The reader is to be called only once, and
+         *  only from within this callback.
+         *
          * @param tag histogram tag or null if none exist
          * @param timestamp logged timestamp
          * @param length logged interval length
@@ -41,22 +52,25 @@ public class HistogramLogScanner implements Closeable {
         boolean onHistogram(String tag, double timestamp, double length, EncodableHistogramSupplier lazyReader);
         boolean onException(Throwable t);
     }
-    
-    private static class LazyHistogramReader implements EncodableHistogramSupplier {
 
-        private final Scanner scanner;
+    private class LazyHistogramReader implements EncodableHistogramSupplier {
+
         private boolean gotIt = true;
+        private int payloadStart;
+        private int payloadEnd;
 
-        private LazyHistogramReader(Scanner scanner)
+        private void allowGet(final int payloadStart, final int payloadEnd)
         {
-            this.scanner = scanner;
+            this.payloadStart = payloadStart;
+            this.payloadEnd = payloadEnd;
+            gotIt = false;
         }
 
-        private void allowGet()
+        private void disallowGet()
         {
-            gotIt = false;
+            gotIt = true;
         }
-        
+
         @Override
         public EncodableHistogram read() throws DataFormatException
         {
@@ -65,37 +79,112 @@ public class HistogramLogScanner implements Closeable {
                 throw new IllegalStateException();
             }
             gotIt = true;
-            
-            final String compressedPayloadString = scanner.next();
-            final ByteBuffer buffer = ByteBuffer.wrap(Base64Helper.parseBase64Binary(compressedPayloadString));
 
-            EncodableHistogram histogram = EncodableHistogram.decodeFromCompressedByteBuffer(buffer, 0);
+            return decodeHistogramPayload(lineBuffer, payloadStart, payloadEnd - payloadStart);
+        }
+
+        private long payloadInputOffset() {
+            if (gotIt) {
+                throw new IllegalStateException();
+            }
+            return lineBufferInputOffset + payloadStart;
+        }
 
-            return histogram;       
+        private int payloadLength() {
+            if (gotIt) {
+                throw new IllegalStateException();
+            }
+            return payloadEnd - payloadStart;
         }
     }
 
-    private final LazyHistogramReader lazyReader;
-    protected final Scanner scanner;
-    
+    /**
+     * Get the offset in the input (relative to where the scanner started reading it) of the (still Base64 encoded
+     * and compressed) payload of the interval histogram currently being reported, so that it can be read back
+     * later and decoded with {@link #decodeHistogramPayload(byte[], int, int)}. To be called only from within
+     * {@link EventHandler#onHistogram(String, double, double, EncodableHistogramSupplier)}.
+     *
+     * @return the input offset of the current interval histogram's payload
+     */
+    long getHistogramPayloadOffset() {
+        return lazyReader.payloadInputOffset();
+    }
+
+    /**
+     * Get the length of the payload of the interval histogram currently being reported (see
+     * {@link #getHistogramPayloadOffset()}).
+     *
+     * @return the length of the current interval histogram's payload
+     */
+    int getHistogramPayloadLength() {
+        return lazyReader.payloadLength();
+    }
+
+    /**
+     * Decode an interval histogram from its (Base64 encoded and compressed) log line payload.
+     *
+     * @param payload The buffer holding the payload
+     * @param offset The offset of the payload in the buffer
+     * @param length The length of the payload
+     * @return the decoded histogram
+     * @throws DataFormatException on error parsing/decompressing the payload
+     */
+    static EncodableHistogram decodeHistogramPayload(final byte[] payload, final int offset, final int length)
+            throws DataFormatException {
+        final ByteBuffer buffer = ByteBuffer.wrap(Base64Helper.parseBase64Binary(payload, offset, length));
+        return EncodableHistogram.decodeFromCompressedByteBuffer(buffer, 0);
+    }
+
+    private static final int INITIAL_BUFFER_SIZE = 64 * 1024;
+
+    private static final Charset UTF_8 = Charset.forName("UTF-8");
+
+    private static final byte[] START_TIME_TOKEN = asciiBytes("#[StartTime:");
+    private static final byte[] BASE_TIME_TOKEN = asciiBytes("#[BaseTime:");
+    private static final byte[] LEGEND_PREFIX = asciiBytes("\"StartTimestamp\"");
+    private static final byte[] TAG_PREFIX = asciiBytes("Tag=");
+
+    private static final double[] POWERS_OF_TEN = {
+            1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+            1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+    };
+
+    private final LazyHistogramReader lazyReader = new LazyHistogramReader();
+    private final InputStream inputStream;
+    private final boolean ownsInputStream;
+
+    // Buffered input. The current line is always held contiguously in lineBuffer[lineStart, lineEnd):
+    private byte[] lineBuffer = new byte[INITIAL_BUFFER_SIZE];
+    // The offset in the input of lineBuffer[0]:
+    private long lineBufferInputOffset = 0;
+    private int bufferPosition = 0;
+    private int bufferLimit = 0;
+    private boolean endOfInput = false;
+    private int lineStart;
+    private int lineEnd;
+
+    // Tokenizer state (within the current line):
+    private int tokenStart;
+    private int tokenEnd;
+
     /**
      * Constructs a new HistogramLogReader that produces intervals read from the specified file name.
      * @param inputFileName The name of the file to read from
      * @throws java.io.FileNotFoundException when unable to find inputFileName
      */
     public HistogramLogScanner(final String inputFileName) throws FileNotFoundException {
-        this(new Scanner(new File(inputFileName)));
+        this(new FileInputStream(inputFileName), true);
     }
 
     /**
      * Constructs a new HistogramLogReader that produces intervals read from the specified InputStream. Note that
      * log readers constructed through this constructor do not assume ownership of stream and will not close it on
      * {@link #close()}.
-     * 
+     *
      * @param inputStream The InputStream to read from
      */
     public HistogramLogScanner(final InputStream inputStream) {
-        this(new Scanner(inputStream));
+        this(inputStream, false);
     }
 
     /**
@@ -104,95 +193,298 @@ public class HistogramLogScanner implements Closeable {
      * @throws java.io.FileNotFoundException when unable to find inputFile
      */
     public HistogramLogScanner(final File inputFile) throws FileNotFoundException {
-        this(new Scanner(inputFile));
+        this(new FileInputStream(inputFile), true);
     }
 
-    private HistogramLogScanner(Scanner scanner)
+    private HistogramLogScanner(final InputStream inputStream, final boolean ownsInputStream)
     {
-        this.scanner = scanner;
-        this.lazyReader = new LazyHistogramReader(scanner);
-        initScanner();
-    }
-
-    private void initScanner() {
-        scanner.useLocale(Locale.US);
-        scanner.useDelimiter("[ ,\\r\\n]");
+        this.inputStream = inputStream;
+        this.ownsInputStream = ownsInputStream;
     }
 
     /**
-     * Close underlying scanner.
+     * Close underlying input (if it was opened by this scanner).
      */
     @Override
     public void close()
     {
-        scanner.close();
+        if (ownsInputStream) {
+            try {
+                inputStream.close();
+            } catch (IOException ex) {
+                // Nothing useful to do about a failure to close an input file.
+            }
+        }
     }
 
     public void process(EventHandler handler) {
-        while (scanner.hasNextLine()) {
+        while (nextLine()) {
             try {
-                if (scanner.hasNext("\\#.*")) {
+                if (!nextToken()) {
+                    continue; // Empty line
+                }
+
+                if (lineBuffer[tokenStart] == '#') {
                     // comment line.
                     // Look for explicit start time or base time notes in comments:
-                    if (scanner.hasNext("#\\[StartTime:")) {
-                        scanner.next("#\\[StartTime:");
-                        if (scanner.hasNextDouble()) {
-                            double startTimeSec = scanner.nextDouble(); // start time represented as seconds since epoch
+                    if (tokenEquals(START_TIME_TOKEN)) {
+                        if (nextToken() && tokenIsDouble()) {
+                            double startTimeSec = parseDoubleToken(); // start time represented as seconds since epoch
                             if (handler.onStartTime(startTimeSec)) {
                                 return;
                             }
                         }
-                    } else if (scanner.hasNext("#\\[BaseTime:")) {
-                        scanner.next("#\\[BaseTime:");
-                        if (scanner.hasNextDouble()) {
-                            double baseTimeSec = scanner.nextDouble(); // base time represented as seconds since epoch
+                    } else if (tokenEquals(BASE_TIME_TOKEN)) {
+                        if (nextToken() && tokenIsDouble()) {
+                            double baseTimeSec = parseDoubleToken(); // base time represented as seconds since epoch
                             if (handler.onBaseTime(baseTimeSec))
                             {
                                 return;
                             }
                         }
-                    } else if (handler.onComment(scanner.next("\\#.*"))) {
+                    } else if (handler.onComment(tokenString())) {
                         return;
                     }
                     continue;
                 }
 
-                if (scanner.hasNext("\"StartTimestamp\".*")) {
+                if (tokenStartsWith(LEGEND_PREFIX)) {
                     // Legend line
                     continue;
                 }
 
                 String tagString = null;
-                if (scanner.hasNext("Tag\\=.*")) {
-                    tagString = scanner.next("Tag\\=.*").substring(4);
+                if (tokenStartsWith(TAG_PREFIX)) {
+                    tagString = new String(lineBuffer, tokenStart + TAG_PREFIX.length,
+                            tokenEnd - tokenStart - TAG_PREFIX.length, UTF_8);
+                    requireNextToken();
                 }
 
                 // Decode: startTimestamp, intervalLength, maxTime, histogramPayload
-                final double logTimeStampInSec = scanner.nextDouble(); // Timestamp is expected to be in seconds
-                final double intervalLengthSec = scanner.nextDouble(); // Timestamp length is expect to be in seconds
-                scanner.nextDouble(); // Skip maxTime field, as max time can be deduced from the histogram.
-                
-                lazyReader.allowGet();
-                if (handler.onHistogram(tagString, logTimeStampInSec, intervalLengthSec, lazyReader)) {
-                    return;
+                final double logTimeStampInSec = parseDoubleToken(); // Timestamp is expected to be in seconds
+                requireNextToken();
+                final double intervalLengthSec = parseDoubleToken(); // Timestamp length is expect to be in seconds
+                requireNextToken();
+                parseDoubleToken(); // Skip maxTime field, as max time can be deduced from the histogram.
+                requireNextToken();
+
+                lazyReader.allowGet(tokenStart, tokenEnd);
+                try {
+                    if (handler.onHistogram(tagString, logTimeStampInSec, intervalLengthSec, lazyReader)) {
+                        return;
+                    }
+                } finally {
+                    lazyReader.disallowGet();
                 }
 
             } catch (Throwable ex) {
                 if (handler.onException(ex)) {
                     return;
                 }
-            } finally {
-                scanner.nextLine(); // Move to next line.
             }
         }
     }
 
     /**
      * Indicates whether or not additional intervals may exist in the log
-     * 
+     *
      * @return true if additional intervals may exist in the log
      */
     public boolean hasNextLine() {
-        return scanner.hasNextLine();
+        try {
+            // Don't compact the buffer here, as a handler may still be using the current line:
+            return (bufferPosition < bufferLimit) || fillBuffer(false);
+        } catch (IOException ex) {
+            throw new RuntimeException(ex);
+        }
+    }
+
+    //   ######## ##     ##  ######## ######## ########  #### ##    ##  ######
+    //      ##    ##     ##  ##       ##       ##     ##  ##  ###   ## ##    ##
+    //      ##    ##     ##  ##       ##       ##     ##  ##  ####  ## ##
+    //      ##    #########  ######   ######   ########   ##  ## ## ## ##   ####
+    //      ##    ##     ##  ##       ##       ##   ##    ##  ##  #### ##    ##
+    //      ##    ##     ##  ##       ##       ##    ##   ##  ##   ### ##    ##
+    //      ##    ##     ##  ######## ######## ##     ## #### ##    ##  ######
+    //
+    // Line reading and tokenizing:
+    //
+
+    /**
+     * Read more input into the buffer, optionally compacting it first (and growing it if needed).
+     * @return false if no more input is available
+     */
+    private boolean fillBuffer(final boolean compact) throws IOException {
+        if (endOfInput) {
+            return false;
+        }
+        if (compact && (bufferPosition > 0)) {
+            System.arraycopy(lineBuffer, bufferPosition, lineBuffer, 0, bufferLimit - bufferPosition);
+            bufferLimit -= bufferPosition;
+            lineBufferInputOffset += bufferPosition;
+            bufferPosition = 0;
+        }
+        if (bufferLimit == lineBuffer.length) {
+            byte[] newBuffer = new byte[lineBuffer.length * 2];
+            System.arraycopy(lineBuffer, 0, newBuffer, 0, bufferLimit);
+            lineBuffer = newBuffer;
+        }
+        int bytesRead;
+        do {
+            bytesRead = inputStream.read(lineBuffer, bufferLimit, lineBuffer.length - bufferLimit);
+        } while (bytesRead == 0);
+        if (bytesRead < 0) {
+            endOfInput = true;
+            return false;
+        }
+        bufferLimit += bytesRead;
+        return true;
+    }
+
+    /**
+     * Advance to the next line of input, establishing [lineStart, lineEnd) (not including the line terminator).
+     * @return false if there are no more lines
+     */
+    private boolean nextLine() {
+        try {
+            if ((bufferPosition >= bufferLimit) && !fillBuffer(true)) {
+                return false;
+            }
+            int scanPosition = bufferPosition;
+            while (true) {
+                while (scanPosition < bufferLimit) {
+                    if (lineBuffer[scanPosition] == '\n') {
+                        lineStart = bufferPosition;
+                        lineEnd = scanPosition;
+                        bufferPosition = scanPosition + 1;
+                        tokenEnd = lineStart;
+                        return true;
+                    }
+                    scanPosition++;
+                }
+                final int scannedLength = scanPosition - bufferPosition;
+                if (!fillBuffer(true)) {
+                    // Last line, with no terminator:
+                    lineStart = bufferPosition;
+                    lineEnd = bufferLimit;
+                    bufferPosition = bufferLimit;
+                    tokenEnd = lineStart;
+                    return true;
+                }
+                scanPosition = bufferPosition + scannedLength;
+            }
+        } catch (IOException ex) {
+            throw new RuntimeException(ex);
+        }
+    }
+
+    private static boolean isDelimiter(final byte b) {
+        return (b == ',') || (b == ' ') || (b == '\r') || (b == '\n');
+    }
+
+    /**
+     * Advance to the next token in the current line, establishing [tokenStart, tokenEnd)
+     * @return false if there are no more tokens in the current line
+     */
+    private boolean nextToken() {
+        int position = tokenEnd;
+        while ((position < lineEnd) && isDelimiter(lineBuffer[position])) {
+            position++;
+        }
+        if (position >= lineEnd) {
+            tokenStart = tokenEnd = lineEnd;
+            return false;
+        }
+        tokenStart = position;
+        while ((position < lineEnd) && !isDelimiter(lineBuffer[position])) {
+            position++;
+        }
+        tokenEnd = position;
+        return true;
+    }
+
+    private void requireNextToken() {
+        if (!nextToken()) {
+            throw new NoSuchElementException("Missing field in log line");
+        }
+    }
+
+    private boolean tokenStartsWith(final byte[] prefix) {
+        if (tokenEnd - tokenStart < prefix.length) {
+            return false;
+        }
+        for (int i = 0; i < prefix.length; i++) {
+            if (lineBuffer[tokenStart + i] != prefix[i]) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    private boolean tokenEquals(final byte[] expected) {
+        return (tokenEnd - tokenStart == expected.length) && tokenStartsWith(expected);
+    }
+
+    private String tokenString() {
+        return new String(lineBuffer, tokenStart, tokenEnd - tokenStart, UTF_8);
+    }
+
+    private boolean tokenIsDouble() {
+        try {
+            parseDoubleToken();
+            return true;
+        } catch (InputMismatchException ex) {
+            return false;
+        }
+    }
+
+    /**
+     * Parse the current token as a double. Plain decimal tokens (the form used for timestamps and values in
+     * histogram logs) are parsed without allocation. Other forms fall back to {@link Double#parseDouble}.
+     */
+    private double parseDoubleToken() {
+        int position = tokenStart;
+        boolean negative = false;
+        if ((position < tokenEnd) && ((lineBuffer[position] == '-') || (lineBuffer[position] == '+'))) {
+            negative = (lineBuffer[position] == '-');
+            position++;
+        }
+        long mantissa = 0;
+        int digits = 0;
+        int fractionDigits = -1;
+        for (; position < tokenEnd; position++) {
+            final byte b = lineBuffer[position];
+            if ((b >= '0') && (b <= '9')) {
+                mantissa = (mantissa * 10) + (b - '0');
+                digits++;
+                if (fractionDigits >= 0) {
+                    fractionDigits++;
+                }
+            } else if ((b == '.') && (fractionDigits < 0)) {
+                fractionDigits = 0;
+            } else {
+                break;
+            }
+        }
+        if ((position == tokenEnd) && (digits > 0) && (digits <= 15)) {
+            // mantissa and the power of ten are both exactly representable as doubles, so a single
+            // (correctly rounded) division yields the same result as Double.parseDouble would:
+            double value = (fractionDigits > 0) ? mantissa / POWERS_OF_TEN[fractionDigits] : mantissa;
+            return negative ? -value : value;
+        }
+        final String token = tokenString();
+        try {
+            return Double.parseDouble(token);
+        } catch (NumberFormatException ex) {
+            throw new InputMismatchException("Expected a number but found: " + token);
+        }
+    }
+
+    private static byte[] asciiBytes(final String s) {
+        final byte[] bytes = new byte[s.length()];
+        for (int i = 0; i < bytes.length; i++) {
+            bytes[i] = (byte) s.charAt(i);
+        }
+        return bytes;
     }
 }
@@ -53,6 +53,10 @@ public class HistogramLogWriter {
 
     private long baseTime = 0;
 
+    private HistogramCompressionCodec compressionCodec = HistogramCompressionCodec.deflate(Deflater.BEST_COMPRESSION);
+    // Reuses its compression state (e.g. a Deflater) across the histograms written, until the log is closed:
+    private HistogramCompressionCodec encodingCodec = compressionCodec.newReusingInstance();
+
     /**
      * Constructs a new HistogramLogWriter around a newly created file with the specified file name.
      * @param outputFileName The name of the file to create
@@ -91,6 +95,10 @@ public class HistogramLogWriter {
      * Closes the file or output stream for this log writer.
      */
     public void close() {
+        synchronized (this) {
+            encodingCodec.release();
+            encodingCodec = compressionCodec;
+        }
         log.close();
     }
 
@@ -109,12 +117,13 @@ public class HistogramLogWriter {
                                         final double endTimeStampSec,
                                         final EncodableHistogram histogram,
                                         final double maxValueUnitRatio) {
-        if ((targetBuffer == null) || targetBuffer.capacity() < histogram.getNeededByteBufferCapacity()) {
-            targetBuffer = ByteBuffer.allocate(histogram.getNeededByteBufferCapacity()).order(BIG_ENDIAN);
+        final int neededCapacity = compressionCodec.getMaxCompressedLength(histogram.getNeededByteBufferCapacity());
+        if ((targetBuffer == null) || targetBuffer.capacity() < neededCapacity) {
+            targetBuffer = ByteBuffer.allocate(neededCapacity).order(BIG_ENDIAN);
         }
         targetBuffer.clear();
 
-        int compressedLength = histogram.encodeIntoCompressedByteBuffer(targetBuffer, Deflater.BEST_COMPRESSION);
+        int compressedLength = histogram.encodeIntoCompressedByteBuffer(targetBuffer, encodingCodec);
         byte[] compressedArray = Arrays.copyOf(targetBuffer.array(), compressedLength);
 
         String tag = histogram.getTag();
@@ -234,6 +243,28 @@ public class HistogramLogWriter {
         this.baseTime = baseTimeMsec;
     }
 
+    /**
+     * Set the compression codec used to encode interval histograms into the log. Defaults to
+     * {@link HistogramCompressionCodec#deflate deflate} at {@link Deflater#BEST_COMPRESSION}. Codecs other
+     * than deflate (e.g. {@link HistogramCompressionCodec#FAST}) reduce the CPU cost of logging, but produce
+     * logs that can only be read by versions of HdrHistogram that support them.
+     * @param compressionCodec the compression codec to use
+     */
+    public synchronized void setCompressionCodec(final HistogramCompressionCodec compressionCodec) {
+        encodingCodec.release();
+        this.compressionCodec = compressionCodec;
+        encodingCodec = compressionCodec.newReusingInstance();
+    }
+
+    /**
+     * return the compression codec used to encode interval histograms
+     * (see {@link org.HdrHistogram.HistogramLogWriter#setCompressionCodec}).
+     * @return the current compression codec
+     */
+    public HistogramCompressionCodec getCompressionCodec() {
+        return compressionCodec;
+    }
+
     /**
      * return the current base time offset (see {@link org.HdrHistogram.HistogramLogWriter#setBaseTime}).
      * @return the current base time
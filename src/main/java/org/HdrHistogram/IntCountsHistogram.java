@@ -70,6 +70,16 @@ public class IntCountsHistogram extends AbstractHistogram {
         counts[index] = (int) value;
     }
 
+    @Override
+    boolean countsArrayIsPlain() {
+        return true;
+    }
+
+    @Override
+    Object getPlainCountsArray() {
+        return countsArrayIsPlain() ? counts : null;
+    }
+
     @Override
     int getNormalizingIndexOffset() {
         return normalizingIndexOffset;
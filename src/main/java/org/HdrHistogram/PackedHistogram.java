@@ -79,6 +79,20 @@ public class PackedHistogram extends Histogram {
         packedCounts.set(index, value);
     }
 
+    @Override
+    boolean countsArrayIsPlain() {
+        // Counts are kept in a packed array:
+        return false;
+    }
+
+    @Override
+    public void setLazyCountsAllocation(final boolean lazyCountsAllocation) {
+        if (lazyCountsAllocation) {
+            // An empty packed array already holds only a minimal physical array:
+            throw new IllegalStateException("PackedHistogram does not support lazy counts allocation.");
+        }
+    }
+
     @Override
     void clearCounts() {
         packedCounts.clear();
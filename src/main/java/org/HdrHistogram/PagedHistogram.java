@@ -0,0 +1,286 @@
+/**
+ * Written by Gil Tene of Azul Systems, and released to the public domain,
+ * as explained at http://creativecommons.org/publicdomain/zero/1.0/
+ *
+ * @author Gil Tene
+ */
+
+package org.HdrHistogram;
+
+import java.io.IOException;
+import java.io.ObjectInputStream;
+import java.nio.ByteBuffer;
+import java.util.Arrays;
+import java.util.zip.DataFormatException;
+
+/**
+ * <h3>A High Dynamic Range (HDR) Histogram that keeps its counts in pages allocated on demand</h3>
+ * <p>
+ * {@link PagedHistogram} keeps its <b><code>long</code></b> counts in fixed size pages, with one page per
+ * half-bucket (i.e. per binary order of magnitude) of the value range, referenced from a page directory. A page is
+ * only allocated when a count within it is first recorded, so value ranges that are never recorded into use no
+ * memory beyond their directory entry. Auto-resizing (see {@link Histogram#setAutoResize}) only extends the page
+ * directory, and never copies (or leaves behind) the already recorded counts, which keeps resizing cheap for
+ * the recording thread.
+ * <p>
+ * In both recording speed and footprint, {@link PagedHistogram} sits between {@link Histogram} (whose counts are a
+ * single dense array) and {@link PackedHistogram} (whose counts are packed for sparse, small counts, at a higher
+ * recording cost). Allocated pages are retained (and zeroed) across {@link #reset()} calls, so that a reset
+ * histogram that records into the same value ranges does not need to allocate them again.
+ * <p>
+ * See package description for {@link org.HdrHistogram} for details.
+ */
+
+public class PagedHistogram extends Histogram {
+
+    // The page directory, indexed by normalized index >> subBucketHalfCountMagnitude. Null pages hold all-zero
+    // counts:
+    long[][] pages;
+
+    @Override
+    long getCountAtIndex(final int index) {
+        return getCountAtNormalizedIndex(normalizeIndex(index, normalizingIndexOffset, countsArrayLength));
+    }
+
+    @Override
+    long getCountAtNormalizedIndex(final int index) {
+        final long[] page = pages[index >> subBucketHalfCountMagnitude];
+        return (page != null) ? page[index & (subBucketHalfCount - 1)] : 0;
+    }
+
+    @Override
+    void incrementCountAtIndex(final int index) {
+        final int normalizedIndex = normalizeIndex(index, normalizingIndexOffset, countsArrayLength);
+        getOrAllocatePage(normalizedIndex >> subBucketHalfCountMagnitude)[normalizedIndex & (subBucketHalfCount - 1)]++;
+    }
+
+    @Override
+    void addToCountAtIndex(final int index, final long value) {
+        final int normalizedIndex = normalizeIndex(index, normalizingIndexOffset, countsArrayLength);
+        getOrAllocatePage(normalizedIndex >> subBucketHalfCountMagnitude)[normalizedIndex & (subBucketHalfCount - 1)]
+                += value;
+    }
+
+    @Override
+    void setCountAtIndex(int index, long value) {
+        setCountAtNormalizedIndex(normalizeIndex(index, normalizingIndexOffset, countsArrayLength), value);
+    }
+
+    @Override
+    void setCountAtNormalizedIndex(int index, long value) {
+        final int pageIndex = index >> subBucketHalfCountMagnitude;
+        if ((value == 0) && (pages[pageIndex] == null)) {
+            return;
+        }
+        getOrAllocatePage(pageIndex)[index & (subBucketHalfCount - 1)] = value;
+    }
+
+    private long[] getOrAllocatePage(final int pageIndex) {
+        long[] page = pages[pageIndex];
+        if (page == null) {
+            page = new long[subBucketHalfCount];
+            pages[pageIndex] = page;
+        }
+        return page;
+    }
+
+    /**
+     * Get the number of count pages currently allocated.
+     *
+     * @return the number of allocated count pages
+     */
+    public int getNumberOfAllocatedPages() {
+        int numberOfAllocatedPages = 0;
+        for (long[] page : pages) {
+            if (page != null) {
+                numberOfAllocatedPages++;
+            }
+        }
+        return numberOfAllocatedPages;
+    }
+
+    @Override
+    boolean canSkipEmptySlots() {
+        // Unallocated pages are known to be empty:
+        return true;
+    }
+
+    @Override
+    int nextPopulatedIndex(final int fromIndex) {
+        // Pages are allocated over normalized indexes, so they can only be used for skipping while those match
+        // the (logical) indexes being scanned:
+        if ((normalizingIndexOffset != 0) || (fromIndex >= countsArrayLength)) {
+            return fromIndex;
+        }
+        int pageIndex = fromIndex >> subBucketHalfCountMagnitude;
+        if (pages[pageIndex] != null) {
+            return fromIndex;
+        }
+        while (++pageIndex < pages.length) {
+            if (pages[pageIndex] != null) {
+                return pageIndex << subBucketHalfCountMagnitude;
+            }
+        }
+        return countsArrayLength;
+    }
+
+    @Override
+    boolean countsArrayIsPlain() {
+        // Counts are kept in pages:
+        return false;
+    }
+
+    @Override
+    public void setOccupancyTracking(final boolean occupancyTracking) {
+        if (occupancyTracking) {
+            // Unallocated pages already serve the same purpose:
+            throw new IllegalStateException("PagedHistogram does not support occupancy tracking.");
+        }
+    }
+
+    @Override
+    public void setLazyCountsAllocation(final boolean lazyCountsAllocation) {
+        if (lazyCountsAllocation) {
+            // Pages are already allocated on demand:
+            throw new IllegalStateException("PagedHistogram does not support lazy counts allocation.");
+        }
+    }
+
+    @Override
+    void clearCounts() {
+        for (long[] page : pages) {
+            if (page != null) {
+                Arrays.fill(page, 0);
+            }
+        }
+        totalCount = 0;
+    }
+
+    @Override
+    public PagedHistogram copy() {
+        PagedHistogram copy = new PagedHistogram(this);
+        copy.add(this);
+        return copy;
+    }
+
+    @Override
+    public PagedHistogram copyCorrectedForCoordinatedOmission(final long expectedIntervalBetweenValueSamples) {
+        PagedHistogram toHistogram = new PagedHistogram(this);
+        toHistogram.addWhileCorrectingForCoordinatedOmission(this, expectedIntervalBetweenValueSamples);
+        return toHistogram;
+    }
+
+    @Override
+    int _getEstimatedFootprintInBytes() {
+        // Each allocated page costs an array header in addition to its counts:
+        return 512 + (4 * pages.length) + (getNumberOfAllocatedPages() * (16 + (8 * subBucketHalfCount)));
+    }
+
+    @Override
+    void resize(long newHighestTrackableValue) {
+        final int oldNormalizedZeroIndex = normalizeIndex(0, normalizingIndexOffset, countsArrayLength);
+        final int oldNumberOfPages = pages.length;
+
+        establishSize(newHighestTrackableValue);
+
+        final int numberOfPages = countsArrayLength >> subBucketHalfCountMagnitude;
+        pages = Arrays.copyOf(pages, numberOfPages);
+
+        if (oldNormalizedZeroIndex != 0) {
+            // We need to shift the pages from the zero index and up to the end of the directory. Normalizing
+            // offsets are always whole multiples of half-buckets, so whole pages can be moved:
+            final int oldZeroPageIndex = oldNormalizedZeroIndex >> subBucketHalfCountMagnitude;
+            final int newZeroPageIndex = oldZeroPageIndex + (numberOfPages - oldNumberOfPages);
+            System.arraycopy(pages, oldZeroPageIndex, pages, newZeroPageIndex, oldNumberOfPages - oldZeroPageIndex);
+            Arrays.fill(pages, oldZeroPageIndex, newZeroPageIndex, null);
+        }
+    }
+
+    /**
+     * Construct an auto-resizing PagedHistogram with a lowest discernible value of 1 and an auto-adjusting
+     * highestTrackableValue. Can auto-resize up to track values up to (Long.MAX_VALUE / 2).
+     *
+     * @param numberOfSignificantValueDigits Specifies the precision to use. This is the number of significant
+     *                                       decimal digits to which the histogram will maintain value resolution
+     *                                       and separation. Must be a non-negative integer between 0 and 5.
+     */
+    public PagedHistogram(final int numberOfSignificantValueDigits) {
+        this(1, 2, numberOfSignificantValueDigits);
+        setAutoResize(true);
+    }
+
+    /**
+     * Construct a PagedHistogram given the Highest value to be tracked and a number of significant decimal digits.
+     * The histogram will be constructed to implicitly track (distinguish from 0) values as low as 1.
+     *
+     * @param highestTrackableValue The highest value to be tracked by the histogram. Must be a positive
+     *                              integer that is {@literal >=} 2.
+     * @param numberOfSignificantValueDigits Specifies the precision to use. This is the number of significant
+     *                                       decimal digits to which the histogram will maintain value resolution
+     *                                       and separation. Must be a non-negative integer between 0 and 5.
+     */
+    public PagedHistogram(final long highestTrackableValue, final int numberOfSignificantValueDigits) {
+        this(1, highestTrackableValue, numberOfSignificantValueDigits);
+    }
+
+    /**
+     * Construct a PagedHistogram given the Lowest and Highest values to be tracked and a number of significant
+     * decimal digits. Providing a lowestDiscernibleValue is useful is situations where the units used
+     * for the histogram's values are much smaller that the minimal accuracy required. E.g. when tracking
+     * time values stated in nanosecond units, where the minimal accuracy required is a microsecond, the
+     * proper value for lowestDiscernibleValue would be 1000.
+     *
+     * @param lowestDiscernibleValue The lowest value that can be tracked (distinguished from 0) by the histogram.
+     *                               Must be a positive integer that is {@literal >=} 1. May be internally rounded
+     *                               down to nearest power of 2.
+     * @param highestTrackableValue The highest value to be tracked by the histogram. Must be a positive
+     *                              integer that is {@literal >=} (2 * lowestDiscernibleValue).
+     * @param numberOfSignificantValueDigits Specifies the precision to use. This is the number of significant
+     *                                       decimal digits to which the histogram will maintain value resolution
+     *                                       and separation. Must be a non-negative integer between 0 and 5.
+     */
+    public PagedHistogram(final long lowestDiscernibleValue, final long highestTrackableValue,
+                          final int numberOfSignificantValueDigits) {
+        super(lowestDiscernibleValue, highestTrackableValue, numberOfSignificantValueDigits, false);
+        pages = new long[countsArrayLength >> subBucketHalfCountMagnitude][];
+    }
+
+    /**
+     * Construct a PagedHistogram with the same range settings as a given source histogram,
+     * duplicating the source's start/end timestamps (but NOT it's contents)
+     * @param source The source histogram to duplicate
+     */
+    public PagedHistogram(final AbstractHistogram source) {
+        super(source, false);
+        pages = new long[countsArrayLength >> subBucketHalfCountMagnitude][];
+    }
+
+    /**
+     * Construct a new histogram by decoding it from a ByteBuffer.
+     * @param buffer The buffer to decode from
+     * @param minBarForHighestTrackableValue Force highestTrackableValue to be set at least this high
+     * @return The newly constructed histogram
+     */
+    public static PagedHistogram decodeFromByteBuffer(final ByteBuffer buffer,
+                                                      final long minBarForHighestTrackableValue) {
+        return decodeFromByteBuffer(buffer, PagedHistogram.class, minBarForHighestTrackableValue);
+    }
+
+    /**
+     * Construct a new histogram by decoding it from a compressed form in a ByteBuffer.
+     * @param buffer The buffer to decode from
+     * @param minBarForHighestTrackableValue Force highestTrackableValue to be set at least this high
+     * @return The newly constructed histogram
+     * @throws DataFormatException on error parsing/decompressing the buffer
+     */
+    public static PagedHistogram decodeFromCompressedByteBuffer(final ByteBuffer buffer,
+                                                                final long minBarForHighestTrackableValue)
+            throws DataFormatException {
+        return decodeFromCompressedByteBuffer(buffer, PagedHistogram.class, minBarForHighestTrackableValue);
+    }
+
+    private void readObject(final ObjectInputStream o)
+            throws IOException, ClassNotFoundException {
+        o.defaultReadObject();
+    }
+}
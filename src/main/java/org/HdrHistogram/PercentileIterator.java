@@ -36,6 +36,7 @@ public class PercentileIterator extends AbstractHistogramIterator implements Ite
         this.percentileLevelToIterateTo = 0.0;
         this.percentileLevelToIterateFrom = 0.0;
         this.reachedLastRecordedValue = false;
+        skipToLowestPopulatedIndex();
     }
 
     /**
@@ -59,6 +60,11 @@ public class PercentileIterator extends AbstractHistogramIterator implements Ite
         return false;
     }
 
+    @Override
+    void incrementSubBucket() {
+        incrementToNextPopulatedSubBucket();
+    }
+
     @Override
     void incrementIterationLevel() {
         percentileLevelToIterateFrom = percentileLevelToIterateTo;
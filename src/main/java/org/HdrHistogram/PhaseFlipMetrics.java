@@ -0,0 +1,101 @@
+/**
+ * Written by Gil Tene of Azul Systems, and released to the public domain,
+ * as explained at http://creativecommons.org/publicdomain/zero/1.0/
+ *
+ * @author Gil Tene
+ */
+
+package org.HdrHistogram;
+
+/**
+ * Collects per-flip instrumentation from a {@link WriterReaderPhaser} (and from the recorders that use one, e.g.
+ * {@link Recorder} and {@link SingleWriterRecorder}), each in a histogram of its own:
+ * <ul>
+ * <li>Flip wait times: the time (in nanoseconds) each {@link WriterReaderPhaser#flipPhase(long) flipPhase} call
+ * spent waiting for in-flight writer critical sections to drain.</li>
+ * <li>Flip wait iterations: the number of wait loop iterations (spins, yields, sleeps or parks) each flip
+ * needed before the writers drained. Flips that did not need to wait record a zero.</li>
+ * <li>Writer enters per phase: the number of writer critical section entries during each phase that was
+ * ended by a flip.</li>
+ * </ul>
+ * A {@link PhaseFlipMetrics} instance is attached with {@link WriterReaderPhaser#setFlipMetrics}, and may be shared
+ * by several phasers. Flips are only timed while metrics are attached. Accessors return copies of the collected
+ * histograms, and may be called from any thread.
+ */
+public class PhaseFlipMetrics {
+    private final Histogram flipWaitTimesNsec;
+    private final Histogram flipWaitIterations;
+    private final Histogram writerEntersPerPhase;
+
+    /**
+     * Construct a {@link PhaseFlipMetrics} whose (auto-resizing) histograms maintain a value resolution
+     * and separation of 3 significant decimal digits.
+     */
+    public PhaseFlipMetrics() {
+        this(3);
+    }
+
+    /**
+     * Construct a {@link PhaseFlipMetrics} whose (auto-resizing) histograms maintain a given value resolution.
+     *
+     * @param numberOfSignificantValueDigits Specifies the precision to use. This is the number of significant
+     *                                       decimal digits to which the histograms will maintain value resolution
+     *                                       and separation. Must be a non-negative integer between 0 and 5.
+     */
+    public PhaseFlipMetrics(final int numberOfSignificantValueDigits) {
+        flipWaitTimesNsec = new Histogram(numberOfSignificantValueDigits);
+        flipWaitIterations = new Histogram(numberOfSignificantValueDigits);
+        writerEntersPerPhase = new Histogram(numberOfSignificantValueDigits);
+    }
+
+    synchronized void recordFlip(final long waitTimeNsec, final long waitIterations, final long writerEnters) {
+        flipWaitTimesNsec.recordValue(Math.max(waitTimeNsec, 0));
+        flipWaitIterations.recordValue(waitIterations);
+        writerEntersPerPhase.recordValue(writerEnters);
+    }
+
+    /**
+     * Get the number of phase flips recorded so far.
+     *
+     * @return the number of phase flips recorded
+     */
+    public synchronized long getFlipCount() {
+        return flipWaitTimesNsec.getTotalCount();
+    }
+
+    /**
+     * Get a copy of the histogram of flip wait times (in nanoseconds).
+     *
+     * @return a copy of the flip wait times histogram
+     */
+    public synchronized Histogram getFlipWaitTimesNsec() {
+        return flipWaitTimesNsec.copy();
+    }
+
+    /**
+     * Get a copy of the histogram of wait loop iterations per flip.
+     *
+     * @return a copy of the flip wait iterations histogram
+     */
+    public synchronized Histogram getFlipWaitIterations() {
+        return flipWaitIterations.copy();
+    }
+
+    /**
+     * Get a copy of the histogram of writer critical section entries per (flipped) phase.
+     *
+     * @return a copy of the writer enters per phase histogram
+     */
+    public synchronized Histogram getWriterEntersPerPhase() {
+        return writerEntersPerPhase.copy();
+    }
+
+    /**
+     * Reset all collected metrics.
+     */
+    public synchronized void reset() {
+        flipWaitTimesNsec.reset();
+        flipWaitIterations.reset();
+        writerEntersPerPhase.reset();
+    }
+}
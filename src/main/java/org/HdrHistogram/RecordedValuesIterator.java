@@ -28,6 +28,7 @@ public class RecordedValuesIterator extends AbstractHistogramIterator implements
     private void reset(final AbstractHistogram histogram) {
         super.resetIterator(histogram);
         visitedIndex = -1;
+        skipToLowestPopulatedIndex();
     }
 
     /**
@@ -37,6 +38,11 @@ public class RecordedValuesIterator extends AbstractHistogramIterator implements
         reset(histogram);
     }
 
+    @Override
+    void incrementSubBucket() {
+        incrementToNextPopulatedSubBucket();
+    }
+
     @Override
     void incrementIterationLevel() {
         visitedIndex = currentIndex;
@@ -43,7 +43,7 @@ public class Recorder implements ValueRecorder, IntervalHistogramProvider<Histog
     private static AtomicLong instanceIdSequencer = new AtomicLong(1);
     private final long instanceId = instanceIdSequencer.getAndIncrement();
 
-    private final WriterReaderPhaser recordingPhaser = new WriterReaderPhaser();
+    private final WriterReaderPhaser recordingPhaser;
 
     private volatile Histogram activeHistogram;
     private Histogram inactiveHistogram;
@@ -65,6 +65,23 @@ public class Recorder implements ValueRecorder, IntervalHistogramProvider<Histog
      * @param packed Specifies whether the recorder will uses a packed internal representation or not.
      */
     public Recorder(final int numberOfSignificantValueDigits, boolean packed) {
+        this(numberOfSignificantValueDigits, packed, false);
+    }
+
+    /**
+     * Construct an auto-resizing {@link Recorder} with a lowest discernible value of
+     * 1 and an auto-adjusting highestTrackableValue. Can auto-resize up to track values up to (Long.MAX_VALUE / 2).
+     *
+     * @param numberOfSignificantValueDigits Specifies the precision to use. This is the number of significant
+     *                                       decimal digits to which the histogram will maintain value resolution
+     *                                       and separation. Must be a non-negative integer between 0 and 5.
+     * @param packed Specifies whether the recorder will uses a packed internal representation or not.
+     * @param stripedPhaser Specifies whether the recorder coordinates recording with interval sampling using a
+     *                      {@link StripedWriterReaderPhaser} (which scales better with many concurrently recording
+     *                      threads) rather than a {@link WriterReaderPhaser}.
+     */
+    public Recorder(final int numberOfSignificantValueDigits, boolean packed, boolean stripedPhaser) {
+        recordingPhaser = stripedPhaser ? new StripedWriterReaderPhaser() : new WriterReaderPhaser();
         activeHistogram = packed ?
                 new InternalPackedConcurrentHistogram(instanceId, numberOfSignificantValueDigits) :
                 new InternalConcurrentHistogram(instanceId, numberOfSignificantValueDigits);
@@ -118,8 +135,66 @@ public class Recorder implements ValueRecorder, IntervalHistogramProvider<Histog
     public Recorder(final long lowestDiscernibleValue,
                     final long highestTrackableValue,
                     final int numberOfSignificantValueDigits) {
-        activeHistogram = new InternalAtomicHistogram(
-                instanceId, lowestDiscernibleValue, highestTrackableValue, numberOfSignificantValueDigits);
+        this(lowestDiscernibleValue, highestTrackableValue, numberOfSignificantValueDigits, false);
+    }
+
+    /**
+     * Construct a {@link Recorder} given the Lowest and highest values to be tracked and a number
+     * of significant decimal digits, optionally using a {@link StripedWriterReaderPhaser}.
+     *
+     * @param lowestDiscernibleValue The lowest value that can be tracked (distinguished from 0) by the histogram.
+     *                               Must be a positive integer that is {@literal >=} 1. May be internally rounded
+     *                               down to nearest power of 2.
+     * @param highestTrackableValue The highest value to be tracked by the histogram. Must be a positive
+     *                              integer that is {@literal >=} (2 * lowestDiscernibleValue).
+     * @param numberOfSignificantValueDigits Specifies the precision to use. This is the number of significant
+     *                                       decimal digits to which the histogram will maintain value resolution
+     *                                       and separation. Must be a non-negative integer between 0 and 5.
+     * @param stripedPhaser Specifies whether the recorder coordinates recording with interval sampling using a
+     *                      {@link StripedWriterReaderPhaser} (which scales better with many concurrently recording
+     *                      threads) rather than a {@link WriterReaderPhaser}.
+     */
+    public Recorder(final long lowestDiscernibleValue,
+                    final long highestTrackableValue,
+                    final int numberOfSignificantValueDigits,
+                    final boolean stripedPhaser) {
+        this(lowestDiscernibleValue, highestTrackableValue, numberOfSignificantValueDigits, stripedPhaser, false);
+    }
+
+    /**
+     * Construct a {@link Recorder} given the Lowest and highest values to be tracked and a number
+     * of significant decimal digits, optionally using a {@link StripedWriterReaderPhaser}, and optionally
+     * allocating interval histogram counts lazily.
+     * <p>
+     * With <b><code>lazyCountsAllocation</code></b> set, the {@link Recorder}'s interval histograms use
+     * lazy counts allocation (see {@link Histogram#setLazyCountsAllocation}): no counts are allocated until
+     * values are first recorded, and interval histograms that saw no recordings over a whole interval release
+     * their counts. Empty interval histograms then encode, add into others, and report without holding or
+     * touching a counts array. This suits large numbers of mostly idle recorders, at the cost of an allocation
+     * within the first recording call following an idle interval.
+     *
+     * @param lowestDiscernibleValue The lowest value that can be tracked (distinguished from 0) by the histogram.
+     *                               Must be a positive integer that is {@literal >=} 1. May be internally rounded
+     *                               down to nearest power of 2.
+     * @param highestTrackableValue The highest value to be tracked by the histogram. Must be a positive
+     *                              integer that is {@literal >=} (2 * lowestDiscernibleValue).
+     * @param numberOfSignificantValueDigits Specifies the precision to use. This is the number of significant
+     *                                       decimal digits to which the histogram will maintain value resolution
+     *                                       and separation. Must be a non-negative integer between 0 and 5.
+     * @param stripedPhaser Specifies whether the recorder coordinates recording with interval sampling using a
+     *                      {@link StripedWriterReaderPhaser} (which scales better with many concurrently recording
+     *                      threads) rather than a {@link WriterReaderPhaser}.
+     * @param lazyCountsAllocation Specifies whether the recorder's interval histograms allocate their counts
+     *                             lazily.
+     */
+    public Recorder(final long lowestDiscernibleValue,
+                    final long highestTrackableValue,
+                    final int numberOfSignificantValueDigits,
+                    final boolean stripedPhaser,
+                    final boolean lazyCountsAllocation) {
+        recordingPhaser = stripedPhaser ? new StripedWriterReaderPhaser() : new WriterReaderPhaser();
+        activeHistogram = new InternalAtomicHistogram(instanceId, lowestDiscernibleValue, highestTrackableValue,
+                numberOfSignificantValueDigits, lazyCountsAllocation);
         inactiveHistogram = null;
         activeHistogram.setStartTimeStamp(System.currentTimeMillis());
     }
@@ -183,6 +258,29 @@ public class Recorder implements ValueRecorder, IntervalHistogramProvider<Histog
         }
     }
 
+    /**
+     * Record a batch of values
+     * <p>
+     * The whole batch is recorded within a single writer critical section, such that each batch is
+     * entirely contained in a single interval histogram. Since a concurrent
+     * {@link #getIntervalHistogram()} call waits for in-flight batches to complete, very large batches
+     * may delay interval sampling.
+     *
+     * @param values The array holding the values to be recorded
+     * @param offset The index in <b><code>values</code></b> of the first value to record
+     * @param length The number of values to record
+     * @throws ArrayIndexOutOfBoundsException (may throw) if a value exceeds highestTrackableValue
+     */
+    public void recordValues(final long[] values, final int offset, final int length)
+            throws ArrayIndexOutOfBoundsException {
+        long criticalValueAtEnter = recordingPhaser.writerCriticalSectionEnter();
+        try {
+            activeHistogram.recordValues(values, offset, length);
+        } finally {
+            recordingPhaser.writerCriticalSectionExit(criticalValueAtEnter);
+        }
+    }
+
     @Override
     public synchronized Histogram getIntervalHistogram() {
         return getIntervalHistogram(null);
@@ -221,6 +319,25 @@ public class Recorder implements ValueRecorder, IntervalHistogramProvider<Histog
         performIntervalSample();
     }
 
+    /**
+     * Collect flip wait times, wait iterations and writer enters per interval for subsequent interval
+     * samples into the given {@link PhaseFlipMetrics}.
+     *
+     * @param flipMetrics the metrics to collect into, or null to stop collecting flip metrics
+     */
+    public void setFlipMetrics(PhaseFlipMetrics flipMetrics) {
+        recordingPhaser.setFlipMetrics(flipMetrics);
+    }
+
+    /**
+     * Get the {@link PhaseFlipMetrics} (if any) that interval sample flips are currently collected into.
+     *
+     * @return the attached flip metrics, or null if none are attached
+     */
+    public PhaseFlipMetrics getFlipMetrics() {
+        return recordingPhaser.getFlipMetrics();
+    }
+
     private void performIntervalSample() {
         try {
             recordingPhaser.readerLock();
@@ -232,7 +349,8 @@ public class Recorder implements ValueRecorder, IntervalHistogramProvider<Histog
                             instanceId,
                             activeHistogram.getLowestDiscernibleValue(),
                             activeHistogram.getHighestTrackableValue(),
-                            activeHistogram.getNumberOfSignificantValueDigits());
+                            activeHistogram.getNumberOfSignificantValueDigits(),
+                            activeHistogram.isLazyCountsAllocation());
                 } else if (activeHistogram instanceof InternalConcurrentHistogram) {
                     inactiveHistogram = new InternalConcurrentHistogram(
                             instanceId,
@@ -261,7 +379,7 @@ public class Recorder implements ValueRecorder, IntervalHistogramProvider<Histog
             // Make sure we are not in the middle of recording a value on the previously active histogram:
 
             // Flip phase to make sure no recordings that were in flight pre-flip are still active:
-            recordingPhaser.flipPhase(500000L /* yield in 0.5 msec units if needed */);
+            recordingPhaser.adaptiveFlipPhase(500000L /* park in up to 0.5 msec units if needed */);
         } finally {
             recordingPhaser.readerUnlock();
         }
@@ -273,9 +391,14 @@ public class Recorder implements ValueRecorder, IntervalHistogramProvider<Histog
         private InternalAtomicHistogram(long id,
                                         long lowestDiscernibleValue,
                                         long highestTrackableValue,
-                                        int numberOfSignificantValueDigits) {
-            super(lowestDiscernibleValue, highestTrackableValue, numberOfSignificantValueDigits);
+                                        int numberOfSignificantValueDigits,
+                                        boolean lazyCountsAllocation) {
+            super(lowestDiscernibleValue, highestTrackableValue, numberOfSignificantValueDigits,
+                    !lazyCountsAllocation);
             this.containingInstanceId = id;
+            this.lazyCountsAllocation = lazyCountsAllocation;
+            // Interval histograms are recorded into far more often than they are queried:
+            setLazyMinMaxTracking(true);
         }
     }
 
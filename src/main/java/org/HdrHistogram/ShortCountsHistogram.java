@@ -69,6 +69,16 @@ public class ShortCountsHistogram extends AbstractHistogram {
         counts[index] = (short) value;
     }
 
+    @Override
+    boolean countsArrayIsPlain() {
+        return true;
+    }
+
+    @Override
+    Object getPlainCountsArray() {
+        return countsArrayIsPlain() ? counts : null;
+    }
+
     @Override
     int getNormalizingIndexOffset() {
         return normalizingIndexOffset;
@@ -193,6 +193,25 @@ public class SingleWriterDoubleRecorder implements DoubleValueRecorder, Interval
         performIntervalSample();
     }
 
+    /**
+     * Collect flip wait times, wait iterations and writer enters per interval for subsequent interval
+     * samples into the given {@link PhaseFlipMetrics}.
+     *
+     * @param flipMetrics the metrics to collect into, or null to stop collecting flip metrics
+     */
+    public void setFlipMetrics(PhaseFlipMetrics flipMetrics) {
+        recordingPhaser.setFlipMetrics(flipMetrics);
+    }
+
+    /**
+     * Get the {@link PhaseFlipMetrics} (if any) that interval sample flips are currently collected into.
+     *
+     * @return the attached flip metrics, or null if none are attached
+     */
+    public PhaseFlipMetrics getFlipMetrics() {
+        return recordingPhaser.getFlipMetrics();
+    }
+
     private void performIntervalSample() {
         try {
             recordingPhaser.readerLock();
@@ -224,7 +243,7 @@ public class SingleWriterDoubleRecorder implements DoubleValueRecorder, Interval
             // Make sure we are not in the middle of recording a value on the previously active histogram:
 
             // Flip phase to make sure no recordings that were in flight pre-flip are still active:
-            recordingPhaser.flipPhase(500000L /* yield in 0.5 msec units if needed */);
+            recordingPhaser.adaptiveFlipPhase(500000L /* park in up to 0.5 msec units if needed */);
         } finally {
             recordingPhaser.readerUnlock();
         }
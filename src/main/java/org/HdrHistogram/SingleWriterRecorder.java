@@ -184,6 +184,29 @@ public class SingleWriterRecorder implements ValueRecorder, IntervalHistogramPro
         }
     }
 
+    /**
+     * Record a batch of values
+     * <p>
+     * The whole batch is recorded within a single writer critical section, such that each batch is
+     * entirely contained in a single interval histogram. Since a concurrent
+     * {@link #getIntervalHistogram()} call waits for in-flight batches to complete, very large batches
+     * may delay interval sampling.
+     *
+     * @param values The array holding the values to be recorded
+     * @param offset The index in <b><code>values</code></b> of the first value to record
+     * @param length The number of values to record
+     * @throws ArrayIndexOutOfBoundsException (may throw) if a value exceeds highestTrackableValue
+     */
+    public void recordValues(final long[] values, final int offset, final int length)
+            throws ArrayIndexOutOfBoundsException {
+        long criticalValueAtEnter = recordingPhaser.writerCriticalSectionEnter();
+        try {
+            activeHistogram.recordValues(values, offset, length);
+        } finally {
+            recordingPhaser.writerCriticalSectionExit(criticalValueAtEnter);
+        }
+    }
+
     @Override
     public synchronized Histogram getIntervalHistogram() {
         return getIntervalHistogram(null);
@@ -222,6 +245,25 @@ public class SingleWriterRecorder implements ValueRecorder, IntervalHistogramPro
         performIntervalSample();
     }
 
+    /**
+     * Collect flip wait times, wait iterations and writer enters per interval for subsequent interval
+     * samples into the given {@link PhaseFlipMetrics}.
+     *
+     * @param flipMetrics the metrics to collect into, or null to stop collecting flip metrics
+     */
+    public void setFlipMetrics(PhaseFlipMetrics flipMetrics) {
+        recordingPhaser.setFlipMetrics(flipMetrics);
+    }
+
+    /**
+     * Get the {@link PhaseFlipMetrics} (if any) that interval sample flips are currently collected into.
+     *
+     * @return the attached flip metrics, or null if none are attached
+     */
+    public PhaseFlipMetrics getFlipMetrics() {
+        return recordingPhaser.getFlipMetrics();
+    }
+
     private void performIntervalSample() {
         try {
             recordingPhaser.readerLock();
@@ -253,7 +295,7 @@ public class SingleWriterRecorder implements ValueRecorder, IntervalHistogramPro
             // Make sure we are not in the middle of recording a value on the previously active histogram:
 
             // Flip phase to make sure no recordings that were in flight pre-flip are still active:
-            recordingPhaser.flipPhase(500000L /* yield in 0.5 msec units if needed */);
+            recordingPhaser.adaptiveFlipPhase(500000L /* park in up to 0.5 msec units if needed */);
         } finally {
             recordingPhaser.readerUnlock();
         }
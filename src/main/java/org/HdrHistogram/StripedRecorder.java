@@ -0,0 +1,364 @@
+/**
+ * Written by Gil Tene of Azul Systems, and released to the public domain,
+ * as explained at http://creativecommons.org/publicdomain/zero/1.0/
+ *
+ * @author Gil Tene
+ */
+
+package org.HdrHistogram;
+
+import java.util.concurrent.CopyOnWriteArrayList;
+import java.util.concurrent.atomic.AtomicLong;
+
+/**
+ * Records integer values from multiple concurrent threads, and provides stable interval {@link Histogram} samples
+ * from live recorded data without interrupting or stalling active recording of values. Each interval histogram
+ * provided contains all value counts accumulated since the previous interval histogram was taken.
+ * <p>
+ * Unlike {@link Recorder}, which has all recording threads update a single shared concurrent histogram,
+ * {@link StripedRecorder} gives each recording thread its own stripe: a pair of plain (non-atomic)
+ * {@link Histogram}s guarded by a per-stripe {@link WriterReaderPhaser}. Recording threads therefore never
+ * contend on shared counts, total count or min/max fields, and recording calls cost about the same as those of a
+ * {@link SingleWriterRecorder}, regardless of the number of recording threads. The stripes are merged into a
+ * single histogram when an interval histogram is taken, so interval sampling cost grows with the number of
+ * recording threads. Stripes of threads that have terminated are dropped once their contents have been sampled.
+ * <p>
+ * {@link StripedRecorder} is a good fit for many (e.g. 32+) threads recording into the same recorder at high
+ * rates. For a handful of recording threads, {@link Recorder} is usually the better (more memory efficient)
+ * choice, as each {@link StripedRecorder} stripe holds two histograms.
+ * <p>
+ * Recording calls are wait-free on architectures that support atomic increment operations, and
+ * are lock-free on architectures that do not.
+ * <p>
+ * A common pattern for using a {@link StripedRecorder} looks like this:
+ * <br><pre><code>
+ * StripedRecorder recorder = new StripedRecorder(2); // Two decimal point accuracy
+ * Histogram intervalHistogram = null;
+ * ...
+ * [start of some loop construct that periodically wants to grab an interval histogram]
+ *   ...
+ *   // Get interval histogram, recycling previous interval histogram:
+ *   intervalHistogram = recorder.getIntervalHistogram(intervalHistogram);
+ *   histogramLogWriter.outputIntervalHistogram(intervalHistogram);
+ *   ...
+ * [end of loop construct]
+ * </code></pre>
+ */
+
+public class StripedRecorder implements ValueRecorder, IntervalHistogramProvider<Histogram> {
+    private static AtomicLong instanceIdSequencer = new AtomicLong(1);
+    private final long instanceId = instanceIdSequencer.getAndIncrement();
+
+    private final long lowestDiscernibleValue;
+    private final long highestTrackableValue;
+    private final int numberOfSignificantValueDigits;
+    private final boolean autoResize;
+
+    private final CopyOnWriteArrayList<Stripe> stripes = new CopyOnWriteArrayList<Stripe>();
+    private final ThreadLocal<Stripe> threadStripe = new ThreadLocal<Stripe>() {
+        @Override
+        protected Stripe initialValue() {
+            Stripe stripe = new Stripe(Thread.currentThread(), newInternalHistogram());
+            stripes.add(stripe);
+            return stripe;
+        }
+    };
+
+    private long intervalStartTimeStampMsec;
+
+    /**
+     * Construct an auto-resizing {@link StripedRecorder} with a lowest discernible value of
+     * 1 and an auto-adjusting highestTrackableValue. Can auto-resize up to track values up to (Long.MAX_VALUE / 2).
+     *
+     * @param numberOfSignificantValueDigits Specifies the precision to use. This is the number of significant
+     *                                       decimal digits to which the histogram will maintain value resolution
+     *                                       and separation. Must be a non-negative integer between 0 and 5.
+     */
+    public StripedRecorder(final int numberOfSignificantValueDigits) {
+        this(1, 2, numberOfSignificantValueDigits, true);
+    }
+
+    /**
+     * Construct a {@link StripedRecorder} given the highest value to be tracked and a number
+     * of significant decimal digits. The histogram will be constructed to implicitly track (distinguish from 0)
+     * values as low as 1.
+     *
+     * @param highestTrackableValue The highest value to be tracked by the histogram. Must be a positive
+     *                              integer that is {@literal >=} 2.
+     * @param numberOfSignificantValueDigits Specifies the precision to use. This is the number of significant
+     *                                       decimal digits to which the histogram will maintain value resolution
+     *                                       and separation. Must be a non-negative integer between 0 and 5.
+     */
+    public StripedRecorder(final long highestTrackableValue,
+                           final int numberOfSignificantValueDigits) {
+        this(1, highestTrackableValue, numberOfSignificantValueDigits);
+    }
+
+    /**
+     * Construct a {@link StripedRecorder} given the Lowest and highest values to be tracked
+     * and a number of significant decimal digits. Providing a lowestDiscernibleValue is useful is situations where
+     * the units used for the histogram's values are much smaller that the minimal accuracy required. E.g. when
+     * tracking time values stated in nanosecond units, where the minimal accuracy required is a microsecond, the
+     * proper value for lowestDiscernibleValue would be 1000.
+     *
+     * @param lowestDiscernibleValue The lowest value that can be tracked (distinguished from 0) by the histogram.
+     *                               Must be a positive integer that is {@literal >=} 1. May be internally rounded
+     *                               down to nearest power of 2.
+     * @param highestTrackableValue The highest value to be tracked by the histogram. Must be a positive
+     *                              integer that is {@literal >=} (2 * lowestDiscernibleValue).
+     * @param numberOfSignificantValueDigits Specifies the precision to use. This is the number of significant
+     *                                       decimal digits to which the histogram will maintain value resolution
+     *                                       and separation. Must be a non-negative integer between 0 and 5.
+     */
+    public StripedRecorder(final long lowestDiscernibleValue,
+                           final long highestTrackableValue,
+                           final int numberOfSignificantValueDigits) {
+        this(lowestDiscernibleValue, highestTrackableValue, numberOfSignificantValueDigits, false);
+    }
+
+    private StripedRecorder(final long lowestDiscernibleValue,
+                            final long highestTrackableValue,
+                            final int numberOfSignificantValueDigits,
+                            final boolean autoResize) {
+        this.lowestDiscernibleValue = lowestDiscernibleValue;
+        this.highestTrackableValue = highestTrackableValue;
+        this.numberOfSignificantValueDigits = numberOfSignificantValueDigits;
+        this.autoResize = autoResize;
+        // Validate the configuration up front, rather than on the first recording thread:
+        newInternalHistogram();
+        intervalStartTimeStampMsec = System.currentTimeMillis();
+    }
+
+    /**
+     * Record a value
+     * @param value the value to record
+     * @throws ArrayIndexOutOfBoundsException (may throw) if value exceeds highestTrackableValue
+     */
+    @Override
+    public void recordValue(final long value) throws ArrayIndexOutOfBoundsException {
+        final Stripe stripe = threadStripe.get();
+        long criticalValueAtEnter = stripe.recordingPhaser.writerCriticalSectionEnter();
+        try {
+            stripe.activeHistogram.recordValue(value);
+        } finally {
+            stripe.recordingPhaser.writerCriticalSectionExit(criticalValueAtEnter);
+        }
+    }
+
+    /**
+     * Record a value in the histogram (adding to the value's current count)
+     *
+     * @param value The value to be recorded
+     * @param count The number of occurrences of this value to record
+     * @throws ArrayIndexOutOfBoundsException (may throw) if value exceeds highestTrackableValue
+     */
+    @Override
+    public void recordValueWithCount(final long value, final long count) throws ArrayIndexOutOfBoundsException {
+        final Stripe stripe = threadStripe.get();
+        long criticalValueAtEnter = stripe.recordingPhaser.writerCriticalSectionEnter();
+        try {
+            stripe.activeHistogram.recordValueWithCount(value, count);
+        } finally {
+            stripe.recordingPhaser.writerCriticalSectionExit(criticalValueAtEnter);
+        }
+    }
+
+    /**
+     * Record a value
+     * <p>
+     * To compensate for the loss of sampled values when a recorded value is larger than the expected
+     * interval between value samples, Histogram will auto-generate an additional series of decreasingly-smaller
+     * (down to the expectedIntervalBetweenValueSamples) value records.
+     * <p>
+     * See related notes {@link AbstractHistogram#recordValueWithExpectedInterval(long, long)}
+     * for more explanations about coordinated omission and expected interval correction.
+     *
+     * @param value The value to record
+     * @param expectedIntervalBetweenValueSamples If expectedIntervalBetweenValueSamples is larger than 0, add
+     *                                           auto-generated value records as appropriate if value is larger
+     *                                           than expectedIntervalBetweenValueSamples
+     * @throws ArrayIndexOutOfBoundsException (may throw) if value exceeds highestTrackableValue
+     */
+    @Override
+    public void recordValueWithExpectedInterval(final long value, final long expectedIntervalBetweenValueSamples)
+            throws ArrayIndexOutOfBoundsException {
+        final Stripe stripe = threadStripe.get();
+        long criticalValueAtEnter = stripe.recordingPhaser.writerCriticalSectionEnter();
+        try {
+            stripe.activeHistogram.recordValueWithExpectedInterval(value, expectedIntervalBetweenValueSamples);
+        } finally {
+            stripe.recordingPhaser.writerCriticalSectionExit(criticalValueAtEnter);
+        }
+    }
+
+    /**
+     * Record a batch of values
+     * <p>
+     * The whole batch is recorded within a single writer critical section of the calling thread's stripe, such
+     * that each batch is entirely contained in a single interval histogram.
+     *
+     * @param values The array holding the values to be recorded
+     * @param offset The index in <b><code>values</code></b> of the first value to record
+     * @param length The number of values to record
+     * @throws ArrayIndexOutOfBoundsException (may throw) if a value exceeds highestTrackableValue
+     */
+    public void recordValues(final long[] values, final int offset, final int length)
+            throws ArrayIndexOutOfBoundsException {
+        final Stripe stripe = threadStripe.get();
+        long criticalValueAtEnter = stripe.recordingPhaser.writerCriticalSectionEnter();
+        try {
+            stripe.activeHistogram.recordValues(values, offset, length);
+        } finally {
+            stripe.recordingPhaser.writerCriticalSectionExit(criticalValueAtEnter);
+        }
+    }
+
+    @Override
+    public synchronized Histogram getIntervalHistogram() {
+        return getIntervalHistogram(null);
+    }
+
+    @Override
+    public synchronized Histogram getIntervalHistogram(Histogram histogramToRecycle) {
+        return getIntervalHistogram(histogramToRecycle, true);
+    }
+
+    @Override
+    public synchronized Histogram getIntervalHistogram(Histogram histogramToRecycle,
+                                                       boolean enforceContainingInstance) {
+        // Verify that replacement histogram can validly be used as an interval histogram:
+        validateFitAsReplacementHistogram(histogramToRecycle, enforceContainingInstance);
+        Histogram sampledHistogram = (histogramToRecycle != null) ? histogramToRecycle : newInternalHistogram();
+        performIntervalSample(sampledHistogram);
+        return sampledHistogram;
+    }
+
+    @Override
+    public synchronized void getIntervalHistogramInto(Histogram targetHistogram) {
+        performIntervalSample(targetHistogram);
+    }
+
+    /**
+     * Reset any value counts accumulated thus far.
+     */
+    @Override
+    public synchronized void reset() {
+        performIntervalSample(null);
+    }
+
+    /**
+     * @return the number of recording threads currently holding a stripe in this recorder
+     */
+    int getStripeCount() {
+        return stripes.size();
+    }
+
+    /**
+     * Flip each stripe's active and inactive histograms, and (if a target histogram is provided) merge the
+     * contents of the now-inactive histograms into it.
+     */
+    private void performIntervalSample(final Histogram targetHistogram) {
+        if (targetHistogram != null) {
+            targetHistogram.reset();
+        }
+        for (Stripe stripe : stripes) {
+            // Check for owner termination before sampling, so that all of the owner's recordings are captured:
+            final boolean ownerTerminated = !stripe.ownerThread.isAlive();
+            stripe.sample(targetHistogram, this);
+            if (ownerTerminated) {
+                // The owning thread is done recording, and its stripe contents have now been sampled:
+                stripes.remove(stripe);
+            }
+        }
+        // Mark end time of previous interval and start time of new one:
+        long now = System.currentTimeMillis();
+        if (targetHistogram != null) {
+            targetHistogram.setStartTimeStamp(intervalStartTimeStampMsec);
+            targetHistogram.setEndTimeStamp(now);
+        }
+        intervalStartTimeStampMsec = now;
+    }
+
+    private InternalHistogram newInternalHistogram() {
+        return autoResize ?
+                new InternalHistogram(instanceId, numberOfSignificantValueDigits) :
+                new InternalHistogram(instanceId,
+                        lowestDiscernibleValue, highestTrackableValue, numberOfSignificantValueDigits);
+    }
+
+    private static class Stripe {
+        final Thread ownerThread;
+        final WriterReaderPhaser recordingPhaser = new WriterReaderPhaser();
+        volatile Histogram activeHistogram;
+        Histogram inactiveHistogram;
+
+        Stripe(final Thread ownerThread, final Histogram activeHistogram) {
+            this.ownerThread = ownerThread;
+            this.activeHistogram = activeHistogram;
+        }
+
+        void sample(final Histogram targetHistogram, final StripedRecorder recorder) {
+            try {
+                recordingPhaser.readerLock();
+
+                // Make sure we have an inactive version to flip in:
+                if (inactiveHistogram == null) {
+                    inactiveHistogram = recorder.newInternalHistogram();
+                }
+
+                inactiveHistogram.reset();
+
+                // Swap active and inactive histograms:
+                final Histogram tempHistogram = inactiveHistogram;
+                inactiveHistogram = activeHistogram;
+                activeHistogram = tempHistogram;
+
+                // Flip phase to make sure no recordings that were in flight pre-flip are still active:
+                recordingPhaser.adaptiveFlipPhase(500000L /* park in up to 0.5 msec units if needed */);
+
+                if (targetHistogram != null) {
+                    targetHistogram.add(inactiveHistogram);
+                }
+            } finally {
+                recordingPhaser.readerUnlock();
+            }
+        }
+    }
+
+    private static class InternalHistogram extends Histogram {
+        private final long containingInstanceId;
+
+        private InternalHistogram(long id, int numberOfSignificantValueDigits) {
+            super(numberOfSignificantValueDigits);
+            this.containingInstanceId = id;
+        }
+
+        private InternalHistogram(long id,
+                                  long lowestDiscernibleValue,
+                                  long highestTrackableValue,
+                                  int numberOfSignificantValueDigits) {
+            super(lowestDiscernibleValue, highestTrackableValue, numberOfSignificantValueDigits);
+            this.containingInstanceId = id;
+        }
+    }
+
+    private void validateFitAsReplacementHistogram(Histogram replacementHistogram,
+                                                   boolean enforceContainingInstance) {
+        boolean bad = true;
+        if (replacementHistogram == null) {
+            bad = false;
+        } else if ((replacementHistogram instanceof InternalHistogram)
+                &&
+                ((!enforceContainingInstance) ||
+                        (((InternalHistogram) replacementHistogram).containingInstanceId == instanceId)
+                )) {
+            bad = false;
+        }
+
+        if (bad) {
+            throw new IllegalArgumentException("replacement histogram must have been obtained via a previous " +
+                    "getIntervalHistogram() call from this " + this.getClass().getName() +
+                    (enforceContainingInstance ? " instance" : " class"));
+        }
+    }
+}
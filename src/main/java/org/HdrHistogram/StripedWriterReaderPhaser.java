@@ -0,0 +1,170 @@
+/**
+ * Written by Gil Tene of Azul Systems, and released to the public domain,
+ * as explained at http://creativecommons.org/publicdomain/zero/1.0/
+ */
+
+package org.HdrHistogram;
+
+import java.util.concurrent.atomic.AtomicLongArray;
+
+/**
+ * A {@link WriterReaderPhaser} that spreads writer epoch counting across multiple cache-line padded cells, so that
+ * concurrently entering writers do not all contend on the same start and end epoch counters.
+ * <p>
+ * {@link WriterReaderPhaser} writers each perform an atomic increment on a shared start epoch when entering their
+ * critical section, and on a shared end epoch when exiting it. With many concurrently writing threads, the cache
+ * lines holding these counters bounce between cores on every write. {@link StripedWriterReaderPhaser} writers
+ * instead increment the epochs of a cell selected by their thread's identity, and a reader phase flip flips
+ * and sums the epochs of all cells. Writer critical sections remain wait-free (on architectures that support
+ * wait-free atomic increment operations), while phase flips become proportionally more expensive with the
+ * number of cells.
+ * <p>
+ * {@link StripedWriterReaderPhaser} provides the same assumptions, guarantees and usage patterns as
+ * {@link WriterReaderPhaser}, and can be used wherever a {@link WriterReaderPhaser} is. It is a good fit for
+ * many (e.g. 8+) threads writing at high rates; with a few writer threads, a {@link WriterReaderPhaser} is
+ * just as fast, and has cheaper phase flips.
+ */
+/*
+ * Each cell holds a start epoch and even and odd end epochs, laid out in a single AtomicLongArray with a
+ * stride (and leading padding) of 128 bytes, which keeps cells on separate (and separately prefetched) cache
+ * lines. All cells are always in the same (odd or even) phase, as they are only flipped together, under the
+ * reader lock. The opaque value returned to writers on entry carries the phase in its sign bit and the
+ * writer's cell offset in its low bits, which is all the matching exit needs.
+ */
+
+public class StripedWriterReaderPhaser extends WriterReaderPhaser {
+    private static final int CELL_STRIDE = 16; // In longs, i.e. 128 bytes
+    private static final int START_EPOCH = 0;
+    private static final int EVEN_END_EPOCH = 1;
+    private static final int ODD_END_EPOCH = 2;
+    private static final int MAX_CELLS = 1 << 12;
+
+    private final int numberOfCells;
+    private final int cellMask;
+    private final AtomicLongArray epochs;
+
+    // Reader-side flip state (only accessed while holding the readerLock):
+    private final long[] startValuesAtFlip;
+    private boolean nextPhaseIsEven;
+    private int drainedCells;
+
+    /**
+     * Construct a {@link StripedWriterReaderPhaser} with a number of cells matching the number of available
+     * processors (rounded up to the next power of 2).
+     */
+    public StripedWriterReaderPhaser() {
+        this(Runtime.getRuntime().availableProcessors());
+    }
+
+    /**
+     * Construct a {@link StripedWriterReaderPhaser} with a given number of cells.
+     *
+     * @param numberOfCells The number of writer epoch cells to use. Will be rounded up to the next power of 2,
+     *                      and must be between 1 and 4096.
+     */
+    public StripedWriterReaderPhaser(final int numberOfCells) {
+        if ((numberOfCells < 1) || (numberOfCells > MAX_CELLS)) {
+            throw new IllegalArgumentException("numberOfCells must be between 1 and " + MAX_CELLS);
+        }
+        this.numberOfCells = (numberOfCells == 1) ? 1 : Integer.highestOneBit(numberOfCells - 1) << 1;
+        cellMask = this.numberOfCells - 1;
+        epochs = new AtomicLongArray((this.numberOfCells + 2) * CELL_STRIDE);
+        for (int cell = 0; cell < this.numberOfCells; cell++) {
+            epochs.set(cellOffset(cell) + ODD_END_EPOCH, Long.MIN_VALUE);
+        }
+        startValuesAtFlip = new long[this.numberOfCells];
+    }
+
+    /**
+     * Get the number of writer epoch cells used by this phaser.
+     *
+     * @return the number of writer epoch cells
+     */
+    public int getNumberOfCells() {
+        return numberOfCells;
+    }
+
+    private static int cellOffset(final int cell) {
+        return (cell + 1) * CELL_STRIDE; // Leave a padding stride ahead of the first cell
+    }
+
+    private int cellOffsetForCurrentThread() {
+        // Spread (typically sequential) thread ids across the cells:
+        final long hash = Thread.currentThread().getId() * 0x9E3779B97F4A7C15L;
+        return cellOffset((int) (hash >>> 32) & cellMask);
+    }
+
+    /**
+     * Indicate entry to a critical section containing a write operation.
+     * <p>
+     * This call is wait-free on architectures that support wait free atomic increment operations,
+     * and is lock-free on architectures that do not.
+     * <p>
+     * {@code writerCriticalSectionEnter()} must be matched with a subsequent
+     * {@link StripedWriterReaderPhaser#writerCriticalSectionExit(long)} in order for
+     * {@link StripedWriterReaderPhaser} synchronization to function properly.
+     *
+     * @return an (opaque) value associated with the critical section entry, which MUST be provided
+     * to the matching {@link StripedWriterReaderPhaser#writerCriticalSectionExit} call.
+     */
+    @Override
+    public long writerCriticalSectionEnter() {
+        final int cellOffset = cellOffsetForCurrentThread();
+        final long startEpoch = epochs.getAndIncrement(cellOffset + START_EPOCH);
+        return (startEpoch & Long.MIN_VALUE) | cellOffset;
+    }
+
+    /**
+     * Indicate exit from a critical section containing a write operation.
+     * <p>
+     * This call is wait-free on architectures that support wait free atomic increment operations,
+     * and is lock-free on architectures that do not.
+     * <p>
+     * {@code writerCriticalSectionExit(long)} must be matched with a preceding
+     * {@link StripedWriterReaderPhaser#writerCriticalSectionEnter()} call, and must be provided with the
+     * matching {@link StripedWriterReaderPhaser#writerCriticalSectionEnter()} call's return value, in
+     * order for {@link StripedWriterReaderPhaser} synchronization to function properly.
+     *
+     * @param criticalValueAtEnter the (opaque) value returned from the matching
+     * {@link StripedWriterReaderPhaser#writerCriticalSectionEnter()} call.
+     */
+    @Override
+    public void writerCriticalSectionExit(final long criticalValueAtEnter) {
+        final int cellOffset = (int) (criticalValueAtEnter & Integer.MAX_VALUE);
+        epochs.getAndIncrement(cellOffset + ((criticalValueAtEnter < 0) ? ODD_END_EPOCH : EVEN_END_EPOCH));
+    }
+
+    @Override
+    long flipEpochs() {
+        // All cells are in the same phase, so the first cell's start epoch tells us which one:
+        nextPhaseIsEven = (epochs.get(cellOffset(0) + START_EPOCH) < 0); // Current phase is odd...
+        final long initialStartValue = nextPhaseIsEven ? 0 : Long.MIN_VALUE;
+        final int nextPhaseEndEpoch = nextPhaseIsEven ? EVEN_END_EPOCH : ODD_END_EPOCH;
+
+        // First, clear all currently unused [next] phase end epochs (to proper initial value for phase):
+        for (int cell = 0; cell < numberOfCells; cell++) {
+            epochs.lazySet(cellOffset(cell) + nextPhaseEndEpoch, initialStartValue);
+        }
+
+        // Next, reset all start values, indicating new phase, and retain values at flip:
+        long writerEnters = 0;
+        for (int cell = 0; cell < numberOfCells; cell++) {
+            startValuesAtFlip[cell] = epochs.getAndSet(cellOffset(cell) + START_EPOCH, initialStartValue);
+            writerEnters += startValuesAtFlip[cell] - (nextPhaseIsEven ? Long.MIN_VALUE : 0);
+        }
+        drainedCells = 0;
+        return writerEnters;
+    }
+
+    @Override
+    boolean previousPhaseDrained() {
+        final int previousPhaseEndEpoch = nextPhaseIsEven ? ODD_END_EPOCH : EVEN_END_EPOCH;
+        // Cells that have drained stay drained, so we only need to re-check the remaining ones:
+        for (; drainedCells < numberOfCells; drainedCells++) {
+            if (epochs.get(cellOffset(drainedCells) + previousPhaseEndEpoch) != startValuesAtFlip[drainedCells]) {
+                return false;
+            }
+        }
+        return true;
+    }
+}
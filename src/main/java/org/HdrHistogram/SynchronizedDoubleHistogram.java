@@ -373,6 +373,11 @@ public class SynchronizedDoubleHistogram extends DoubleHistogram {
         return super.getValueAtPercentile(percentile);
     }
 
+    @Override
+    public synchronized void getValuesAtPercentiles(final double[] percentiles, final double[] valuesAtPercentiles) {
+        super.getValuesAtPercentiles(percentiles, valuesAtPercentiles);
+    }
+
     @Override
     public synchronized double getPercentileAtOrBelowValue(final double value) {
         return super.getPercentileAtOrBelowValue(value);
@@ -457,6 +462,13 @@ public class SynchronizedDoubleHistogram extends DoubleHistogram {
         return super.encodeIntoCompressedByteBuffer(targetBuffer, compressionLevel);
     }
 
+    @Override
+    public synchronized int encodeIntoCompressedByteBuffer(
+            final ByteBuffer targetBuffer,
+            final HistogramCompressionCodec codec) {
+        return super.encodeIntoCompressedByteBuffer(targetBuffer, codec);
+    }
+
     @Override
     public synchronized int encodeIntoCompressedByteBuffer(final ByteBuffer targetBuffer) {
         return super.encodeIntoCompressedByteBuffer(targetBuffer);
@@ -141,6 +141,21 @@ public class SynchronizedHistogram extends Histogram {
         super.setAutoResize(autoResize);
     }
 
+    @Override
+    public synchronized void setLazyMinMaxTracking(boolean lazyMinMaxTracking) {
+        super.setLazyMinMaxTracking(lazyMinMaxTracking);
+    }
+
+    @Override
+    public synchronized void setLazyCountsAllocation(boolean lazyCountsAllocation) {
+        super.setLazyCountsAllocation(lazyCountsAllocation);
+    }
+
+    @Override
+    public synchronized void setOccupancyTracking(final boolean occupancyTracking) {
+        super.setOccupancyTracking(occupancyTracking);
+    }
+
     @Override
     public synchronized void recordValue(final long value) throws ArrayIndexOutOfBoundsException {
         super.recordValue(value);
@@ -157,6 +172,12 @@ public class SynchronizedHistogram extends Histogram {
         super.recordValueWithExpectedInterval(value, expectedIntervalBetweenValueSamples);
     }
 
+    @Override
+    public synchronized void recordValues(final long[] values, final int offset, final int length)
+            throws ArrayIndexOutOfBoundsException {
+        super.recordValues(values, offset, length);
+    }
+
     /**
      * @deprecated
      */
@@ -436,6 +457,11 @@ public class SynchronizedHistogram extends Histogram {
         return super.getValueAtPercentile(percentile);
     }
 
+    @Override
+    public synchronized void getValuesAtPercentiles(final double[] percentiles, final long[] valuesAtPercentiles) {
+        super.getValuesAtPercentiles(percentiles, valuesAtPercentiles);
+    }
+
     @Override
     public synchronized double getPercentileAtOrBelowValue(final long value) {
         return super.getPercentileAtOrBelowValue(value);
@@ -515,6 +541,13 @@ public class SynchronizedHistogram extends Histogram {
         return super.encodeIntoCompressedByteBuffer(targetBuffer, compressionLevel);
     }
 
+    @Override
+    public synchronized int encodeIntoCompressedByteBuffer(
+            final ByteBuffer targetBuffer,
+            final HistogramCompressionCodec codec) {
+        return super.encodeIntoCompressedByteBuffer(targetBuffer, codec);
+    }
+
     @Override
     public synchronized int encodeIntoCompressedByteBuffer(final ByteBuffer targetBuffer) {
         return super.encodeIntoCompressedByteBuffer(targetBuffer);
@@ -7,6 +7,7 @@ package org.HdrHistogram;
 
 import java.util.concurrent.TimeUnit;
 import java.util.concurrent.atomic.AtomicLongFieldUpdater;
+import java.util.concurrent.locks.LockSupport;
 import java.util.concurrent.locks.ReentrantLock;
 
 /**
@@ -131,6 +132,11 @@ import java.util.concurrent.locks.ReentrantLock;
  * data structure). Writers can always proceed at full speed in what they
  * perceive to be the current (odd or even) epoch. The epoch flip is fast (a
  * single atomic op).
+ *
+ * Adaptive flips wait for writers that are still in the old epoch by first
+ * spinning (writers normally exit within nanoseconds), then yielding, and
+ * finally parking with exponentially increasing park times, so that a reader
+ * waiting on a descheduled writer does not keep burning a core.
  */
 
 public class WriterReaderPhaser {
@@ -140,6 +146,16 @@ public class WriterReaderPhaser {
 
     private final ReentrantLock readerLock = new ReentrantLock();
 
+    private volatile PhaseFlipMetrics flipMetrics;
+
+    // Reader-side flip state (only accessed while holding the readerLock):
+    private boolean nextPhaseIsEven;
+    private long startValueAtFlip;
+
+    private static final int ADAPTIVE_SPIN_ITERATIONS = 128;
+    private static final int ADAPTIVE_YIELD_ITERATIONS = 64;
+    private static final long ADAPTIVE_INITIAL_PARK_TIME_NSEC = 1000;
+
     private static final AtomicLongFieldUpdater<WriterReaderPhaser> startEpochUpdater =
             AtomicLongFieldUpdater.newUpdater(WriterReaderPhaser.class, "startEpoch");
     private static final AtomicLongFieldUpdater<WriterReaderPhaser> evenEndEpochUpdater =
@@ -221,32 +237,97 @@ public class WriterReaderPhaser {
      * @param yieldTimeNsec The amount of time (in nanoseconds) to sleep in each yield if yield loop is needed.
      */
     public void flipPhase(long yieldTimeNsec) {
+        flipPhase(yieldTimeNsec, false);
+    }
+
+    /**
+     * Flip a phase in the {@link WriterReaderPhaser} instance, waiting for in-flight writer critical sections
+     * with an adaptive strategy. Like {@link WriterReaderPhaser#flipPhase(long)}, {@code adaptiveFlipPhase()}
+     * can only be called while holding the {@link WriterReaderPhaser#readerLock() readerLock}, and will return
+     * only after all writer critical sections that may have been in flight when the call was made had completed.
+     * <p>
+     * Rather than waiting in fixed units, {@code adaptiveFlipPhase()} first briefly spins (writer critical
+     * sections are normally exited within nanoseconds), then yields, and then parks with exponentially increasing
+     * park times, up to maxParkTimeNsec per park. This keeps flips prompt when writers are merely mid-operation,
+     * while not burning a core when a writer has been descheduled inside its critical section.
+     *
+     * @param maxParkTimeNsec The maximum amount of time (in nanoseconds) to park in each wait iteration once
+     *                        spinning and yielding have not sufficed. A value of 0 keeps yielding instead.
+     */
+    public void adaptiveFlipPhase(long maxParkTimeNsec) {
+        flipPhase(maxParkTimeNsec, true);
+    }
+
+    private void flipPhase(final long waitTimeNsec, final boolean adaptive) {
         if (!readerLock.isHeldByCurrentThread()) {
             throw new IllegalStateException("flipPhase() can only be called while holding the readerLock()");
         }
 
-        // Read the volatile 'startEpoch' exactly once
-        boolean nextPhaseIsEven = (startEpoch < 0); // Current phase is odd...
+        final PhaseFlipMetrics metrics = flipMetrics;
+        final long flipStartTimeNsec = (metrics != null) ? System.nanoTime() : 0;
 
-        // First, clear currently unused [next] phase end epoch (to proper initial value for phase):
-        long initialStartValue = nextPhaseIsEven ? 0 : Long.MIN_VALUE;
-        (nextPhaseIsEven ? evenEndEpochUpdater : oddEndEpochUpdater).lazySet(this, initialStartValue);
+        final long writerEnters = flipEpochs();
 
-        // Next, reset start value, indicating new phase, and retain value at flip:
-        long startValueAtFlip = startEpochUpdater.getAndSet(this, initialStartValue);
-
-        // Now, spin until previous phase end value catches up with start value at flip:
-        while((nextPhaseIsEven ? oddEndEpoch : evenEndEpoch) != startValueAtFlip)  {
-            if (yieldTimeNsec == 0) {
+        // Now, wait until the previous phase's writers have all exited:
+        long waitIterations = 0;
+        long parkTimeNsec = Math.min(ADAPTIVE_INITIAL_PARK_TIME_NSEC, waitTimeNsec);
+        while (!previousPhaseDrained()) {
+            waitIterations++;
+            if (adaptive) {
+                if (waitIterations <= ADAPTIVE_SPIN_ITERATIONS) {
+                    // Just spin; the writer is most likely about to exit its critical section.
+                } else if ((waitIterations <= ADAPTIVE_SPIN_ITERATIONS + ADAPTIVE_YIELD_ITERATIONS) ||
+                        (waitTimeNsec == 0)) {
+                    Thread.yield();
+                } else {
+                    LockSupport.parkNanos(this, parkTimeNsec);
+                    parkTimeNsec = Math.min(parkTimeNsec * 2, waitTimeNsec);
+                }
+            } else if (waitTimeNsec == 0) {
                 Thread.yield();
             } else {
                 try {
-                    TimeUnit.NANOSECONDS.sleep(yieldTimeNsec);
+                    TimeUnit.NANOSECONDS.sleep(waitTimeNsec);
                 } catch (InterruptedException ex) {
                     // nothing to do here, we just woke up earlier that expected.
                 }
             }
         }
+
+        if (metrics != null) {
+            metrics.recordFlip(System.nanoTime() - flipStartTimeNsec, waitIterations, writerEnters);
+        }
+    }
+
+    /**
+     * Start a new phase (called only by a reader holding the readerLock). Writers entering their critical
+     * sections after this call returns are counted towards the new phase.
+     *
+     * @return the number of writer critical section entries during the phase that was just ended
+     */
+    long flipEpochs() {
+        // Read the volatile 'startEpoch' exactly once
+        nextPhaseIsEven = (startEpoch < 0); // Current phase is odd...
+
+        // First, clear currently unused [next] phase end epoch (to proper initial value for phase):
+        long initialStartValue = nextPhaseIsEven ? 0 : Long.MIN_VALUE;
+        (nextPhaseIsEven ? evenEndEpochUpdater : oddEndEpochUpdater).lazySet(this, initialStartValue);
+
+        // Next, reset start value, indicating new phase, and retain value at flip:
+        startValueAtFlip = startEpochUpdater.getAndSet(this, initialStartValue);
+
+        // The ended phase's start epoch began counting from the initial value of its own parity:
+        return startValueAtFlip - (nextPhaseIsEven ? Long.MIN_VALUE : 0);
+    }
+
+    /**
+     * Determine whether all writer critical sections entered during the phase ended by the latest
+     * {@link #flipEpochs()} call have exited (called only by a reader holding the readerLock).
+     *
+     * @return true if no writers remain in the previous phase
+     */
+    boolean previousPhaseDrained() {
+        return (nextPhaseIsEven ? oddEndEpoch : evenEndEpoch) == startValueAtFlip;
     }
 
     /**
@@ -268,4 +349,23 @@ public class WriterReaderPhaser {
     public void flipPhase() {
         flipPhase(0);
     }
+
+    /**
+     * Attach a {@link PhaseFlipMetrics} instance to collect flip wait times, wait iterations and writer
+     * enters per phase for subsequent phase flips into.
+     *
+     * @param flipMetrics the metrics to collect into, or null to stop collecting flip metrics
+     */
+    public void setFlipMetrics(PhaseFlipMetrics flipMetrics) {
+        this.flipMetrics = flipMetrics;
+    }
+
+    /**
+     * Get the {@link PhaseFlipMetrics} instance (if any) that phase flips are currently collected into.
+     *
+     * @return the attached flip metrics, or null if none are attached
+     */
+    public PhaseFlipMetrics getFlipMetrics() {
+        return flipMetrics;
+    }
 }
@@ -95,6 +95,12 @@
  * <b><code>short</code></b> fields respectively, are provided for use cases where smaller count ranges are practical
  * and smaller overall storage is beneficial (e.g. systems where tens of thousands of in-memory histogram are
  * being tracked).</li>
+ *  <li>{@link org.HdrHistogram.AdaptiveCountsHistogram}, which starts out tracking value counts in <b><code>byte</code></b>
+ * fields, and widens them (per half-bucket of the value range) as needed, for use cases where small overall storage
+ * is beneficial but count ranges cannot be bounded up front.</li>
+ *  <li>{@link org.HdrHistogram.PagedHistogram}, which tracks value counts in <b><code>long</code></b> fields kept in
+ * pages that are only allocated for the value ranges actually recorded into, and which auto-resizes without copying
+ * its counts.</li>
  *  <li>{@link org.HdrHistogram.AtomicHistogram}, {@link org.HdrHistogram.ConcurrentHistogram}
  *  and {@link org.HdrHistogram.SynchronizedHistogram}</li>
  * </ul>
@@ -130,6 +136,9 @@
  * It is worth mentioning that since Histogram objects are additive, it is common practice to use per-thread
  * non-synchronized histograms or {@link org.HdrHistogram.SingleWriterRecorder}s, and using a summary/reporting
  * thread perform histogram aggregation math across time and/or threads.
+ * {@link org.HdrHistogram.StripedRecorder} packages this practice behind a single multi-writer recorder, by
+ * giving each recording thread its own non-synchronized histograms and merging them when interval histograms are
+ * taken.
  * </p>
  * <h3>Iteration</h3>
  * Histograms supports multiple convenient forms of iterating through the histogram data set, including linear,
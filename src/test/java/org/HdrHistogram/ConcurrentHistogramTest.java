@@ -9,10 +9,16 @@
 package org.HdrHistogram;
 
 import org.junit.Assert;
+import org.junit.jupiter.api.Assumptions;
 import org.junit.jupiter.api.Test;
 import org.junit.jupiter.params.ParameterizedTest;
 import org.junit.jupiter.params.provider.ValueSource;
 
+import java.lang.reflect.Field;
+import java.lang.reflect.Method;
+import java.lang.reflect.Modifier;
+import java.util.ArrayList;
+import java.util.List;
 import java.util.Random;
 import java.util.concurrent.Semaphore;
 import java.util.concurrent.atomic.AtomicLong;
@@ -68,6 +74,262 @@ public class ConcurrentHistogramTest {
         doRun = false;
     }
 
+    @Test
+    public void testConcurrentDoubleAutoRangedRecording() throws Exception {
+        // Auto-resizing (recordings may be handed off to the adjusting thread):
+        verifyConcurrentDoubleAutoRangedRecording(new ConcurrentDoubleHistogram(2), 1.0E-6, 1.0E6);
+        // Fixed dynamic range (recordings wait for in-progress adjustments):
+        verifyConcurrentDoubleAutoRangedRecording(
+                new ConcurrentDoubleHistogram(1000L * 1000 * 1000 * 1000 * 100, 2), 1.0E-6, 1.0E6);
+    }
+
+    private void verifyConcurrentDoubleAutoRangedRecording(final ConcurrentDoubleHistogram histogram,
+                                                           final double lowestValue, final double highestValue)
+            throws Exception {
+        final int numberOfThreads = 8;
+        final int recordingsPerThread = 20000;
+        Thread[] threads = new Thread[numberOfThreads];
+        for (int i = 0; i < numberOfThreads; i++) {
+            final int threadIndex = i;
+            threads[i] = new Thread(new Runnable() {
+                @Override
+                public void run() {
+                    Random random = new Random(threadIndex);
+                    for (int j = 0; j < recordingsPerThread; j++) {
+                        // Mostly values around 1.0, with outliers that periodically expand the range both ways:
+                        double value = 0.5 + random.nextDouble();
+                        if ((j % 1000) == threadIndex) {
+                            value = lowestValue * (1.0 + j / (double) recordingsPerThread);
+                        } else if ((j % 1000) == (500 + threadIndex)) {
+                            value = highestValue * (1.0 - j / (2.0 * recordingsPerThread));
+                        }
+                        histogram.recordValue(value);
+                    }
+                }
+            });
+        }
+        for (Thread thread : threads) {
+            thread.start();
+        }
+        for (Thread thread : threads) {
+            thread.join();
+        }
+        Assert.assertEquals((long) numberOfThreads * recordingsPerThread, histogram.getTotalCount());
+        Assert.assertTrue(histogram.getMinNonZeroValue() <= lowestValue * 1.01);
+        Assert.assertTrue(histogram.getMaxValue() >= highestValue * 0.5);
+        Assert.assertEquals(histogram.getTotalCount(),
+                histogram.getCountBetweenValues(0.0, highestValue * 1.01), 0.0);
+    }
+
+    @ParameterizedTest
+    @ValueSource(classes = {
+            AtomicHistogram.class,
+            ConcurrentHistogram.class,
+            PackedConcurrentHistogram.class,
+    })
+    public void testTotalCountFieldIsolation(final Class<?> histoClass) throws Exception {
+        // Inspect the actual field layout (the same way object layout tools do) where the JVM allows it:
+        Method objectFieldOffset = null;
+        Object unsafe = null;
+        try {
+            Field theUnsafe = Class.forName("sun.misc.Unsafe").getDeclaredField("theUnsafe");
+            theUnsafe.setAccessible(true);
+            unsafe = theUnsafe.get(null);
+            objectFieldOffset = unsafe.getClass().getMethod("objectFieldOffset", Field.class);
+        } catch (Exception ex) {
+            // Leave objectFieldOffset unset.
+        }
+        Assumptions.assumeTrue(objectFieldOffset != null, "field offsets are not available on this JVM");
+
+        long totalCountOffset = -1;
+        List<Long> otherFieldOffsets = new ArrayList<Long>();
+        for (Class<?> c = histoClass; c != Object.class; c = c.getSuperclass()) {
+            for (Field field : c.getDeclaredFields()) {
+                if (Modifier.isStatic(field.getModifiers()) || field.getName().contains("Pad")) {
+                    continue;
+                }
+                long offset = (Long) objectFieldOffset.invoke(unsafe, field);
+                if (field.getName().equals("totalCount") && (totalCountOffset < 0)) {
+                    // The most derived declaration is the one in use:
+                    totalCountOffset = offset;
+                } else {
+                    otherFieldOffsets.add(offset);
+                }
+            }
+        }
+        Assert.assertTrue(totalCountOffset >= 0);
+        for (long offset : otherFieldOffsets) {
+            Assert.assertTrue("field at offset " + offset + " shares a cache line with totalCount at offset " +
+                    totalCountOffset, Math.abs(offset - totalCountOffset) >= 64);
+        }
+    }
+
+    @ParameterizedTest
+    @ValueSource(classes = {
+            ConcurrentHistogram.class,
+            PackedConcurrentHistogram.class,
+    })
+    public void testSnapshotQueries(final Class<?> histoClass) throws Exception {
+        ConcurrentHistogram histogram = (ConcurrentHistogram)
+                HistogramTestUtils.constructHistogram(histoClass, 3600L * 1000 * 1000, 3);
+        Histogram expected = new Histogram(3600L * 1000 * 1000, 3);
+        Random random = new Random(42);
+        for (int i = 0; i < 10000; i++) {
+            long value = (long) (1000000 * random.nextDouble() * random.nextDouble());
+            histogram.recordValue(value);
+            expected.recordValue(value);
+        }
+        verifySameQueryResults(expected, histogram);
+
+        // Query snapshots are private to each query (and not retained by the histogram), and skip building the
+        // cumulative count index that explicitly taken snapshots keep:
+        Assert.assertNotSame(histogram.getQueryHistogram(), histogram.getQueryHistogram());
+        Assert.assertFalse(histogram.getQueryHistogram().isCumulativeCountIndexing());
+        Assert.assertTrue(histogram.snapshot().isCumulativeCountIndexing());
+
+        // Recordings are picked up by the next query:
+        histogram.recordValue(5000000);
+        expected.recordValue(5000000);
+        verifySameQueryResults(expected, histogram);
+
+        // As are other content changes (that leave the total count unchanged):
+        histogram.reset();
+        expected.reset();
+        for (int i = 0; i < 10001; i++) {
+            histogram.recordValue(i);
+            expected.recordValue(i);
+        }
+        verifySameQueryResults(expected, histogram);
+
+        // Adding from a concurrent histogram goes through its snapshot:
+        Histogram sum = new Histogram(3600L * 1000 * 1000, 3);
+        sum.add(histogram);
+        sum.add(histogram);
+        Assert.assertEquals(2 * expected.getTotalCount(), sum.getTotalCount());
+        Assert.assertEquals(expected.getValueAtPercentile(99.0), sum.getValueAtPercentile(99.0));
+        sum.subtract(histogram);
+        Assert.assertEquals(expected, sum);
+        Assert.assertEquals(expected, histogram.copy());
+    }
+
+    private void verifySameQueryResults(final Histogram expected, final ConcurrentHistogram histogram) {
+        double[] percentiles = {0.0, 25.0, 50.0, 90.0, 99.0, 99.9, 100.0};
+        long[] expectedValues = new long[percentiles.length];
+        long[] values = new long[percentiles.length];
+        expected.getValuesAtPercentiles(percentiles, expectedValues);
+        histogram.getValuesAtPercentiles(percentiles, values);
+        Assert.assertArrayEquals(expectedValues, values);
+        for (double percentile : percentiles) {
+            Assert.assertEquals(expected.getValueAtPercentile(percentile), histogram.getValueAtPercentile(percentile));
+        }
+        Assert.assertEquals(expected.getMean(), histogram.getMean(), 0.0);
+        Assert.assertEquals(expected.getStdDeviation(), histogram.getStdDeviation(), 0.0);
+        Assert.assertEquals(expected.getPercentileAtOrBelowValue(10000),
+                histogram.getPercentileAtOrBelowValue(10000), 0.0);
+        Assert.assertEquals(expected.getCountBetweenValues(1000, 100000),
+                histogram.getCountBetweenValues(1000, 100000));
+        long totalRecorded = 0;
+        for (HistogramIterationValue v : histogram.recordedValues()) {
+            Assert.assertEquals(expected.getCountAtValue(v.getValueIteratedTo()), v.getCountAtValueIteratedTo());
+            totalRecorded += v.getCountAtValueIteratedTo();
+        }
+        Assert.assertEquals(expected.getTotalCount(), totalRecorded);
+    }
+
+    @Test
+    public void testSnapshotQueriesDuringConcurrentRecording() throws Exception {
+        final ConcurrentHistogram histogram = new ConcurrentHistogram(3);
+        final int numberOfThreads = 4;
+        final int recordingsPerThread = 200000;
+        Thread[] threads = new Thread[numberOfThreads];
+        for (int i = 0; i < numberOfThreads; i++) {
+            final int threadIndex = i;
+            threads[i] = new Thread(new Runnable() {
+                @Override
+                public void run() {
+                    Random random = new Random(threadIndex);
+                    for (int j = 0; j < recordingsPerThread; j++) {
+                        // Occasional large values keep auto-resizing the histogram while it is being queried:
+                        final int shift = ((j % 10000) == 0) ? (j / 10000) : 0;
+                        histogram.recordValue((long) (1000 * random.nextDouble()) << shift);
+                    }
+                }
+            });
+        }
+        for (Thread thread : threads) {
+            thread.start();
+        }
+        boolean recording = true;
+        while (recording) {
+            recording = false;
+            for (Thread thread : threads) {
+                recording |= thread.isAlive();
+            }
+            FrozenHistogram snapshot = histogram.snapshot();
+            // Each snapshot is internally consistent, and never ahead of the histogram:
+            long totalRecorded = 0;
+            for (HistogramIterationValue v : snapshot.recordedValues()) {
+                totalRecorded += v.getCountAtValueIteratedTo();
+            }
+            Assert.assertEquals(snapshot.getTotalCount(), totalRecorded);
+            Assert.assertTrue(snapshot.getTotalCount() <= histogram.getTotalCount());
+            Assert.assertEquals(snapshot.highestEquivalentValue(snapshot.getMaxValue()),
+                    snapshot.getValueAtPercentile(100.0));
+            Assert.assertTrue(snapshot.getValueAtPercentile(50.0) <= histogram.getValueAtPercentile(100.0));
+        }
+        for (Thread thread : threads) {
+            thread.join();
+        }
+        Assert.assertEquals((long) numberOfThreads * recordingsPerThread, histogram.snapshot().getTotalCount());
+    }
+
+    @Test
+    public void testConcurrentIndexedQueries() throws Exception {
+        final AtomicHistogram histogram = new AtomicHistogram(highestTrackableValue, 3);
+        histogram.setCumulativeCountIndexing(true);
+        Random random = new Random(42);
+        for (int i = 0; i < 100000; i++) {
+            histogram.recordValue((long) (random.nextDouble() * random.nextDouble() * 1000000));
+        }
+        final double[] percentiles = {0.0, 25.0, 50.0, 90.0, 99.0, 99.9, 100.0};
+        final long[] expectedValues = new long[percentiles.length];
+        for (int i = 0; i < percentiles.length; i++) {
+            expectedValues[i] = histogram.getValueAtPercentile(percentiles[i]);
+        }
+        final long expectedCountBetweenValues = histogram.getCountBetweenValues(1000, 100000);
+
+        // Queries that each find the index invalidated, and rebuild it while other threads are searching it,
+        // must all see consistent answers:
+        final int numberOfThreads = 4;
+        final AtomicLong mismatches = new AtomicLong();
+        Thread[] threads = new Thread[numberOfThreads];
+        for (int i = 0; i < numberOfThreads; i++) {
+            threads[i] = new Thread(new Runnable() {
+                @Override
+                public void run() {
+                    for (int j = 0; j < 2000; j++) {
+                        histogram.invalidateCachedStatistics();
+                        for (int k = 0; k < percentiles.length; k++) {
+                            if (histogram.getValueAtPercentile(percentiles[k]) != expectedValues[k]) {
+                                mismatches.incrementAndGet();
+                            }
+                        }
+                        if (histogram.getCountBetweenValues(1000, 100000) != expectedCountBetweenValues) {
+                            mismatches.incrementAndGet();
+                        }
+                    }
+                }
+            });
+        }
+        for (Thread thread : threads) {
+            thread.start();
+        }
+        for (Thread thread : threads) {
+            thread.join();
+        }
+        Assert.assertEquals(0, mismatches.get());
+    }
+
     static AtomicLong valueRecorderId = new AtomicLong(42);
 
     class ValueRecorder extends Thread {
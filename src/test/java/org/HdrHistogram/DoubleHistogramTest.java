@@ -19,6 +19,7 @@ import org.junit.jupiter.params.ParameterizedTest;
 import org.junit.jupiter.params.provider.ValueSource;
 
 import java.io.*;
+import java.util.Random;
 import java.util.zip.Deflater;
 
 import static org.HdrHistogram.HistogramTestUtils.constructDoubleHistogram;
@@ -92,6 +93,29 @@ public class DoubleHistogramTest {
                 });
     }
 
+    @ParameterizedTest
+    @ValueSource(classes = {
+            DoubleHistogram.class,
+            ConcurrentDoubleHistogram.class,
+            SynchronizedDoubleHistogram.class,
+            PackedDoubleHistogram.class,
+            PackedConcurrentDoubleHistogram.class,
+    })
+    public void testGetValuesAtPercentiles(Class histoClass) throws Exception {
+        DoubleHistogram histogram =
+                constructDoubleHistogram(histoClass, trackableValueRangeSize, numberOfSignificantValueDigits);
+        for (int i = 0; i < 10000; i++) {
+            histogram.recordValue(((i * 7919L) % 1000000) / 8.0);
+        }
+        final double[] percentiles = {99.0, 0.0, 50.0, 90.0, 99.9, 100.0};
+        final double[] values = new double[percentiles.length];
+        histogram.getValuesAtPercentiles(percentiles, values);
+        for (int i = 0; i < percentiles.length; i++) {
+            assertEquals("value at " + percentiles[i] + "%'ile",
+                    histogram.getValueAtPercentile(percentiles[i]), values[i], 0.0);
+        }
+    }
+
     @ParameterizedTest
     @ValueSource(classes = {
             DoubleHistogram.class,
@@ -184,6 +208,43 @@ public class DoubleHistogramTest {
         assertEquals(1L, histogram.getTotalCount());
     }
 
+    @ParameterizedTest
+    @ValueSource(classes = {
+            DoubleHistogram.class,
+            ConcurrentDoubleHistogram.class,
+            SynchronizedDoubleHistogram.class,
+            PackedDoubleHistogram.class,
+            PackedConcurrentDoubleHistogram.class,
+    })
+    public void testRecordValueFastPathMatchesCountedRecording(Class histoClass) throws Exception {
+        DoubleHistogram histogram = constructDoubleHistogram(histoClass, numberOfSignificantValueDigits);
+        // recordValueWithCount() does not use the single value recording fast path:
+        DoubleHistogram reference = constructDoubleHistogram(histoClass, numberOfSignificantValueDigits);
+        Random random = new Random(42);
+        for (int round = 0; round < 2; round++) {
+            for (int i = 0; i < 100000; i++) {
+                // Log-uniform values whose range widens as the recording goes on (forcing range adjustments),
+                // with exact powers of two and bucket boundary values mixed in:
+                double value = Math.pow(10.0, (random.nextDouble() - 0.5) * (1.0 + i / 10000.0));
+                if ((i % 7) == 0) {
+                    value = Math.scalb(1.0, Math.getExponent(value));
+                } else if ((i % 11) == 0) {
+                    value = Math.nextAfter(Math.scalb(1.0, Math.getExponent(value)), 0.0);
+                }
+                histogram.recordValue(value);
+                reference.recordValueWithCount(value, 1);
+            }
+            histogram.recordValue(0.0);
+            reference.recordValueWithCount(0.0, 1);
+            assertEquals(reference.getTotalCount(), histogram.getTotalCount());
+            assertEquals(reference.getMaxValue(), histogram.getMaxValue(), 0.0);
+            assertEquals(reference.getMinNonZeroValue(), histogram.getMinNonZeroValue(), 0.0);
+            assertEquals(reference, histogram);
+            histogram.reset();
+            reference.reset();
+        }
+    }
+
     @ParameterizedTest
     @ValueSource(classes = {
             DoubleHistogram.class,
@@ -571,6 +632,9 @@ public class DoubleHistogramTest {
         testDoubleHistogramSerialization(withIntHistogram);
         withShortHistogram = constructDoubleHistogram(histoClass,trackableValueRangeSize, 2, ShortCountsHistogram.class);
         testDoubleHistogramSerialization(withShortHistogram);
+        DoubleHistogram withAdaptiveHistogram =
+                constructDoubleHistogram(histoClass,trackableValueRangeSize, 2, AdaptiveCountsHistogram.class);
+        testDoubleHistogramSerialization(withAdaptiveHistogram);
     }
 
     @ParameterizedTest
@@ -799,9 +863,11 @@ public class DoubleHistogramTest {
         genericResizeTest(constructDoubleHistogram(histoClass, 2));
         genericResizeTest(constructDoubleHistogram(histoClass,2, IntCountsHistogram.class));
         genericResizeTest(constructDoubleHistogram(histoClass,2, ShortCountsHistogram.class));
+        genericResizeTest(constructDoubleHistogram(histoClass,2, AdaptiveCountsHistogram.class));
         genericResizeTest(constructDoubleHistogram(histoClass,2, ConcurrentHistogram.class));
         genericResizeTest(constructDoubleHistogram(histoClass,2, SynchronizedHistogram.class));
         genericResizeTest(constructDoubleHistogram(histoClass,2, PackedHistogram.class));
+        genericResizeTest(constructDoubleHistogram(histoClass,2, PagedHistogram.class));
         genericResizeTest(constructDoubleHistogram(histoClass,2, PackedConcurrentHistogram.class));
     }
 }
@@ -27,9 +27,12 @@ public class HistogramAutosizingTest {
             ConcurrentHistogram.class,
             SynchronizedHistogram.class,
             PackedHistogram.class,
+            PagedHistogram.class,
             PackedConcurrentHistogram.class,
             IntCountsHistogram.class,
             ShortCountsHistogram.class,
+            AdaptiveCountsHistogram.class,
+            ByteBufferHistogram.class,
     })
     public void testHistogramAutoSizingEdges(Class c) throws Exception {
         AbstractHistogram histogram = constructHistogram(c,3);
@@ -47,9 +50,12 @@ public class HistogramAutosizingTest {
             ConcurrentHistogram.class,
             SynchronizedHistogram.class,
             PackedHistogram.class,
+            PagedHistogram.class,
             PackedConcurrentHistogram.class,
             IntCountsHistogram.class,
             ShortCountsHistogram.class,
+            AdaptiveCountsHistogram.class,
+            ByteBufferHistogram.class,
     })
     public void testHistogramEqualsAfterResizing(Class c) throws Exception {
         AbstractHistogram histogram = constructHistogram(c,3);
@@ -73,9 +79,12 @@ public class HistogramAutosizingTest {
             ConcurrentHistogram.class,
             SynchronizedHistogram.class,
             PackedHistogram.class,
+            PagedHistogram.class,
             PackedConcurrentHistogram.class,
             IntCountsHistogram.class,
             ShortCountsHistogram.class,
+            AdaptiveCountsHistogram.class,
+            ByteBufferHistogram.class,
     })
     public void testHistogramAutoSizing(Class c) throws Exception {
         AbstractHistogram histogram = constructHistogram(c,3);
@@ -93,9 +102,12 @@ public class HistogramAutosizingTest {
             ConcurrentHistogram.class,
             SynchronizedHistogram.class,
             PackedHistogram.class,
+            PagedHistogram.class,
             PackedConcurrentHistogram.class,
             IntCountsHistogram.class,
             ShortCountsHistogram.class,
+            AdaptiveCountsHistogram.class,
+            ByteBufferHistogram.class,
     })
     public void testAutoSizingAdd(Class c) throws Exception {
         AbstractHistogram histogram1 = constructHistogram(c, 2);
@@ -117,6 +129,7 @@ public class HistogramAutosizingTest {
             ConcurrentHistogram.class,
             SynchronizedHistogram.class,
             PackedHistogram.class,
+            PagedHistogram.class,
             PackedConcurrentHistogram.class,
             IntCountsHistogram.class,
     })
@@ -9,7 +9,9 @@
 package org.HdrHistogram;
 
 import org.junit.Assert;
+import org.junit.jupiter.api.Assertions;
 import org.junit.jupiter.api.Test;
+import org.junit.jupiter.api.function.Executable;
 import org.junit.experimental.theories.DataPoints;
 import org.junit.experimental.theories.Theories;
 import org.junit.experimental.theories.Theory;
@@ -18,6 +20,9 @@ import org.junit.jupiter.params.provider.ValueSource;
 import org.junit.runner.RunWith;
 
 import java.nio.ByteBuffer;
+import java.util.Iterator;
+import java.util.zip.DataFormatException;
+import java.util.zip.Deflater;
 
 import static org.HdrHistogram.HistogramTestUtils.constructHistogram;
 import static org.HdrHistogram.HistogramTestUtils.constructDoubleHistogram;
@@ -290,9 +295,11 @@ public class HistogramEncodingTest {
             ConcurrentHistogram.class,
             SynchronizedHistogram.class,
             PackedHistogram.class,
+            PagedHistogram.class,
             PackedConcurrentHistogram.class,
             IntCountsHistogram.class,
             ShortCountsHistogram.class,
+            AdaptiveCountsHistogram.class,
     })
     public void testSimpleIntegerHistogramEncoding(final Class histoClass) throws Exception {
         AbstractHistogram histogram = constructHistogram(histoClass, 274877906943L, 3);
@@ -383,9 +390,11 @@ public class HistogramEncodingTest {
             ConcurrentHistogram.class,
             SynchronizedHistogram.class,
             PackedHistogram.class,
+            PagedHistogram.class,
             PackedConcurrentHistogram.class,
             IntCountsHistogram.class,
             ShortCountsHistogram.class,
+            AdaptiveCountsHistogram.class,
     })
     public void testResizingHistogramBetweenCompressedEncodings(final Class histoClass) throws Exception {
         AbstractHistogram histogram = constructHistogram(histoClass, 3);
@@ -404,4 +413,188 @@ public class HistogramEncodingTest {
         AbstractHistogram histogram2 = decodeFromCompressedByteBuffer(histoClass, targetCompressedBuffer, 0);
         Assert.assertEquals(histogram, histogram2);
     }
+
+    @ParameterizedTest
+    @ValueSource(classes = {
+            Histogram.class,
+            ConcurrentHistogram.class,
+            PackedHistogram.class,
+            PagedHistogram.class,
+            IntCountsHistogram.class,
+            ShortCountsHistogram.class,
+            AdaptiveCountsHistogram.class,
+    })
+    public void testEncodedHistogramView(final Class histoClass) throws Exception {
+        AbstractHistogram histogram = constructHistogram(histoClass, 1000, highestTrackableValue, 3);
+        EncodedHistogramView emptyView = viewOf(histogram, false);
+        Assert.assertEquals(0, emptyView.getTotalCount());
+        Assert.assertEquals(0, emptyView.getMaxValue());
+        Assert.assertEquals(0, emptyView.getValueAtPercentile(99.0));
+        Assert.assertFalse(emptyView.recordedValues().iterator().hasNext());
+
+        histogram.recordValue(0);
+        for (int i = 1; i <= 1000; i++) {
+            histogram.recordValue(i * 3571L);
+        }
+        histogram.recordValueWithCount(100000000L, 7);
+
+        for (boolean compressed : new boolean[] {false, true}) {
+            EncodedHistogramView view = viewOf(histogram, compressed);
+            Assert.assertEquals(histogram.getLowestDiscernibleValue(), view.getLowestDiscernibleValue());
+            Assert.assertEquals(histogram.getTotalCount(), view.getTotalCount());
+            Assert.assertEquals(histogram.getMaxValue(), view.getMaxValue());
+            Assert.assertEquals(histogram.getMinNonZeroValue(), view.getMinNonZeroValue());
+            for (double percentile : new double[] {0.0, 1.0, 50.0, 90.0, 99.0, 99.9, 99.99, 100.0}) {
+                Assert.assertEquals(histogram.getValueAtPercentile(percentile),
+                        view.getValueAtPercentile(percentile));
+            }
+            Iterator<HistogramIterationValue> viewValues = view.recordedValues().iterator();
+            for (HistogramIterationValue expected : histogram.recordedValues()) {
+                Assert.assertTrue(viewValues.hasNext());
+                HistogramIterationValue actual = viewValues.next();
+                Assert.assertEquals(expected.getValueIteratedTo(), actual.getValueIteratedTo());
+                Assert.assertEquals(expected.getCountAtValueIteratedTo(), actual.getCountAtValueIteratedTo());
+                Assert.assertEquals(expected.getTotalCountToThisValue(), actual.getTotalCountToThisValue());
+                Assert.assertEquals(expected.getPercentile(), actual.getPercentile(), 0.0);
+            }
+            Assert.assertFalse(viewValues.hasNext());
+        }
+    }
+
+    @ParameterizedTest
+    @ValueSource(classes = {
+            Histogram.class,
+            ConcurrentHistogram.class,
+            SynchronizedHistogram.class,
+            PackedHistogram.class,
+            PagedHistogram.class,
+            IntCountsHistogram.class,
+            ShortCountsHistogram.class,
+            AdaptiveCountsHistogram.class,
+    })
+    public void testCompressionCodecs(final Class histoClass) throws Exception {
+        AbstractHistogram histogram = constructHistogram(histoClass, highestTrackableValue, 3);
+        for (int i = 0; i < 10000; i++) {
+            histogram.recordValue((i * 7919L) % 1000000);
+        }
+        histogram.recordValueWithCount(highestTrackableValue - 1, 3);
+
+        final HistogramCompressionCodec[] codecs = {
+                HistogramCompressionCodec.DEFLATE,
+                HistogramCompressionCodec.deflate(Deflater.BEST_SPEED),
+                HistogramCompressionCodec.FAST,
+                HistogramCompressionCodec.NONE
+        };
+        for (HistogramCompressionCodec codec : codecs) {
+            for (BufferAllocator allocator : ALLOCATORS) {
+                ByteBuffer targetBuffer = allocator.allocate(histogram.getNeededByteBufferCapacity());
+                int bytesWritten = histogram.encodeIntoCompressedByteBuffer(targetBuffer, codec);
+                Assert.assertEquals(bytesWritten, targetBuffer.position());
+                targetBuffer.rewind();
+                AbstractHistogram decodedHistogram = decodeFromCompressedByteBuffer(histoClass, targetBuffer, 0);
+                Assert.assertEquals(histogram, decodedHistogram);
+
+                targetBuffer.rewind();
+                EncodedHistogramView view = EncodedHistogramView.wrapCompressed(targetBuffer);
+                Assert.assertEquals(histogram.getTotalCount(), view.getTotalCount());
+                Assert.assertEquals(histogram.getMaxValue(), view.getMaxValue());
+            }
+        }
+    }
+
+    @Test
+    public void testFastCodecCorruptContents() throws Exception {
+        Histogram histogram = new Histogram(highestTrackableValue, 3);
+        for (int i = 0; i < 1000; i++) {
+            histogram.recordValue(i * 31L);
+        }
+        final ByteBuffer targetBuffer = ByteBuffer.allocate(histogram.getNeededByteBufferCapacity());
+        int bytesWritten = histogram.encodeIntoCompressedByteBuffer(targetBuffer, HistogramCompressionCodec.FAST);
+        targetBuffer.putInt(4, bytesWritten - 8 - 3); // Truncate the compressed contents
+        targetBuffer.rewind();
+        Assertions.assertThrows(DataFormatException.class, new Executable() {
+            @Override
+            public void execute() throws Throwable {
+                Histogram.decodeFromCompressedByteBuffer(targetBuffer, 0);
+            }
+        });
+    }
+
+    @Test
+    public void testDeflateCodecCorruptContents() throws Exception {
+        Histogram histogram = new Histogram(highestTrackableValue, 3);
+        for (int i = 0; i < 1000; i++) {
+            histogram.recordValue(i * 31L);
+        }
+        // Truncated compressed contents:
+        final ByteBuffer truncatedBuffer = ByteBuffer.allocate(histogram.getNeededByteBufferCapacity());
+        int bytesWritten = histogram.encodeIntoCompressedByteBuffer(truncatedBuffer, HistogramCompressionCodec.DEFLATE);
+        truncatedBuffer.putInt(4, (bytesWritten - 8) / 2);
+        truncatedBuffer.rewind();
+        Assertions.assertThrows(DataFormatException.class, new Executable() {
+            @Override
+            public void execute() throws Throwable {
+                EncodedHistogramView.wrapCompressed(truncatedBuffer);
+            }
+        });
+
+        // Validly compressed contents, with a negative or implausibly large payload length in their header:
+        for (int payloadLength : new int[] {-8, Integer.MAX_VALUE - 64}) {
+            ByteBuffer encodedBuffer = ByteBuffer.allocate(histogram.getNeededByteBufferCapacity());
+            int encodedLength = histogram.encodeIntoByteBuffer(encodedBuffer);
+            encodedBuffer.putInt(4, payloadLength);
+            byte[] compressedContents = new byte[encodedLength + 64];
+            Deflater compressor = new Deflater();
+            compressor.setInput(encodedBuffer.array(), 0, encodedLength);
+            compressor.finish();
+            int compressedLength = compressor.deflate(compressedContents);
+            compressor.end();
+            final ByteBuffer corruptBuffer = ByteBuffer.allocate(8 + compressedLength);
+            corruptBuffer.putInt(truncatedBuffer.getInt(0)); // The deflate compressed encoding cookie
+            corruptBuffer.putInt(compressedLength);
+            corruptBuffer.put(compressedContents, 0, compressedLength);
+            corruptBuffer.rewind();
+            Assertions.assertThrows(DataFormatException.class, new Executable() {
+                @Override
+                public void execute() throws Throwable {
+                    EncodedHistogramView.wrapCompressed(corruptBuffer);
+                }
+            });
+        }
+    }
+
+    @ParameterizedTest
+    @ValueSource(classes = {
+            DoubleHistogram.class,
+            SynchronizedDoubleHistogram.class,
+            ConcurrentDoubleHistogram.class,
+            PackedDoubleHistogram.class,
+    })
+    public void testDoubleHistogramCompressionCodecs(final Class histoClass) throws Exception {
+        DoubleHistogram histogram = constructDoubleHistogram(histoClass, 100000000L, 3);
+        for (int i = 0; i < 1000; i++) {
+            histogram.recordValue(i * 0.37);
+        }
+        for (HistogramCompressionCodec codec :
+                new HistogramCompressionCodec[] {HistogramCompressionCodec.FAST, HistogramCompressionCodec.NONE}) {
+            ByteBuffer targetBuffer = ByteBuffer.allocate(histogram.getNeededByteBufferCapacity());
+            histogram.encodeIntoCompressedByteBuffer(targetBuffer, codec);
+            targetBuffer.rewind();
+            DoubleHistogram decodedHistogram =
+                    decodeDoubleHistogramFromCompressedByteBuffer(histoClass, targetBuffer, 0);
+            Assert.assertEquals(histogram, decodedHistogram);
+        }
+    }
+
+    private static EncodedHistogramView viewOf(AbstractHistogram histogram, boolean compressed) throws Exception {
+        ByteBuffer targetBuffer = ByteBuffer.allocate(histogram.getNeededByteBufferCapacity());
+        if (compressed) {
+            histogram.encodeIntoCompressedByteBuffer(targetBuffer);
+            targetBuffer.rewind();
+            return EncodedHistogramView.wrapCompressed(targetBuffer);
+        }
+        histogram.encodeIntoByteBuffer(targetBuffer);
+        targetBuffer.rewind();
+        return EncodedHistogramView.wrap(targetBuffer);
+    }
 }
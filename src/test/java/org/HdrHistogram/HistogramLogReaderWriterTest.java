@@ -7,6 +7,9 @@ import java.io.File;
 import java.io.FileInputStream;
 import java.io.FileOutputStream;
 import java.io.InputStream;
+import java.io.PrintStream;
+import java.nio.file.Files;
+import java.util.zip.DataFormatException;
 
 public class HistogramLogReaderWriterTest {
 
@@ -55,6 +58,59 @@ public class HistogramLogReaderWriterTest {
         Assert.assertEquals(accumulatedHistogramWithTagA, accumulatedHistogramWithNoTag);
     }
 
+    @Test
+    public void scanTaggedV2LogLazily() throws Exception {
+        InputStream readerStream = HistogramLogReaderWriterTest.class.getResourceAsStream("tagged-Log.logV2.hlog");
+        HistogramLogScanner scanner = new HistogramLogScanner(readerStream);
+        final Histogram accumulatedHistogramWithTagA = new Histogram(3);
+        final int[] counts = new int[2]; // [histograms seen, histograms decoded]
+        final double[] startTimeSec = new double[1];
+        scanner.process(new HistogramLogScanner.EventHandler() {
+            @Override
+            public boolean onComment(String comment) {
+                return false;
+            }
+
+            @Override
+            public boolean onBaseTime(double secondsSinceEpoch) {
+                return false;
+            }
+
+            @Override
+            public boolean onStartTime(double secondsSinceEpoch) {
+                startTimeSec[0] = secondsSinceEpoch;
+                return false;
+            }
+
+            @Override
+            public boolean onHistogram(String tag, double timestamp, double length,
+                                       HistogramLogScanner.EncodableHistogramSupplier lazyReader) {
+                counts[0]++;
+                if ("A".equals(tag)) {
+                    try {
+                        accumulatedHistogramWithTagA.add((Histogram) lazyReader.read());
+                    } catch (DataFormatException ex) {
+                        throw new RuntimeException(ex);
+                    }
+                    counts[1]++;
+                }
+                return false;
+            }
+
+            @Override
+            public boolean onException(Throwable t) {
+                throw new RuntimeException(t);
+            }
+        });
+        scanner.close();
+        readerStream.close();
+
+        Assert.assertTrue(startTimeSec[0] > 0);
+        Assert.assertEquals(21, counts[1]);
+        Assert.assertEquals(42, counts[0]);
+        Assert.assertEquals(32290 / 2, accumulatedHistogramWithTagA.getTotalCount());
+    }
+
     @Test
     public void jHiccupV2Log() throws Exception {
         InputStream readerStream = HistogramLogReaderWriterTest.class.getResourceAsStream("jHiccup-2.0.7S.logV2.hlog");
@@ -339,4 +395,109 @@ public class HistogramLogReaderWriterTest {
         readerStream.close();
     }
 
+    @Test
+    public void fastCompressedLog() throws Exception {
+        File temp = File.createTempFile("hdrhistogramtesting", "hlog");
+        temp.deleteOnExit();
+        FileOutputStream writerStream = new FileOutputStream(temp);
+        HistogramLogWriter writer = new HistogramLogWriter(writerStream);
+        writer.setCompressionCodec(HistogramCompressionCodec.FAST);
+        writer.outputLogFormatVersion();
+        writer.outputStartTime(11000);
+        writer.outputLegend();
+        Histogram histogram = new Histogram(3);
+        for (int i = 0; i < 1000; i++) {
+            histogram.recordValue(i * 131L);
+        }
+        histogram.setStartTimeStamp(11100);
+        histogram.setEndTimeStamp(12100);
+        writer.outputIntervalHistogram(histogram);
+        DoubleHistogram doubleHistogram = new DoubleHistogram(3);
+        doubleHistogram.recordValue(0.25);
+        doubleHistogram.recordValue(1000.5);
+        doubleHistogram.setStartTimeStamp(12100);
+        doubleHistogram.setEndTimeStamp(13100);
+        writer.outputIntervalHistogram(doubleHistogram);
+        writerStream.close();
+
+        FileInputStream readerStream = new FileInputStream(temp);
+        HistogramLogReader reader = new HistogramLogReader(readerStream);
+        Assert.assertEquals(histogram, reader.nextIntervalHistogram());
+        Assert.assertEquals(doubleHistogram, reader.nextIntervalHistogram());
+        Assert.assertNull(reader.nextIntervalHistogram());
+        readerStream.close();
+    }
+
+    private static String processLog(String resourceName, String outputFileName, String... extraArgs)
+            throws Exception {
+        String inputFileName = new File(
+                HistogramLogReaderWriterTest.class.getResource(resourceName).toURI()).getPath();
+        return processLogFile(inputFileName, outputFileName, extraArgs);
+    }
+
+    private static String processLogFile(String inputFileName, String outputFileName, String... extraArgs) {
+        String[] args = new String[4 + extraArgs.length];
+        args[0] = "-i";
+        args[1] = inputFileName;
+        args[2] = "-o";
+        args[3] = outputFileName;
+        System.arraycopy(extraArgs, 0, args, 4, extraArgs.length);
+        new HistogramLogProcessor(args).run();
+        return outputFileName;
+    }
+
+    private static void assertSameFileContents(String expectedFileName, String actualFileName) throws Exception {
+        File expectedFile = new File(expectedFileName);
+        File actualFile = new File(actualFileName);
+        expectedFile.deleteOnExit();
+        actualFile.deleteOnExit();
+        Assert.assertEquals(new String(Files.readAllBytes(expectedFile.toPath()), "UTF-8"),
+                new String(Files.readAllBytes(actualFile.toPath()), "UTF-8"));
+    }
+
+    @Test
+    public void parallelLogProcessing() throws Exception {
+        File temp = File.createTempFile("hdrhistogramtesting", "processed");
+        temp.deleteOnExit();
+        String sequential = processLog("ycsb.logV1.hlog", temp.getPath() + ".sequential", "-mwp", "99");
+        String parallel = processLog("ycsb.logV1.hlog", temp.getPath() + ".parallel", "-mwp", "99",
+                "-threads", "4");
+        assertSameFileContents(sequential, parallel);
+        assertSameFileContents(sequential + ".hgrm", parallel + ".hgrm");
+        assertSameFileContents(sequential + ".mwp", parallel + ".mwp");
+
+        sequential = processLog("tagged-Log.logV2.hlog", temp.getPath() + ".sequentialA", "-tag", "A",
+                "-start", "10", "-end", "30", "-csv");
+        parallel = processLog("tagged-Log.logV2.hlog", temp.getPath() + ".parallelA", "-tag", "A",
+                "-start", "10", "-end", "30", "-csv", "-threads", "3");
+        assertSameFileContents(sequential, parallel);
+        assertSameFileContents(sequential + ".hgrm", parallel + ".hgrm");
+    }
+
+    @Test
+    public void parallelLogProcessingSkipsUndecodableLinesOutOfRange() throws Exception {
+        File temp = File.createTempFile("hdrhistogramtesting", "hlog");
+        temp.deleteOnExit();
+        PrintStream log = new PrintStream(new FileOutputStream(temp));
+        HistogramLogWriter writer = new HistogramLogWriter(log);
+        writer.outputLogFormatVersion();
+        writer.outputStartTime(0);
+        writer.outputLegend();
+        // An interval line that cannot be decoded, before the processed range:
+        log.print("0.000,1.000,0.000,AAAAAAAAAAAAAAAAAAAAAAAA\n");
+        Histogram histogram = new Histogram(3);
+        for (int i = 1; i <= 40; i++) {
+            histogram.reset();
+            histogram.recordValueWithCount(1000L * i, i);
+            writer.outputIntervalHistogram(i, i + 1, histogram);
+        }
+        writer.close();
+
+        String sequential = processLogFile(temp.getPath(), temp.getPath() + ".sequential", "-start", "5", "-v");
+        String parallel = processLogFile(temp.getPath(), temp.getPath() + ".parallel", "-start", "5", "-v",
+                "-threads", "3");
+        assertSameFileContents(sequential, parallel);
+        assertSameFileContents(sequential + ".hgrm", parallel + ".hgrm");
+    }
+
 }
@@ -33,9 +33,12 @@ public class HistogramShiftTest {
             ConcurrentHistogram.class,
             SynchronizedHistogram.class,
             PackedHistogram.class,
+            PagedHistogram.class,
             PackedConcurrentHistogram.class,
             IntCountsHistogram.class,
             ShortCountsHistogram.class,
+            AdaptiveCountsHistogram.class,
+            ByteBufferHistogram.class,
     })
     public void testHistogramShift(Class histoClass) throws Exception {
         // Histogram h = new Histogram(1L, 1L << 32, 3);
@@ -18,6 +18,9 @@ import org.junit.jupiter.params.provider.CsvSource;
 import org.junit.jupiter.params.provider.ValueSource;
 
 import java.io.*;
+import java.nio.ByteBuffer;
+import java.util.Iterator;
+import java.util.Random;
 import java.util.zip.Deflater;
 
 import static org.junit.Assert.assertEquals;
@@ -41,9 +44,11 @@ public class HistogramTest {
             AtomicHistogram.class,
             SynchronizedHistogram.class,
             PackedHistogram.class,
+            PagedHistogram.class,
             PackedConcurrentHistogram.class,
             IntCountsHistogram.class,
             ShortCountsHistogram.class,
+            AdaptiveCountsHistogram.class,
     })
     public void testConstructionArgumentRanges(Class histoClass) throws Exception {
         Boolean thrown = false;
@@ -89,9 +94,11 @@ public class HistogramTest {
             AtomicHistogram.class,
             SynchronizedHistogram.class,
             PackedHistogram.class,
+            PagedHistogram.class,
             PackedConcurrentHistogram.class,
             IntCountsHistogram.class,
             ShortCountsHistogram.class,
+            AdaptiveCountsHistogram.class,
     })
     public void testUnitMagnitude0IndexCalculations(Class histoClass) {
         // Histogram h = new Histogram(1L, 1L << 32, 3);
@@ -131,9 +138,11 @@ public class HistogramTest {
             AtomicHistogram.class,
             SynchronizedHistogram.class,
             PackedHistogram.class,
+            PagedHistogram.class,
             PackedConcurrentHistogram.class,
             IntCountsHistogram.class,
             ShortCountsHistogram.class,
+            AdaptiveCountsHistogram.class,
     })
     public void testUnitMagnitude4IndexCalculations(Class histoClass) {
         // Histogram h = new Histogram(1L << 12, 1L << 32, 3);
@@ -182,9 +191,11 @@ public class HistogramTest {
             AtomicHistogram.class,
             SynchronizedHistogram.class,
             PackedHistogram.class,
+            PagedHistogram.class,
             PackedConcurrentHistogram.class,
             IntCountsHistogram.class,
             ShortCountsHistogram.class,
+            AdaptiveCountsHistogram.class,
     })
     public void testUnitMagnitude51SubBucketMagnitude11IndexCalculations(Class histoClass) {
         // maximum unit magnitude for this precision
@@ -232,9 +243,11 @@ public class HistogramTest {
             AtomicHistogram.class,
             SynchronizedHistogram.class,
             PackedHistogram.class,
+            PagedHistogram.class,
             PackedConcurrentHistogram.class,
             IntCountsHistogram.class,
             ShortCountsHistogram.class,
+            AdaptiveCountsHistogram.class,
     })
     public void testUnitMagnitude52SubBucketMagnitude11Throws(Class histoClass) {
         try {
@@ -254,9 +267,11 @@ public class HistogramTest {
             AtomicHistogram.class,
             SynchronizedHistogram.class,
             PackedHistogram.class,
+            PagedHistogram.class,
             PackedConcurrentHistogram.class,
             IntCountsHistogram.class,
             ShortCountsHistogram.class,
+            AdaptiveCountsHistogram.class,
     })
     public void testUnitMagnitude54SubBucketMagnitude8Ok(Class histoClass) {
         // Histogram h = new Histogram(1L << 54, 1L << 62, 2);
@@ -282,9 +297,11 @@ public class HistogramTest {
             AtomicHistogram.class,
             SynchronizedHistogram.class,
             PackedHistogram.class,
+            PagedHistogram.class,
             PackedConcurrentHistogram.class,
             IntCountsHistogram.class,
             ShortCountsHistogram.class,
+            AdaptiveCountsHistogram.class,
     })
     public void testUnitMagnitude61SubBucketMagnitude0Ok(Class histoClass) {
         // Histogram h = new Histogram(1L << 61, 1L << 62, 0);
@@ -309,9 +326,11 @@ public class HistogramTest {
             ConcurrentHistogram.class,
             SynchronizedHistogram.class,
             PackedHistogram.class,
+            PagedHistogram.class,
             PackedConcurrentHistogram.class,
             IntCountsHistogram.class,
             ShortCountsHistogram.class,
+            AdaptiveCountsHistogram.class,
     })
     public void testEmptyHistogram(Class histoClass) throws Exception {
         // Histogram histogram = new Histogram(3);
@@ -335,9 +354,11 @@ public class HistogramTest {
             AtomicHistogram.class,
             SynchronizedHistogram.class,
             PackedHistogram.class,
+            PagedHistogram.class,
             PackedConcurrentHistogram.class,
             IntCountsHistogram.class,
             ShortCountsHistogram.class,
+            AdaptiveCountsHistogram.class,
     })
     public void testConstructionArgumentGets(Class histoClass) throws Exception {
         // Histogram histogram = new Histogram(highestTrackableValue, numberOfSignificantValueDigits);
@@ -393,9 +414,11 @@ public class HistogramTest {
             AtomicHistogram.class,
             SynchronizedHistogram.class,
             PackedHistogram.class,
+            PagedHistogram.class,
             PackedConcurrentHistogram.class,
             IntCountsHistogram.class,
             ShortCountsHistogram.class,
+            AdaptiveCountsHistogram.class,
     })
     public void testRecordValue(Class histoClass) throws Exception {
             // Histogram histogram = new Histogram(highestTrackableValue, numberOfSignificantValueDigits);
@@ -413,9 +436,11 @@ public class HistogramTest {
             AtomicHistogram.class,
             SynchronizedHistogram.class,
             PackedHistogram.class,
+            PagedHistogram.class,
             PackedConcurrentHistogram.class,
             IntCountsHistogram.class,
             ShortCountsHistogram.class,
+            AdaptiveCountsHistogram.class,
     })
     public void testRecordValue_Overflow_ShouldThrowException(final Class histoClass) throws Exception {
         Assertions.assertThrows(ArrayIndexOutOfBoundsException.class,
@@ -436,9 +461,432 @@ public class HistogramTest {
             AtomicHistogram.class,
             SynchronizedHistogram.class,
             PackedHistogram.class,
+            PagedHistogram.class,
             PackedConcurrentHistogram.class,
             IntCountsHistogram.class,
             ShortCountsHistogram.class,
+            AdaptiveCountsHistogram.class,
+    })
+    public void testRecordValues(Class histoClass) throws Exception {
+        AbstractHistogram histogram = constructHistogram(histoClass, highestTrackableValue, numberOfSignificantValueDigits);
+        AbstractHistogram expectedHistogram = constructHistogram(histoClass, highestTrackableValue, numberOfSignificantValueDigits);
+        long[] values = new long[1000];
+        for (int i = 0; i < values.length; i++) {
+            values[i] = (i * 7919L) % 100000;
+        }
+        // Record only the middle of the array:
+        histogram.recordValues(values, 100, 800);
+        for (int i = 100; i < 900; i++) {
+            expectedHistogram.recordValue(values[i]);
+        }
+        Assert.assertEquals(expectedHistogram, histogram);
+        Assert.assertEquals(800L, histogram.getTotalCount());
+        Assert.assertEquals(expectedHistogram.getMinValue(), histogram.getMinValue());
+        Assert.assertEquals(expectedHistogram.getMinNonZeroValue(), histogram.getMinNonZeroValue());
+        Assert.assertEquals(expectedHistogram.getMaxValue(), histogram.getMaxValue());
+
+        // An empty batch is a no-op:
+        histogram.recordValues(values, 0, 0);
+        Assert.assertEquals(800L, histogram.getTotalCount());
+        verifyMaxValue(histogram);
+    }
+
+    @ParameterizedTest
+    @ValueSource(classes = {
+            Histogram.class,
+            ConcurrentHistogram.class,
+            AtomicHistogram.class,
+            SynchronizedHistogram.class,
+            PackedHistogram.class,
+            PagedHistogram.class,
+            PackedConcurrentHistogram.class,
+            IntCountsHistogram.class,
+            ShortCountsHistogram.class,
+            AdaptiveCountsHistogram.class,
+    })
+    public void testRecordValues_Overflow_KeepsPrecedingValues(Class histoClass) throws Exception {
+        AbstractHistogram histogram = constructHistogram(histoClass, highestTrackableValue, numberOfSignificantValueDigits);
+        long[] values = {testValueLevel, testValueLevel * 1000, highestTrackableValue * 3, testValueLevel};
+        boolean thrown = false;
+        try {
+            histogram.recordValues(values, 0, values.length);
+        } catch (ArrayIndexOutOfBoundsException e) {
+            thrown = true;
+        }
+        Assert.assertTrue(thrown);
+        Assert.assertEquals(2L, histogram.getTotalCount());
+        Assert.assertEquals(1L, histogram.getCountAtValue(testValueLevel));
+        Assert.assertTrue(histogram.valuesAreEquivalent(testValueLevel * 1000, histogram.getMaxValue()));
+        verifyMaxValue(histogram);
+    }
+
+    private static void assertEquivalentQueryResults(AbstractHistogram expected, AbstractHistogram actual) {
+        final double[] percentiles = {0.0, 1.0, 25.0, 50.0, 90.0, 99.0, 99.9, 99.99, 100.0};
+        for (double percentile : percentiles) {
+            Assert.assertEquals("value at " + percentile + "%'ile",
+                    expected.getValueAtPercentile(percentile), actual.getValueAtPercentile(percentile));
+        }
+        final long[] values = {0, 1, testValueLevel, 1000, 12345, 100000, highestTrackableValue};
+        for (long value : values) {
+            Assert.assertEquals("percentile at or below " + value,
+                    expected.getPercentileAtOrBelowValue(value), actual.getPercentileAtOrBelowValue(value), 0.0);
+            Assert.assertEquals("count between 0 and " + value,
+                    expected.getCountBetweenValues(0, value), actual.getCountBetweenValues(0, value));
+            Assert.assertEquals("count between " + value + " and max",
+                    expected.getCountBetweenValues(value, highestTrackableValue),
+                    actual.getCountBetweenValues(value, highestTrackableValue));
+        }
+    }
+
+    @ParameterizedTest
+    @ValueSource(classes = {
+            Histogram.class,
+            ConcurrentHistogram.class,
+            AtomicHistogram.class,
+            SynchronizedHistogram.class,
+            PackedHistogram.class,
+            PagedHistogram.class,
+            PackedConcurrentHistogram.class,
+            IntCountsHistogram.class,
+            ShortCountsHistogram.class,
+            AdaptiveCountsHistogram.class,
+    })
+    public void testCumulativeCountIndexing(Class histoClass) throws Exception {
+        AbstractHistogram histogram = constructHistogram(histoClass, highestTrackableValue, numberOfSignificantValueDigits);
+        AbstractHistogram indexedHistogram = constructHistogram(histoClass, highestTrackableValue, numberOfSignificantValueDigits);
+        indexedHistogram.setCumulativeCountIndexing(true);
+        Assert.assertTrue(indexedHistogram.isCumulativeCountIndexing());
+        Assert.assertFalse(histogram.isCumulativeCountIndexing());
+
+        // Empty histograms:
+        assertEquivalentQueryResults(histogram, indexedHistogram);
+
+        for (int i = 0; i < 1000; i++) {
+            histogram.recordValue((i * 7919L) % 100000);
+            indexedHistogram.recordValue((i * 7919L) % 100000);
+        }
+        assertEquivalentQueryResults(histogram, indexedHistogram);
+
+        // Recording after a query must be reflected in subsequent queries:
+        histogram.recordValueWithCount(100000, 500);
+        indexedHistogram.recordValueWithCount(100000, 500);
+        assertEquivalentQueryResults(histogram, indexedHistogram);
+
+        // Adding:
+        AbstractHistogram other = constructHistogram(histoClass, highestTrackableValue, numberOfSignificantValueDigits);
+        other.recordValueWithCount(12345, 300);
+        histogram.add(other);
+        indexedHistogram.add(other);
+        assertEquivalentQueryResults(histogram, indexedHistogram);
+
+        // Reset, then re-record the same number of values at different levels:
+        long totalCount = indexedHistogram.getTotalCount();
+        histogram.reset();
+        indexedHistogram.reset();
+        histogram.recordValueWithCount(1, totalCount);
+        indexedHistogram.recordValueWithCount(1, totalCount);
+        Assert.assertEquals(totalCount, indexedHistogram.getTotalCount());
+        assertEquivalentQueryResults(histogram, indexedHistogram);
+
+        // Negative count recordings that leave the total count unchanged:
+        histogram.recordValueWithCount(1, -10);
+        indexedHistogram.recordValueWithCount(1, -10);
+        histogram.recordValueWithCount(1000, 10);
+        indexedHistogram.recordValueWithCount(1000, 10);
+        Assert.assertEquals(totalCount, indexedHistogram.getTotalCount());
+        assertEquivalentQueryResults(histogram, indexedHistogram);
+
+        indexedHistogram.setCumulativeCountIndexing(false);
+        Assert.assertFalse(indexedHistogram.isCumulativeCountIndexing());
+        assertEquivalentQueryResults(histogram, indexedHistogram);
+    }
+
+    private static double[] iteratedMeanAndStdDeviation(AbstractHistogram histogram) {
+        double total = 0;
+        long count = 0;
+        for (HistogramIterationValue v : histogram.recordedValues()) {
+            total += histogram.medianEquivalentValue(v.getValueIteratedTo()) * (double) v.getCountAtValueIteratedTo();
+            count += v.getCountAtValueIteratedTo();
+        }
+        final double mean = total / count;
+        double squaredDeviationsTotal = 0;
+        for (HistogramIterationValue v : histogram.recordedValues()) {
+            double deviation = histogram.medianEquivalentValue(v.getValueIteratedTo()) - mean;
+            squaredDeviationsTotal += deviation * deviation * v.getCountAtValueIteratedTo();
+        }
+        return new double[] {mean, Math.sqrt(squaredDeviationsTotal / count)};
+    }
+
+    @ParameterizedTest
+    @ValueSource(classes = {
+            Histogram.class,
+            ConcurrentHistogram.class,
+            AtomicHistogram.class,
+            SynchronizedHistogram.class,
+            PackedHistogram.class,
+            PagedHistogram.class,
+            PackedConcurrentHistogram.class,
+            IntCountsHistogram.class,
+            ShortCountsHistogram.class,
+            AdaptiveCountsHistogram.class,
+    })
+    public void testMeanAndStdDeviation(Class histoClass) throws Exception {
+        AbstractHistogram histogram = constructHistogram(histoClass, highestTrackableValue, numberOfSignificantValueDigits);
+        for (int i = 0; i < 10000; i++) {
+            histogram.recordValue((i * 7919L) % 1000000);
+        }
+        histogram.recordValueWithCount(100000000L, 10);
+        double[] expected = iteratedMeanAndStdDeviation(histogram);
+        Assert.assertEquals(expected[0], histogram.getMean(), expected[0] * 1e-12);
+        Assert.assertEquals(expected[1], histogram.getStdDeviation(), expected[1] * 1e-12);
+        // Repeated (cached) queries return the same results:
+        Assert.assertEquals(histogram.getMean(), histogram.getMean(), 0.0);
+        Assert.assertEquals(histogram.getStdDeviation(), histogram.getStdDeviation(), 0.0);
+
+        // Recording after a query must be reflected in subsequent queries:
+        histogram.recordValueWithCount(1000, 5000);
+        expected = iteratedMeanAndStdDeviation(histogram);
+        Assert.assertEquals(expected[0], histogram.getMean(), expected[0] * 1e-12);
+        Assert.assertEquals(expected[1], histogram.getStdDeviation(), expected[1] * 1e-12);
+
+        // Reset, then re-record the same number of values at a single level:
+        long totalCount = histogram.getTotalCount();
+        histogram.reset();
+        histogram.recordValueWithCount(1000, totalCount);
+        Assert.assertEquals(histogram.medianEquivalentValue(1000), histogram.getMean(), 0.0);
+        Assert.assertEquals(0.0, histogram.getStdDeviation(), 0.0);
+    }
+
+    @ParameterizedTest
+    @ValueSource(classes = {
+            Histogram.class,
+            ConcurrentHistogram.class,
+            AtomicHistogram.class,
+            SynchronizedHistogram.class,
+            PackedHistogram.class,
+            PagedHistogram.class,
+            PackedConcurrentHistogram.class,
+            IntCountsHistogram.class,
+            ShortCountsHistogram.class,
+            AdaptiveCountsHistogram.class,
+    })
+    public void testGetValuesAtPercentiles(Class histoClass) throws Exception {
+        final AbstractHistogram histogram = constructHistogram(histoClass, highestTrackableValue, numberOfSignificantValueDigits);
+        final double[] ascendingPercentiles = {0.0, 25.0, 50.0, 50.0, 90.0, 99.0, 99.9, 99.99, 100.0};
+        final double[] unorderedPercentiles = {99.9, 0.0, 100.0, 50.0, 99.99, 25.0, 90.0, 50.0, 99.0};
+        final long[] values = new long[ascendingPercentiles.length + 1];
+
+        // Empty histogram:
+        histogram.getValuesAtPercentiles(ascendingPercentiles, values);
+        for (int i = 0; i < ascendingPercentiles.length; i++) {
+            Assert.assertEquals(0L, values[i]);
+        }
+
+        for (int i = 0; i < 10000; i++) {
+            histogram.recordValue((i * 7919L) % 1000000);
+        }
+        histogram.recordValueWithCount(100000000L, 10);
+
+        for (int pass = 0; pass < 2; pass++) {
+            histogram.getValuesAtPercentiles(ascendingPercentiles, values);
+            for (int i = 0; i < ascendingPercentiles.length; i++) {
+                Assert.assertEquals("value at " + ascendingPercentiles[i] + "%'ile",
+                        histogram.getValueAtPercentile(ascendingPercentiles[i]), values[i]);
+            }
+            histogram.getValuesAtPercentiles(unorderedPercentiles, values);
+            for (int i = 0; i < unorderedPercentiles.length; i++) {
+                Assert.assertEquals("value at " + unorderedPercentiles[i] + "%'ile",
+                        histogram.getValueAtPercentile(unorderedPercentiles[i]), values[i]);
+            }
+            // Second pass resolves the percentiles through the cumulative count index:
+            histogram.setCumulativeCountIndexing(true);
+        }
+
+        Assertions.assertThrows(IllegalArgumentException.class, new Executable() {
+            @Override
+            public void execute() throws Throwable {
+                histogram.getValuesAtPercentiles(ascendingPercentiles, new long[2]);
+            }
+        });
+    }
+
+    @Test
+    public void testCumulativeCountIndexingWithShiftAndResize() throws Exception {
+        Histogram histogram = new Histogram(3);
+        Histogram indexedHistogram = new Histogram(3);
+        indexedHistogram.setCumulativeCountIndexing(true);
+        for (int i = 0; i < 1000; i++) {
+            histogram.recordValue(1000 + i);
+            indexedHistogram.recordValue(1000 + i);
+        }
+        assertEquivalentQueryResults(histogram, indexedHistogram);
+
+        histogram.shiftValuesLeft(4);
+        indexedHistogram.shiftValuesLeft(4);
+        assertEquivalentQueryResults(histogram, indexedHistogram);
+
+        // Recording a large value auto-resizes the histogram:
+        histogram.recordValue(highestTrackableValue);
+        indexedHistogram.recordValue(highestTrackableValue);
+        assertEquivalentQueryResults(histogram, indexedHistogram);
+    }
+
+    @ParameterizedTest
+    @ValueSource(classes = {
+            Histogram.class,
+            ConcurrentHistogram.class,
+            PackedHistogram.class,
+            PagedHistogram.class,
+            IntCountsHistogram.class,
+    })
+    public void testFrozenHistogram(Class histoClass) throws Exception {
+        AbstractHistogram histogram = constructHistogram(histoClass, highestTrackableValue, numberOfSignificantValueDigits);
+        for (int i = 0; i < 1000; i++) {
+            histogram.recordValue((i * 7919L) % 100000);
+        }
+        histogram.recordValue(0);
+        histogram.setStartTimeStamp(1000);
+        histogram.setEndTimeStamp(2000);
+        histogram.setTag("frozen");
+
+        final FrozenHistogram frozenHistogram = new FrozenHistogram(histogram);
+        Assert.assertEquals(histogram, frozenHistogram);
+        Assert.assertEquals(histogram.getTotalCount(), frozenHistogram.getTotalCount());
+        Assert.assertEquals(histogram.getMinNonZeroValue(), frozenHistogram.getMinNonZeroValue());
+        Assert.assertEquals(histogram.getMaxValue(), frozenHistogram.getMaxValue());
+        Assert.assertEquals(1000, frozenHistogram.getStartTimeStamp());
+        Assert.assertEquals(2000, frozenHistogram.getEndTimeStamp());
+        Assert.assertEquals("frozen", frozenHistogram.getTag());
+        Assert.assertTrue(frozenHistogram.isCumulativeCountIndexing());
+        assertEquivalentQueryResults(histogram, frozenHistogram);
+        Assert.assertEquals(histogram, frozenHistogram.copy());
+
+        // The snapshot is not affected by subsequent changes to the source:
+        histogram.recordValue(testValueLevel);
+        Assert.assertEquals(1001L, frozenHistogram.getTotalCount());
+
+        Assertions.assertThrows(IllegalStateException.class, new Executable() {
+            @Override
+            public void execute() throws Throwable {
+                frozenHistogram.recordValue(testValueLevel);
+            }
+        });
+        Assertions.assertThrows(IllegalStateException.class, new Executable() {
+            @Override
+            public void execute() throws Throwable {
+                frozenHistogram.recordValues(new long[] {testValueLevel}, 0, 1);
+            }
+        });
+        Assertions.assertThrows(IllegalStateException.class, new Executable() {
+            @Override
+            public void execute() throws Throwable {
+                frozenHistogram.add(frozenHistogram);
+            }
+        });
+        Assertions.assertThrows(IllegalStateException.class, new Executable() {
+            @Override
+            public void execute() throws Throwable {
+                frozenHistogram.reset();
+            }
+        });
+        Assertions.assertThrows(IllegalStateException.class, new Executable() {
+            @Override
+            public void execute() throws Throwable {
+                frozenHistogram.shiftValuesLeft(1);
+            }
+        });
+        Assert.assertEquals(1001L, frozenHistogram.getTotalCount());
+    }
+
+    @Test
+    public void testByteBufferHistogram() throws Exception {
+        Histogram reference = new Histogram(highestTrackableValue, numberOfSignificantValueDigits);
+        ByteBufferHistogram directHistogram =
+                new ByteBufferHistogram(highestTrackableValue, numberOfSignificantValueDigits);
+        final int capacity = ByteBufferHistogram.getNeededBufferCapacity(1, highestTrackableValue,
+                numberOfSignificantValueDigits);
+        ByteBuffer heapBuffer = ByteBuffer.allocate(capacity + 16);
+        heapBuffer.position(16);
+        ByteBufferHistogram heapHistogram =
+                new ByteBufferHistogram(1, highestTrackableValue, numberOfSignificantValueDigits, heapBuffer);
+        for (int i = 0; i < 1000; i++) {
+            long value = (i * 7919L) % 100000;
+            reference.recordValue(value);
+            directHistogram.recordValue(value);
+            heapHistogram.recordValue(value);
+        }
+        assertEqual(reference, directHistogram);
+        assertEqual(reference, heapHistogram);
+        assertEquivalentQueryResults(reference, directHistogram);
+
+        // Wrapping the buffer re-establishes the histogram's contents:
+        heapBuffer.position(16);
+        ByteBufferHistogram wrappedHistogram = ByteBufferHistogram.wrap(heapBuffer);
+        assertEqual(reference, wrappedHistogram);
+        Assert.assertEquals(reference.getMinNonZeroValue(), wrappedHistogram.getMinNonZeroValue());
+        Assert.assertEquals(reference.getMaxValue(), wrappedHistogram.getMaxValue());
+
+        Assertions.assertThrows(IllegalArgumentException.class, new Executable() {
+            @Override
+            public void execute() throws Throwable {
+                new ByteBufferHistogram(1, highestTrackableValue, numberOfSignificantValueDigits,
+                        ByteBuffer.allocate(capacity - 1));
+            }
+        });
+        Assertions.assertThrows(IllegalArgumentException.class, new Executable() {
+            @Override
+            public void execute() throws Throwable {
+                ByteBufferHistogram.wrap(ByteBuffer.allocate(capacity));
+            }
+        });
+        final ByteBufferHistogram fixedSizeHistogram = heapHistogram;
+        Assertions.assertThrows(IllegalStateException.class, new Executable() {
+            @Override
+            public void execute() throws Throwable {
+                fixedSizeHistogram.setAutoResize(true);
+            }
+        });
+
+        testAbstractSerialization(new ByteBufferHistogram(highestTrackableValue, numberOfSignificantValueDigits));
+    }
+
+    @Test
+    public void testFileBackedByteBufferHistogram() throws Exception {
+        File file = File.createTempFile("ByteBufferHistogram", ".hgrm");
+        file.deleteOnExit();
+        ByteBufferHistogram writer =
+                ByteBufferHistogram.createFileBacked(file, 1, highestTrackableValue, numberOfSignificantValueDigits);
+        writer.recordValue(testValueLevel);
+        writer.recordValueWithCount(testValueLevel * 1000, 10);
+
+        // A sidecar reader sees the recorded counts without serialization:
+        ByteBufferHistogram reader = ByteBufferHistogram.openFileBacked(file, true);
+        assertEqual(writer, reader);
+        Assert.assertEquals(11L, reader.getTotalCount());
+
+        writer.recordValue(testValueLevel * 100000);
+        Assert.assertEquals(11L, reader.getTotalCount());
+        reader.syncFromBuffer();
+        assertEqual(writer, reader);
+        Assert.assertEquals(writer.getMaxValue(), reader.getMaxValue());
+
+        writer.reset();
+        reader.syncFromBuffer();
+        Assert.assertEquals(0L, reader.getTotalCount());
+    }
+
+    @ParameterizedTest
+    @ValueSource(classes = {
+            Histogram.class,
+            ConcurrentHistogram.class,
+            AtomicHistogram.class,
+            SynchronizedHistogram.class,
+            PackedHistogram.class,
+            PagedHistogram.class,
+            PackedConcurrentHistogram.class,
+            IntCountsHistogram.class,
+            ShortCountsHistogram.class,
+            AdaptiveCountsHistogram.class,
     })
     public void testConstructionWithLargeNumbers(Class histoClass) throws Exception {
             // Histogram histogram = new Histogram(20000000, 100000000, 5);
@@ -460,9 +908,11 @@ public class HistogramTest {
             AtomicHistogram.class,
             SynchronizedHistogram.class,
             PackedHistogram.class,
+            PagedHistogram.class,
             PackedConcurrentHistogram.class,
             IntCountsHistogram.class,
             ShortCountsHistogram.class,
+            AdaptiveCountsHistogram.class,
     })
     public void testValueAtPercentileMatchesPercentile(Class histoClass) throws Exception {
             // Histogram histogram = new Histogram(1, Long.MAX_VALUE, 3);
@@ -493,9 +943,11 @@ public class HistogramTest {
             AtomicHistogram.class,
             SynchronizedHistogram.class,
             PackedHistogram.class,
+            PagedHistogram.class,
             PackedConcurrentHistogram.class,
             IntCountsHistogram.class,
             ShortCountsHistogram.class,
+            AdaptiveCountsHistogram.class,
     })
     public void testValueAtPercentileMatchesPercentileIter(Class histoClass) throws Exception {
             // Histogram histogram = new Histogram(1, Long.MAX_VALUE, 3);
@@ -528,9 +980,11 @@ public class HistogramTest {
             AtomicHistogram.class,
             SynchronizedHistogram.class,
             PackedHistogram.class,
+            PagedHistogram.class,
             PackedConcurrentHistogram.class,
             IntCountsHistogram.class,
             ShortCountsHistogram.class,
+            AdaptiveCountsHistogram.class,
     })
     public void testRecordValueWithExpectedInterval(Class histoClass) throws Exception {
             // Histogram histogram = new Histogram(highestTrackableValue, numberOfSignificantValueDigits);
@@ -562,9 +1016,73 @@ public class HistogramTest {
             AtomicHistogram.class,
             SynchronizedHistogram.class,
             PackedHistogram.class,
+            PagedHistogram.class,
+            PackedConcurrentHistogram.class,
+            IntCountsHistogram.class,
+            ShortCountsHistogram.class,
+            AdaptiveCountsHistogram.class,
+    })
+    public void testBulkCoordinatedOmissionCorrection(Class histoClass) throws Exception {
+        final long[][] valuesAndIntervals = {
+                {10000000L, 1000L},     // 9999 missing values, many per bucket
+                {3000000L, 7L},         // Interval not aligned with bucket boundaries
+                {123456789L, 1000000L}, // Fewer missing values than buckets
+                {2047L, 1L},            // Unit resolution range
+                {5000L, 2500L},         // Single missing value
+                {4999L, 2500L},         // No missing values
+        };
+        for (long[] valueAndInterval : valuesAndIntervals) {
+            final long value = valueAndInterval[0];
+            final long expectedInterval = valueAndInterval[1];
+            AbstractHistogram histogram =
+                    constructHistogram(histoClass, highestTrackableValue, numberOfSignificantValueDigits);
+            AbstractHistogram expectedHistogram =
+                    constructHistogram(histoClass, highestTrackableValue, numberOfSignificantValueDigits);
+            histogram.recordValueWithExpectedInterval(value, expectedInterval);
+            histogram.recordValueWithCount(value / 3, 1);
+            expectedHistogram.recordValue(value);
+            for (long missingValue = value - expectedInterval; missingValue >= expectedInterval;
+                 missingValue -= expectedInterval) {
+                expectedHistogram.recordValue(missingValue);
+            }
+            expectedHistogram.recordValue(value / 3);
+            Assert.assertEquals(expectedHistogram, histogram);
+            Assert.assertEquals(expectedHistogram.getTotalCount(), histogram.getTotalCount());
+            Assert.assertEquals(expectedHistogram.getMinNonZeroValue(), histogram.getMinNonZeroValue());
+            Assert.assertEquals(expectedHistogram.getMaxValue(), histogram.getMaxValue());
+
+            // Post-recording correction, with counts larger than 1:
+            AbstractHistogram rawHistogram =
+                    constructHistogram(histoClass, highestTrackableValue, numberOfSignificantValueDigits);
+            rawHistogram.recordValueWithCount(value, 3);
+            AbstractHistogram correctedHistogram = rawHistogram.copyCorrectedForCoordinatedOmission(expectedInterval);
+            AbstractHistogram expectedCorrectedHistogram =
+                    constructHistogram(histoClass, highestTrackableValue, numberOfSignificantValueDigits);
+            final long recordedValue = rawHistogram.highestEquivalentValue(value);
+            expectedCorrectedHistogram.recordValueWithCount(recordedValue, 3);
+            for (long missingValue = recordedValue - expectedInterval; missingValue >= expectedInterval;
+                 missingValue -= expectedInterval) {
+                expectedCorrectedHistogram.recordValueWithCount(missingValue, 3);
+            }
+            Assert.assertEquals(expectedCorrectedHistogram, correctedHistogram);
+            Assert.assertEquals(expectedCorrectedHistogram.getTotalCount(), correctedHistogram.getTotalCount());
+            Assert.assertEquals(expectedCorrectedHistogram.getMinNonZeroValue(),
+                    correctedHistogram.getMinNonZeroValue());
+        }
+    }
+
+    @ParameterizedTest
+    @ValueSource(classes = {
+            Histogram.class,
+            ConcurrentHistogram.class,
+            AtomicHistogram.class,
+            SynchronizedHistogram.class,
+            PackedHistogram.class,
+            PagedHistogram.class,
             PackedConcurrentHistogram.class,
             IntCountsHistogram.class,
             ShortCountsHistogram.class,
+            AdaptiveCountsHistogram.class,
     })
     public void testReset(Class histoClass) throws Exception {
             // Histogram histogram = new Histogram(highestTrackableValue, numberOfSignificantValueDigits);
@@ -584,6 +1102,688 @@ public class HistogramTest {
             Assert.assertEquals(histogram.getMaxValue(), 80);
     }
 
+    @ParameterizedTest
+    @ValueSource(classes = {
+            Histogram.class,
+            SynchronizedHistogram.class,
+            IntCountsHistogram.class,
+            ShortCountsHistogram.class,
+    })
+    public void testSameShapeAddAndSubtractKernels(Class histoClass) throws Exception {
+        final Class[] otherClasses = {
+                Histogram.class, SynchronizedHistogram.class, IntCountsHistogram.class, ShortCountsHistogram.class
+        };
+        for (Class otherClass : otherClasses) {
+            AbstractHistogram histogram =
+                    constructHistogram(histoClass, highestTrackableValue, numberOfSignificantValueDigits);
+            AbstractHistogram other =
+                    constructHistogram(otherClass, highestTrackableValue, numberOfSignificantValueDigits);
+            // The reference histogram goes through the generic (index by index) add and subtract paths:
+            AbstractHistogram reference =
+                    new PackedHistogram(highestTrackableValue, numberOfSignificantValueDigits);
+            histogram.recordValueWithCount(1000, 5);
+            reference.recordValueWithCount(1000, 5);
+            // A sparse span, including a zero value:
+            other.recordValueWithCount(0, 2);
+            other.recordValueWithCount(1000, 3);
+            other.recordValueWithCount(123456789, 7);
+
+            histogram.add(other);
+            reference.add(other);
+            Assert.assertEquals(reference, histogram);
+            Assert.assertEquals(15L, histogram.getTotalCount());
+            Assert.assertEquals(0L, histogram.getMinValue());
+            Assert.assertEquals(reference.getMaxValue(), histogram.getMaxValue());
+            Assert.assertEquals(reference.getMinNonZeroValue(), histogram.getMinNonZeroValue());
+
+            histogram.subtract(other);
+            reference.subtract(other);
+            Assert.assertEquals(reference, histogram);
+            Assert.assertEquals(5L, histogram.getTotalCount());
+            Assert.assertEquals(histogram.highestEquivalentValue(1000), histogram.getMaxValue());
+            Assert.assertEquals(1000L, histogram.getMinNonZeroValue());
+
+            // Subtracting more than is there fails without modifying the histogram:
+            final AbstractHistogram finalHistogram = histogram;
+            final AbstractHistogram finalOther = other;
+            Assertions.assertThrows(IllegalArgumentException.class, new Executable() {
+                @Override
+                public void execute() throws Throwable {
+                    finalHistogram.subtract(finalOther);
+                }
+            });
+            Assert.assertEquals(reference, histogram);
+
+            // An empty other histogram adds nothing:
+            other.reset();
+            histogram.add(other);
+            Assert.assertEquals(reference, histogram);
+        }
+    }
+
+    @Test
+    public void testPlainCountsArrayCapability() throws Exception {
+        // Subclasses that keep their counts in the inherited array qualify for the kernels:
+        Histogram subclassed = new Histogram(highestTrackableValue, numberOfSignificantValueDigits) {
+        };
+        subclassed.recordValueWithCount(1000, 3);
+        Assert.assertNotNull(subclassed.getPlainCountsArray());
+
+        // Frozen histograms can be read by the kernels, but not updated:
+        FrozenHistogram frozen = new FrozenHistogram(subclassed);
+        Assert.assertNotNull(frozen.getPlainCountsArray());
+        Assert.assertNull(frozen.getUpdatablePlainCountsArray());
+        Histogram histogram = new Histogram(highestTrackableValue, numberOfSignificantValueDigits);
+        histogram.add(frozen);
+        histogram.add(subclassed);
+        Assert.assertEquals(6L, histogram.getCountAtValue(1000));
+        final FrozenHistogram finalFrozen = frozen;
+        final Histogram finalHistogram = histogram;
+        Assertions.assertThrows(IllegalStateException.class, new Executable() {
+            @Override
+            public void execute() throws Throwable {
+                finalFrozen.add(finalHistogram);
+            }
+        });
+
+        // Subclasses that keep their counts elsewhere opt out:
+        Assert.assertNull(new AtomicHistogram(highestTrackableValue, numberOfSignificantValueDigits)
+                .getPlainCountsArray());
+        Assert.assertNull(new ConcurrentHistogram(highestTrackableValue, numberOfSignificantValueDigits)
+                .getPlainCountsArray());
+        Assert.assertNull(new PackedHistogram(highestTrackableValue, numberOfSignificantValueDigits)
+                .getPlainCountsArray());
+        Assert.assertNull(new PagedHistogram(highestTrackableValue, numberOfSignificantValueDigits)
+                .getPlainCountsArray());
+    }
+
+    @ParameterizedTest
+    @ValueSource(classes = {
+            Histogram.class,
+            AtomicHistogram.class,
+            ConcurrentHistogram.class,
+            PackedConcurrentHistogram.class,
+    })
+    public void testLazyMinMaxTracking(Class histoClass) throws Exception {
+        AbstractHistogram tracked =
+                constructHistogram(histoClass, highestTrackableValue, numberOfSignificantValueDigits);
+        AbstractHistogram lazy =
+                constructHistogram(histoClass, highestTrackableValue, numberOfSignificantValueDigits);
+        Assert.assertFalse(lazy.isLazyMinMaxTracking());
+        lazy.setLazyMinMaxTracking(true);
+        Assert.assertTrue(lazy.isLazyMinMaxTracking());
+        Assert.assertEquals(tracked.getMaxValue(), lazy.getMaxValue());
+        Assert.assertEquals(tracked.getMinNonZeroValue(), lazy.getMinNonZeroValue());
+
+        Random random = new Random(42);
+        for (int i = 0; i < 10000; i++) {
+            long value = (long) (random.nextDouble() * random.nextDouble() * highestTrackableValue / 2);
+            tracked.recordValue(value);
+            lazy.recordValue(value);
+            if ((i % 1000) == 0) {
+                // Queries in between recordings must not go stale:
+                Assert.assertEquals(tracked.getMaxValue(), lazy.getMaxValue());
+                Assert.assertEquals(tracked.getMinNonZeroValue(), lazy.getMinNonZeroValue());
+            }
+        }
+        tracked.recordValue(0);
+        lazy.recordValue(0);
+        Assert.assertEquals(tracked.getMaxValue(), lazy.getMaxValue());
+        Assert.assertEquals(tracked.getMinNonZeroValue(), lazy.getMinNonZeroValue());
+        Assert.assertEquals(tracked.getMinValue(), lazy.getMinValue());
+        Assert.assertEquals(tracked.getValueAtPercentile(99.9), lazy.getValueAtPercentile(99.9));
+        Assert.assertEquals(tracked.getMean(), lazy.getMean(), 0.0);
+        Assert.assertEquals(tracked, lazy);
+        Assert.assertEquals(tracked.getNeededByteBufferCapacity(), lazy.getNeededByteBufferCapacity());
+        ByteBuffer trackedBuffer = ByteBuffer.allocate(tracked.getNeededByteBufferCapacity());
+        ByteBuffer lazyBuffer = ByteBuffer.allocate(lazy.getNeededByteBufferCapacity());
+        Assert.assertEquals(tracked.encodeIntoByteBuffer(trackedBuffer), lazy.encodeIntoByteBuffer(lazyBuffer));
+        Assert.assertEquals(trackedBuffer.flip(), lazyBuffer.flip());
+
+        // Adding extends the derived range:
+        AbstractHistogram other =
+                constructHistogram(histoClass, highestTrackableValue, numberOfSignificantValueDigits);
+        other.recordValue(highestTrackableValue);
+        tracked.add(other);
+        lazy.add(other);
+        Assert.assertEquals(tracked.getMaxValue(), lazy.getMaxValue());
+        Assert.assertEquals(tracked, lazy);
+
+        // Reset and shift (where supported) are reflected:
+        tracked.reset();
+        lazy.reset();
+        Assert.assertEquals(tracked.getMaxValue(), lazy.getMaxValue());
+        Assert.assertEquals(tracked.getMinNonZeroValue(), lazy.getMinNonZeroValue());
+        tracked.recordValue(7);
+        lazy.recordValue(7);
+        tracked.recordValue(1000);
+        lazy.recordValue(1000);
+        if (histoClass != AtomicHistogram.class) {
+            tracked.shiftValuesLeft(2);
+            lazy.shiftValuesLeft(2);
+        }
+        Assert.assertEquals(tracked.getMaxValue(), lazy.getMaxValue());
+        Assert.assertEquals(tracked.getMinNonZeroValue(), lazy.getMinNonZeroValue());
+
+        // Tracking on recording resumes from the current contents:
+        lazy.setLazyMinMaxTracking(false);
+        Assert.assertEquals(tracked.getMaxValue(), lazy.getMaxValue());
+        Assert.assertEquals(tracked.getMinNonZeroValue(), lazy.getMinNonZeroValue());
+        tracked.recordValue(3);
+        lazy.recordValue(3);
+        Assert.assertEquals(tracked.getMinNonZeroValue(), lazy.getMinNonZeroValue());
+        Assert.assertEquals(lazy.lowestEquivalentValue(3), lazy.getMinNonZeroValue());
+
+        // Sub-unit values (which share index 0 with zero) with a lowestDiscernibleValue above 1:
+        tracked = constructHistogram(histoClass, 1000, highestTrackableValue, numberOfSignificantValueDigits);
+        lazy = constructHistogram(histoClass, 1000, highestTrackableValue, numberOfSignificantValueDigits);
+        lazy.setLazyMinMaxTracking(true);
+        tracked.recordValue(5);
+        lazy.recordValue(5);
+        Assert.assertTrue(lazy.getMaxValue() > 0);
+        Assert.assertEquals(tracked.getMaxValue(), lazy.getMaxValue());
+        Assert.assertEquals(tracked.getMinNonZeroValue(), lazy.getMinNonZeroValue());
+        Assert.assertEquals(tracked.getNeededByteBufferCapacity(), lazy.getNeededByteBufferCapacity());
+    }
+
+    @Test
+    public void testAdaptiveCountsWordSizePromotion() throws Exception {
+        AdaptiveCountsHistogram histogram =
+                new AdaptiveCountsHistogram(highestTrackableValue, numberOfSignificantValueDigits);
+        Histogram reference = new Histogram(highestTrackableValue, numberOfSignificantValueDigits);
+        final int numberOfBlocks = histogram.getNumberOfBlocksWithWordSize(1);
+        final int blockLength = histogram.subBucketHalfCount;
+        Assert.assertEquals(histogram.countsArrayLength, numberOfBlocks * blockLength);
+        final long initialFootprint = histogram.getEstimatedFootprintInBytes();
+        Assert.assertTrue(initialFootprint * 4 < reference.getEstimatedFootprintInBytes());
+
+        // Each count needs a wider word than the one before it, and each lands in a block of its own:
+        final long[] values = {10, 100000, 10000000, 1000000000};
+        final long[] counts = {255, 256, 65536, 1L << 32};
+        for (int i = 0; i < values.length; i++) {
+            histogram.recordValueWithCount(values[i], counts[i]);
+            reference.recordValueWithCount(values[i], counts[i]);
+        }
+        histogram.recordValueWithCount(20, 7);
+        reference.recordValueWithCount(20, 7);
+        Assert.assertEquals(numberOfBlocks - 3, histogram.getNumberOfBlocksWithWordSize(1));
+        Assert.assertEquals(1, histogram.getNumberOfBlocksWithWordSize(2));
+        Assert.assertEquals(1, histogram.getNumberOfBlocksWithWordSize(4));
+        Assert.assertEquals(1, histogram.getNumberOfBlocksWithWordSize(8));
+        Assert.assertEquals(initialFootprint + (1 + 3 + 7) * blockLength, histogram.getEstimatedFootprintInBytes());
+        Assert.assertEquals(reference, histogram);
+
+        // Promotion keeps the other counts in the block:
+        histogram.recordValue(10);
+        reference.recordValue(10);
+        Assert.assertEquals(2, histogram.getNumberOfBlocksWithWordSize(2));
+        Assert.assertEquals(256L, histogram.getCountAtValue(10));
+        Assert.assertEquals(7L, histogram.getCountAtValue(20));
+        Assert.assertEquals(reference, histogram);
+        Assert.assertEquals(reference.getValueAtPercentile(99.0), histogram.getValueAtPercentile(99.0));
+        Assert.assertEquals(reference.getMean(), histogram.getMean(), 0.0);
+
+        // Encoding round trips (into both adaptive and plain histograms):
+        ByteBuffer buffer = ByteBuffer.allocate(histogram.getNeededByteBufferCapacity());
+        histogram.encodeIntoCompressedByteBuffer(buffer);
+        buffer.rewind();
+        Assert.assertEquals(histogram, AdaptiveCountsHistogram.decodeFromCompressedByteBuffer(buffer, 0));
+        buffer.rewind();
+        Assert.assertEquals(reference, Histogram.decodeFromCompressedByteBuffer(buffer, 0));
+
+        // Counts that go negative (transiently) are kept as long counts:
+        histogram.recordValueWithCount(5000, -1);
+        Assert.assertEquals(-1L, histogram.getCountAtValue(5000));
+        histogram.recordValueWithCount(5000, 1);
+        Assert.assertEquals(0L, histogram.getCountAtValue(5000));
+        Assert.assertEquals(2, histogram.getNumberOfBlocksWithWordSize(8));
+
+        // Reset clears the counts, but keeps the block word sizes:
+        final long footprint = histogram.getEstimatedFootprintInBytes();
+        histogram.reset();
+        Assert.assertEquals(0L, histogram.getTotalCount());
+        Assert.assertEquals(0L, histogram.getCountAtValue(1000000000));
+        Assert.assertEquals(2, histogram.getNumberOfBlocksWithWordSize(8));
+        Assert.assertEquals(footprint, histogram.getEstimatedFootprintInBytes());
+    }
+
+    @Test
+    public void testPagedHistogramPages() throws Exception {
+        final PagedHistogram histogram = new PagedHistogram(numberOfSignificantValueDigits);
+        Histogram reference = new Histogram(numberOfSignificantValueDigits);
+        Assert.assertEquals(0, histogram.getNumberOfAllocatedPages());
+        final int pageLength = histogram.subBucketHalfCount;
+
+        histogram.recordValue(1000);
+        reference.recordValue(1000);
+        Assert.assertEquals(1, histogram.getNumberOfAllocatedPages());
+        final long[] firstPage = histogram.pages[histogram.countsArrayIndex(1000) / pageLength];
+        Assert.assertNotNull(firstPage);
+
+        // Auto-resizing extends the page directory, without copying (or allocating) pages:
+        for (long value = 3; value < highestTrackableValue; value *= 10) {
+            histogram.recordValue(value);
+            reference.recordValue(value);
+        }
+        Assert.assertSame(firstPage, histogram.pages[histogram.countsArrayIndex(1000) / pageLength]);
+        Assert.assertEquals(histogram.countsArrayLength, histogram.pages.length * pageLength);
+        final int allocatedPages = histogram.getNumberOfAllocatedPages();
+        Assert.assertTrue(allocatedPages < histogram.pages.length);
+        Assert.assertEquals(512 + (4 * histogram.pages.length) + (allocatedPages * (16 + (8 * pageLength))),
+                histogram.getEstimatedFootprintInBytes());
+        Assert.assertEquals(reference, histogram);
+        Assert.assertEquals(reference.getValueAtPercentile(50.0), histogram.getValueAtPercentile(50.0));
+        Assert.assertEquals(reference.getMinNonZeroValue(), histogram.getMinNonZeroValue());
+
+        // Iteration and encoding skip over unallocated pages:
+        Iterator<HistogramIterationValue> expectedValues = reference.recordedValues().iterator();
+        for (HistogramIterationValue v : histogram.recordedValues()) {
+            HistogramIterationValue expected = expectedValues.next();
+            Assert.assertEquals(expected.getValueIteratedTo(), v.getValueIteratedTo());
+            Assert.assertEquals(expected.getCountAtValueIteratedTo(), v.getCountAtValueIteratedTo());
+        }
+        Assert.assertFalse(expectedValues.hasNext());
+        ByteBuffer buffer = ByteBuffer.allocate(histogram.getNeededByteBufferCapacity());
+        histogram.encodeIntoCompressedByteBuffer(buffer);
+        buffer.rewind();
+        Assert.assertEquals(reference, PagedHistogram.decodeFromCompressedByteBuffer(buffer, 0));
+
+        // Reset zeroes, but retains, the allocated pages:
+        histogram.reset();
+        Assert.assertEquals(allocatedPages, histogram.getNumberOfAllocatedPages());
+        Assert.assertFalse(histogram.recordedValues().iterator().hasNext());
+        Assert.assertEquals(0L, histogram.getCountAtValue(1000));
+
+        Assertions.assertThrows(IllegalStateException.class, new Executable() {
+            @Override
+            public void execute() throws Throwable {
+                histogram.setOccupancyTracking(true);
+            }
+        });
+    }
+
+    @ParameterizedTest
+    @ValueSource(classes = {
+            Histogram.class,
+            ConcurrentHistogram.class,
+            IntCountsHistogram.class,
+            PackedHistogram.class,
+            PagedHistogram.class,
+    })
+    public void testScansBoundedByPopulatedSpan(Class histoClass) throws Exception {
+        for (boolean recordZero : new boolean[] {false, true}) {
+            for (boolean indexing : new boolean[] {false, true}) {
+                AbstractHistogram histogram =
+                        constructHistogram(histoClass, highestTrackableValue, numberOfSignificantValueDigits);
+                histogram.setCumulativeCountIndexing(indexing);
+                // A narrow band of values:
+                for (long value = 100000; value < 101000; value += 7) {
+                    histogram.recordValueWithCount(value, 1 + (value % 3));
+                }
+                if (recordZero) {
+                    histogram.recordValueWithCount(0, 5);
+                }
+                verifyScansAgainstFullScan(histogram);
+
+                AbstractHistogram copy = histogram.copy();
+                Assert.assertEquals(histogram, copy);
+                Assert.assertEquals(histogram.hashCode(), copy.hashCode());
+                copy.recordValue(100500);
+                copy.subtract(histogram);
+                Assert.assertEquals(1L, copy.getTotalCount());
+                Assert.assertEquals(1L, copy.getCountAtValue(100500));
+                Assert.assertFalse(histogram.equals(copy));
+            }
+        }
+
+        // Sub-unit values land in index 0 without moving the min non-zero value, and must still be found:
+        AbstractHistogram histogram = constructHistogram(histoClass, 1000L, highestTrackableValue,
+                numberOfSignificantValueDigits);
+        histogram.recordValueWithCount(5, 3);
+        histogram.recordValueWithCount(50000, 4);
+        verifyScansAgainstFullScan(histogram);
+        Assert.assertEquals(histogram.highestEquivalentValue(0), histogram.getValueAtPercentile(10.0));
+        Assert.assertEquals(3L, histogram.getCountBetweenValues(0, 999));
+        AbstractHistogram other = constructHistogram(histoClass, 1000L, highestTrackableValue,
+                numberOfSignificantValueDigits);
+        other.recordValueWithCount(50000, 5);
+        other.recordValue(7);
+        other.recordValue(3);
+        Assert.assertFalse(histogram.equals(other));
+    }
+
+    @ParameterizedTest
+    @ValueSource(classes = {
+            Histogram.class,
+            SynchronizedHistogram.class,
+    })
+    public void testOccupancyTracking(Class histoClass) throws Exception {
+        Histogram histogram =
+                (Histogram) constructHistogram(histoClass, highestTrackableValue, numberOfSignificantValueDigits);
+        Histogram reference =
+                (Histogram) constructHistogram(histoClass, highestTrackableValue, numberOfSignificantValueDigits);
+        histogram.recordValue(1000);
+        // Enabling tracking picks up existing counts:
+        histogram.setOccupancyTracking(true);
+        Assert.assertTrue(histogram.isOccupancyTracking());
+        reference.recordValue(1000);
+        for (long value = 3; value < highestTrackableValue; value *= 7) {
+            histogram.recordValueWithCount(value, 3);
+            reference.recordValueWithCount(value, 3);
+        }
+        histogram.recordValue(0);
+        reference.recordValue(0);
+        verifyOccupancyTrackingAgainst(reference, histogram);
+
+        // Subtraction leaves (possibly) stale occupancy bits behind, which must be skipped as zero counts:
+        Histogram subtrahend = new Histogram(highestTrackableValue, numberOfSignificantValueDigits);
+        subtrahend.recordValueWithCount(21, 3);
+        subtrahend.recordValue(1000);
+        histogram.subtract(subtrahend);
+        reference.subtract(subtrahend);
+        verifyOccupancyTrackingAgainst(reference, histogram);
+
+        // Adding a tracking histogram (which skips over its empty slots) into others:
+        Histogram sum = new Histogram(highestTrackableValue, numberOfSignificantValueDigits);
+        sum.add(histogram);
+        Assert.assertEquals(reference, sum);
+        IntCountsHistogram intCountsSum = new IntCountsHistogram(1000, highestTrackableValue,
+                numberOfSignificantValueDigits);
+        intCountsSum.add(histogram);
+        Assert.assertEquals(reference.getTotalCount(), intCountsSum.getTotalCount());
+        sum.subtract(histogram);
+        Assert.assertEquals(0L, sum.getTotalCount());
+
+        histogram.reset();
+        Assert.assertFalse(histogram.recordedValues().iterator().hasNext());
+        histogram.recordValue(42);
+        Assert.assertEquals(1L, histogram.getCountAtValue(42));
+        Assert.assertEquals(42L, histogram.getValueAtPercentile(100.0));
+
+        // Auto-resizing re-establishes the bitmap over the resized counts array:
+        Histogram autoResizing = (Histogram) constructHistogram(histoClass, numberOfSignificantValueDigits);
+        Histogram autoResizingReference =
+                (Histogram) constructHistogram(histoClass, numberOfSignificantValueDigits);
+        autoResizing.setOccupancyTracking(true);
+        for (long value = 1; value < highestTrackableValue; value *= 3) {
+            autoResizing.recordValue(value);
+            autoResizingReference.recordValue(value);
+        }
+        verifyOccupancyTrackingAgainst(autoResizingReference, autoResizing);
+
+        histogram.setOccupancyTracking(false);
+        Assert.assertFalse(histogram.isOccupancyTracking());
+    }
+
+    @ParameterizedTest
+    @ValueSource(classes = {
+            Histogram.class,
+            SynchronizedHistogram.class,
+    })
+    public void testAddIntoOccupancyTracking(Class histoClass) throws Exception {
+        Histogram source = new Histogram(highestTrackableValue, numberOfSignificantValueDigits);
+        for (long value = 3; value < highestTrackableValue; value *= 7) {
+            source.recordValueWithCount(value, 3);
+        }
+        source.recordValue(0);
+
+        // Adding a plain histogram into a tracking one must mark the added slots as occupied:
+        Histogram aggregate =
+                (Histogram) constructHistogram(histoClass, highestTrackableValue, numberOfSignificantValueDigits);
+        aggregate.setOccupancyTracking(true);
+        aggregate.add(source);
+        aggregate.add(source);
+        Histogram reference = new Histogram(highestTrackableValue, numberOfSignificantValueDigits);
+        reference.add(source);
+        reference.add(source);
+        verifyOccupancyTrackingAgainst(reference, aggregate);
+
+        // As must copying a plain histogram into a tracking one:
+        Histogram copy =
+                (Histogram) constructHistogram(histoClass, highestTrackableValue, numberOfSignificantValueDigits);
+        copy.setOccupancyTracking(true);
+        source.copyInto(copy);
+        verifyOccupancyTrackingAgainst(source, copy);
+    }
+
+    @Test
+    public void testOccupancyTrackingUnsupported() throws Exception {
+        final Histogram histogram = new AtomicHistogram(highestTrackableValue, numberOfSignificantValueDigits);
+        Assertions.assertThrows(IllegalStateException.class, new Executable() {
+            @Override
+            public void execute() throws Throwable {
+                histogram.setOccupancyTracking(true);
+            }
+        });
+        Assert.assertFalse(histogram.isOccupancyTracking());
+    }
+
+    @Test
+    public void testOccupancyTrackingInSubclass() throws Exception {
+        Histogram histogram = new Histogram(highestTrackableValue, numberOfSignificantValueDigits) {
+        };
+        Histogram reference = new Histogram(highestTrackableValue, numberOfSignificantValueDigits);
+        histogram.setOccupancyTracking(true);
+        Assert.assertTrue(histogram.isOccupancyTracking());
+        for (long value : new long[] {0, 17, 1000, 123456789}) {
+            histogram.recordValue(value);
+            reference.recordValue(value);
+        }
+        verifyOccupancyTrackingAgainst(reference, histogram);
+    }
+
+    @Test
+    public void testEmptySlotSkippingCapability() throws Exception {
+        Histogram histogram = new Histogram(highestTrackableValue, numberOfSignificantValueDigits);
+        Assert.assertFalse(histogram.hasOccupancyBitmap());
+        Assert.assertFalse(histogram.canSkipEmptySlots());
+        histogram.setOccupancyTracking(true);
+        Assert.assertTrue(histogram.hasOccupancyBitmap());
+        Assert.assertTrue(histogram.canSkipEmptySlots());
+
+        // Paged histograms skip unallocated pages, but have no occupancy bitmap to maintain:
+        PagedHistogram paged = new PagedHistogram(highestTrackableValue, numberOfSignificantValueDigits);
+        Assert.assertFalse(paged.hasOccupancyBitmap());
+        Assert.assertTrue(paged.canSkipEmptySlots());
+    }
+
+    @ParameterizedTest
+    @ValueSource(classes = {
+            Histogram.class,
+            SynchronizedHistogram.class,
+            AtomicHistogram.class,
+    })
+    public void testLazyCountsAllocation(Class histoClass) throws Exception {
+        Histogram histogram =
+                (Histogram) constructHistogram(histoClass, highestTrackableValue, numberOfSignificantValueDigits);
+        Histogram reference =
+                (Histogram) constructHistogram(histoClass, highestTrackableValue, numberOfSignificantValueDigits);
+        final int allocatedFootprint = 512 + (8 * histogram.countsArrayLength);
+        Assert.assertEquals(allocatedFootprint, histogram.getEstimatedFootprintInBytes());
+        // Enabling lazy allocation releases the counts of an empty histogram right away:
+        histogram.setLazyCountsAllocation(true);
+        Assert.assertTrue(histogram.isLazyCountsAllocation());
+        Assert.assertEquals(512, histogram.getEstimatedFootprintInBytes());
+
+        // An unallocated histogram queries, iterates, encodes, and adds (and is added to) as an empty one:
+        Assert.assertEquals(0L, histogram.getCountAtValue(1000));
+        Assert.assertEquals(0L, histogram.getValueAtPercentile(99.0));
+        Assert.assertFalse(histogram.recordedValues().iterator().hasNext());
+        histogram.add(new Histogram(highestTrackableValue, numberOfSignificantValueDigits));
+        histogram.add(new IntCountsHistogram(1000, highestTrackableValue, numberOfSignificantValueDigits));
+        Histogram sum = new Histogram(highestTrackableValue, numberOfSignificantValueDigits);
+        sum.add(histogram);
+        Assert.assertEquals(0L, sum.getTotalCount());
+        ByteBuffer buffer = ByteBuffer.allocate(histogram.getNeededByteBufferCapacity());
+        histogram.encodeIntoCompressedByteBuffer(buffer);
+        buffer.rewind();
+        Assert.assertEquals(0L, Histogram.decodeFromCompressedByteBuffer(buffer, 0).getTotalCount());
+        Assert.assertEquals(reference, histogram);
+        Assert.assertEquals(512, histogram.getEstimatedFootprintInBytes());
+
+        // Recording allocates the counts:
+        for (long value = 3; value < highestTrackableValue; value *= 7) {
+            histogram.recordValueWithCount(value, 3);
+            reference.recordValueWithCount(value, 3);
+        }
+        Assert.assertEquals(allocatedFootprint, histogram.getEstimatedFootprintInBytes());
+        Assert.assertEquals(reference, histogram);
+
+        // A reset keeps the counts of a histogram that was recorded into since the previous reset, while a
+        // reset that finds the histogram still empty releases them:
+        histogram.reset();
+        reference.reset();
+        Assert.assertEquals(allocatedFootprint, histogram.getEstimatedFootprintInBytes());
+        Assert.assertEquals(reference, histogram);
+        histogram.reset();
+        Assert.assertEquals(512, histogram.getEstimatedFootprintInBytes());
+
+        // Adding a non-empty histogram allocates the counts:
+        reference.recordValue(42);
+        histogram.add(reference);
+        Assert.assertEquals(allocatedFootprint, histogram.getEstimatedFootprintInBytes());
+        Assert.assertEquals(reference, histogram);
+
+        // Counts that cancel out to a zero total count are not released by enabling lazy allocation:
+        histogram.reset();
+        histogram.setLazyCountsAllocation(false);
+        histogram.recordValueWithCount(1000, 1);
+        histogram.recordValueWithCount(2000, -1);
+        histogram.setLazyCountsAllocation(true);
+        Assert.assertEquals(allocatedFootprint, histogram.getEstimatedFootprintInBytes());
+        Assert.assertEquals(-1L, histogram.getCountAtValue(2000));
+
+        // Disabling lazy allocation allocates the counts right away:
+        histogram.reset();
+        Assert.assertEquals(512, histogram.getEstimatedFootprintInBytes());
+        histogram.setLazyCountsAllocation(false);
+        Assert.assertFalse(histogram.isLazyCountsAllocation());
+        Assert.assertEquals(allocatedFootprint, histogram.getEstimatedFootprintInBytes());
+
+        if (histogram.supportsAutoResize()) {
+            // Auto-resizing an unallocated histogram allocates its counts at the new size:
+            Histogram autoResizing = (Histogram) constructHistogram(histoClass, numberOfSignificantValueDigits);
+            autoResizing.setLazyCountsAllocation(true);
+            autoResizing.recordValue(highestTrackableValue);
+            Assert.assertEquals(512 + (8 * autoResizing.countsArrayLength),
+                    autoResizing.getEstimatedFootprintInBytes());
+            Assert.assertEquals(1L, autoResizing.getCountAtValue(highestTrackableValue));
+        }
+    }
+
+    @ParameterizedTest
+    @ValueSource(classes = {
+            ConcurrentHistogram.class,
+            PackedHistogram.class,
+            PackedConcurrentHistogram.class,
+            PagedHistogram.class,
+    })
+    public void testLazyCountsAllocationUnsupported(Class histoClass) throws Exception {
+        final Histogram histogram =
+                (Histogram) constructHistogram(histoClass, highestTrackableValue, numberOfSignificantValueDigits);
+        Assertions.assertThrows(IllegalStateException.class, new Executable() {
+            @Override
+            public void execute() throws Throwable {
+                histogram.setLazyCountsAllocation(true);
+            }
+        });
+        Assert.assertFalse(histogram.isLazyCountsAllocation());
+    }
+
+    @Test
+    public void testSharedHistogramLayout() throws Exception {
+        Histogram histogram = new Histogram(1000, highestTrackableValue, numberOfSignificantValueDigits);
+        PackedHistogram packedHistogram =
+                new PackedHistogram(1000, highestTrackableValue, numberOfSignificantValueDigits);
+        Assert.assertSame(histogram.layout, packedHistogram.layout);
+        Assert.assertNotSame(histogram.layout, new Histogram(highestTrackableValue, 2).layout);
+
+        Histogram autoResizingHistogram = new Histogram(numberOfSignificantValueDigits);
+        final HistogramLayout initialLayout = autoResizingHistogram.layout;
+        autoResizingHistogram.recordValue(Long.MAX_VALUE / 2);
+        Assert.assertNotSame(initialLayout, autoResizingHistogram.layout);
+        assertEquals(autoResizingHistogram.countsArrayLength, autoResizingHistogram.layout.countsArrayLength);
+        assertEquals(autoResizingHistogram.bucketCount, autoResizingHistogram.layout.bucketCount);
+
+        // Table driven index to value translation matches value based equivalence:
+        for (AbstractHistogram h : new AbstractHistogram[] {histogram, autoResizingHistogram}) {
+            for (int i = 0; i < h.countsArrayLength; i++) {
+                final long value = h.valueFromIndex(i);
+                assertEquals(h.lowestEquivalentValue(value), value);
+                assertEquals(h.highestEquivalentValue(value), h.highestEquivalentValueAtIndex(i));
+            }
+        }
+    }
+
+    private void verifyOccupancyTrackingAgainst(final Histogram reference, final Histogram histogram) {
+        Assert.assertEquals(reference, histogram);
+        HistogramIterationValue expected;
+        Iterator<HistogramIterationValue> expectedValues = reference.recordedValues().iterator();
+        for (HistogramIterationValue v : histogram.recordedValues()) {
+            expected = expectedValues.next();
+            Assert.assertEquals(expected.getValueIteratedTo(), v.getValueIteratedTo());
+            Assert.assertEquals(expected.getValueIteratedFrom(), v.getValueIteratedFrom());
+            Assert.assertEquals(expected.getCountAtValueIteratedTo(), v.getCountAtValueIteratedTo());
+            Assert.assertEquals(expected.getTotalValueToThisValue(), v.getTotalValueToThisValue());
+        }
+        Assert.assertFalse(expectedValues.hasNext());
+        expectedValues = reference.percentiles(5).iterator();
+        for (HistogramIterationValue v : histogram.percentiles(5)) {
+            expected = expectedValues.next();
+            Assert.assertEquals(expected.getValueIteratedTo(), v.getValueIteratedTo());
+            Assert.assertEquals(expected.getPercentileLevelIteratedTo(), v.getPercentileLevelIteratedTo(), 0.0);
+        }
+        Assert.assertFalse(expectedValues.hasNext());
+
+        ByteBuffer expectedBuffer = ByteBuffer.allocate(reference.getNeededByteBufferCapacity());
+        reference.encodeIntoByteBuffer(expectedBuffer);
+        ByteBuffer buffer = ByteBuffer.allocate(histogram.getNeededByteBufferCapacity());
+        histogram.encodeIntoByteBuffer(buffer);
+        expectedBuffer.flip();
+        buffer.flip();
+        Assert.assertEquals(expectedBuffer, buffer);
+    }
+
+    private void verifyScansAgainstFullScan(final AbstractHistogram histogram) {
+        final long totalCount = histogram.getTotalCount();
+        long totalToIndex = 0;
+        long weightedTotal = 0;
+        int recordedValues = 0;
+        for (int i = 0; i < histogram.countsArrayLength; i++) {
+            final long count = histogram.getCountAtIndex(i);
+            if (count == 0) {
+                continue;
+            }
+            final long value = histogram.valueFromIndex(i);
+            totalToIndex += count;
+            weightedTotal += count * histogram.highestEquivalentValue(value);
+            recordedValues++;
+            final double percentile = (100.0 * totalToIndex) / totalCount;
+            Assert.assertEquals(percentile, histogram.getPercentileAtOrBelowValue(value), 0.0);
+            Assert.assertEquals(histogram.highestEquivalentValue(value),
+                    histogram.getValueAtPercentile((100.0 * (totalToIndex - 0.5)) / totalCount));
+            Assert.assertEquals(totalToIndex, histogram.getCountBetweenValues(0, value));
+            Assert.assertEquals(totalCount - totalToIndex + count,
+                    histogram.getCountBetweenValues(value, histogram.getHighestTrackableValue()));
+        }
+        Assert.assertEquals(totalCount, totalToIndex);
+
+        int iteratedValues = 0;
+        for (HistogramIterationValue v : histogram.recordedValues()) {
+            iteratedValues++;
+            Assert.assertTrue(v.getCountAtValueIteratedTo() > 0);
+        }
+        Assert.assertEquals(recordedValues, iteratedValues);
+        HistogramIterationValue last = null;
+        for (HistogramIterationValue v : histogram.percentiles(5)) {
+            last = v;
+        }
+        Assert.assertNotNull(last);
+        Assert.assertEquals(totalCount, last.getTotalCountToThisValue());
+        Assert.assertEquals(weightedTotal, last.getTotalValueToThisValue());
+        Assert.assertEquals(histogram.getMaxValue(), last.getValueIteratedTo());
+    }
+
     @ParameterizedTest
     @ValueSource(classes = {
             Histogram.class,
@@ -591,9 +1791,11 @@ public class HistogramTest {
             AtomicHistogram.class,
             SynchronizedHistogram.class,
             PackedHistogram.class,
+            PagedHistogram.class,
             PackedConcurrentHistogram.class,
             IntCountsHistogram.class,
             ShortCountsHistogram.class,
+            AdaptiveCountsHistogram.class,
     })
     public void testAdd(Class histoClass) throws Exception {
             // Histogram histogram = new Histogram(highestTrackableValue, numberOfSignificantValueDigits);
@@ -644,9 +1846,11 @@ public class HistogramTest {
             AtomicHistogram.class,
             SynchronizedHistogram.class,
             PackedHistogram.class,
+            PagedHistogram.class,
             PackedConcurrentHistogram.class,
             IntCountsHistogram.class,
             ShortCountsHistogram.class,
+            AdaptiveCountsHistogram.class,
     })
     public void testSubtractAfterAdd(Class histoClass) {
             // Histogram histogram = new Histogram(highestTrackableValue, numberOfSignificantValueDigits);
@@ -681,9 +1885,11 @@ public class HistogramTest {
             AtomicHistogram.class,
             SynchronizedHistogram.class,
             PackedHistogram.class,
+            PagedHistogram.class,
             PackedConcurrentHistogram.class,
             IntCountsHistogram.class,
             ShortCountsHistogram.class,
+            AdaptiveCountsHistogram.class,
     })
     public void testSubtractToZeroCounts(Class histoClass) {
             // Histogram histogram = new Histogram(highestTrackableValue, numberOfSignificantValueDigits);
@@ -710,9 +1916,11 @@ public class HistogramTest {
             AtomicHistogram.class,
             SynchronizedHistogram.class,
             PackedHistogram.class,
+            PagedHistogram.class,
             PackedConcurrentHistogram.class,
             IntCountsHistogram.class,
             ShortCountsHistogram.class,
+            AdaptiveCountsHistogram.class,
     })
     public void testSubtractToNegativeCountsThrows(Class histoClass) {
             // Histogram histogram = new Histogram(highestTrackableValue, numberOfSignificantValueDigits);
@@ -742,9 +1950,11 @@ public class HistogramTest {
             AtomicHistogram.class,
             SynchronizedHistogram.class,
             PackedHistogram.class,
+            PagedHistogram.class,
             PackedConcurrentHistogram.class,
             IntCountsHistogram.class,
             ShortCountsHistogram.class,
+            AdaptiveCountsHistogram.class,
     })
     public void testSubtractSubtrahendValuesOutsideMinuendRangeThrows(Class histoClass) {
             // Histogram histogram = new Histogram(highestTrackableValue, numberOfSignificantValueDigits);
@@ -776,9 +1986,11 @@ public class HistogramTest {
             AtomicHistogram.class,
             SynchronizedHistogram.class,
             PackedHistogram.class,
+            PagedHistogram.class,
             PackedConcurrentHistogram.class,
             IntCountsHistogram.class,
             ShortCountsHistogram.class,
+            AdaptiveCountsHistogram.class,
     })
     public void testSubtractSubtrahendValuesInsideMinuendRangeWorks(Class histoClass) {
             // Histogram histogram = new Histogram(highestTrackableValue, numberOfSignificantValueDigits);
@@ -816,9 +2028,11 @@ public class HistogramTest {
             AtomicHistogram.class,
             SynchronizedHistogram.class,
             PackedHistogram.class,
+            PagedHistogram.class,
             PackedConcurrentHistogram.class,
             IntCountsHistogram.class,
             ShortCountsHistogram.class,
+            AdaptiveCountsHistogram.class,
     })
     public void testSizeOfEquivalentValueRange(Class histoClass) {
             // Histogram histogram = new Histogram(highestTrackableValue, numberOfSignificantValueDigits);
@@ -849,9 +2063,11 @@ public class HistogramTest {
             AtomicHistogram.class,
             SynchronizedHistogram.class,
             PackedHistogram.class,
+            PagedHistogram.class,
             PackedConcurrentHistogram.class,
             IntCountsHistogram.class,
             ShortCountsHistogram.class,
+            AdaptiveCountsHistogram.class,
     })
     public void testScaledSizeOfEquivalentValueRange(Class histoClass) {
             // Histogram histogram = new Histogram(1024, highestTrackableValue, numberOfSignificantValueDigits);
@@ -876,9 +2092,11 @@ public class HistogramTest {
             AtomicHistogram.class,
             SynchronizedHistogram.class,
             PackedHistogram.class,
+            PagedHistogram.class,
             PackedConcurrentHistogram.class,
             IntCountsHistogram.class,
             ShortCountsHistogram.class,
+            AdaptiveCountsHistogram.class,
     })
     public void testLowestEquivalentValue(Class histoClass) {
             // Histogram histogram = new Histogram(highestTrackableValue, numberOfSignificantValueDigits);
@@ -897,9 +2115,11 @@ public class HistogramTest {
             AtomicHistogram.class,
             SynchronizedHistogram.class,
             PackedHistogram.class,
+            PagedHistogram.class,
             PackedConcurrentHistogram.class,
             IntCountsHistogram.class,
             ShortCountsHistogram.class,
+            AdaptiveCountsHistogram.class,
     })
     public void testScaledLowestEquivalentValue(Class histoClass) {
             // Histogram histogram = new Histogram(1024, highestTrackableValue, numberOfSignificantValueDigits);
@@ -918,9 +2138,11 @@ public class HistogramTest {
             AtomicHistogram.class,
             SynchronizedHistogram.class,
             PackedHistogram.class,
+            PagedHistogram.class,
             PackedConcurrentHistogram.class,
             IntCountsHistogram.class,
             ShortCountsHistogram.class,
+            AdaptiveCountsHistogram.class,
     })
     public void testHighestEquivalentValue(Class histoClass) {
             // Histogram histogram = new Histogram(1024, highestTrackableValue, numberOfSignificantValueDigits);
@@ -947,9 +2169,11 @@ public class HistogramTest {
             AtomicHistogram.class,
             SynchronizedHistogram.class,
             PackedHistogram.class,
+            PagedHistogram.class,
             PackedConcurrentHistogram.class,
             IntCountsHistogram.class,
             ShortCountsHistogram.class,
+            AdaptiveCountsHistogram.class,
     })
     public void testScaledHighestEquivalentValue(Class histoClass) {
             // Histogram histogram = new Histogram(highestTrackableValue, numberOfSignificantValueDigits);
@@ -976,9 +2200,11 @@ public class HistogramTest {
             AtomicHistogram.class,
             SynchronizedHistogram.class,
             PackedHistogram.class,
+            PagedHistogram.class,
             PackedConcurrentHistogram.class,
             IntCountsHistogram.class,
             ShortCountsHistogram.class,
+            AdaptiveCountsHistogram.class,
     })
     public void testMedianEquivalentValue(Class histoClass) {
             // Histogram histogram = new Histogram(highestTrackableValue, numberOfSignificantValueDigits);
@@ -1003,9 +2229,11 @@ public class HistogramTest {
             AtomicHistogram.class,
             SynchronizedHistogram.class,
             PackedHistogram.class,
+            PagedHistogram.class,
             PackedConcurrentHistogram.class,
             IntCountsHistogram.class,
             ShortCountsHistogram.class,
+            AdaptiveCountsHistogram.class,
     })
     public void testScaledMedianEquivalentValue(Class histoClass) {
             // Histogram histogram = new Histogram(1024, highestTrackableValue, numberOfSignificantValueDigits);
@@ -1030,9 +2258,11 @@ public class HistogramTest {
             AtomicHistogram.class,
             SynchronizedHistogram.class,
             PackedHistogram.class,
+            PagedHistogram.class,
             PackedConcurrentHistogram.class,
             IntCountsHistogram.class,
             ShortCountsHistogram.class,
+            AdaptiveCountsHistogram.class,
     })
     public void testNextNonEquivalentValue(Class histoClass) {
             // Histogram histogram = new Histogram(highestTrackableValue, numberOfSignificantValueDigits);
@@ -1204,9 +2434,11 @@ public class HistogramTest {
             AtomicHistogram.class,
             SynchronizedHistogram.class,
             PackedHistogram.class,
+            PagedHistogram.class,
             PackedConcurrentHistogram.class,
             IntCountsHistogram.class,
             ShortCountsHistogram.class,
+            AdaptiveCountsHistogram.class,
     })
     public void testCopy(Class histoClass) throws Exception {
         AbstractHistogram histogram =
@@ -1224,9 +2456,11 @@ public class HistogramTest {
             AtomicHistogram.class,
             SynchronizedHistogram.class,
             PackedHistogram.class,
+            PagedHistogram.class,
             PackedConcurrentHistogram.class,
             IntCountsHistogram.class,
             ShortCountsHistogram.class,
+            AdaptiveCountsHistogram.class,
     })
     public void testScaledCopy(Class histoClass) throws Exception {
         AbstractHistogram histogram =
@@ -1246,9 +2480,11 @@ public class HistogramTest {
             AtomicHistogram.class,
             SynchronizedHistogram.class,
             PackedHistogram.class,
+            PagedHistogram.class,
             PackedConcurrentHistogram.class,
             IntCountsHistogram.class,
             ShortCountsHistogram.class,
+            AdaptiveCountsHistogram.class,
     })
     public void testCopyInto(Class histoClass) throws Exception {
         AbstractHistogram histogram =
@@ -1276,9 +2512,11 @@ public class HistogramTest {
             AtomicHistogram.class,
             SynchronizedHistogram.class,
             PackedHistogram.class,
+            PagedHistogram.class,
             PackedConcurrentHistogram.class,
             IntCountsHistogram.class,
             ShortCountsHistogram.class,
+            AdaptiveCountsHistogram.class,
     })
     public void testScaledCopyInto(Class histoClass) throws Exception {
         AbstractHistogram histogram =
@@ -17,6 +17,8 @@ import org.junit.jupiter.api.function.Executable;
 import org.junit.jupiter.params.ParameterizedTest;
 import org.junit.jupiter.params.provider.ValueSource;
 
+import java.util.concurrent.CountDownLatch;
+
 /**
  * JUnit test for {@link Histogram}
  */
@@ -145,6 +147,28 @@ public class RecorderTest {
         Assert.assertEquals(arraysAreEqual, true);
     }
 
+    @ParameterizedTest
+    @ValueSource(booleans = {false, true})
+    public void testBatchIntervalRecording(boolean usePacked) throws Exception {
+        Histogram histogram = new Histogram(highestTrackableValue, 3);
+        Recorder recorder = new Recorder(3, usePacked);
+        SingleWriterRecorder singleWriterRecorder = new SingleWriterRecorder(3, usePacked);
+
+        long[] values = new long[10000];
+        for (int i = 0; i < values.length; i++) {
+            values[i] = 3000 * i;
+        }
+        for (int i = 0; i < values.length; i += 1000) {
+            histogram.recordValues(values, i, 1000);
+            recorder.recordValues(values, i, 1000);
+            singleWriterRecorder.recordValues(values, i, 1000);
+        }
+
+        Assert.assertEquals(histogram, recorder.getIntervalHistogram());
+        Assert.assertEquals(histogram, singleWriterRecorder.getIntervalHistogram());
+        Assert.assertEquals(0L, recorder.getIntervalHistogram().getTotalCount());
+    }
+
     @ParameterizedTest
     @ValueSource(booleans = {false, true})
     public void testSimpleAutosizingRecorder(boolean usePacked) throws Exception {
@@ -396,4 +420,301 @@ public class RecorderTest {
         DoubleHistogram histToRecycle = recorder1.getIntervalHistogram();
         DoubleHistogram histToRecycle2 = recorder2.getIntervalHistogram(histToRecycle, false);
     }
+
+    // StripedRecorder tests:
+
+    @Test
+    public void testStripedIntervalRecording() throws Exception {
+        final StripedRecorder recorder = new StripedRecorder(highestTrackableValue, 3);
+        final int numberOfThreads = 8;
+        final int valuesPerThread = 10000;
+        Histogram expectedHistogram = new Histogram(highestTrackableValue, 3);
+        Thread[] threads = new Thread[numberOfThreads];
+        for (int t = 0; t < numberOfThreads; t++) {
+            final long threadValueBase = 1000L * (t + 1);
+            for (int i = 0; i < valuesPerThread; i++) {
+                expectedHistogram.recordValue(threadValueBase + i);
+            }
+            threads[t] = new Thread(new Runnable() {
+                @Override
+                public void run() {
+                    for (int i = 0; i < valuesPerThread; i++) {
+                        recorder.recordValue(threadValueBase + i);
+                    }
+                }
+            });
+        }
+        for (Thread thread : threads) {
+            thread.start();
+        }
+        for (Thread thread : threads) {
+            thread.join();
+        }
+        Histogram intervalHistogram = recorder.getIntervalHistogram();
+        Assert.assertEquals(expectedHistogram, intervalHistogram);
+        Assert.assertTrue(intervalHistogram.getStartTimeStamp() <= intervalHistogram.getEndTimeStamp());
+        // Stripes of terminated threads are dropped once sampled:
+        Assert.assertEquals(0, recorder.getStripeCount());
+
+        // Recording from this thread, and recycling the previous interval histogram:
+        recorder.recordValueWithCount(5000, 7);
+        recorder.recordValues(new long[] {6000, 7000}, 0, 2);
+        Histogram intervalHistogram2 = recorder.getIntervalHistogram(intervalHistogram);
+        Assert.assertSame(intervalHistogram, intervalHistogram2);
+        Assert.assertEquals(9L, intervalHistogram2.getTotalCount());
+        Assert.assertEquals(7L, intervalHistogram2.getCountAtValue(5000));
+        Assert.assertEquals(1, recorder.getStripeCount());
+
+        recorder.recordValue(5000);
+        recorder.reset();
+        Assert.assertEquals(0L, recorder.getIntervalHistogram().getTotalCount());
+    }
+
+    @Test
+    public void testStripedAutosizingRecorder() throws Exception {
+        StripedRecorder recorder = new StripedRecorder(3);
+        recorder.recordValue(highestTrackableValue * 1000);
+        recorder.recordValue(1);
+        Histogram histogram = recorder.getIntervalHistogram();
+        Assert.assertEquals(2L, histogram.getTotalCount());
+        Assert.assertTrue(histogram.valuesAreEquivalent(highestTrackableValue * 1000, histogram.getMaxValue()));
+    }
+
+    @Test
+    public void testStripedRecyclingContainingInstanceEnforcement() throws Exception {
+        Assertions.assertThrows(IllegalArgumentException.class,
+                new Executable() {
+                    @Override
+                    public void execute() throws Throwable {
+                        StripedRecorder recorder1 = new StripedRecorder(3);
+                        StripedRecorder recorder2 = new StripedRecorder(3);
+                        Histogram histToRecycle = recorder1.getIntervalHistogram();
+                        Histogram histToRecycle2 = recorder2.getIntervalHistogram(histToRecycle);
+                    }
+                });
+        Assertions.assertThrows(IllegalArgumentException.class,
+                new Executable() {
+                    @Override
+                    public void execute() throws Throwable {
+                        StripedRecorder recorder = new StripedRecorder(3);
+                        Histogram histogramA = recorder.getIntervalHistogram(new Histogram(3));
+                    }
+                });
+        StripedRecorder recorder1 = new StripedRecorder(3);
+        StripedRecorder recorder2 = new StripedRecorder(3);
+        Histogram histToRecycle = recorder1.getIntervalHistogram();
+        Histogram histToRecycle2 = recorder2.getIntervalHistogram(histToRecycle, false);
+    }
+
+    @ParameterizedTest
+    @ValueSource(booleans = {false, true})
+    public void testFlipMetrics(final boolean singleWriter) throws Exception {
+        PhaseFlipMetrics flipMetrics = new PhaseFlipMetrics();
+        Recorder recorder = singleWriter ? null : new Recorder(3);
+        SingleWriterRecorder swRecorder = singleWriter ? new SingleWriterRecorder(3) : null;
+        if (singleWriter) {
+            swRecorder.setFlipMetrics(flipMetrics);
+            Assert.assertSame(flipMetrics, swRecorder.getFlipMetrics());
+        } else {
+            recorder.setFlipMetrics(flipMetrics);
+            Assert.assertSame(flipMetrics, recorder.getFlipMetrics());
+        }
+
+        // Phases alternate between odd and even epochs, so use several intervals:
+        for (int interval = 1; interval <= 5; interval++) {
+            for (int i = 0; i < interval * 100; i++) {
+                if (singleWriter) {
+                    swRecorder.recordValue(i);
+                } else {
+                    recorder.recordValue(i);
+                }
+            }
+            Histogram intervalHistogram = singleWriter ?
+                    swRecorder.getIntervalHistogram() : recorder.getIntervalHistogram();
+            Assert.assertEquals(interval * 100L, intervalHistogram.getTotalCount());
+        }
+
+        Assert.assertEquals(5L, flipMetrics.getFlipCount());
+        Histogram writerEnters = flipMetrics.getWriterEntersPerPhase();
+        Assert.assertEquals(5L, writerEnters.getTotalCount());
+        Assert.assertEquals(100L, writerEnters.getMinValue());
+        Assert.assertTrue(writerEnters.valuesAreEquivalent(500L, writerEnters.getMaxValue()));
+        Assert.assertEquals(5L, flipMetrics.getFlipWaitTimesNsec().getTotalCount());
+        // No writers were in flight during any of the flips:
+        Assert.assertEquals(0L, flipMetrics.getFlipWaitIterations().getMaxValue());
+
+        flipMetrics.reset();
+        Assert.assertEquals(0L, flipMetrics.getFlipCount());
+        if (singleWriter) {
+            swRecorder.setFlipMetrics(null);
+            swRecorder.getIntervalHistogram();
+        } else {
+            recorder.setFlipMetrics(null);
+            recorder.getIntervalHistogram();
+        }
+        Assert.assertEquals(0L, flipMetrics.getFlipCount());
+    }
+
+    @Test
+    public void testAdaptiveFlipWaitsForInFlightWriter() throws Exception {
+        final WriterReaderPhaser phaser = new WriterReaderPhaser();
+        final PhaseFlipMetrics flipMetrics = new PhaseFlipMetrics();
+        phaser.setFlipMetrics(flipMetrics);
+        final CountDownLatch writerEntered = new CountDownLatch(1);
+        final long writerStallTimeMsec = 20;
+
+        Thread writer = new Thread(new Runnable() {
+            @Override
+            public void run() {
+                long criticalValueAtEnter = phaser.writerCriticalSectionEnter();
+                try {
+                    writerEntered.countDown();
+                    Thread.sleep(writerStallTimeMsec);
+                } catch (InterruptedException ex) {
+                    // Exit the critical section early.
+                } finally {
+                    phaser.writerCriticalSectionExit(criticalValueAtEnter);
+                }
+            }
+        });
+        writer.start();
+        writerEntered.await();
+
+        phaser.readerLock();
+        try {
+            phaser.adaptiveFlipPhase(100000L);
+        } finally {
+            phaser.readerUnlock();
+        }
+        writer.join();
+
+        Assert.assertEquals(1L, flipMetrics.getFlipCount());
+        Assert.assertEquals(1L, flipMetrics.getWriterEntersPerPhase().getMaxValue());
+        // Waited through the spin and yield stages, and then parked (at most 0.1 msec at a time):
+        Assert.assertTrue(flipMetrics.getFlipWaitIterations().getMaxValue() > 192);
+        Assert.assertTrue(flipMetrics.getFlipWaitTimesNsec().getMaxValue() > 0);
+    }
+
+    @ParameterizedTest
+    @ValueSource(booleans = {false, true})
+    public void testConcurrentIntervalRecording(final boolean stripedPhaser) throws Exception {
+        final int numberOfThreads = 8;
+        final int recordingsPerThread = 100000;
+        final Recorder recorder = new Recorder(3, false, stripedPhaser);
+        final DoubleRecorder doubleRecorder = new DoubleRecorder(3, false, stripedPhaser);
+        final PhaseFlipMetrics flipMetrics = new PhaseFlipMetrics();
+        recorder.setFlipMetrics(flipMetrics);
+
+        Thread[] writers = new Thread[numberOfThreads];
+        for (int t = 0; t < numberOfThreads; t++) {
+            writers[t] = new Thread(new Runnable() {
+                @Override
+                public void run() {
+                    for (int i = 0; i < recordingsPerThread; i++) {
+                        recorder.recordValue(i);
+                        doubleRecorder.recordValue(i / 1000.0);
+                    }
+                }
+            });
+            writers[t].start();
+        }
+
+        // Sample intervals while the writers are recording, and once more after they are all done:
+        Histogram accumulated = new Histogram(3);
+        DoubleHistogram doubleAccumulated = new DoubleHistogram(3);
+        Histogram intervalHistogram = null;
+        DoubleHistogram doubleIntervalHistogram = null;
+        long intervalSamples = 1;
+        for (Thread writer : writers) {
+            while (writer.isAlive()) {
+                intervalSamples++;
+                intervalHistogram = recorder.getIntervalHistogram(intervalHistogram);
+                accumulated.add(intervalHistogram);
+                doubleIntervalHistogram = doubleRecorder.getIntervalHistogram(doubleIntervalHistogram);
+                doubleAccumulated.add(doubleIntervalHistogram);
+                writer.join(1);
+            }
+        }
+        accumulated.add(recorder.getIntervalHistogram(intervalHistogram));
+        doubleAccumulated.add(doubleRecorder.getIntervalHistogram(doubleIntervalHistogram));
+
+        long expectedTotal = (long) numberOfThreads * recordingsPerThread;
+        Assert.assertEquals(expectedTotal, accumulated.getTotalCount());
+        Assert.assertEquals(numberOfThreads, accumulated.getCountAtValue(recordingsPerThread / 2));
+        Assert.assertEquals(expectedTotal, doubleAccumulated.getTotalCount());
+        Assert.assertEquals(intervalSamples, flipMetrics.getFlipCount());
+        Assert.assertTrue(flipMetrics.getWriterEntersPerPhase().getMaxValue() <= expectedTotal);
+    }
+
+    @Test
+    public void testLazyCountsAllocationRecorder() throws Exception {
+        Recorder recorder = new Recorder(1, highestTrackableValue, 3, false, true);
+        final int unallocatedFootprint = 512;
+        // Neither interval histogram holds counts until values are recorded:
+        Histogram intervalHistogram = recorder.getIntervalHistogram();
+        final int allocatedFootprint = unallocatedFootprint + (8 * intervalHistogram.countsArrayLength);
+        Assert.assertTrue(intervalHistogram.isLazyCountsAllocation());
+        Assert.assertEquals(0L, intervalHistogram.getTotalCount());
+        Assert.assertEquals(unallocatedFootprint, intervalHistogram.getEstimatedFootprintInBytes());
+        intervalHistogram = recorder.getIntervalHistogram(intervalHistogram);
+        Assert.assertEquals(unallocatedFootprint, intervalHistogram.getEstimatedFootprintInBytes());
+
+        recorder.recordValue(1000);
+        intervalHistogram = recorder.getIntervalHistogram(intervalHistogram);
+        Assert.assertEquals(1L, intervalHistogram.getCountAtValue(1000));
+        Assert.assertEquals(allocatedFootprint, intervalHistogram.getEstimatedFootprintInBytes());
+
+        // Empty intervals add into others without holding counts:
+        Histogram accumulated = new Histogram(highestTrackableValue, 3);
+        accumulated.add(intervalHistogram);
+        intervalHistogram = recorder.getIntervalHistogram(intervalHistogram);
+        Assert.assertEquals(unallocatedFootprint, intervalHistogram.getEstimatedFootprintInBytes());
+        accumulated.add(intervalHistogram);
+        Assert.assertEquals(unallocatedFootprint, intervalHistogram.getEstimatedFootprintInBytes());
+        Assert.assertEquals(1L, accumulated.getTotalCount());
+
+        // The histogram that held the recorded interval keeps its counts through a reset, and releases them
+        // at the following reset, after an idle interval:
+        intervalHistogram = recorder.getIntervalHistogram(intervalHistogram);
+        Assert.assertEquals(0L, intervalHistogram.getTotalCount());
+        Assert.assertEquals(allocatedFootprint, intervalHistogram.getEstimatedFootprintInBytes());
+        intervalHistogram = recorder.getIntervalHistogram(intervalHistogram);
+        intervalHistogram = recorder.getIntervalHistogram(intervalHistogram);
+        Assert.assertEquals(unallocatedFootprint, intervalHistogram.getEstimatedFootprintInBytes());
+
+        recorder.recordValue(2000);
+        intervalHistogram = recorder.getIntervalHistogram(intervalHistogram);
+        Assert.assertEquals(1L, intervalHistogram.getCountAtValue(2000));
+    }
+
+    @Test
+    public void testStripedPhaserCells() throws Exception {
+        Assert.assertEquals(1, new StripedWriterReaderPhaser(1).getNumberOfCells());
+        Assert.assertEquals(8, new StripedWriterReaderPhaser(5).getNumberOfCells());
+        Assert.assertEquals(64, new StripedWriterReaderPhaser(64).getNumberOfCells());
+        Assertions.assertThrows(IllegalArgumentException.class,
+                new Executable() {
+                    @Override
+                    public void execute() throws Throwable {
+                        new StripedWriterReaderPhaser(0);
+                    }
+                });
+
+        // Writers that entered before a flip hold it up, across alternating phase parities:
+        final StripedWriterReaderPhaser phaser = new StripedWriterReaderPhaser(4);
+        for (int flip = 0; flip < 4; flip++) {
+            long criticalValueAtEnter = phaser.writerCriticalSectionEnter();
+            phaser.readerLock();
+            try {
+                phaser.flipEpochs();
+                Assert.assertFalse(phaser.previousPhaseDrained());
+                long criticalValueInNewPhase = phaser.writerCriticalSectionEnter();
+                phaser.writerCriticalSectionExit(criticalValueAtEnter);
+                Assert.assertTrue(phaser.previousPhaseDrained());
+                phaser.writerCriticalSectionExit(criticalValueInNewPhase);
+            } finally {
+                phaser.readerUnlock();
+            }
+        }
+    }
 }